@@ -0,0 +1,526 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include "../include/Matrix.h"
+#include "../include/FixedMatrix.h"
+#include "../include/MatrixBatch.h"
+#include "../include/MatrixKernels.h"
+#include "../include/Parallel.h"
+#include "../include/WorkspaceFile.h"
+
+// Performance suite for the Matrix library, in the style of Google Benchmark:
+// every case is timed over enough iterations to run for --min-time seconds,
+// repeated --repetitions times, and reported as the median time per
+// iteration together with its arithmetic (GFLOP/s) and memory (GB/s)
+// throughput. --json writes the results in a Google-Benchmark-like layout
+// that --baseline reads back, flagging every case that got slower than the
+// stored run by more than --threshold percent.
+//
+// Build with -DCMAKE_BUILD_TYPE=Release: timings of unoptimized builds say
+// little about production performance.
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    // ========================= CASES =========================
+
+    /**
+     * One benchmark: prepare() builds the inputs (untimed) and returns the
+     * body that is timed. flops and bytes are the work of one body call.
+     */
+    struct Case {
+        std::string name;
+        double flops;
+        double bytes;
+        std::function<std::function<void()>()> prepare;
+    };
+
+    struct Result {
+        std::string name;
+        long long iterations;
+        double nsPerIteration;
+        double flops;
+        double bytes;
+    };
+
+    // Stores results the optimizer must not discard
+    volatile double sink = 0.0;
+
+    void keep(const Matrix& m) {
+        sink = m.getRows() > 0 ? m(0, 0) : 0.0;
+    }
+
+    // Deterministic pseudo-random values in [-1, 1)
+    Matrix randomMatrix(int rows, int cols, unsigned seed) {
+        Matrix m(rows, cols);
+        double* values = m.data();
+        unsigned state = seed;
+        for (long long i = 0; i < static_cast<long long>(rows) * cols; ++i) {
+            state = state * 1664525u + 1013904223u;
+            values[i] = static_cast<double>(state >> 8) / static_cast<double>(1u << 23) - 1.0;
+        }
+        return m;
+    }
+
+    // Diagonally dominant, so LU-based cases never hit a singular matrix
+    Matrix wellConditioned(int n, unsigned seed) {
+        Matrix m = randomMatrix(n, n, seed);
+        for (int i = 0; i < n; ++i)
+            m(i, i) += n;
+        return m;
+    }
+
+    std::string shape(int rows, int cols) {
+        return std::to_string(rows) + "x" + std::to_string(cols);
+    }
+
+    // Scratch file for the workspace file cases, removed after the run
+    std::string temporaryPath(const std::string& extension) {
+        static const std::string stem = "matrixBench_" + std::to_string(std::time(nullptr));
+        return (std::filesystem::temp_directory_path() / (stem + extension)).string();
+    }
+
+    std::vector<Case> buildCases(bool quick) {
+        const auto sizes = [quick](std::vector<int> all) {
+            if (quick) all.resize(std::min<std::size_t>(all.size(), 2));
+            return all;
+        };
+        std::vector<Case> cases;
+
+        // Products: square sweep, then tall-times-wide, wide-times-tall and matrix-vector
+        std::vector<std::vector<int>> products;
+        for (int n : sizes({64, 128, 256, 512, 1024}))
+            products.push_back({n, n, n});
+        for (const auto& mkn : std::vector<std::vector<int>>{{1024, 64, 1024}, {64, 1024, 64}, {2048, 2048, 1}})
+            if (!quick) products.push_back(mkn);
+        for (const auto& mkn : products) {
+            const int m = mkn[0], k = mkn[1], n = mkn[2];
+            cases.push_back({"multiply/" + std::to_string(m) + "x" + std::to_string(k) + "x" + std::to_string(n),
+                             2.0 * m * k * n, 8.0 * (double(m) * k + double(k) * n + double(m) * n), [=] {
+                const Matrix a = randomMatrix(m, k, 1u), b = randomMatrix(k, n, 2u);
+                return std::function<void()>([a, b] { keep(a * b); });
+            }});
+        }
+
+        // Strassen against the blocked product above, at and past the crossover
+        for (int n : sizes({1024, 2048})) {
+            cases.push_back({"multiply_strassen/" + std::to_string(n) + "x" + std::to_string(n) + "x" + std::to_string(n),
+                             2.0 * n * n * n, 24.0 * double(n) * n, [=] {
+                const Matrix a = randomMatrix(n, n, 1u), b = randomMatrix(n, n, 2u);
+                Matrix c(n, n);
+                return std::function<void()>([a, b, c, n]() mutable {
+                    MatrixKernels::gemmStrassen(n, n, n, 1.0, a.data(), n, b.data(), n, 0.0, c.data(), n);
+                    keep(c);
+                });
+            }});
+        }
+
+        // Element-wise passes, evaluated into existing storage
+        for (int n : sizes({256, 1024, 2048})) {
+            const double count = double(n) * n;
+            cases.push_back({"add/" + shape(n, n), count, 24.0 * count, [=] {
+                const Matrix a = randomMatrix(n, n, 3u), b = randomMatrix(n, n, 4u);
+                Matrix c(n, n);
+                return std::function<void()>([a, b, c]() mutable { c = a + b; keep(c); });
+            }});
+            cases.push_back({"scale/" + shape(n, n), count, 16.0 * count, [=] {
+                Matrix a = randomMatrix(n, n, 5u);
+                return std::function<void()>([a]() mutable { a *= 1.0000001; keep(a); });
+            }});
+            cases.push_back({"axpy/" + shape(n, n), 2.0 * count, 24.0 * count, [=] {
+                const Matrix a = randomMatrix(n, n, 6u);
+                Matrix c = randomMatrix(n, n, 7u);
+                return std::function<void()>([a, c]() mutable { c.axpy(1e-9, a); keep(c); });
+            }});
+        }
+
+        std::vector<std::pair<int, int>> transposes;
+        for (int n : sizes({256, 1024, 2048}))
+            transposes.emplace_back(n, n);
+        if (!quick) transposes.emplace_back(4096, 256);
+        for (const auto& [rows, cols] : transposes) {
+            cases.push_back({"transpose/" + shape(rows, cols), 0.0, 16.0 * rows * cols, [=] {
+                const Matrix a = randomMatrix(rows, cols, 8u);
+                return std::function<void()>([a] { keep(a.transpose()); });
+            }});
+        }
+
+        // Sizes with fixed-size kernels (FixedKernels), where call overhead dominates
+        for (int n : {3, 4, 8}) {
+            const double n3 = double(n) * n * n, bytes = 8.0 * n * n;
+            cases.push_back({"multiply/" + shape(n, n), 2.0 * n3, 3.0 * bytes, [=] {
+                const Matrix a = randomMatrix(n, n, 15u), b = randomMatrix(n, n, 16u);
+                return std::function<void()>([a, b] { keep(a * b); });
+            }});
+            cases.push_back({"determinant/" + shape(n, n), 2.0 * n3 / 3.0, bytes, [=] {
+                const Matrix a = wellConditioned(n, 17u);
+                return std::function<void()>([a] { sink = a.determinant(); });
+            }});
+            cases.push_back({"inverse/" + shape(n, n), 2.0 * n3, 2.0 * bytes, [=] {
+                const Matrix a = wellConditioned(n, 18u);
+                return std::function<void()>([a] { keep(a.inverse()); });
+            }});
+        }
+
+        // Factorization-based operations (flop counts of the textbook algorithms)
+        for (int n : sizes({64, 128, 256, 512})) {
+            const double n3 = double(n) * n * n, bytes = 8.0 * n * n;
+            cases.push_back({"determinant/" + shape(n, n), 2.0 * n3 / 3.0, bytes, [=] {
+                const Matrix a = wellConditioned(n, 9u);
+                return std::function<void()>([a] { sink = a.determinant(); });
+            }});
+            cases.push_back({"rank/" + shape(n, n), 2.0 * n3 / 3.0, bytes, [=] {
+                const Matrix a = randomMatrix(n, n, 10u);
+                return std::function<void()>([a] { sink = a.rank(); });
+            }});
+            cases.push_back({"inverse/" + shape(n, n), 2.0 * n3, 2.0 * bytes, [=] {
+                const Matrix a = wellConditioned(n, 11u);
+                return std::function<void()>([a] { keep(a.inverse()); });
+            }});
+            cases.push_back({"solve/" + shape(n, n), 2.0 * n3 / 3.0 + 4.0 * n * n, bytes, [=] {
+                const Matrix a = wellConditioned(n, 12u), b = randomMatrix(n, 1, 13u);
+                return std::function<void()>([a, b] { keep(a.solve(b).x); });
+            }});
+        }
+        if (!quick) {
+            cases.push_back({"rank/512x128", 2.0 * 128 * 128 * (512 - 128 / 3.0), 8.0 * 512 * 128, [] {
+                const Matrix a = randomMatrix(512, 128, 14u);
+                return std::function<void()>([a] { sink = a.rank(); });
+            }});
+        }
+
+        // Many small systems: one batched call against a Matrix per system
+        for (int n : sizes({4, 16})) {
+            const int count = quick ? 10000 : 100000;
+            const double flops = count * (2.0 * n * n * n / 3.0 + 2.0 * n * n), bytes = 8.0 * count * (n * n + 2.0 * n);
+            const std::string name = std::to_string(count) + "x" + shape(n, n);
+            cases.push_back({"batch_solve/" + name, flops, bytes, [=] {
+                MatrixBatch a(count, n, n), b(count, n, 1);
+                for (int k = 0; k < count; ++k) {
+                    a.setMatrix(k, wellConditioned(n, 30u + k));
+                    b.setMatrix(k, randomMatrix(n, 1, 31u + k));
+                }
+                return std::function<void()>([a, b] { sink = batchSolve(a, b).singularCount; });
+            }});
+            cases.push_back({"solve_each/" + name, flops, bytes, [=] {
+                std::vector<Matrix> a, b;
+                for (int k = 0; k < count; ++k) {
+                    a.push_back(wellConditioned(n, 30u + k));
+                    b.push_back(randomMatrix(n, 1, 31u + k));
+                }
+                return std::function<void()>([a, b, count] {
+                    for (int k = 0; k < count; ++k) keep(a[k].solve(b[k]).x);
+                });
+            }});
+        }
+
+        // 9 multiplies and 6 adds per rotated vector
+        for (int n : sizes({1000, 100000, 1000000})) {
+            cases.push_back({"rotate3D/" + shape(3, n), 15.0 * n, 48.0 * n, [=] {
+                const Matrix vectors = randomMatrix(3, n, 15u);
+                return std::function<void()>([vectors] { keep(vectors.rotate3D(10.0, 20.0, 30.0)); });
+            }});
+        }
+
+        // Workspace files; bytes are those of the matrix elements
+        for (int n : sizes({256, 1024})) {
+            const double bytes = 8.0 * n * n;
+            for (const std::string format : {"text", "binary"}) {
+                const bool binary = format == "binary";
+                const std::string path = temporaryPath(binary ? ".bin" : ".txt");
+                cases.push_back({"save_" + format + "/" + shape(n, n), 0.0, bytes, [=] {
+                    const Matrix a = randomMatrix(n, n, 16u);
+                    return std::function<void()>([a, path, binary] {
+                        const std::vector<std::pair<std::string, const Matrix*>> matrices{{"A", &a}};
+                        if (binary) WorkspaceFile::writeBinary(path, matrices);
+                        else WorkspaceFile::writeText(path, matrices);
+                    });
+                }});
+                cases.push_back({"load_" + format + "/" + shape(n, n), 0.0, bytes, [=] {
+                    const Matrix a = randomMatrix(n, n, 17u);
+                    const std::vector<std::pair<std::string, const Matrix*>> matrices{{"A", &a}};
+                    if (binary) WorkspaceFile::writeBinary(path, matrices);
+                    else WorkspaceFile::writeText(path, matrices);
+                    return std::function<void()>([path, binary] {
+                        const auto loaded = binary ? WorkspaceFile::readBinary(path) : WorkspaceFile::readText(path);
+                        keep(loaded.front().second);
+                    });
+                }});
+            }
+        }
+        return cases;
+    }
+
+    // ========================= RUNNING =========================
+
+    /**
+     * Discards everything written to a stream while in scope (Matrix warns
+     * about large matrices on std::cerr).
+     */
+    class Silence {
+    public:
+        explicit Silence(std::ostream& stream) : _stream(stream), _previous(stream.rdbuf(&_null)) {}
+        ~Silence() { _stream.rdbuf(_previous); }
+        Silence(const Silence&) = delete;
+        Silence& operator=(const Silence&) = delete;
+
+    private:
+        struct NullBuffer : std::streambuf {
+            int overflow(int c) override { return traits_type::not_eof(c); }
+        };
+        NullBuffer _null;
+        std::ostream& _stream;
+        std::streambuf* _previous;
+    };
+
+    double secondsSince(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    double timeIterations(const std::function<void()>& body, long long iterations) {
+        const Clock::time_point start = Clock::now();
+        for (long long i = 0; i < iterations; ++i)
+            body();
+        return secondsSince(start);
+    }
+
+    /**
+     * Grow the iteration count until one batch runs for minTime (as Google
+     * Benchmark does), then time `repetitions` batches and keep the median.
+     */
+    Result runCase(const Case& c, double minTime, int repetitions) {
+        Silence quiet(std::cerr);
+        const std::function<void()> body = c.prepare();
+        body(); // warm-up: page in the inputs, fill the allocator's cache
+
+        long long iterations = 1;
+        double elapsed = timeIterations(body, iterations);
+        while (elapsed < minTime && iterations < (1LL << 30)) {
+            const double scale = elapsed > 0.0 ? 1.4 * minTime / elapsed : 10.0;
+            iterations = std::max(iterations + 1, static_cast<long long>(iterations * std::min(scale, 10.0)));
+            elapsed = timeIterations(body, iterations);
+        }
+
+        std::vector<double> samples{elapsed / iterations};
+        for (int r = 1; r < repetitions; ++r)
+            samples.push_back(timeIterations(body, iterations) / iterations);
+        std::sort(samples.begin(), samples.end());
+        return {c.name, iterations, 1e9 * samples[samples.size() / 2], c.flops, c.bytes};
+    }
+
+    double gflops(const Result& r) { return r.flops / r.nsPerIteration; }
+    double gigabytesPerSecond(const Result& r) { return r.bytes / r.nsPerIteration; }
+
+    std::string formatTime(double ns) {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(ns < 1e4 ? 0 : 1);
+        if (ns < 1e4) out << ns << " ns";
+        else if (ns < 1e7) out << ns / 1e3 << " us";
+        else out << ns / 1e6 << " ms";
+        return out.str();
+    }
+
+    void printHeader() {
+        std::cout << std::left << std::setw(28) << "Benchmark" << std::right
+                  << std::setw(14) << "Time" << std::setw(12) << "Iterations"
+                  << std::setw(11) << "GFLOP/s" << std::setw(10) << "GB/s" << '\n'
+                  << std::string(75, '-') << std::endl;
+    }
+
+    void printResult(const Result& r) {
+        std::cout << std::left << std::setw(28) << r.name << std::right
+                  << std::setw(14) << formatTime(r.nsPerIteration) << std::setw(12) << r.iterations
+                  << std::fixed << std::setprecision(2);
+        if (r.flops > 0.0) std::cout << std::setw(11) << gflops(r);
+        else std::cout << std::setw(11) << "-";
+        std::cout << std::setw(10) << gigabytesPerSecond(r) << std::endl;
+    }
+
+    // ========================= JSON =========================
+
+    void writeJson(const std::string& path, const std::vector<Result>& results) {
+        std::ofstream out(path);
+        if (!out)
+            throw std::runtime_error("Could not write '" + path + "'.");
+        char date[32];
+        const std::time_t now = std::time(nullptr);
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+        out << std::setprecision(10)
+            << "{\n  \"context\": {\n"
+            << "    \"date\": \"" << date << "\",\n"
+            << "    \"policy\": \"" << Parallel::currentPolicy().describe() << "\",\n"
+            << "    \"threads\": " << Parallel::workerCount() << ",\n"
+#ifdef NDEBUG
+            << "    \"library_build_type\": \"release\"\n"
+#else
+            << "    \"library_build_type\": \"debug\"\n"
+#endif
+            << "  },\n  \"benchmarks\": [\n";
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
+            out << "    {\n"
+                << "      \"name\": \"" << r.name << "\",\n"
+                << "      \"iterations\": " << r.iterations << ",\n"
+                << "      \"real_time\": " << r.nsPerIteration << ",\n"
+                << "      \"time_unit\": \"ns\",\n"
+                << "      \"flops_per_second\": " << r.flops / r.nsPerIteration * 1e9 << ",\n"
+                << "      \"bytes_per_second\": " << r.bytes / r.nsPerIteration * 1e9 << "\n"
+                << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+    }
+
+    /**
+     * Read "name" -> real_time (ns) from a file written by writeJson() (or
+     * by Google Benchmark with time_unit ns). Only the fields needed for a
+     * comparison are parsed.
+     */
+    std::map<std::string, double> readBaseline(const std::string& path) {
+        std::ifstream in(path);
+        if (!in)
+            throw std::runtime_error("Could not open baseline '" + path + "'.");
+        const std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+        const auto valueAfter = [&text](const std::string& key, std::size_t from) -> std::size_t {
+            const std::size_t at = text.find("\"" + key + "\"", from);
+            if (at == std::string::npos) return at;
+            const std::size_t colon = text.find(':', at);
+            return colon == std::string::npos ? colon : text.find_first_not_of(" \t\r\n", colon + 1);
+        };
+
+        std::map<std::string, double> times;
+        for (std::size_t pos = valueAfter("name", 0); pos != std::string::npos && text[pos] == '"';
+             pos = valueAfter("name", pos)) {
+            const std::size_t end = text.find('"', pos + 1);
+            const std::size_t time = valueAfter("real_time", end);
+            if (end == std::string::npos || time == std::string::npos)
+                throw std::runtime_error("Malformed baseline '" + path + "'.");
+            times[text.substr(pos + 1, end - pos - 1)] = std::strtod(text.c_str() + time, nullptr);
+            pos = time;
+        }
+        return times;
+    }
+
+    /**
+     * Print each result next to its baseline; returns the number of regressions.
+     */
+    int compare(const std::vector<Result>& results, const std::map<std::string, double>& baseline, double thresholdPercent) {
+        std::cout << std::defaultfloat << "\nComparison with baseline (regression: more than " << thresholdPercent << "% slower)\n"
+                  << std::left << std::setw(28) << "Benchmark" << std::right << std::setw(14) << "Baseline"
+                  << std::setw(14) << "Current" << std::setw(10) << "Change" << '\n'
+                  << std::string(66, '-') << std::endl;
+        int regressions = 0;
+        for (const Result& r : results) {
+            std::cout << std::left << std::setw(28) << r.name << std::right;
+            const auto it = baseline.find(r.name);
+            if (it == baseline.end() || it->second <= 0.0) {
+                std::cout << std::setw(14) << "-" << std::setw(14) << formatTime(r.nsPerIteration) << "       new" << std::endl;
+                continue;
+            }
+            const double change = 100.0 * (r.nsPerIteration / it->second - 1.0);
+            const bool regressed = change > thresholdPercent;
+            regressions += regressed;
+            std::cout << std::setw(14) << formatTime(it->second) << std::setw(14) << formatTime(r.nsPerIteration)
+                      << std::setw(9) << std::showpos << std::fixed << std::setprecision(1) << change << "%"
+                      << std::noshowpos << (regressed ? "  REGRESSION" : "") << std::endl;
+        }
+        return regressions;
+    }
+
+    void printUsage(const char* program) {
+        std::cerr << "Usage: " << program << " [options]\n"
+                  << "  --filter <text>       run only benchmarks whose name contains text\n"
+                  << "  --list                list the benchmarks and exit\n"
+                  << "  --quick               smallest sizes only (a smoke test)\n"
+                  << "  --min-time <seconds>  minimum time per measurement (default 0.2)\n"
+                  << "  --repetitions <n>     measurements per benchmark, median reported (default 3)\n"
+                  << "  --threads <n>         thread limit, 1 = serial (default: all cores)\n"
+                  << "  --json <file>         write the results as JSON\n"
+                  << "  --baseline <file>     compare against a JSON file written by --json\n"
+                  << "  --threshold <percent> slowdown reported as a regression (default 10)\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string filter, jsonPath, baselinePath;
+    bool list = false, quick = false;
+    double minTime = 0.2, threshold = 10.0;
+    int repetitions = 3;
+    long threads = -1;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--list") list = true;
+        else if (arg == "--quick") quick = true;
+        else if (arg == "--filter" && hasValue) filter = argv[++i];
+        else if (arg == "--json" && hasValue) jsonPath = argv[++i];
+        else if (arg == "--baseline" && hasValue) baselinePath = argv[++i];
+        else if (arg == "--min-time" && hasValue) minTime = std::atof(argv[++i]);
+        else if (arg == "--repetitions" && hasValue) repetitions = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--threshold" && hasValue) threshold = std::atof(argv[++i]);
+        else if (arg == "--threads" && hasValue) threads = std::atol(argv[++i]);
+        else {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (threads == 1) Parallel::setDefaultPolicy(ExecutionPolicy::serial());
+    else if (threads > 1) Parallel::setDefaultPolicy(ExecutionPolicy::parallel(static_cast<unsigned>(threads)));
+
+    std::vector<Case> cases = buildCases(quick);
+    cases.erase(std::remove_if(cases.begin(), cases.end(),
+                               [&filter](const Case& c) { return c.name.find(filter) == std::string::npos; }),
+                cases.end());
+    if (list) {
+        for (const Case& c : cases)
+            std::cout << c.name << '\n';
+        return 0;
+    }
+
+    try {
+        std::map<std::string, double> baseline;
+        if (!baselinePath.empty())
+            baseline = readBaseline(baselinePath);
+
+#ifndef NDEBUG
+        std::cout << "Note: built without NDEBUG; use a Release build for meaningful timings.\n";
+#endif
+        std::cout << "Policy: " << Parallel::currentPolicy().describe() << "\n\n";
+        printHeader();
+        std::vector<Result> results;
+        for (const Case& c : cases) {
+            results.push_back(runCase(c, minTime, repetitions));
+            printResult(results.back());
+        }
+
+        for (const char* extension : {".txt", ".bin"})
+            std::remove(temporaryPath(extension).c_str());
+
+        if (!jsonPath.empty())
+            writeJson(jsonPath, results);
+        if (!baselinePath.empty() && compare(results, baseline, threshold) > 0)
+            return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 2;
+    }
+    return 0;
+}
@@ -1,68 +1,230 @@
 #include "CLI.h"
+#include "WorkspaceFile.h"
+#include "Profiler.h"
+#include "TaskScheduler.h"
 #include <sstream>
 #include <iostream>
 #include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <new>
+#include <thread>
 
+namespace {
+    /**
+     * Points a stream at another buffer for its lifetime; a null target
+     * leaves the stream alone.
+     */
+    class StreamRedirect {
+    public:
+        StreamRedirect(std::ios& stream, std::streambuf* target)
+            : _stream(stream), _previous(target ? stream.rdbuf(target) : nullptr) {}
+        ~StreamRedirect() {
+            if (_previous) _stream.rdbuf(_previous);
+        }
+        StreamRedirect(const StreamRedirect&) = delete;
+        StreamRedirect& operator=(const StreamRedirect&) = delete;
+
+    private:
+        std::ios& _stream;
+        std::streambuf* _previous;
+    };
+
+    /**
+     * Reads through to another buffer, counting the lines taken from it.
+     * Unbuffered, so input read by a command (assign) is counted too and
+     * nothing is read beyond what was asked for.
+     */
+    class LineCounter : public std::streambuf {
+    public:
+        explicit LineCounter(std::streambuf* source) : _source(source) {}
+
+        /** Number of the line the next character belongs to (1-based). */
+        [[nodiscard]] size_t nextLine() const { return _lines + 1; }
+
+    protected:
+        int_type underflow() override { return _source->sgetc(); }
+
+        int_type uflow() override {
+            const int_type c = _source->sbumpc();
+            if (traits_type::eq_int_type(c, traits_type::to_int_type('\n'))) ++_lines;
+            return c;
+        }
 
+    private:
+        std::streambuf* _source;
+        size_t _lines = 0;
+    };
+
+    std::string formatMilliseconds(double seconds) {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(3) << seconds * 1e3 << " ms";
+        return out.str();
+    }
+
+    /**
+     * Counts and times the commands of a script, reports the failed ones
+     * on std::cerr and prints the summary at the end.
+     */
+    class ScriptReport {
+    public:
+        explicit ScriptReport(bool verbose) : _verbose(verbose) {}
+
+        /**
+         * Record one command; captured is its suppressed output, shown if it failed.
+         */
+        void record(const std::string& command, size_t lineNumber, const std::string& line, bool succeeded,
+                    double seconds, const std::string& captured) {
+            CommandTiming& timing = _timings[command];
+            ++timing.count;
+            timing.seconds += seconds;
+            ++_executed;
+            if (!succeeded) {
+                ++_failed;
+                std::cerr << "Command failed at line " << lineNumber << ": " << line << '\n' << captured;
+            }
+            if (_verbose) {
+                std::cerr << "[" << formatMilliseconds(seconds) << "] " << line << '\n';
+            }
+        }
+
+        /**
+         * Print the summary; returns the script's exit status.
+         */
+        int finish(double totalSeconds) const {
+            std::ostringstream summary;
+            summary << "Script finished: " << _executed << (_executed == 1 ? " command" : " commands")
+                    << " (" << _failed << " failed) in " << formatMilliseconds(totalSeconds) << ".\n";
+            for (const auto& [name, timing] : _timings) {
+                summary << "  " << std::left << std::setw(16) << name << std::right << std::setw(8) << timing.count
+                        << std::setw(16) << formatMilliseconds(timing.seconds) << '\n';
+            }
+            std::cerr << summary.str();
+            return _failed == 0 ? 0 : 1;
+        }
 
-CLI::CLI()
-    : workspace(),
-      available_commands{
-          "create", "load", "help", "exit"
+    private:
+        struct CommandTiming {
+            size_t count = 0;
+            double seconds = 0.0;
+        };
+
+        bool _verbose;
+        std::map<std::string, CommandTiming> _timings;
+        size_t _executed = 0, _failed = 0;
+    };
+}
+
+
+
+CLI::CLI() : CLI(Workspace()) {}
+
+CLI::CLI(Workspace&& workspace)
+    : workspace(std::move(workspace)),
+      command_order{
+          "create", "create_sparse", "create_float32", "create_disk", "delete", "assign", "set",
+          "to_sparse", "to_dense", "to_float32", "to_float64", "to_disk", "to_memory", "scalar_multiply",
+          "transpose", "rank", "det", "inverse", "lu", "3d_rotate", "add", "subtract",
+          "multiply", "solve", "lu_solve", "lstsq", "list", "show", "save", "load",
+          "create_batch", "batch_put", "batch_get", "batch_multiply", "batch_solve", "batch_det", "batch_inverse",
+          "policy", "solver", "stats", "trace", "help", "exit"
       },
       commands{
           {"create",
               { [this](std::istringstream& iss){ return executeCreateCommand(iss); },
                 "Create a new matrix with optional initial value.",
-                "create <matName> <rows> <cols> [initValue]" }},
+                "create <matName> <rows> <cols> [initValue]", 0, false, Access::WritesFirst }},
+          {"create_sparse",
+              { [this](std::istringstream& iss){ return executeCreateSparseCommand(iss); },
+                "Create a new all-zero sparse matrix (not bound by the dense size limit).",
+                "create_sparse <matName> <rows> <cols>", 0, false, Access::WritesFirst }},
+          {"create_float32",
+              { [this](std::istringstream& iss){ return executeCreateFloat32Command(iss); },
+                "Create a new single-precision matrix (half the memory) with optional initial value.",
+                "create_float32 <matName> <rows> <cols> [initValue]", 0, false, Access::WritesFirst }},
+          {"create_disk",
+              { [this](std::istringstream& iss){ return executeCreateDiskCommand(iss); },
+                "Create a new matrix stored in a temporary file (for matrices larger than memory).",
+                "create_disk <matName> <rows> <cols> [initValue]" }},
+          {"set",
+              { [this](std::istringstream& iss){ return executeSetCommand(iss); },
+                "Set a single element of a matrix.",
+                "set <matName> <row> <col> <value>", 1, false, Access::WritesFirst }},
+          {"to_sparse",
+              { [this](std::istringstream& iss){ return executeToSparseCommand(iss); },
+                "Store a matrix in sparse form (only its non-zeros are kept).",
+                "to_sparse <matName>", 1, false, Access::WritesFirst }},
+          {"to_dense",
+              { [this](std::istringstream& iss){ return executeToDenseCommand(iss); },
+                "Store a sparse matrix in dense form.",
+                "to_dense <matName>", 1, false, Access::WritesFirst }},
+          {"to_float32",
+              { [this](std::istringstream& iss){ return executeToFloat32Command(iss); },
+                "Store a dense matrix in single precision (elements are rounded).",
+                "to_float32 <matName>", 1, false, Access::WritesFirst }},
+          {"to_float64",
+              { [this](std::istringstream& iss){ return executeToFloat64Command(iss); },
+                "Store a single-precision matrix in double precision.",
+                "to_float64 <matName>", 1, false, Access::WritesFirst }},
+          {"to_disk",
+              { [this](std::istringstream& iss){ return executeToDiskCommand(iss); },
+                "Move a dense matrix out of memory into a temporary file.",
+                "to_disk <matName>", 1 }},
+          {"to_memory",
+              { [this](std::istringstream& iss){ return executeToMemoryCommand(iss); },
+                "Load a matrix stored on disk back into memory.",
+                "to_memory <matName>", 1 }},
           {"delete",
               { [this](std::istringstream& iss){ return executeDeleteCommand(iss); },
                 "Delete a matrix from the workspace.",
-                "delete <matName>" }},
+                "delete <matName>", 1, false, Access::WritesFirst }},
           {"assign",
               { [this](std::istringstream& iss){ return executeAssignCommand(iss); },
                 "Assign values to a matrix interactively.",
-                "assign <matName>" }},
+                "assign <matName>", 1 }},
           {"list",
               { [this](std::istringstream& iss){ return executeListCommand(iss); },
                 "List all matrices in the workspace.",
-                "list" }},
+                "list", 1, true }},
           {"show",
               { [this](std::istringstream& iss){ return executeShowCommand(iss); },
                 "Display the contents of a matrix.",
-                "show <matName>" }},
+                "show <matName>", 1, true, Access::ReadsFirst }},
           {"add",
               { [this](std::istringstream& iss){ return executeAddCommand(iss); },
                 "Add two matrices and store the result.",
-                "add <resultName> <mat1Name> <mat2Name>" }},
+                "add <resultName> <mat1Name> <mat2Name>", 2, false, Access::WritesFirstReadsRest }},
           {"subtract",
               { [this](std::istringstream& iss){ return executeSubtractCommand(iss); },
                 "Subtract one matrix from another and store the result.",
-                "subtract <resultName> <mat1Name> <mat2Name>" }},
+                "subtract <resultName> <mat1Name> <mat2Name>", 2, false, Access::WritesFirstReadsRest }},
           {"multiply",
               { [this](std::istringstream& iss){ return executeMultiplyCommand(iss); },
                 "Multiply two matrices and store the result.",
-                "multiply <resultName> <mat1Name> <mat2Name>" }},
+                "multiply <resultName> <mat1Name> <mat2Name>", 2, false, Access::WritesFirstReadsRest }},
           {"scalar_multiply",
               { [this](std::istringstream& iss){ return executeScalarMultiplyCommand(iss); },
                 "Multiply a matrix by a scalar and store the result.",
-                "scalar_multiply <resultName> <matName> <scalar>" }},
+                "scalar_multiply <resultName> <matName> <scalar>", 1, false, Access::WritesFirstReadsRest, {2} }},
           {"transpose",
               { [this](std::istringstream& iss){ return executeTransposeCommand(iss); },
                 "Transpose a matrix.",
-                "transpose <matName>" }},
+                "transpose <matName>", 1, false, Access::WritesFirst }},
           {"help",
               { [this](std::istringstream& iss) { return printHelp(iss); },
                 "Display this help message.",
-                "help" }},
+                "help", 0, true }},
           {"exit",
               { [this](std::istringstream& iss){ return exitCLI(iss); },
                 "Exit the CLI.",
                 "exit" }},
           {"save",
               { [this](std::istringstream& iss){ return executeSaveCommand(iss); },
-                "Save the current workspace to a file.",
-                "save <filename>" }},
+                "Save the current workspace to a file (binary if the name ends in .bin).",
+                "save <filename>", 1 }},
           {"load",
               { [this](std::istringstream& iss){ return executeLoadCommand(iss); },
                 "Load a workspace from a file.",
@@ -70,27 +232,85 @@ CLI::CLI()
           {"rank",
               { [this](std::istringstream& iss){ return executeRankCommand(iss); },
                 "Get the rank of a matrix.",
-                "rank <matName>" }},
+                "rank <matName>", 1, true, Access::ReadsFirst }},
           {"det",
               { [this](std::istringstream& iss){ return executeDeterminantCommand(iss); },
                 "Get the determinant of a matrix.",
-                "det <matName>" }},
+                "det <matName>", 1, true, Access::ReadsFirst }},
           {"inverse",
               { [this](std::istringstream& iss){ return executeInverseCommand(iss); },
                 "Get the inverse of a matrix and store it.",
-                "inverse <resultName> <matName>" }},
+                "inverse <resultName> <matName>", 1, false, Access::WritesFirstReadsRest }},
           {"solve",
               { [this](std::istringstream& iss){ return executeSolveCommand(iss); },
                 "Solve the linear system Ax=b and store the result.",
-                "solve <resultName> <matrixA> <columnB>" }},
+                "solve <resultName> <matrixA> <columnB>", 2, false, Access::WritesFirstReadsRest }},
+          {"lu",
+              { [this](std::istringstream& iss){ return executeLUCommand(iss); },
+                "Compute and store the LU factorization of a matrix for repeated solves.",
+                "lu <matName>", 1, false, Access::ReadsFirst }},
+          {"lu_solve",
+              { [this](std::istringstream& iss){ return executeLUSolveCommand(iss); },
+                "Solve AX=B using the stored LU factors of A (factoring A if needed).",
+                "lu_solve <resultName> <matrixA> <matrixB>", 2, false, Access::WritesFirstReadsRest }},
+          {"lstsq",
+              { [this](std::istringstream& iss){ return executeLeastSquaresCommand(iss); },
+                "Store the least-squares solution of AX=B (any shape of A, also overdetermined).",
+                "lstsq <resultName> <matrixA> <matrixB>", 2, false, Access::WritesFirstReadsRest }},
+          {"create_batch",
+              { [this](std::istringstream& iss){ return executeCreateBatchCommand(iss); },
+                "Create a batch of same-shaped matrices, for batched products, solves, determinants and inverses.",
+                "create_batch <batchName> <count> <rows> <cols> [initValue]", 0, false, Access::WritesFirst }},
+          {"batch_put",
+              { [this](std::istringstream& iss){ return executeBatchPutCommand(iss); },
+                "Copy a matrix into a batch at the given index.",
+                "batch_put <batchName> <index> <matName>", 1, false, Access::WritesFirstReadsRest, {1} }},
+          {"batch_get",
+              { [this](std::istringstream& iss){ return executeBatchGetCommand(iss); },
+                "Copy the matrix at the given index of a batch out as a matrix.",
+                "batch_get <matName> <batchName> <index>", 1, false, Access::WritesFirstReadsRest, {2} }},
+          {"batch_multiply",
+              { [this](std::istringstream& iss){ return executeBatchMultiplyCommand(iss); },
+                "Multiply two batches matrix by matrix and store the batch of products.",
+                "batch_multiply <resultName> <batchA> <batchB>", 1, false, Access::WritesFirstReadsRest }},
+          {"batch_solve",
+              { [this](std::istringstream& iss){ return executeBatchSolveCommand(iss); },
+                "Solve A_k X_k = B_k for every matrix of two batches and store the batch of solutions.",
+                "batch_solve <resultName> <batchA> <batchB>", 1, false, Access::WritesFirstReadsRest }},
+          {"batch_det",
+              { [this](std::istringstream& iss){ return executeBatchDeterminantCommand(iss); },
+                "Store the determinants of a batch as a column matrix.",
+                "batch_det <resultName> <batchName>", 1, false, Access::WritesFirstReadsRest }},
+          {"batch_inverse",
+              { [this](std::istringstream& iss){ return executeBatchInverseCommand(iss); },
+                "Invert every matrix of a batch and store the batch of inverses.",
+                "batch_inverse <resultName> <batchName>", 1, false, Access::WritesFirstReadsRest }},
+          {"policy",
+              { [this](std::istringstream& iss){ return executePolicyCommand(iss); },
+                "Show or set the execution policy (serial, or parallel with an optional thread count; strassen selects the Strassen multiply for large products).",
+                "policy [serial | parallel [threads]] [strassen]", 0, true }},
+          {"solver",
+              { [this](std::istringstream& iss){ return executeSolverCommand(iss); },
+                "Show or set the solver used by 'solve' (iterative solvers take a preconditioner, tolerance and iteration cap).",
+                "solver [direct | cg | gmres | bicgstab [none | jacobi | ilu0] [tolerance] [maxIterations]]", 0, true }},
+          {"stats",
+              { [this](std::istringstream& iss){ return executeStatsCommand(iss); },
+                "Show (or reset) the calls, time, GFLOP/s and allocations of every instrumented operation.",
+                "stats [reset]", 0, true }},
+          {"trace",
+              { [this](std::istringstream& iss){ return executeTraceCommand(iss); },
+                "Record a timeline of the instrumented operations, written as Chrome trace JSON (Perfetto).",
+                "trace start | trace stop <file>" }},
             {"3d_rotate",
               { [this](std::istringstream& iss){ return execute3DVectorRotationCommand(iss); },
-                "Rotate a 3D vector(3x1) around the axis by given degrees.",
-                "3d_rotate <vectorName> <angleDegreesX> <angleDegreesY> <angleDegreesZ" }}
+                "Rotate 3D vectors (3x1, or every column of a 3xN matrix) around the axes by given degrees.",
+                "3d_rotate <vectorName> [<vectorName> ...] <angleDegreesX> <angleDegreesY> <angleDegreesZ>", 1, false, Access::WritesAllButLast3 }}
 
       },
       running(RUNNING)
-{};
+{
+    checkAvailableCommands();
+}
 
 void CLI::startCLI() {
     std::cout << "Algebraic Matrix CLI v1.0" << std::endl;
@@ -98,7 +318,7 @@ void CLI::startCLI() {
         printAvailableCommands();
         std::string input;
         std::cout << "> ";
-        std::getline(std::cin, input);
+        if (!std::getline(std::cin, input)) break; // end of input
         if (input.empty()) continue;
 
         if (!executeCommand(input)) {
@@ -108,6 +328,178 @@ void CLI::startCLI() {
     }
 }
 
+int CLI::runScript(std::istream& script, const bool verbose, const bool async) {
+    if (async) return runScriptAsync(script, verbose);
+
+    using Clock = std::chrono::steady_clock;
+    // The script doubles as std::cin, for commands that read further input (assign)
+    LineCounter counter(script.rdbuf());
+    StreamRedirect input(std::cin, &counter);
+
+    std::ostringstream captured;
+    ScriptReport report(verbose);
+    const Clock::time_point start = Clock::now();
+
+    std::string line;
+    for (size_t lineNumber = counter.nextLine(); running && std::getline(std::cin, line);
+         lineNumber = counter.nextLine()) {
+        std::istringstream iss(line);
+        std::string command;
+        if (!(iss >> command) || command.front() == '#') continue;
+
+        const auto info = commands.find(command);
+        const bool quiet = !verbose && (info == commands.end() || !info->second.printsResult);
+        captured.str("");
+        const Clock::time_point begin = Clock::now();
+        bool succeeded;
+        {
+            StreamRedirect output(std::cout, quiet ? captured.rdbuf() : nullptr);
+            succeeded = dispatchCommand(command, iss);
+        }
+        report.record(command, lineNumber, line, succeeded,
+                      std::chrono::duration<double>(Clock::now() - begin).count(), captured.str());
+    }
+
+    return report.finish(std::chrono::duration<double>(Clock::now() - start).count());
+}
+
+int CLI::runScriptAsync(std::istream& script, const bool verbose) {
+    using Clock = std::chrono::steady_clock;
+    LineCounter counter(script.rdbuf());
+    StreamRedirect input(std::cin, &counter);
+
+    // A command in flight: it runs on its own CLI over a snapshot of the matrices it names
+    struct Job {
+        std::string command, args, line;
+        size_t lineNumber = 0;
+        bool quiet = false;
+        std::vector<std::string> reads, writes;
+        std::unique_ptr<CLI> worker;
+        std::ostringstream output;
+        bool succeeded = false;
+        double seconds = 0.0;
+    };
+
+    std::ostringstream captured;
+    ScriptReport report(verbose);
+    const Clock::time_point start = Clock::now();
+    TaskScheduler scheduler(std::max(2u, std::thread::hardware_concurrency()));
+    int pendingDeletes = 0; // scheduled deletes not yet committed: the matrix count may still drop
+
+    std::string line;
+    for (size_t lineNumber = counter.nextLine(); running && std::getline(std::cin, line);
+         lineNumber = counter.nextLine()) {
+        std::istringstream iss(line);
+        std::string command;
+        if (!(iss >> command) || command.front() == '#') continue;
+
+        const auto info = commands.find(command);
+        auto job = std::make_shared<Job>();
+        job->command = command;
+        job->lineNumber = lineNumber;
+        job->line = line;
+        job->quiet = !verbose && (info == commands.end() || !info->second.printsResult);
+        std::getline(iss, job->args);
+        if (info != commands.end())
+            commandAccess(info->second, job->args, job->reads, job->writes);
+        std::vector<std::string> names = job->reads;
+        names.insert(names.end(), job->writes.begin(), job->writes.end());
+
+        // A command is offered by the matrix count it would see in a synchronous run:
+        // scheduled commands may still add matrices, and deletes remove them
+        const bool available = isAvailable(command) && (info->second.minMatrices == 0 || pendingDeletes == 0);
+
+        if (!available || info->second.access == Access::Exclusive || !workspace.canSnapshot(names)) {
+            // Runs alone on the workspace itself, as in a synchronous script
+            scheduler.waitAll();
+            std::istringstream args(job->args);
+            captured.str("");
+            const Clock::time_point begin = Clock::now();
+            bool succeeded;
+            {
+                StreamRedirect output(std::cout, job->quiet ? captured.rdbuf() : nullptr);
+                succeeded = dispatchCommand(command, args);
+            }
+            report.record(command, lineNumber, line, succeeded,
+                          std::chrono::duration<double>(Clock::now() - begin).count(), captured.str());
+            continue;
+        }
+
+        TaskScheduler::Task task;
+        task.reads = job->reads;
+        task.writes = job->writes;
+        task.start = [this, job, names] {
+            job->worker.reset(new CLI(workspace.snapshot(names)));
+            job->worker->workspace.setOutput(job->output);
+            job->output.copyfmt(std::cout);
+            return [job] {
+                const Clock::time_point begin = Clock::now();
+                {
+                    MATRIX_PROFILE_DYNAMIC("CLI::" + job->command);
+                    std::istringstream args(job->args);
+                    job->succeeded = job->worker->runAction(job->command, args);
+                }
+                job->seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+            };
+        };
+        const bool deletes = command == "delete";
+        if (deletes) ++pendingDeletes;
+        task.commit = [this, job, deletes, &pendingDeletes] {
+            workspace.merge(std::move(job->worker->workspace), job->writes, job->reads);
+            job->worker.reset();
+            if (deletes) --pendingDeletes;
+        };
+        task.retire = [this, job, &report] {
+            if (!job->quiet) std::cout << job->output.str() << std::flush;
+            // Printing a matrix leaves its stream in fixed notation, which later numbers keep
+            if ((job->output.flags() & std::ios::fixed) && !(std::cout.flags() & std::ios::fixed))
+                std::cout.copyfmt(job->output);
+            report.record(job->command, job->lineNumber, job->line, job->succeeded, job->seconds,
+                          job->quiet ? job->output.str() : std::string());
+            workspace.endCommand();
+        };
+        scheduler.submit(std::move(task));
+    }
+    scheduler.waitAll();
+
+    return report.finish(std::chrono::duration<double>(Clock::now() - start).count());
+}
+
+void CLI::commandAccess(const CommandInfo& info, const std::string& args,
+                        std::vector<std::string>& reads, std::vector<std::string>& writes) {
+    std::istringstream iss(args);
+    std::vector<std::string> tokens{std::istream_iterator<std::string>(iss), std::istream_iterator<std::string>()};
+    // Numbers name no matrix; dropping them leaves only names (3d_rotate's angles are handled by its Access)
+    for (auto position = info.numberArgs.rbegin(); position != info.numberArgs.rend(); ++position)
+        if (*position < static_cast<int>(tokens.size())) tokens.erase(tokens.begin() + *position);
+    auto add = [](std::vector<std::string>& names, const std::string& name) {
+        if (std::find(names.begin(), names.end(), name) == names.end()) names.push_back(name);
+    };
+
+    reads.clear();
+    writes.clear();
+    switch (info.access) {
+        case Access::Exclusive:
+            break;
+        case Access::ReadsFirst:
+            if (!tokens.empty()) add(reads, tokens.front());
+            break;
+        case Access::WritesFirst:
+            if (!tokens.empty()) add(writes, tokens.front());
+            break;
+        case Access::WritesFirstReadsRest:
+            for (size_t i = 0; i < tokens.size(); ++i) {
+                if (i == 0) add(writes, tokens[i]);
+                else if (tokens[i] != tokens.front()) add(reads, tokens[i]);
+            }
+            break;
+        case Access::WritesAllButLast3:
+            for (size_t i = 0; i + 3 < tokens.size(); ++i)
+                add(writes, tokens[i]);
+            break;
+    }
+}
+
 void CLI::printAvailableCommands() {
     CLI::checkAvailableCommands();
 
@@ -118,40 +510,47 @@ void CLI::printAvailableCommands() {
 }
 
 void CLI::checkAvailableCommands() {
-    const size_t matrix_count = workspace.getMatrixCount();
-
-    if (matrix_count == 1) {
-        available_commands = {
-            "create","delete","assign","scalar_multiply",
-            "transpose","rank","det","inverse","3d_rotate",
-            "list", "show","save","load","help","exit"
-        };
-    } else if (matrix_count >= 2) {
-        available_commands = {
-            "create", "delete","assign",
-            "scalar_multiply","transpose","rank",
-            "det","inverse","3d_rotate","add","subtract",
-            "multiply","solve","list","show","save","load",
-            "help", "exit"
-          };
-    } else {
-        available_commands = {
-            "create","load",
-            "help", "exit"
-        };
+    available_commands.clear();
+    for (const auto& name : command_order) {
+        if (isAvailable(name))
+            available_commands.push_back(name);
     }
 }
 
+bool CLI::isAvailable(const std::string& command) const {
+    const auto it = commands.find(command);
+    return it != commands.end() &&
+           workspace.getMatrixCount() >= static_cast<size_t>(it->second.minMatrices);
+}
+
 bool CLI::executeCommand(const std::string& input) {
     std::istringstream iss(input);
     std::string command;
     iss >> command;
-    if (std::find(available_commands.begin(),available_commands.end(),command) == available_commands.end()) {
-        std::cout << "Unknown command: " << command << std::endl;
+    return dispatchCommand(command, iss);
+}
+
+bool CLI::dispatchCommand(const std::string& command, std::istringstream& args) {
+    if (!isAvailable(command)) {
+        workspace.output() << "Unknown command: " << command << std::endl;
         return false;
     }
 
-    return commands[command].action(iss);
+    MATRIX_PROFILE_DYNAMIC("CLI::" + command);
+    const bool succeeded = runAction(command, args);
+    workspace.endCommand();
+    return succeeded;
+}
+
+bool CLI::runAction(const std::string& command, std::istringstream& args) {
+    try {
+        return commands.at(command).action(args);
+    } catch (const std::bad_alloc&) {
+        // Commands report their own errors; running out of memory part-way is not one of them
+        workspace.output() << "Not enough memory for " << command
+                           << ". Use create_disk for matrices larger than memory." << std::endl;
+        return false;
+    }
 }
 
 bool CLI::executeCreateCommand(std::istringstream& iss) {
@@ -161,7 +560,7 @@ bool CLI::executeCreateCommand(std::istringstream& iss) {
 
     iss >> name >> rows >> cols;
     if (iss.fail()) {
-        std::cout << "Invalid arguments for create command." << std::endl;
+        workspace.output() << "Invalid arguments for create command." << std::endl;
         return false;
     }
 
@@ -172,13 +571,120 @@ bool CLI::executeCreateCommand(std::istringstream& iss) {
 
     // Check for trailing input
     if (!checkForTrailingInput(iss)) {
-        std::cout << "Invalid arguments for create command." << std::endl;
+        workspace.output() << "Invalid arguments for create command." << std::endl;
         return false;
     }
 
     return workspace.createMatrix(name, rows, cols, initValue);
 }
 
+bool CLI::executeCreateSparseCommand(std::istringstream& iss) {
+    std::string name;
+    int rows = 0, cols = 0;
+    iss >> name >> rows >> cols;
+    if (iss.fail() || !checkForTrailingInput(iss)) {
+        workspace.output() << "Invalid arguments for create_sparse command." << std::endl;
+        return false;
+    }
+    return workspace.createSparseMatrix(name, rows, cols);
+}
+
+bool CLI::executeCreateFloat32Command(std::istringstream& iss) {
+    std::string name;
+    int rows = 0, cols = 0;
+    float initValue = 0.0f; // default
+
+    iss >> name >> rows >> cols;
+    if (iss.fail()) {
+        workspace.output() << "Invalid arguments for create_float32 command." << std::endl;
+        return false;
+    }
+
+    // Try reading optional initValue
+    if (!(iss >> initValue)) {
+        iss.clear();     // clear fail
+    }
+
+    if (!checkForTrailingInput(iss)) {
+        workspace.output() << "Invalid arguments for create_float32 command." << std::endl;
+        return false;
+    }
+
+    return workspace.createFloatMatrix(name, rows, cols, initValue);
+}
+
+bool CLI::executeCreateDiskCommand(std::istringstream& iss) {
+    std::string name;
+    int rows = 0, cols = 0;
+    double initValue = 0.0; // default
+
+    iss >> name >> rows >> cols;
+    if (iss.fail()) {
+        workspace.output() << "Invalid arguments for create_disk command." << std::endl;
+        return false;
+    }
+
+    // Try reading optional initValue
+    if (!(iss >> initValue)) {
+        iss.clear();     // clear fail
+    }
+
+    if (!checkForTrailingInput(iss)) {
+        workspace.output() << "Invalid arguments for create_disk command." << std::endl;
+        return false;
+    }
+
+    return workspace.createDiskMatrix(name, rows, cols, initValue);
+}
+
+bool CLI::executeSetCommand(std::istringstream& iss) {
+    std::string name;
+    int row = 0, col = 0;
+    double value = 0.0;
+    iss >> name >> row >> col >> value;
+    if (iss.fail() || !checkForTrailingInput(iss)) {
+        workspace.output() << "Invalid arguments for set command." << std::endl;
+        return false;
+    }
+    return workspace.setElement(name, row, col, value);
+}
+
+bool CLI::executeToSparseCommand(std::istringstream& iss) {
+    return executeSingleMatrixCommand(iss,
+            [this](const std::string& name) { return workspace.convertToSparse(name); },
+            "Invalid arguments for to_sparse command.");
+}
+
+bool CLI::executeToDenseCommand(std::istringstream& iss) {
+    return executeSingleMatrixCommand(iss,
+            [this](const std::string& name) { return workspace.convertToDense(name); },
+            "Invalid arguments for to_dense command.");
+}
+
+bool CLI::executeToFloat32Command(std::istringstream& iss) {
+    return executeSingleMatrixCommand(iss,
+            [this](const std::string& name) { return workspace.convertToFloat32(name); },
+            "Invalid arguments for to_float32 command.");
+}
+
+bool CLI::executeToFloat64Command(std::istringstream& iss) {
+    return executeSingleMatrixCommand(iss,
+            [this](const std::string& name) { return workspace.convertToFloat64(name); },
+            "Invalid arguments for to_float64 command.");
+}
+
+bool CLI::executeToDiskCommand(std::istringstream& iss) {
+    return executeSingleMatrixCommand(iss,
+            [this](const std::string& name) { return workspace.convertToDisk(name); },
+            "Invalid arguments for to_disk command.");
+}
+
+bool CLI::executeToMemoryCommand(std::istringstream& iss) {
+    return executeSingleMatrixCommand(iss,
+            [this](const std::string& name) { return workspace.convertToMemory(name); },
+            "Invalid arguments for to_memory command.");
+}
+
 bool CLI::executeTransposeCommand(std::istringstream &iss) {
     return executeSingleMatrixCommand(iss,
             [this](const std::string& name) { return workspace.transposeMatrix(name); },
@@ -236,7 +742,7 @@ bool CLI::executeScalarMultiplyCommand(std::istringstream& iss) {
     double scalar;
     iss >> resultName >> matName >> scalar;
     if (iss.fail() || !checkForTrailingInput(iss)) {
-        std::cout << "Invalid arguments for scalar_multiply command." << std::endl;
+        workspace.output() << "Invalid arguments for scalar_multiply command." << std::endl;
         return false;
     }
     return workspace.scalarMultiplyMatrix(resultName, matName, scalar);
@@ -244,20 +750,20 @@ bool CLI::executeScalarMultiplyCommand(std::istringstream& iss) {
 
 bool CLI::printHelp(std::istringstream& iss) const {
     if (!checkForTrailingInput(iss)) return false;
-    std::cout << "Available commands:\n";
+    workspace.output() << "Available commands:\n";
     for (const auto& pair  : commands) {
         const auto& usage = pair.second.usage;
         const auto& description = pair.second.description;
         const auto& name = pair.first;
-        std::cout << "  - " << name << " : " << usage << "\n"
-                  << "      " << description << "\n\n";
+        workspace.output() << "  - " << name << " : " << usage << "\n"
+                           << "      " << description << "\n\n";
     }
     return true;
 }
 
 bool CLI::exitCLI(std::istringstream& iss) {
     if (!checkForTrailingInput(iss)) return false;
-    std::cout << "Exiting CLI." << std::endl;
+    workspace.output() << "Exiting CLI." << std::endl;
     running = STOPPING;
     return true;
 }
@@ -278,11 +784,11 @@ bool CLI::executeBinaryMatrixCommand(
         std::istringstream& iss,
         const std::function<bool(const std::string&, const std::string&, const std::string&)>& operation,
         const std::string& errorMessage
-    ) {
+    ) const {
     std::string resultName, mat1Name, mat2Name;
     iss >> resultName >> mat1Name >> mat2Name;
     if (resultName.empty() || mat1Name.empty() || mat2Name.empty() || !checkForTrailingInput(iss)) {
-        std::cout <<  errorMessage << std::endl;
+        workspace.output() << errorMessage << std::endl;
         return false;
     }
     return operation(resultName, mat1Name, mat2Name);
@@ -292,11 +798,11 @@ bool CLI::executeSingleMatrixCommand(
         std::istringstream& iss,
         const std::function<bool(const std::string&)>& operation,
         const std::string& errorMessage
-    ) {
+    ) const {
     std::string matrixName;
     iss >> matrixName;
     if (matrixName.empty() || !checkForTrailingInput(iss)) {
-        std::cout << errorMessage << std::endl;
+        workspace.output() << errorMessage << std::endl;
         return false;
     }
     return operation(matrixName);
@@ -304,14 +810,15 @@ bool CLI::executeSingleMatrixCommand(
 
 bool CLI::executeSaveLoadCommand(std::istringstream& iss,
     const std::function<bool(const std::string &)>& operation,
-    const std::string &errorMessage) {
+    const std::string &errorMessage) const {
     std::string filename;
     iss >> filename;
     if (filename.empty() || !checkForTrailingInput(iss)) {
-        std::cout << errorMessage << std::endl;
+        workspace.output() << errorMessage << std::endl;
         return false;
     }
-    if (filename.size() < 4 || filename.substr(filename.size() - 4) != ".txt") {
+    if ((filename.size() < 4 || filename.substr(filename.size() - 4) != ".txt") &&
+        !WorkspaceFile::isBinaryName(filename)) {
         filename += ".txt";
     }
 
@@ -340,7 +847,7 @@ bool CLI::executeInverseCommand(std::istringstream& iss)  {
     std::string resultName, matName;
     iss >> resultName >> matName;
     if (resultName.empty() || matName.empty() || !checkForTrailingInput(iss)) {
-        std::cout << "Invalid arguments for inverse command." << std::endl;
+        workspace.output() << "Invalid arguments for inverse command." << std::endl;
         return false;
     }
     return workspace.inverseMatrix(resultName, matName);
@@ -354,15 +861,211 @@ bool CLI::executeSolveCommand(std::istringstream& iss) {
         "Invalid arguments for solve command.");
 }
 
-bool CLI::execute3DVectorRotationCommand(std::istringstream &iss) {
+bool CLI::executeLUCommand(std::istringstream& iss) {
+    return executeSingleMatrixCommand(iss,
+            [this](const std::string& name) { return workspace.factorMatrix(name); },
+            "Invalid arguments for lu command.");
+}
+
+bool CLI::executeLUSolveCommand(std::istringstream& iss) {
+    return executeBinaryMatrixCommand(iss,
+        [this](const std::string& r, const std::string& A, const std::string& b) {
+            return workspace.solveWithFactorization(r, A, b);
+        },
+        "Invalid arguments for lu_solve command.");
+}
+
+bool CLI::executeLeastSquaresCommand(std::istringstream& iss) {
+    return executeBinaryMatrixCommand(iss,
+        [this](const std::string& r, const std::string& A, const std::string& b) {
+            return workspace.leastSquaresMatrix(r, A, b);
+        },
+        "Invalid arguments for lstsq command.");
+}
+
+bool CLI::executeCreateBatchCommand(std::istringstream& iss) {
+    std::string name;
+    int count = 0, rows = 0, cols = 0;
+    double initValue = 0.0;
+    iss >> name >> count >> rows >> cols;
+    if (iss.fail()) {
+        workspace.output() << "Invalid arguments for create_batch command." << std::endl;
+        return false;
+    }
+    if (!(iss >> initValue)) {
+        iss.clear();
+    }
+    if (!checkForTrailingInput(iss)) {
+        workspace.output() << "Invalid arguments for create_batch command." << std::endl;
+        return false;
+    }
+    return workspace.createBatch(name, count, rows, cols, initValue);
+}
+
+bool CLI::executeBatchPutCommand(std::istringstream& iss) {
+    std::string batchName, matName;
+    int index = 0;
+    iss >> batchName >> index >> matName;
+    if (iss.fail() || !checkForTrailingInput(iss)) {
+        workspace.output() << "Invalid arguments for batch_put command." << std::endl;
+        return false;
+    }
+    return workspace.insertIntoBatch(batchName, index, matName);
+}
 
-    std::string matName;
-    double angleDegreesX, angleDegreesY, angleDegreesZ;
-    iss >> matName >> angleDegreesX >> angleDegreesY >> angleDegreesZ;
-    if (matName.empty() || iss.fail() || !checkForTrailingInput(iss)) {
-        std::cout << "Invalid arguments for 3D vector rotation command." << std::endl;
+bool CLI::executeBatchGetCommand(std::istringstream& iss) {
+    std::string matName, batchName;
+    int index = 0;
+    iss >> matName >> batchName >> index;
+    if (iss.fail() || !checkForTrailingInput(iss)) {
+        workspace.output() << "Invalid arguments for batch_get command." << std::endl;
         return false;
     }
-        return workspace.rotate3DVector(matName, angleDegreesX, angleDegreesY, angleDegreesZ);
+    return workspace.extractFromBatch(matName, batchName, index);
+}
+
+bool CLI::executeBatchMultiplyCommand(std::istringstream& iss) {
+    return executeBinaryMatrixCommand(iss,
+        [this](const std::string& r, const std::string& A, const std::string& B) {
+            return workspace.multiplyBatches(r, A, B);
+        },
+        "Invalid arguments for batch_multiply command.");
+}
 
-}
\ No newline at end of file
+bool CLI::executeBatchSolveCommand(std::istringstream& iss) {
+    return executeBinaryMatrixCommand(iss,
+        [this](const std::string& r, const std::string& A, const std::string& B) {
+            return workspace.solveBatches(r, A, B);
+        },
+        "Invalid arguments for batch_solve command.");
+}
+
+bool CLI::executeBatchDeterminantCommand(std::istringstream& iss) {
+    std::string resultName, batchName;
+    iss >> resultName >> batchName;
+    if (resultName.empty() || batchName.empty() || !checkForTrailingInput(iss)) {
+        workspace.output() << "Invalid arguments for batch_det command." << std::endl;
+        return false;
+    }
+    return workspace.batchDeterminants(resultName, batchName);
+}
+
+bool CLI::executeBatchInverseCommand(std::istringstream& iss) {
+    std::string resultName, batchName;
+    iss >> resultName >> batchName;
+    if (resultName.empty() || batchName.empty() || !checkForTrailingInput(iss)) {
+        workspace.output() << "Invalid arguments for batch_inverse command." << std::endl;
+        return false;
+    }
+    return workspace.invertBatch(resultName, batchName);
+}
+
+bool CLI::executePolicyCommand(std::istringstream& iss) {
+    std::string mode;
+    if (!(iss >> mode))
+        return workspace.showExecutionPolicy();
+
+    // Either mode may be followed by "strassen" to select the Strassen multiply
+    auto withMultiply = [this, &iss](ExecutionPolicy policy) {
+        std::string multiply;
+        if (iss >> multiply) {
+            if (multiply != "strassen") return false;
+            policy.multiply = ExecutionPolicy::Multiply::Strassen;
+        }
+        return checkForTrailingInput(iss) && workspace.setExecutionPolicy(policy);
+    };
+
+    if (mode == "serial" && withMultiply(ExecutionPolicy::serial()))
+        return true;
+
+    if (mode == "parallel") {
+        int threads = 0; // default: one per hardware thread
+        if (!(iss >> threads)) {
+            iss.clear();
+            threads = 0;
+        }
+        if (threads >= 0 && withMultiply(ExecutionPolicy::parallel(static_cast<unsigned>(threads))))
+            return true;
+    }
+
+    workspace.output() << "Invalid arguments for policy command." << std::endl;
+    return false;
+}
+
+bool CLI::executeSolverCommand(std::istringstream& iss) {
+    std::string method;
+    if (!(iss >> method))
+        return workspace.showSolver();
+
+    SolverOptions options;
+    if (!IterativeSolvers::parseMethod(method, options.method)) {
+        workspace.output() << "Invalid arguments for solver command." << std::endl;
+        return false;
+    }
+
+    if (options.method != SolverMethod::Direct) {
+        // Optional positional settings; anything omitted keeps its default.
+        std::string preconditioner;
+        bool valid = true;
+        if (iss >> preconditioner)
+            valid = IterativeSolvers::parsePreconditioner(preconditioner, options.preconditioner);
+        if (valid && !(iss >> options.tolerance)) {
+            iss.clear();
+            options.tolerance = SolverOptions{}.tolerance;
+        } else if (valid && !(iss >> options.maxIterations)) {
+            iss.clear();
+            options.maxIterations = SolverOptions{}.maxIterations;
+        }
+        if (!valid) {
+            workspace.output() << "Invalid arguments for solver command." << std::endl;
+            return false;
+        }
+    }
+
+    if (!checkForTrailingInput(iss)) {
+        workspace.output() << "Invalid arguments for solver command." << std::endl;
+        return false;
+    }
+    return workspace.setSolver(options);
+}
+
+bool CLI::executeStatsCommand(std::istringstream& iss) {
+    std::string action;
+    if (!(iss >> action))
+        return workspace.showStatistics();
+    if (action == "reset" && checkForTrailingInput(iss))
+        return workspace.resetStatistics();
+    workspace.output() << "Invalid arguments for stats command." << std::endl;
+    return false;
+}
+
+bool CLI::executeTraceCommand(std::istringstream& iss) {
+    std::string action, filename;
+    iss >> action;
+    if (action == "start" && checkForTrailingInput(iss))
+        return workspace.startTrace();
+    if (action == "stop" && (iss >> filename) && checkForTrailingInput(iss))
+        return workspace.stopTrace(filename);
+    workspace.output() << "Invalid arguments for trace command." << std::endl;
+    return false;
+}
+
+bool CLI::execute3DVectorRotationCommand(std::istringstream &iss) {
+    // One or more vector names followed by the three angles
+    std::vector<std::string> tokens;
+    std::string token;
+    while (iss >> token) tokens.push_back(token);
+
+    double angles[3];
+    bool valid = tokens.size() >= 4;
+    for (int i = 0; valid && i < 3; ++i) {
+        std::istringstream number(tokens[tokens.size() - 3 + i]);
+        valid = (number >> angles[i]) && checkForTrailingInput(number);
+    }
+    if (!valid) {
+        workspace.output() << "Invalid arguments for 3D vector rotation command." << std::endl;
+        return false;
+    }
+    tokens.resize(tokens.size() - 3);
+    return workspace.rotate3DVectors(tokens, angles[0], angles[1], angles[2]);
+}
@@ -2,6 +2,7 @@
 #include <string>
 #include <sstream>
 #include <functional>
+#include <iostream>
 #include <unordered_map>
 #include <vector>
 #include "../include/Workspace.h"
@@ -17,11 +18,26 @@
  * Commands are dynamically registered via a command-dispatch table, each with
  * a description and usage format, allowing scalable and extensible command
  * management without hardcoded help text or logic duplication.
+ *
+ * Besides the interactive loop (startCLI()), runScript() executes a script
+ * of commands in batch mode: no prompt or command listing, confirmations
+ * suppressed, and a timing summary at the end.
  */
 class CLI {
 private:
     using CommandFunction = std::function<bool(std::istringstream&)>; ///< Type alias for command function handlers.
 
+    /**
+     * @brief Which matrices a command touches, named by its arguments (for asynchronous scripts).
+     */
+    enum class Access {
+        Exclusive,            ///< Whole workspace, files or further input: runs alone, after everything before it.
+        ReadsFirst,           ///< Reads the matrix named by the first argument.
+        WritesFirst,          ///< Creates, modifies or deletes the matrix named by the first argument.
+        WritesFirstReadsRest, ///< Writes the first argument's matrix from the other arguments' matrices.
+        WritesAllButLast3     ///< Modifies every argument's matrix but the last three (3d_rotate's angles).
+    };
+
     /**
      * @struct CommandInfo
      * @brief Encapsulates metadata and behavior for a CLI command.
@@ -30,10 +46,15 @@ private:
         CommandFunction action;   ///< The callable function that executes the command.
         std::string description;  ///< Human-readable description of what the command does.
         std::string usage;        ///< Syntax example for how to use the command.
+        int minMatrices = 0;      ///< Matrices the workspace must hold for the command to be available (0, 1 or 2).
+        bool printsResult = false; ///< Whether the command's output is its result (kept by quiet scripts).
+        Access access = Access::Exclusive; ///< Matrices the command reads and writes.
+        std::vector<int> numberArgs{};     ///< Argument positions (0-based, ascending) holding numbers, not matrix names.
     };
 
     Workspace workspace; ///< Manages matrices and their operations.
     std::vector<std::string> available_commands; ///< Dynamically updated list of commands visible to the user.
+    std::vector<std::string> command_order; ///< Every command, in the order they are listed.
     std::unordered_map<std::string, CommandInfo> commands; ///< Maps command names to execution info.
 
     bool running; ///< Controls the main CLI loop state.
@@ -57,6 +78,14 @@ private:
      */
     void checkAvailableCommands();
 
+    /**
+     * @brief Whether a command exists and the workspace holds enough matrices for it.
+     *
+     * A hash lookup, so executing a command does not depend on the size of
+     * the command list.
+     */
+    [[nodiscard]] bool isAvailable(const std::string& command) const;
+
     /**
      * @brief Executes a parsed command line input.
      * @param input The raw command string entered by the user.
@@ -64,9 +93,51 @@ private:
      */
     bool executeCommand(const std::string& input);
 
+    /**
+     * @brief Executes a command whose name has already been read from args.
+     * @return True if the command is available and executed successfully.
+     */
+    bool dispatchCommand(const std::string& command, std::istringstream& args);
+
+    /**
+     * @brief Runs a command's action, reporting running out of memory as a failure.
+     * @return True if the command executed successfully.
+     */
+    bool runAction(const std::string& command, std::istringstream& args);
+
+    /**
+     * @brief The matrices a command line reads and writes.
+     * @param info The command's entry.
+     * @param args The arguments following the command name.
+     * @param reads Receives the names read only.
+     * @param writes Receives the names written.
+     */
+    static void commandAccess(const CommandInfo& info, const std::string& args,
+                              std::vector<std::string>& reads, std::vector<std::string>& writes);
+
+    /**
+     * @brief runScript() with independent commands running concurrently.
+     */
+    int runScriptAsync(std::istream& script, bool verbose);
+
+    /**
+     * @brief A CLI over an existing workspace (a snapshot an asynchronous command runs on).
+     */
+    explicit CLI(Workspace&& workspace);
+
     // ========================= SPECIFIC COMMAND EXECUTORS =========================
 
     bool executeCreateCommand(std::istringstream& iss);
+    bool executeCreateSparseCommand(std::istringstream& iss);
+    bool executeCreateFloat32Command(std::istringstream& iss);
+    bool executeCreateDiskCommand(std::istringstream& iss);
+    bool executeSetCommand(std::istringstream& iss);
+    bool executeToSparseCommand(std::istringstream& iss);
+    bool executeToDenseCommand(std::istringstream& iss);
+    bool executeToFloat32Command(std::istringstream& iss);
+    bool executeToFloat64Command(std::istringstream& iss);
+    bool executeToDiskCommand(std::istringstream& iss);
+    bool executeToMemoryCommand(std::istringstream& iss);
     bool executeTransposeCommand(std::istringstream& iss);
     bool executeDeleteCommand(std::istringstream& iss);
     bool executeAssignCommand(std::istringstream& iss);
@@ -82,6 +153,20 @@ private:
     bool executeDeterminantCommand(std::istringstream& iss) const;
     bool executeInverseCommand(std::istringstream& iss);
     bool executeSolveCommand(std::istringstream& iss);
+    bool executeLUCommand(std::istringstream& iss);
+    bool executeLUSolveCommand(std::istringstream& iss);
+    bool executeLeastSquaresCommand(std::istringstream& iss);
+    bool executeCreateBatchCommand(std::istringstream& iss);
+    bool executeBatchPutCommand(std::istringstream& iss);
+    bool executeBatchGetCommand(std::istringstream& iss);
+    bool executeBatchMultiplyCommand(std::istringstream& iss);
+    bool executeBatchSolveCommand(std::istringstream& iss);
+    bool executeBatchDeterminantCommand(std::istringstream& iss);
+    bool executeBatchInverseCommand(std::istringstream& iss);
+    bool executePolicyCommand(std::istringstream& iss);
+    bool executeSolverCommand(std::istringstream& iss);
+    bool executeStatsCommand(std::istringstream& iss);
+    bool executeTraceCommand(std::istringstream& iss);
     bool execute3DVectorRotationCommand(std::istringstream& iss);
 
     // ========================= GENERIC HELPER UTILITIES =========================
@@ -127,11 +212,11 @@ private:
      * @param errorMessage Error message printed if arguments are invalid.
      * @return True if operation succeeded, false otherwise.
      */
-    static bool executeBinaryMatrixCommand(
+    bool executeBinaryMatrixCommand(
         std::istringstream& iss,
         const std::function<bool(const std::string&, const std::string&, const std::string&)>& operation,
         const std::string& errorMessage
-    );
+    ) const;
 
     /**
      * @brief Executes a single-matrix command (e.g., transpose, rank, det, show).
@@ -143,11 +228,11 @@ private:
      * @param errorMessage Error message printed if arguments are invalid.
      * @return True if operation succeeded, false otherwise.
      */
-    static bool executeSingleMatrixCommand(
+    bool executeSingleMatrixCommand(
         std::istringstream& iss,
         const std::function<bool(const std::string&)>& operation,
         const std::string& errorMessage
-    );
+    ) const;
 
     /**
      * @brief Executes file-based commands (save or load).
@@ -160,11 +245,11 @@ private:
      * @param errorMessage Error message printed if arguments are invalid.
      * @return True if operation succeeded, false otherwise.
      */
-    static bool executeSaveLoadCommand(
+    bool executeSaveLoadCommand(
         std::istringstream& iss,
         const std::function<bool(const std::string&)>& operation,
         const std::string& errorMessage
-    );
+    ) const;
 
 public:
     // ========================= LIFECYCLE =========================
@@ -185,6 +270,40 @@ public:
      */
     void startCLI();
 
+    /**
+     * @brief Runs a script of commands (one per line) in batch mode.
+     *
+     * No prompt or command listing is printed. Unless verbose, a command's
+     * output is only shown when it is the command's result (list, show,
+     * rank, det, help, policy, solver) or when the command fails; failures
+     * are reported on std::cerr together with the failing line and its
+     * number. Empty lines and lines starting with '#' are skipped, and
+     * `exit` ends the script early. While the script runs it also serves as
+     * std::cin, so `assign` reads its values from the lines that follow it.
+     *
+     * At the end, the number of commands, their total time, and the count
+     * and time per command name are written to std::cerr; verbose also
+     * reports the time of every command as it runs.
+     *
+     * With async, commands are scheduled by the matrices they name: a
+     * command waits only for the earlier commands that write a matrix it
+     * reads or writes, or that read a matrix it writes, and commands on
+     * independent matrices run concurrently, each on its own snapshot of
+     * the matrices it names (see TaskScheduler). Output, failures and
+     * timings are still reported in script order. Commands that need the
+     * whole workspace, files or further input (list, save, load, assign,
+     * policy, solver, stats, trace, help, exit) and commands on
+     * out-of-core matrices wait for everything before them and run alone.
+     * A command is accepted as soon as it exists; missing matrices are
+     * reported by the command itself.
+     *
+     * @param script Stream to read the commands from.
+     * @param verbose Whether to show every command's output and timing.
+     * @param async Whether to run independent commands concurrently.
+     * @return 0 if every command succeeded, 1 otherwise.
+     */
+    int runScript(std::istream& script, bool verbose = false, bool async = false);
+
     /**
      * @brief Default destructor.
      */
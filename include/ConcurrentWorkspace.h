@@ -0,0 +1,154 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+#include "Workspace.h"
+
+/**
+ * @class ConcurrentWorkspace
+ * @brief A Workspace that several threads can operate on at the same time.
+ *
+ * Every operation names the matrices it reads and the matrices it writes.
+ * The names are hashed onto SHARDS reader-writer locks: readers of a shard
+ * share it, a writer holds it alone. An operation therefore only waits for
+ * operations on the same shards, and read-only operations (show, rank,
+ * det) never wait for each other. The locks of an operation are always
+ * taken in ascending shard order, so operations cannot deadlock.
+ *
+ * While holding its shards, an operation copies its matrices out of the
+ * underlying Workspace (Workspace::snapshot(); dense matrices are shared
+ * copy-on-write, so this copies no elements). It then runs on that copy
+ * without further locking and merges what it wrote back
+ * (Workspace::merge()). Only the copy and the merge hold the lock on the
+ * workspace's maps, and both are short. Results cached by readers (rank,
+ * determinant, LU factors) are kept for later operations.
+ *
+ * Whole-workspace operations take every shard. listMatrices() and
+ * saveWorkspaceToFile() take them shared, just long enough to snapshot
+ * every matrix, so a save writes one consistent state of the workspace
+ * while writers carry on. loadWorkspaceFromFile() reads the file first and
+ * then replaces the contents with every shard held exclusively.
+ * Out-of-core matrices cannot be snapshotted, so operations on them, too,
+ * run with every shard held exclusively.
+ *
+ * Messages go to the stream passed to each call, so every client can
+ * collect its own output.
+ */
+class ConcurrentWorkspace {
+public:
+    /**
+     * @brief An operation on (a snapshot of) the workspace; returns whether it succeeded.
+     */
+    using Operation = std::function<bool(Workspace&)>;
+
+    static constexpr std::size_t SHARDS = 64; ///< Number of locks the names are spread over.
+
+    ConcurrentWorkspace() = default;
+
+    /**
+     * @brief Takes over the matrices of an existing workspace.
+     */
+    explicit ConcurrentWorkspace(Workspace&& workspace);
+
+    ConcurrentWorkspace(const ConcurrentWorkspace&) = delete;
+    ConcurrentWorkspace& operator=(const ConcurrentWorkspace&) = delete;
+
+    // ========================= GENERIC ACCESS =========================
+
+    /**
+     * @brief Runs an operation that touches only the named matrices.
+     *
+     * op receives a workspace holding just those matrices (the ones that
+     * exist) and may read the names in reads and create, modify or delete
+     * the names in writes; changes to any other name are discarded, and so
+     * are all its changes if it returns false.
+     *
+     * @param reads Matrices the operation only reads.
+     * @param writes Matrices the operation may create, modify or delete.
+     * @param op The operation.
+     * @param out Stream for the operation's messages.
+     * @return What op returned.
+     */
+    bool execute(const std::vector<std::string>& reads, const std::vector<std::string>& writes,
+                 const Operation& op, std::ostream& out = std::cout);
+
+    /**
+     * @brief Runs an operation on the whole workspace, with every other operation blocked.
+     */
+    bool executeExclusive(const Operation& op, std::ostream& out = std::cout);
+
+    // ========================= READ-ONLY OPERATIONS =========================
+
+    [[nodiscard]] size_t getMatrixCount() const; ///< @copydoc Workspace::getMatrixCount()
+    [[nodiscard]] std::vector<std::string> getMatrixNames() const; ///< @copydoc Workspace::getMatrixNames()
+
+    bool showMatrix(const std::string& matName, std::ostream& out = std::cout);        ///< @copydoc Workspace::showMatrix()
+    bool rankMatrix(const std::string& matName, std::ostream& out = std::cout);        ///< @copydoc Workspace::rankMatrix()
+    bool determinantMatrix(const std::string& matName, std::ostream& out = std::cout); ///< @copydoc Workspace::determinantMatrix()
+
+    /**
+     * @brief Prints every matrix, as of one consistent point in time.
+     * @return False if the workspace is empty.
+     */
+    bool listMatrices(std::ostream& out = std::cout);
+
+    // ========================= MODIFYING OPERATIONS =========================
+
+    bool createMatrix(const std::string& matName, int rows, int cols, double initValue = 0.0,
+                      std::ostream& out = std::cout);                           ///< @copydoc Workspace::createMatrix()
+    bool setElement(const std::string& matName, int row, int col, double value,
+                    std::ostream& out = std::cout);                             ///< @copydoc Workspace::setElement()
+    bool deleteMatrix(const std::string& matName, std::ostream& out = std::cout); ///< @copydoc Workspace::deleteMatrix()
+    bool addMatrices(const std::string& resultName, const std::string& mat1Name, const std::string& mat2Name,
+                     std::ostream& out = std::cout);                            ///< @copydoc Workspace::addMatrices()
+    bool subtractMatrices(const std::string& resultName, const std::string& mat1Name, const std::string& mat2Name,
+                          std::ostream& out = std::cout);                       ///< @copydoc Workspace::subtractMatrices()
+    bool multiplyMatrices(const std::string& resultName, const std::string& mat1Name, const std::string& mat2Name,
+                          std::ostream& out = std::cout);                       ///< @copydoc Workspace::multiplyMatrices()
+
+    // ========================= PERSISTENCE =========================
+
+    /**
+     * @brief Saves a consistent snapshot of the workspace; writers are only blocked while it is taken.
+     * @return True if saving succeeded, false otherwise.
+     */
+    bool saveWorkspaceToFile(const std::string& filename, std::ostream& out = std::cout);
+
+    /**
+     * @brief Replaces the workspace with a file's contents, atomically for every other operation.
+     * @return True if loading succeeded, false otherwise (the workspace is then unchanged).
+     */
+    bool loadWorkspaceFromFile(const std::string& filename, std::ostream& out = std::cout);
+
+private:
+    /**
+     * @brief Every shard's lock; a name's shard is its hash modulo SHARDS.
+     */
+    std::array<std::shared_mutex, SHARDS> shards;
+
+    /**
+     * @brief Guards the maps inside workspace; taken after the shards, and only briefly.
+     */
+    mutable std::shared_mutex structure;
+
+    Workspace workspace; ///< The matrices.
+
+    [[nodiscard]] static std::size_t shardOf(const std::string& matName);
+
+    /**
+     * @brief execute() with the shards already held: nullopt if a name is on disk.
+     */
+    std::optional<bool> executeOnSnapshot(const std::vector<std::string>& reads,
+                                          const std::vector<std::string>& writes,
+                                          const Operation& op, std::ostream& out);
+
+    /**
+     * @brief A snapshot of every matrix, taken with every shard held shared; nullopt if some are on disk.
+     */
+    std::optional<Workspace> snapshotAll();
+};
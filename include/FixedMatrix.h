@@ -0,0 +1,328 @@
+#pragma once
+#include <array>
+#include <algorithm>
+#include <cmath>
+#include "Matrix.h"
+#include "MatrixException.h"
+
+/**
+ * @namespace FixedKernels
+ * @brief Kernels for small matrices whose dimensions are template parameters.
+ *
+ * Every loop has a compile-time trip count, so the compiler unrolls them
+ * completely. FixedMatrix is built on them, and the runtime-sized Matrix
+ * dispatches to them (multiply(), determinant(), inverse(), solve() below)
+ * when its shape is one of the SPECIALIZED_SIZES.
+ */
+namespace FixedKernels {
+
+    /**
+     * @brief c = a * b for row-major M x K and K x N arrays (c must not overlap a or b).
+     */
+    template <int M, int K, int N>
+    constexpr void multiply(const double* a, const double* b, double* c) {
+        for (int i = 0; i < M; ++i) {
+            for (int j = 0; j < N; ++j) {
+                double sum = 0.0;
+                for (int k = 0; k < K; ++k)
+                    sum += a[i * K + k] * b[k * N + j];
+                c[i * N + j] = sum;
+            }
+        }
+    }
+
+    /**
+     * @brief Square sizes with specialized Matrix kernels.
+     */
+    constexpr bool isSpecialized(int n) {
+        return n == 2 || n == 3 || n == 4 || n == 8;
+    }
+
+    /**
+     * @brief c = a * b through a fixed-size kernel, for an n x n a and an
+     *        n x n or n x 1 b with isSpecialized(n).
+     * @return False (and c untouched) for any other shape.
+     */
+    bool multiply(int m, int k, int n, const double* a, const double* b, double* c);
+
+    /**
+     * @brief det of the row-major n x n array a, as LUDecomposition::determinant().
+     * @return False (and det untouched) unless isSpecialized(n).
+     */
+    bool determinant(int n, const double* a, double& det);
+
+    /**
+     * @brief The inverse of the row-major n x n array a, as LUDecomposition::inverse().
+     * @return False (and inverse untouched) unless isSpecialized(n).
+     * @throws MatrixSingular if a is singular.
+     */
+    bool inverse(int n, const double* a, double* inverse);
+
+    /**
+     * @brief x = a⁻¹ b for a row-major n x n array a and n-vector b, as LUDecomposition::solve().
+     * @return False (and x untouched) unless isSpecialized(n) and a is nonsingular.
+     */
+    bool solve(int n, const double* a, const double* b, double* x);
+}
+
+/**
+ * @class FixedMatrix
+ * @brief Small matrix whose dimensions are fixed at compile time.
+ *
+ * The elements are stored inline, row-major, so a FixedMatrix lives on the
+ * stack and is never heap-allocated. Every loop has a compile-time trip
+ * count, which lets the compiler unroll products such as Mat3 * Vec3
+ * completely. Element access is unchecked; convert to a Matrix with
+ * toMatrix() for the checked, general-purpose operations.
+ *
+ * @tparam Rows Number of rows (> 0).
+ * @tparam Cols Number of columns (> 0).
+ */
+template <int Rows, int Cols>
+class FixedMatrix {
+    static_assert(Rows > 0 && Cols > 0, "FixedMatrix dimensions must be positive");
+
+private:
+    std::array<double, Rows * Cols> _data{}; ///< Row-major elements.
+
+public:
+    // ==== Constructors ====
+
+    /**
+     * @brief Zero matrix.
+     */
+    constexpr FixedMatrix() = default;
+
+    /**
+     * @brief Matrix with the given elements, in row-major order.
+     */
+    constexpr explicit FixedMatrix(const std::array<double, Rows * Cols>& values) : _data(values) {}
+
+    /**
+     * @brief Identity matrix (square sizes only).
+     */
+    static constexpr FixedMatrix identity() {
+        static_assert(Rows == Cols, "identity() requires a square FixedMatrix");
+        FixedMatrix result;
+        for (int i = 0; i < Rows; ++i)
+            result(i, i) = 1.0;
+        return result;
+    }
+
+    /**
+     * @brief Copy a Matrix of the same dimensions.
+     * @throws MatrixDimensionMismatch if the dimensions differ.
+     */
+    static FixedMatrix fromMatrix(const Matrix& matrix) {
+        if (matrix.getRows() != Rows || matrix.getCols() != Cols)
+            throw MatrixDimensionMismatch(matrix.getRows(), matrix.getCols(), Rows, Cols);
+        FixedMatrix result;
+        std::copy(matrix.data(), matrix.data() + Rows * Cols, result._data.begin());
+        return result;
+    }
+
+    /**
+     * @brief Copy into a general Matrix.
+     */
+    [[nodiscard]] Matrix toMatrix() const {
+        Matrix result(Rows, Cols);
+        std::copy(_data.begin(), _data.end(), result.data());
+        return result;
+    }
+
+    // ==== Basic Information ====
+
+    [[nodiscard]] static constexpr int getRows() { return Rows; } ///< Row count.
+    [[nodiscard]] static constexpr int getCols() { return Cols; } ///< Column count.
+
+    [[nodiscard]] constexpr double* data() { return _data.data(); }             ///< Row-major elements.
+    [[nodiscard]] constexpr const double* data() const { return _data.data(); } ///< Row-major elements.
+
+    // ==== Element Access (unchecked) ====
+
+    constexpr double& operator()(int row, int col) { return _data[row * Cols + col]; }
+    constexpr double operator()(int row, int col) const { return _data[row * Cols + col]; }
+
+    // ==== Comparison Operators ====
+
+    constexpr bool operator==(const FixedMatrix& other) const {
+        for (int i = 0; i < Rows * Cols; ++i)
+            if (_data[i] != other._data[i]) return false;
+        return true;
+    }
+    constexpr bool operator!=(const FixedMatrix& other) const { return !(*this == other); }
+
+    // ==== Arithmetic ====
+
+    constexpr FixedMatrix operator+(const FixedMatrix& other) const {
+        FixedMatrix result;
+        for (int i = 0; i < Rows * Cols; ++i)
+            result._data[i] = _data[i] + other._data[i];
+        return result;
+    }
+
+    constexpr FixedMatrix operator-(const FixedMatrix& other) const {
+        FixedMatrix result;
+        for (int i = 0; i < Rows * Cols; ++i)
+            result._data[i] = _data[i] - other._data[i];
+        return result;
+    }
+
+    constexpr FixedMatrix operator*(double scalar) const {
+        FixedMatrix result;
+        for (int i = 0; i < Rows * Cols; ++i)
+            result._data[i] = _data[i] * scalar;
+        return result;
+    }
+
+    /**
+     * @brief Matrix product; the inner dimensions are checked at compile time.
+     */
+    template <int OtherCols>
+    constexpr FixedMatrix<Rows, OtherCols> operator*(const FixedMatrix<Cols, OtherCols>& other) const {
+        FixedMatrix<Rows, OtherCols> result;
+        FixedKernels::multiply<Rows, Cols, OtherCols>(data(), other.data(), result.data());
+        return result;
+    }
+
+    [[nodiscard]] constexpr FixedMatrix<Cols, Rows> transpose() const {
+        FixedMatrix<Cols, Rows> result;
+        for (int i = 0; i < Rows; ++i)
+            for (int j = 0; j < Cols; ++j)
+                result(j, i) = (*this)(i, j);
+        return result;
+    }
+};
+
+/**
+ * @class FixedLU
+ * @brief LU factorization with partial pivoting of an N x N FixedMatrix.
+ *
+ * Does what LUDecomposition does for a matrix of that size, with the same
+ * pivot choices, singularity threshold and order of operations, so both
+ * decide singularity alike. Values agree to rounding only: LUDecomposition
+ * updates rows through MatrixKernels::axpy, which may fuse the multiply-add.
+ * As N is known at compile time, the elimination and substitutions compile
+ * to straight-line code with no allocation.
+ *
+ * @tparam N Matrix size (> 0).
+ */
+template <int N>
+class FixedLU {
+    static_assert(N > 0, "FixedLU size must be positive");
+
+private:
+    FixedMatrix<N, N> _lu;       ///< Packed L (unit diagonal implied) and U.
+    std::array<int, N> _pivots{}; ///< Row permutation: row i of PA is row _pivots[i] of A.
+    int _swapCount = 0;          ///< Number of row swaps (sign of the determinant).
+    bool _singular = false;      ///< True if a (near-)zero pivot was encountered.
+
+    /**
+     * @brief x := U⁻¹ L⁻¹ x for an already permuted x.
+     */
+    template <int Cols>
+    void substitute(FixedMatrix<N, Cols>& x) const {
+        for (int i = 1; i < N; ++i)
+            for (int k = 0; k < i; ++k)
+                for (int j = 0; j < Cols; ++j) x(i, j) += -_lu(i, k) * x(k, j);
+        for (int i = N - 1; i >= 0; --i) {
+            for (int k = i + 1; k < N; ++k)
+                for (int j = 0; j < Cols; ++j) x(i, j) += -_lu(i, k) * x(k, j);
+            for (int j = 0; j < Cols; ++j) x(i, j) /= _lu(i, i);
+        }
+    }
+
+public:
+    /**
+     * @brief Factor a matrix.
+     */
+    explicit FixedLU(const FixedMatrix<N, N>& matrix) : _lu(matrix) {
+        for (int i = 0; i < N; ++i) _pivots[i] = i;
+        for (int i = 0; i < N; ++i) {
+            double maxEl = std::abs(_lu(i, i));
+            int maxRow = i;
+            for (int k = i + 1; k < N; ++k) {
+                const double v = std::abs(_lu(k, i));
+                if (v > maxEl) { maxEl = v; maxRow = k; }
+            }
+
+            // A (near-)zero pivot: skip the column, as LUDecomposition does
+            if (maxEl < ScalarTraits<double>::epsilon) {
+                _singular = true;
+                for (int k = i + 1; k < N; ++k) _lu(k, i) = 0.0;
+                continue;
+            }
+            if (maxRow != i) {
+                for (int j = 0; j < N; ++j) std::swap(_lu(i, j), _lu(maxRow, j));
+                std::swap(_pivots[i], _pivots[maxRow]);
+                _swapCount++;
+            }
+            for (int k = i + 1; k < N; ++k) {
+                const double c = -_lu(k, i) / _lu(i, i);
+                for (int j = i + 1; j < N; ++j) _lu(k, j) += c * _lu(i, j);
+                _lu(k, i) = -c;
+            }
+        }
+    }
+
+    [[nodiscard]] bool isSingular() const { return _singular; } ///< Whether a pivot was (near) zero.
+
+    /**
+     * @brief Determinant (0 if singular or below Matrix's tolerance).
+     */
+    [[nodiscard]] double determinant() const {
+        double det = 1.0;
+        for (int i = 0; i < N; ++i) det *= _lu(i, i);
+        if (std::abs(det) < ScalarTraits<double>::epsilon) det = 0.0;
+        if (_swapCount % 2 != 0) det = det != 0.0 ? -det : 0.0;
+        return det;
+    }
+
+    /**
+     * @brief Solve AX = B.
+     * @throws MatrixSingular if the factored matrix is singular.
+     */
+    template <int Cols>
+    [[nodiscard]] FixedMatrix<N, Cols> solve(const FixedMatrix<N, Cols>& b) const {
+        if (_singular) throw MatrixSingular();
+        FixedMatrix<N, Cols> x;
+        for (int i = 0; i < N; ++i)
+            for (int j = 0; j < Cols; ++j) x(i, j) = b(_pivots[i], j);
+        substitute(x);
+        return x;
+    }
+
+    /**
+     * @brief The inverse of the factored matrix.
+     * @throws MatrixSingular if the factored matrix is singular.
+     */
+    [[nodiscard]] FixedMatrix<N, N> inverse() const {
+        if (_singular) throw MatrixSingular();
+        FixedMatrix<N, N> x;
+        for (int i = 0; i < N; ++i) x(i, _pivots[i]) = 1.0;
+        substitute(x);
+        return x;
+    }
+};
+
+using Mat3 = FixedMatrix<3, 3>; ///< 3x3 matrix, e.g. a rotation.
+using Vec3 = FixedMatrix<3, 1>; ///< 3D column vector.
+
+/**
+ * @namespace Rotation3D
+ * @brief Builders for 3D rotation matrices.
+ *
+ * Angles are in degrees. Multiples of 90 degrees produce exact 0/1/-1
+ * entries.
+ */
+namespace Rotation3D {
+
+    [[nodiscard]] Mat3 aboutX(double angleDegrees); ///< Rotation around the X axis.
+    [[nodiscard]] Mat3 aboutY(double angleDegrees); ///< Rotation around the Y axis.
+    [[nodiscard]] Mat3 aboutZ(double angleDegrees); ///< Rotation around the Z axis.
+
+    /**
+     * @brief Combined rotation: around X first, then Y, then Z (Rz * Ry * Rx).
+     */
+    [[nodiscard]] Mat3 fromAngles(double angleDegreesX, double angleDegreesY, double angleDegreesZ);
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <string>
+#include "Matrix.h"
+#include "SparseMatrix.h"
+
+/**
+ * @brief Algorithm used to solve Ax = b.
+ */
+enum class SolverMethod {
+    Direct,            ///< Elimination (Matrix::solve); also classifies singular systems.
+    ConjugateGradient, ///< Conjugate gradient, for symmetric positive definite A.
+    GMRES,             ///< Restarted GMRES, for any non-singular A.
+    BiCGSTAB           ///< Stabilized biconjugate gradient, for any non-singular A.
+};
+
+/**
+ * @brief Preconditioner applied by the iterative solvers.
+ */
+enum class PreconditionerType {
+    None,   ///< Plain iteration.
+    Jacobi, ///< Scale by the inverse diagonal of A.
+    ILU0    ///< Incomplete LU factorization with A's sparsity pattern.
+};
+
+/**
+ * @struct SolverOptions
+ * @brief Which solver to use and when an iterative one should stop.
+ */
+struct SolverOptions {
+    SolverMethod method = SolverMethod::Direct;
+    PreconditionerType preconditioner = PreconditionerType::Jacobi;
+    double tolerance = 1e-10;  ///< Stop once ||b - Ax|| <= tolerance * ||b||.
+    int maxIterations = 1000;  ///< Iteration cap (GMRES counts inner iterations).
+    int restart = 30;          ///< GMRES Krylov subspace size before restarting.
+
+    /**
+     * @brief Human-readable form, e.g. "direct" or
+     *        "gmres (ilu0 preconditioner, tolerance 1e-10, at most 1000 iterations)".
+     */
+    [[nodiscard]] std::string describe() const;
+};
+
+/**
+ * @namespace IterativeSolvers
+ * @brief Preconditioned Krylov solvers for large square systems Ax = b.
+ *
+ * Each solver starts from x = 0 and only touches A through matrix-vector
+ * products, so a SparseMatrix is solved without ever being densified; the
+ * products are split by rows across the thread pool. All solvers return
+ * SolveStatus::Unique once the relative residual reaches options.tolerance,
+ * and SolveStatus::NotConverged (with x empty) if the iteration cap is hit
+ * or the method breaks down first. SolveResult::residual is always the
+ * true relative residual of the last iterate.
+ *
+ * The Jacobi preconditioner needs a non-zero diagonal; ILU(0) additionally
+ * needs non-zero pivots. Both throw MatrixSingular otherwise.
+ */
+namespace IterativeSolvers {
+
+    /**
+     * @brief Name of a method as accepted by the CLI ("direct", "cg", "gmres", "bicgstab").
+     */
+    [[nodiscard]] std::string methodName(SolverMethod method);
+
+    /**
+     * @brief Name of a preconditioner as accepted by the CLI ("none", "jacobi", "ilu0").
+     */
+    [[nodiscard]] std::string preconditionerName(PreconditionerType preconditioner);
+
+    /**
+     * @brief Look up a method by its methodName().
+     * @return False if name is not a known method.
+     */
+    bool parseMethod(const std::string& name, SolverMethod& method);
+
+    /**
+     * @brief Look up a preconditioner by its preconditionerName().
+     * @return False if name is not a known preconditioner.
+     */
+    bool parsePreconditioner(const std::string& name, PreconditionerType& preconditioner);
+
+    /**
+     * @brief Preconditioned conjugate gradient. A must be symmetric positive definite.
+     * @throws MatrixNotSquare if A is not square.
+     * @throws MatrixDimensionMismatch if b is not a column vector with A's row count.
+     */
+    [[nodiscard]] SolveResult conjugateGradient(const Matrix& A, const Matrix& b, const SolverOptions& options);
+    [[nodiscard]] SolveResult conjugateGradient(const SparseMatrix& A, const Matrix& b, const SolverOptions& options);
+
+    /**
+     * @brief Right-preconditioned GMRES(options.restart) with Givens rotations.
+     * @throws MatrixNotSquare if A is not square.
+     * @throws MatrixDimensionMismatch if b is not a column vector with A's row count.
+     */
+    [[nodiscard]] SolveResult gmres(const Matrix& A, const Matrix& b, const SolverOptions& options);
+    [[nodiscard]] SolveResult gmres(const SparseMatrix& A, const Matrix& b, const SolverOptions& options);
+
+    /**
+     * @brief Right-preconditioned BiCGSTAB.
+     * @throws MatrixNotSquare if A is not square.
+     * @throws MatrixDimensionMismatch if b is not a column vector with A's row count.
+     */
+    [[nodiscard]] SolveResult bicgstab(const Matrix& A, const Matrix& b, const SolverOptions& options);
+    [[nodiscard]] SolveResult bicgstab(const SparseMatrix& A, const Matrix& b, const SolverOptions& options);
+
+    /**
+     * @brief Solve with the method selected in options.
+     *
+     * SolverMethod::Direct runs Matrix::solve (on a dense copy of a sparse A).
+     */
+    [[nodiscard]] SolveResult solve(const Matrix& A, const Matrix& b, const SolverOptions& options);
+    [[nodiscard]] SolveResult solve(const SparseMatrix& A, const Matrix& b, const SolverOptions& options);
+}
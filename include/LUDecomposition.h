@@ -0,0 +1,135 @@
+#pragma once
+#include <vector>
+#include "Matrix.h"
+
+/**
+ * @class LUDecomposition
+ * @brief LU factorization with partial pivoting, PA = LU, reusable across solves.
+ *
+ * The factors are stored packed in a single n x n matrix: the strict lower
+ * triangle holds L (whose unit diagonal is implicit) and the upper triangle
+ * holds U. The row permutation P is kept as a pivot vector.
+ *
+ * Large matrices are factored by a right-looking blocked algorithm whose
+ * trailing-matrix update runs through MatrixKernels::gemm on all available
+ * cores (see Parallel::parallelFor); small ones use a single unblocked pass.
+ *
+ * Factoring costs O(n³) once; afterwards every solve costs O(n²) per
+ * right-hand-side column, and the determinant is available in O(n). This
+ * makes it the right tool when the same coefficient matrix is solved
+ * against many right-hand sides.
+ *
+ * A singular matrix can still be factored (its determinant is then 0), but
+ * solve() and inverse() throw MatrixSingular for it.
+ *
+ * A small change to the factored matrix, such as one element, row or
+ * column, is a rank-one change A + u vᵀ. update() folds it into the
+ * factors in O(n²) instead of refactoring in O(n³): solutions are
+ * corrected with the Sherman-Morrison formula and the determinant with the
+ * matrix determinant lemma, det(A + u vᵀ) = det(A) (1 + vᵀ A⁻¹ u). Each
+ * update adds O(n) to every later solve, so their number is capped.
+ */
+class LUDecomposition {
+private:
+    Matrix _lu;                ///< Packed factors: L below the diagonal, U on and above it.
+    std::vector<int> _pivots;  ///< _pivots[i] is the row of the original matrix now at row i.
+    int _swapCount;            ///< Number of row interchanges performed (determinant sign).
+    bool _singular;            ///< True if a (near-)zero pivot was encountered.
+
+    /**
+     * @brief A rank-one change A := A + u vᵀ made after factoring.
+     */
+    struct RankOneUpdate {
+        std::vector<double> w; ///< A⁻¹ u, for A as it was before this change.
+        std::vector<double> v; ///< The change's row vector.
+        double ratio;          ///< 1 + vᵀ w = det(A + u vᵀ) / det(A).
+    };
+    std::vector<RankOneUpdate> _updates; ///< Changes since factoring, oldest first.
+    double _updateRatio;                 ///< Product of the updates' ratios.
+
+    /**
+     * @brief Factor columns [first, first + width) with partial pivoting.
+     *
+     * Pivots are searched over all rows below the diagonal and whole rows are
+     * swapped, but elimination only updates columns inside the panel; the
+     * columns to its right are updated afterwards by the blocked driver.
+     */
+    void factorPanel(int first, int width);
+
+    /**
+     * @brief Solve LUx = Pb in place for every column of x.
+     * @param x On entry the permuted right-hand side, on exit the solution.
+     */
+    void substitute(Matrix& x) const;
+
+    /**
+     * @brief Turn solutions for the factored matrix into solutions for the updated one.
+     * @param x Solutions (one per column), corrected in place.
+     */
+    void applyUpdates(Matrix& x) const;
+
+public:
+    static constexpr int MAX_UPDATES = 32;            ///< update() refuses more changes than this.
+    static constexpr double UPDATE_TOLERANCE = 1e-8;  ///< Smallest |det(A + u vᵀ) / det(A)| update() accepts.
+
+    /**
+     * @brief Factor a square matrix.
+     * @param matrix Matrix to factor.
+     * @throws MatrixNotSquare if the matrix is not square.
+     */
+    explicit LUDecomposition(const Matrix& matrix);
+
+    /**
+     * @brief Dimension n of the factored n x n matrix.
+     */
+    [[nodiscard]] int size() const;
+
+    /**
+     * @brief Whether a (near-)zero pivot was encountered during factoring.
+     */
+    [[nodiscard]] bool isSingular() const;
+
+    /**
+     * @brief Determinant of the factored matrix, from the diagonal of U.
+     * @return Determinant value (0 if singular).
+     */
+    [[nodiscard]] double determinant() const;
+
+    /**
+     * @brief Solve AX = B for one or more right-hand-side columns.
+     * @param b Right-hand side with size() rows and any number of columns.
+     * @return Solution X with the same shape as b.
+     * @throws MatrixDimensionMismatch if b has the wrong number of rows.
+     * @throws MatrixSingular if the factored matrix is singular.
+     */
+    [[nodiscard]] Matrix solve(const Matrix& b) const;
+
+    /**
+     * @brief Inverse of the factored matrix, solved column by column from the factors.
+     * @return A⁻¹.
+     * @throws MatrixSingular if the factored matrix is singular.
+     */
+    [[nodiscard]] Matrix inverse() const;
+
+    /**
+     * @brief Change the factored matrix A to A + u vᵀ, in O(n²).
+     *
+     * A zero u or v is accepted without being counted. Nothing changes if
+     * the update is refused: when A is singular, when
+     * MAX_UPDATES updates have been made, or when A + u vᵀ is singular or
+     * nearly so (determinant ratio below UPDATE_TOLERANCE), where the
+     * correction would lose too much accuracy. The matrix should then be
+     * factored again.
+     *
+     * @param u Column vector with size() rows.
+     * @param v Column vector with size() rows.
+     * @return True if the factors now describe A + u vᵀ.
+     * @throws MatrixDimensionMismatch if u or v is not a size() x 1 vector.
+     */
+    bool update(const Matrix& u, const Matrix& v);
+
+    /**
+     * @brief Number of update() changes folded into the factors.
+     */
+    [[nodiscard]] int updateCount() const;
+};
@@ -1,13 +1,37 @@
 #pragma once
 #include <iostream>
+#include <memory>
 #include <vector>
+#include <utility>
+#include <functional>
+#include "MatrixAllocator.h"
+#include "MatrixExpression.h"
 
 struct SolveResult; // Forward declaration
+template <int Rows, int Cols> class FixedMatrix; // See FixedMatrix.h
 
 using std::vector;
 
 /**
- * @class Matrix
+ * @brief Per-element-type constants used by BasicMatrix.
+ */
+template <typename T>
+struct ScalarTraits;
+
+template <>
+struct ScalarTraits<double> {
+    static constexpr double epsilon = 1e-10;   ///< Pivot / zero tolerance.
+    static constexpr const char* name = "float64";
+};
+
+template <>
+struct ScalarTraits<float> {
+    static constexpr float epsilon = 1e-5f;    ///< Pivot / zero tolerance (float has ~7 significant digits).
+    static constexpr const char* name = "float32";
+};
+
+/**
+ * @class BasicMatrix
  * @brief Represents a 2D mathematical matrix supporting arithmetic,
  *        Gaussian elimination, determinant, inverse, and linear system solving.
  *
@@ -15,29 +39,136 @@ using std::vector;
  * It supports matrix operations such as addition, subtraction, multiplication,
  * transpose, determinant, rank, and inversion. Exception handling is used
  * to manage invalid operations, mismatched dimensions, or singular matrices.
+ *
+ * Element-wise arithmetic (+, -, scalar *, unary -) is lazy: it builds a
+ * MatrixExpression that is evaluated in one fused pass when assigned to a
+ * Matrix. Operations on temporaries reuse the temporary's buffer instead.
+ *
+ * Copies share their elements: copying a matrix (or returning, storing or
+ * capturing one by value) is O(1), and the elements are only duplicated
+ * when one of the copies is first modified. Like std::shared_ptr, the
+ * sharing is thread-safe, but a single matrix must not be modified from
+ * several threads at once. Pointers and references obtained from the
+ * non-const accessors must not be held across a copy of the matrix.
+ *
+ * The element type T is double (Matrix) or float (FloatMatrix); both are
+ * compiled in Matrix.cpp. Float matrices take half the memory and the
+ * kernels process twice as many elements per SIMD instruction.
+ *
+ * @tparam T Element type (double or float).
  */
-class Matrix {
+template <typename T>
+class BasicMatrix : public MatrixExpression<BasicMatrix<T>> {
 private:
-    vector<double> _matrix; ///< Flat vector storing matrix elements in row-major order.
+    friend class LUDecomposition; ///< Factorization kernels work on the raw rows.
+    friend class QRDecomposition; ///< Likewise.
+    friend class MatrixBatch;     ///< Shares the element limit.
+
+    using Storage = vector<T, PooledAllocator<T>>; ///< Row-major elements (64-byte aligned, pooled; see MatrixMemory).
+
+    std::shared_ptr<Storage> _storage; ///< Elements, shared with copies until modified; never null.
     int _rows;              ///< Number of matrix rows.
     int _cols;              ///< Number of matrix columns.
 
     // ==== Internal constants ====
-    static constexpr int MATRIX_LIMIT_ERROR = 10'000'000;   ///< Maximum allowed total elements (throws error).
-    static constexpr int MATRIX_LIMIT_WARNING = 1'000'000;  ///< Warning threshold for large matrices.
-    static constexpr double EPSILON = 1e-10;                ///< Tolerance for floating-point comparisons.
+    static constexpr long long MATRIX_LIMIT_ERROR = 4'000'000'000; ///< Maximum allowed total elements (throws error); see OutOfCoreMatrix beyond it.
+    static constexpr long long MATRIX_LIMIT_WARNING = 1'000'000;   ///< Warning threshold for large matrices.
+    static constexpr T EPSILON = ScalarTraits<T>::epsilon;  ///< Tolerance for floating-point comparisons.
 
     // ==== Internal helpers for function overloading ====
-    static constexpr Matrix* NOT_SOLVE = nullptr; ///< Helper for Gaussian elimination modes (no right-hand side).
+    static constexpr BasicMatrix* NOT_SOLVE = nullptr; ///< Helper for Gaussian elimination modes (no right-hand side).
     static constexpr int* NO_DET = nullptr;       ///< Helper for Gaussian elimination modes (no determinant).
     static constexpr bool FULL_REDUCTION = true;  ///< Flag for full (reduced) elimination mode.
     static constexpr bool NO_REDUCTION = false;   ///< Flag for forward-only elimination mode.
 
     /**
      * @brief Compute the 1D index in the internal vector for a given row and column.
+     *
+     * 64-bit, as a matrix may hold more than INT_MAX elements.
+     *
      * @throws MatrixOutOfBounds if indices are invalid.
      */
-    [[nodiscard]] int index(int row, int col) const;
+    [[nodiscard]] std::size_t index(int row, int col) const;
+
+    /**
+     * @brief Shared storage of every empty matrix, so that default construction does not allocate.
+     */
+    static const std::shared_ptr<Storage>& emptyStorage();
+
+    /**
+     * @brief Give this matrix its own copy of the elements if they are shared.
+     *
+     * Every public modifying operation calls this first. The unchecked
+     * accessors below do not: internal code that writes through them
+     * detaches once beforehand.
+     */
+    void detach();
+
+    // ==== Unchecked fast-path access for internal kernels ====
+    // Matrix's own loops index through these instead of operator(), which
+    // validates every access. Building with MATRIX_BOUNDS_CHECKS defined (the
+    // default for Debug builds) routes them through index() as well.
+
+    /**
+     * @brief Pointer to the first element of a row (unchecked).
+     * @param row Row index (0-based).
+     */
+    [[nodiscard]] T* rowPtr(int row) {
+#ifdef MATRIX_BOUNDS_CHECKS
+        return _storage->data() + index(row, 0);
+#else
+        return _storage->data() + static_cast<std::size_t>(row) * _cols;
+#endif
+    }
+
+    /**
+     * @brief Pointer to the first element of a row (unchecked, read-only).
+     * @param row Row index (0-based).
+     */
+    [[nodiscard]] const T* rowPtr(int row) const {
+#ifdef MATRIX_BOUNDS_CHECKS
+        return _storage->data() + index(row, 0);
+#else
+        return _storage->data() + static_cast<std::size_t>(row) * _cols;
+#endif
+    }
+
+    /**
+     * @brief Element access without bounds checking.
+     * @param row Row index (0-based).
+     * @param col Column index (0-based).
+     */
+    [[nodiscard]] T& at(int row, int col) {
+#ifdef MATRIX_BOUNDS_CHECKS
+        return (*_storage)[index(row, col)];
+#else
+        return (*_storage)[static_cast<std::size_t>(row) * _cols + col];
+#endif
+    }
+
+    /**
+     * @brief Element access without bounds checking (read-only).
+     * @param row Row index (0-based).
+     * @param col Column index (0-based).
+     */
+    [[nodiscard]] const T& at(int row, int col) const {
+#ifdef MATRIX_BOUNDS_CHECKS
+        return (*_storage)[index(row, col)];
+#else
+        return (*_storage)[static_cast<std::size_t>(row) * _cols + col];
+#endif
+    }
+
+    static constexpr std::size_t SLICE_SIZE = 1024; ///< Granularity of element-wise work splitting.
+
+    /**
+     * @brief Run an element-wise pass over the storage, possibly in parallel.
+     *
+     * The flat element range is cut into slices that body(first, count)
+     * processes independently; under a parallel ExecutionPolicy large
+     * matrices spread the slices across the thread pool.
+     */
+    void forEachSlice(const std::function<void(std::size_t first, std::size_t count)>& body) const;
 
     /**
      * @brief Swap two rows of the matrix in place.
@@ -52,26 +183,26 @@ private:
      * @return Combined augmented matrix [A | right].
      * @throws MatrixDimensionMismatch if row counts differ.
      */
-    [[nodiscard]] Matrix augment(const Matrix& right) const;
+    [[nodiscard]] BasicMatrix augment(const BasicMatrix& right) const;
 
     /**
      *
      * @param angleDegrees the angel in degrees
      * @return The rotation matrix around the X axis.
      */
-    static Matrix XRotationMatrix(double angleDegrees);
+    static BasicMatrix XRotationMatrix(double angleDegrees);
     /**
      *
      * @param angleDegrees the angel in degrees
      * @return The rotation matrix around the Y axis.
      */
-    static Matrix YRotationMatrix(double angleDegrees);
+    static BasicMatrix YRotationMatrix(double angleDegrees);
     /**
      *
      * @param angleDegrees the angel in degrees
      * @return The rotation matrix around the Z axis.
      */
-    static Matrix ZRotationMatrix(double angleDegrees);
+    static BasicMatrix ZRotationMatrix(double angleDegrees);
     /**
      * @brief Creates a combined rotation matrix for 3D vectors.
      *
@@ -82,7 +213,7 @@ private:
      * @param angleDegreesZ Rotation angle around the Z-axis in degrees.
      * @return The combined rotation matrix.
      */
-    static Matrix createRotationMatrix(double angleDegreesX, double angleDegreesY, double angleDegreesZ);
+    static BasicMatrix createRotationMatrix(double angleDegreesX, double angleDegreesY, double angleDegreesZ);
 
     /**
      * @brief Convert matrix to row-echelon form (forward elimination only).
@@ -102,18 +233,20 @@ private:
      * @return Row-echelon form of this matrix (a copy). If `right` was
      *         provided it is mutated to its row-echelon counterpart as well.
      */
-    [[nodiscard]] Matrix forwardElimination(Matrix* right, bool throwOnZeroPivot, int* swapCount = nullptr) const;
+    [[nodiscard]] BasicMatrix forwardElimination(BasicMatrix* right, bool throwOnZeroPivot, int* swapCount = nullptr) const;
 
 
 
 
 public:
+    using value_type = T; ///< Element type.
+
     // ==== Constructors & Destructor ====
 
     /**
      * @brief Default constructor. Creates an empty 0x0 matrix.
      */
-    Matrix() : _matrix(), _rows(0), _cols(0) {}
+    BasicMatrix() : _storage(emptyStorage()), _rows(0), _cols(0) {}
 
     /**
      * @brief Construct a matrix of given size and initial value.
@@ -122,20 +255,63 @@ public:
      * @param initValue Optional initial value for all elements (default 0.0).
      * @throws MatrixInvalidInitialization if dimensions are invalid.
      * @throws MatrixTooLarge if matrix exceeds size limit.
+     * @throws MatrixExceedsMemory if it does not fit in memory.
      */
-    Matrix(int rows, int cols, double initValue = 0.0);
+    BasicMatrix(int rows, int cols, T initValue = T(0));
+
+    /**
+     * @brief Evaluate an element-wise expression into a new matrix.
+     *
+     * This is where lazy expressions such as `A + B - C * 2.0` are computed:
+     * one allocation and a single fused pass over the result. It also
+     * converts between element types, e.g. `FloatMatrix f(m)` for a Matrix m.
+     *
+     * @param expression Expression to evaluate.
+     */
+    template <typename E>
+    BasicMatrix(const MatrixExpression<E>& expression);
 
     /**
      * @brief Default destructor.
      */
-    ~Matrix() = default;
+    ~BasicMatrix() = default;
+
+    /**
+     * @brief Copy constructor. O(1): the elements are shared until either matrix is modified.
+     */
+    BasicMatrix(const BasicMatrix& other) = default;
+
+    /**
+     * @brief Move constructor. Takes over the other matrix's buffer.
+     * @param other Matrix to move from; left as an empty 0x0 matrix.
+     */
+    BasicMatrix(BasicMatrix&& other) noexcept;
 
     /**
      * @brief Copy assignment operator.
      * @param other Matrix to copy from.
      * @return Reference to this matrix.
      */
-    Matrix& operator=(const Matrix& other);
+    BasicMatrix& operator=(const BasicMatrix& other);
+
+    /**
+     * @brief Move assignment operator. Takes over the other matrix's buffer.
+     * @param other Matrix to move from; left as an empty 0x0 matrix.
+     * @return Reference to this matrix.
+     */
+    BasicMatrix& operator=(BasicMatrix&& other) noexcept;
+
+    /**
+     * @brief Evaluate an element-wise expression into this matrix.
+     *
+     * If the dimensions already match, the result is written in place without
+     * allocating (expressions are element-wise, so `A = A + B` is safe).
+     *
+     * @param expression Expression to evaluate.
+     * @return Reference to this matrix.
+     */
+    template <typename E>
+    BasicMatrix& operator=(const MatrixExpression<E>& expression);
 
     // ==== Comparison Operators ====
 
@@ -144,14 +320,14 @@ public:
      * @param other Matrix to compare with.
      * @return True if both matrices have equal dimensions and elements.
      */
-    bool operator==(const Matrix& other) const;
+    bool operator==(const BasicMatrix& other) const;
 
     /**
      * @brief Inequality operator.
      * @param other Matrix to compare with.
      * @return True if matrices differ in size or content.
      */
-    bool operator!=(const Matrix& other) const;
+    bool operator!=(const BasicMatrix& other) const;
 
     // ==== Element Access ====
 
@@ -162,7 +338,7 @@ public:
      * @return Reference to element value (read-only).
      * @throws MatrixOutOfBounds if indices are invalid.
      */
-    const double& operator()(int row, int column) const;
+    const T& operator()(int row, int column) const;
 
     /**
      * @brief Access an element (modifiable version).
@@ -171,7 +347,7 @@ public:
      * @return Reference to element value (modifiable).
      * @throws MatrixOutOfBounds if indices are invalid.
      */
-    double& operator()(int row, int column);
+    T& operator()(int row, int column);
 
     // ==== Scalar Operations ====
 
@@ -180,13 +356,20 @@ public:
      * @param scalar Scalar value.
      * @return Reference to this matrix after modification.
      */
-    Matrix& operator*=(const double& scalar);
+    BasicMatrix& operator*=(const T& scalar);
 
     /**
-     * @brief Unary negation (returns -A).
-     * @return New matrix with all elements negated.
+     * @brief Fused in-place update A += alpha * B (BLAS axpy).
+     *
+     * Computes the scaled sum in a single pass without materializing alpha * B.
+     *
+     * @param alpha Scalar multiplier for the other matrix.
+     * @param other Matrix to add (must have the same dimensions).
+     * @return Reference to this matrix after modification.
+     * @throws MatrixDimensionMismatch if dimensions differ.
      */
-    Matrix operator-() const;
+    BasicMatrix& axpy(T alpha, const BasicMatrix& other);
+
 
     // ==== Basic Information ====
 
@@ -214,17 +397,37 @@ public:
      * |4|5|6|
      * @endcode
      */
-    friend std::ostream& operator<<(std::ostream& os, const Matrix& matrix);
+    template <typename U>
+    friend std::ostream& operator<<(std::ostream& os, const BasicMatrix<U>& matrix);
 
     // ==== Matrix Arithmetic ====
 
-    Matrix operator*(const Matrix& other) const;      ///< Matrix multiplication.
-    Matrix operator+(const Matrix& other) const;      ///< Matrix addition.
-    Matrix operator-(const Matrix& other) const;      ///< Matrix subtraction.
-    Matrix& operator+=(const Matrix& other);          ///< In-place addition.
-    Matrix& operator-=(const Matrix& other);          ///< In-place subtraction.
-    Matrix& operator*=(const Matrix& other);          ///< In-place multiplication.
-    Matrix operator*(const double& scalar) const;     ///< Matrix-scalar multiplication.
+    BasicMatrix operator*(const BasicMatrix& other) const;      ///< Matrix multiplication.
+    BasicMatrix& operator+=(const BasicMatrix& other);          ///< In-place addition.
+    BasicMatrix& operator-=(const BasicMatrix& other);          ///< In-place subtraction.
+    BasicMatrix& operator*=(const BasicMatrix& other);          ///< In-place multiplication.
+
+    template <typename E>
+    BasicMatrix& operator+=(const MatrixExpression<E>& expression); ///< In-place addition of an expression (single pass).
+    template <typename E>
+    BasicMatrix& operator-=(const MatrixExpression<E>& expression); ///< In-place subtraction of an expression (single pass).
+
+    /**
+     * @brief Flat element access used by expression evaluation.
+     * @param i Row-major element index (not bounds-checked).
+     * @return Element value.
+     */
+    [[nodiscard]] T elementAt(std::size_t i) const { return (*_storage)[i]; }
+
+    /**
+     * @brief Raw row-major storage (getRows() * getCols() elements), for bulk I/O.
+     */
+    [[nodiscard]] T* data() { detach(); return _storage->data(); }
+
+    /**
+     * @brief Raw row-major storage (read-only), for bulk I/O.
+     */
+    [[nodiscard]] const T* data() const { return _storage->data(); }
 
     // ==== Advanced Operations ====
 
@@ -232,7 +435,17 @@ public:
      * @brief Transpose the matrix (rows become columns).
      * @return Transposed matrix.
      */
-    [[nodiscard]] Matrix transpose() const;
+    [[nodiscard]] BasicMatrix transpose() const;
+
+    /**
+     * @brief Transpose the matrix in place, without allocating a second matrix.
+     *
+     * Square matrices swap tiles across the diagonal; rectangular ones are
+     * permuted in place by cycle following, and their dimensions swap.
+     *
+     * @return Reference to this matrix after modification.
+     */
+    BasicMatrix& transposeInPlace();
 
     /**
      * @brief Perform Gaussian elimination.
@@ -246,12 +459,15 @@ public:
      * @return Resulting upper-triangular or reduced matrix.
      * @throws MatrixSingular if the matrix is singular and full reduction is required.
      */
-    Matrix gaussianElimination(Matrix* right,
-                               bool fullReduction,
-                               int* swapCount = nullptr) const;
+    BasicMatrix gaussianElimination(BasicMatrix* right,
+                                    bool fullReduction,
+                                    int* swapCount = nullptr) const;
 
     /**
      * @brief Compute the determinant of the matrix.
+     *
+     * Computed in double precision for every element type.
+     *
      * @return Determinant value.
      * @throws MatrixNotSquare if matrix is not square.
      */
@@ -259,17 +475,26 @@ public:
 
     /**
      * @brief Compute the matrix rank.
+     *
+     * Counts the diagonal entries of a column-pivoted QR factorization above
+     * max(rows, cols) * epsilon * (largest column norm), so the threshold
+     * scales with the matrix (see QRDecomposition). Computed in double
+     * precision for every element type.
+     *
      * @return Rank of the matrix.
      */
     [[nodiscard]] int rank() const;
 
     /**
      * @brief Compute the inverse of the matrix (A⁻¹).
+     *
+     * Computed in double precision and rounded to the element type.
+     *
      * @return Inverse matrix.
      * @throws MatrixNotSquare if not square.
      * @throws MatrixSingular if determinant is zero.
      */
-    [[nodiscard]] Matrix inverse() const;
+    [[nodiscard]] BasicMatrix inverse() const;
 
     /**
      * @brief Create an identity matrix of given size.
@@ -277,49 +502,206 @@ public:
      * @return Identity matrix.
      * @throws MatrixInvalidInitialization if size <= 0.
      */
-    static Matrix identity(int size);
+    static BasicMatrix identity(int size);
 
     /**
-     * @brief Solve a linear system Ax = b using Gaussian elimination.
+     * @brief Solve a linear system Ax = b.
      *
      * Determines whether the system has a unique, infinite, or no solution.
-     * If a unique solution exists, it is returned in SolveResult.x.
+     * If a unique solution exists, it is returned in SolveResult.x along
+     * with its relative residual. A nonsingular square A is solved by LU;
+     * anything else is classified and solved from one column-pivoted QR
+     * (QRDecomposition::solve()), which also solves overdetermined systems
+     * whose equations agree. The system is always solved in double
+     * precision, so x is a (double) Matrix for every element type.
      *
      * @param b Column vector (matrix with one column).
      * @return SolveResult structure with solution and status.
      * @throws MatrixDimensionMismatch if dimensions are invalid.
      */
-    [[nodiscard]] SolveResult solve(const Matrix& b) const;
+    [[nodiscard]] SolveResult solve(const BasicMatrix& b) const;
 
-    Matrix rotate3D(double angleDegreesX, double angleDegreesY, double angleDegreesZ) const;
+    /**
+     * @brief Rotate 3D column vectors around the X, then Y, then Z axis.
+     *
+     * Every column of a 3xN matrix is treated as a vector, so one call
+     * rotates all of them (see rotate3DInPlace()).
+     *
+     * @throws MatrixDimensionMismatch if the matrix does not have 3 rows.
+     */
+    [[nodiscard]] BasicMatrix rotate3D(double angleDegreesX, double angleDegreesY, double angleDegreesZ) const;
+
+    /**
+     * @brief Apply a 3x3 matrix to every column of a 3xN matrix, in place.
+     *
+     * The rows are the x, y and z components of the vectors, so this is a
+     * single SIMD pass over the storage, split across the thread pool for
+     * large N. Precompute the rotation once (e.g. Rotation3D::fromAngles())
+     * and reuse it for any number of matrices.
+     *
+     * @throws MatrixDimensionMismatch if the matrix does not have 3 rows.
+     */
+    void rotate3DInPlace(const FixedMatrix<3, 3>& rotation);
 };
 
+using Matrix = BasicMatrix<double>;     ///< Double-precision matrix (the default).
+using FloatMatrix = BasicMatrix<float>; ///< Single-precision matrix.
+
+// ==== BasicMatrix member templates ====
+
+template <typename T>
+template <typename E>
+BasicMatrix<T>::BasicMatrix(const MatrixExpression<E>& expression)
+    : _storage(std::make_shared<Storage>(expression.size())), _rows(expression.getRows()), _cols(expression.getCols()) {
+    const E& e = expression.self();
+    T* out = _storage->data();
+    forEachSlice([&e, out](std::size_t first, std::size_t count) {
+        for (std::size_t i = first; i < first + count; ++i)
+            out[i] = static_cast<T>(e.elementAt(i));
+    });
+}
+
+template <typename T>
+template <typename E>
+BasicMatrix<T>& BasicMatrix<T>::operator=(const MatrixExpression<E>& expression) {
+    if (_rows != expression.getRows() || _cols != expression.getCols()) {
+        *this = BasicMatrix(expression);
+        return *this;
+    }
+    detach();
+    const E& e = expression.self();
+    T* out = _storage->data();
+    forEachSlice([&e, out](std::size_t first, std::size_t count) {
+        for (std::size_t i = first; i < first + count; ++i)
+            out[i] = static_cast<T>(e.elementAt(i));
+    });
+    return *this;
+}
+
+template <typename T>
+template <typename E>
+BasicMatrix<T>& BasicMatrix<T>::operator+=(const MatrixExpression<E>& expression) {
+    checkSameDimensions(*this, expression);
+    detach();
+    const E& e = expression.self();
+    T* out = _storage->data();
+    forEachSlice([&e, out](std::size_t first, std::size_t count) {
+        for (std::size_t i = first; i < first + count; ++i)
+            out[i] += e.elementAt(i);
+    });
+    return *this;
+}
+
+template <typename T>
+template <typename E>
+BasicMatrix<T>& BasicMatrix<T>::operator-=(const MatrixExpression<E>& expression) {
+    checkSameDimensions(*this, expression);
+    detach();
+    const E& e = expression.self();
+    T* out = _storage->data();
+    forEachSlice([&e, out](std::size_t first, std::size_t count) {
+        for (std::size_t i = first; i < first + count; ++i)
+            out[i] -= e.elementAt(i);
+    });
+    return *this;
+}
+
+// ==== Operators on temporaries ====
+// A temporary operand already owns a buffer of the right size, so these
+// compute into it eagerly instead of building a lazy expression.
+
+template <typename T>
+BasicMatrix<T> operator+(BasicMatrix<T>&& lhs, BasicMatrix<T>&& rhs); ///< Addition of two temporaries, reusing the left buffer.
+
+/**
+ * @brief Addition with a temporary left operand, reusing its buffer.
+ */
+template <typename T, typename R>
+BasicMatrix<T> operator+(BasicMatrix<T>&& lhs, const MatrixExpression<R>& rhs) {
+    lhs += rhs.self();
+    return std::move(lhs);
+}
+
+/**
+ * @brief Addition with a temporary right operand, reusing its buffer.
+ */
+template <typename L, typename T>
+BasicMatrix<T> operator+(const MatrixExpression<L>& lhs, BasicMatrix<T>&& rhs) {
+    // Addition commutes, so the right-hand temporary can hold the result.
+    rhs += lhs.self();
+    return std::move(rhs);
+}
+
 /**
- * @brief Scalar-matrix multiplication (scalar * matrix).
- * @param scalar Scalar multiplier.
- * @param matrix Matrix operand.
- * @return New matrix where each element is scaled.
+ * @brief Subtraction with a temporary left operand, reusing its buffer.
  */
-Matrix operator*(const double& scalar, const Matrix& matrix);
+template <typename T, typename R>
+BasicMatrix<T> operator-(BasicMatrix<T>&& lhs, const MatrixExpression<R>& rhs) {
+    lhs -= rhs.self();
+    return std::move(lhs);
+}
+
+template <typename T>
+BasicMatrix<T> operator*(BasicMatrix<T>&& matrix, double scalar); ///< Scaling of a temporary, reusing its buffer.
+template <typename T>
+BasicMatrix<T> operator*(double scalar, BasicMatrix<T>&& matrix); ///< Scaling of a temporary, reusing its buffer.
+template <typename T>
+BasicMatrix<T> operator-(BasicMatrix<T>&& matrix);                ///< Negation of a temporary, reusing its buffer.
+
+// ==== Comparison with expression operands ====
+// Exact-match overloads so Matrix == expression does not compete between
+// Matrix::operator== (via conversion) and the generic expression comparison.
+
+template <typename T, typename R>
+bool operator==(const BasicMatrix<T>& lhs, const MatrixExpression<R>& rhs) { return expressionsEqual(lhs, rhs); }
+template <typename L, typename T>
+bool operator==(const MatrixExpression<L>& lhs, const BasicMatrix<T>& rhs) { return expressionsEqual(lhs, rhs); }
+template <typename T, typename R>
+bool operator!=(const BasicMatrix<T>& lhs, const MatrixExpression<R>& rhs) { return !expressionsEqual(lhs, rhs); }
+template <typename L, typename T>
+bool operator!=(const MatrixExpression<L>& lhs, const BasicMatrix<T>& rhs) { return !expressionsEqual(lhs, rhs); }
+
+// ==== Matrix multiplication with expression operands ====
+// Not element-wise, so the expression side is materialized first (with the
+// matrix operand's element type).
+
+template <typename T, typename R>
+BasicMatrix<T> operator*(const BasicMatrix<T>& lhs, const MatrixExpression<R>& rhs) {
+    return lhs * BasicMatrix<T>(rhs);
+}
+
+template <typename L, typename T>
+BasicMatrix<T> operator*(const MatrixExpression<L>& lhs, const BasicMatrix<T>& rhs) {
+    return BasicMatrix<T>(lhs) * rhs;
+}
+
+template <typename L, typename R>
+Matrix operator*(const MatrixExpression<L>& lhs, const MatrixExpression<R>& rhs) {
+    return Matrix(lhs) * Matrix(rhs);
+}
 
 /**
  * @brief Status of a linear system solution.
  *
  * Used in SolveResult to indicate whether Ax = b has a unique,
- * infinite, or no solution.
+ * infinite, or no solution, or whether an iterative solver gave up.
  */
 enum class SolveStatus {
-    Unique,     ///< A unique solution exists.
-    Infinite,   ///< Infinitely many solutions exist.
-    NoSolution  ///< No valid solution exists.
+    Unique,      ///< A unique solution exists.
+    Infinite,    ///< Infinitely many solutions exist.
+    NoSolution,  ///< No valid solution exists.
+    NotConverged ///< An iterative solver stopped before reaching its tolerance.
 };
 
 /**
  * @brief Structure representing the result of solving a linear system.
  *
- * Contains both the solution status and the resulting vector (if unique).
+ * Contains the solution status, the resulting vector (if unique), and how
+ * it was reached.
  */
 struct SolveResult {
-    SolveStatus status; ///< Solution status.
-    Matrix x;           ///< Solution matrix (valid only if status == Unique).
+    SolveStatus status;   ///< Solution status.
+    Matrix x;             ///< Solution matrix (valid only if status == Unique).
+    int iterations = 0;   ///< Iterations performed (0 for direct solves).
+    double residual = 0.0; ///< Relative residual ||b - Ax|| / ||b|| of x (0 if there is no x).
 };
@@ -0,0 +1,93 @@
+#pragma once
+#include <cstddef>
+#include <new>
+
+/**
+ * @namespace MatrixMemory
+ * @brief Aligned, pooled storage for matrix elements.
+ *
+ * Every buffer is aligned to ALIGNMENT bytes (a cache line, and the width of
+ * the widest SIMD register) and rounded up to a size class: four classes per
+ * power of two, so at most a quarter of a buffer is padding. Freed buffers
+ * are kept on a free list per size class and handed out again by the next
+ * allocation of that class, so the temporaries of elimination, augment(),
+ * inverse() and the arithmetic operators reuse memory that is already
+ * mapped instead of going through malloc and faulting in fresh pages.
+ *
+ * The free lists hold at most cacheLimit() bytes; buffers freed beyond that
+ * are returned to the system immediately. trim() releases cached buffers on
+ * demand (Workspace does so after every command).
+ *
+ * All functions are thread-safe, and a buffer may be freed on a different
+ * thread than the one that allocated it.
+ */
+namespace MatrixMemory {
+
+    constexpr std::size_t ALIGNMENT = 64; ///< Alignment of every buffer, in bytes.
+
+    /**
+     * @brief Counters describing the pool's activity since start-up.
+     */
+    struct Statistics {
+        std::size_t allocations = 0; ///< Buffers requested.
+        std::size_t reused = 0;      ///< Requests served from a free list.
+        std::size_t cachedBytes = 0; ///< Bytes currently held on the free lists.
+        std::size_t cacheLimit = 0;  ///< Maximum cachedBytes.
+    };
+
+    /**
+     * @brief Allocate an aligned buffer of at least bytes bytes.
+     * @throws std::bad_alloc if the system is out of memory.
+     */
+    [[nodiscard]] void* allocate(std::size_t bytes);
+
+    /**
+     * @brief Return a buffer obtained from allocate(bytes) (same bytes).
+     */
+    void deallocate(void* buffer, std::size_t bytes) noexcept;
+
+    /**
+     * @brief Current counters.
+     */
+    [[nodiscard]] Statistics statistics();
+
+    /**
+     * @brief Set the maximum number of bytes kept on the free lists (trims if needed).
+     */
+    void setCacheLimit(std::size_t bytes);
+
+    /**
+     * @brief Release cached buffers, largest first, until at most keepBytes remain.
+     */
+    void trim(std::size_t keepBytes = 0);
+}
+
+/**
+ * @class PooledAllocator
+ * @brief Standard allocator drawing from MatrixMemory.
+ *
+ * Stateless, so containers using it can be moved and swapped freely.
+ */
+template <typename T>
+class PooledAllocator {
+public:
+    using value_type = T;
+
+    PooledAllocator() noexcept = default;
+    template <typename U>
+    PooledAllocator(const PooledAllocator<U>&) noexcept {}
+
+    [[nodiscard]] T* allocate(std::size_t n) {
+        if (n > static_cast<std::size_t>(-1) / sizeof(T)) throw std::bad_array_new_length();
+        return static_cast<T*>(MatrixMemory::allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* buffer, std::size_t n) noexcept {
+        MatrixMemory::deallocate(buffer, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const PooledAllocator<U>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const PooledAllocator<U>&) const noexcept { return false; }
+};
@@ -0,0 +1,172 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Matrix.h"
+#include "MatrixAllocator.h"
+
+/**
+ * @class MatrixBatch
+ * @brief Many independent matrices of one shape, interleaved for SIMD.
+ *
+ * The matrices are stored in blocks of LANES: within a block, element
+ * (i, j) of all LANES matrices is contiguous, followed by element
+ * (i, j + 1) of all of them, and so on (an array of structures of arrays).
+ * An operation on every matrix of a block is then the scalar algorithm
+ * with each arithmetic step done on LANES values at once, which maps onto
+ * one AVX-512 register (two AVX2 registers) of doubles. The batch
+ * functions below run the AVX-512, AVX2 or baseline build of their kernels,
+ * whichever the running CPU supports, and spread the blocks over the
+ * thread pool.
+ *
+ * The last block is padded up to LANES matrices; the padding takes part
+ * in the arithmetic but never in the results.
+ */
+class MatrixBatch {
+public:
+    static constexpr int LANES = 8; ///< Matrices interleaved per block.
+
+    /**
+     * @brief Empty batch (no matrices).
+     */
+    MatrixBatch() = default;
+
+    /**
+     * @brief Batch of count rows x cols matrices with every element set to initValue.
+     * @throws MatrixInvalidInitialization if count is negative or a dimension is not positive.
+     * @throws MatrixTooLarge if the batch exceeds Matrix's element limit.
+     */
+    MatrixBatch(int count, int rows, int cols, double initValue = 0.0);
+
+    /**
+     * @brief Copy count row-major rows x cols matrices, the k-th starting at data + k * stride.
+     * @param stride Distance between consecutive matrices, in elements (>= rows * cols).
+     * @throws MatrixInvalidInitialization if the dimensions are invalid or stride is too small.
+     */
+    static MatrixBatch fromStrided(const double* data, int count, int rows, int cols, std::ptrdiff_t stride);
+
+    /**
+     * @brief Write the matrices out row-major, the k-th starting at data + k * stride.
+     */
+    void toStrided(double* data, std::ptrdiff_t stride) const;
+
+    [[nodiscard]] int count() const { return _count; } ///< Number of matrices.
+    [[nodiscard]] int rows() const { return _rows; }   ///< Rows of every matrix.
+    [[nodiscard]] int cols() const { return _cols; }   ///< Columns of every matrix.
+    [[nodiscard]] int blocks() const { return (_count + LANES - 1) / LANES; } ///< Number of LANES-wide blocks.
+
+    /**
+     * @brief Element (row, col) of matrix index.
+     * @throws MatrixOutOfBounds if any index is out of range.
+     */
+    double& operator()(int index, int row, int col);
+    [[nodiscard]] double operator()(int index, int row, int col) const; ///< @copydoc operator()(int, int, int)
+
+    /**
+     * @brief Copy of matrix index.
+     * @throws MatrixOutOfBounds if index is out of range.
+     */
+    [[nodiscard]] Matrix matrix(int index) const;
+
+    /**
+     * @brief Replace matrix index.
+     * @throws MatrixOutOfBounds if index is out of range.
+     * @throws MatrixDimensionMismatch if the matrix has a different shape.
+     */
+    void setMatrix(int index, const Matrix& matrix);
+
+    /**
+     * @brief Interleaved elements of block b: element (i, j) of its lane l
+     *        is at [(i * cols() + j) * LANES + l].
+     */
+    [[nodiscard]] double* block(int b) { return _data.data() + static_cast<std::size_t>(b) * blockSize(); }
+    [[nodiscard]] const double* block(int b) const { return _data.data() + static_cast<std::size_t>(b) * blockSize(); } ///< @copydoc block(int)
+
+private:
+    int _count = 0;
+    int _rows = 0;
+    int _cols = 0;
+    std::vector<double, PooledAllocator<double>> _data; ///< blocks() blocks of blockSize() elements.
+
+    [[nodiscard]] std::size_t blockSize() const { return static_cast<std::size_t>(_rows) * _cols * LANES; }
+    [[nodiscard]] std::size_t offset(int index, int row, int col) const;
+};
+
+/**
+ * @brief Results of batchSolve() and batchInverse().
+ */
+struct BatchSolveResult {
+    MatrixBatch x;                     ///< Solutions (inverses); zero for the singular matrices.
+    std::vector<std::uint8_t> singular; ///< Nonzero where the matrix was singular.
+    int singularCount = 0;             ///< Number of singular matrices.
+};
+
+// ==== Batches ====
+
+/**
+ * @brief C_k = A_k B_k for every k.
+ * @throws MatrixDimensionMismatch if the counts differ or the shapes do not chain.
+ */
+MatrixBatch batchMultiply(const MatrixBatch& a, const MatrixBatch& b);
+
+/**
+ * @brief Solve A_k X_k = B_k for every k by LU with partial pivoting.
+ *
+ * A singular A_k (a pivot below Matrix::EPSILON, as in LUDecomposition)
+ * is flagged rather than thrown, so one bad system does not cost the rest.
+ *
+ * @throws MatrixNotSquare if the matrices of a are not square.
+ * @throws MatrixDimensionMismatch if the counts or row counts differ.
+ */
+BatchSolveResult batchSolve(const MatrixBatch& a, const MatrixBatch& b);
+
+/**
+ * @brief det(A_k) for every k (0 for singular matrices, as LUDecomposition::determinant()).
+ * @throws MatrixNotSquare if the matrices are not square.
+ */
+std::vector<double> batchDeterminant(const MatrixBatch& a);
+
+/**
+ * @brief A_k⁻¹ for every k, singular matrices flagged as in batchSolve().
+ * @throws MatrixNotSquare if the matrices are not square.
+ */
+BatchSolveResult batchInverse(const MatrixBatch& a);
+
+// ==== Strided arrays ====
+// The k-th matrix of each array is row-major and starts at pointer + k * stride.
+// Blocks are interleaved on the fly, so no interleaved copy of the whole batch is made.
+
+/**
+ * @brief c_k = a_k b_k for count products of m x inner by inner x n matrices.
+ * @throws MatrixInvalidInitialization if a dimension or stride is invalid.
+ */
+void batchMultiply(int count, int m, int inner, int n,
+                   const double* a, std::ptrdiff_t strideA,
+                   const double* b, std::ptrdiff_t strideB,
+                   double* c, std::ptrdiff_t strideC);
+
+/**
+ * @brief x_k = a_k⁻¹ b_k for count n x n systems with nrhs right-hand sides.
+ * @param singular If not null, receives count flags (nonzero: a_k singular, x_k set to zero).
+ * @return Number of singular systems.
+ * @throws MatrixInvalidInitialization if a dimension or stride is invalid.
+ */
+int batchSolve(int count, int n, int nrhs,
+               const double* a, std::ptrdiff_t strideA,
+               const double* b, std::ptrdiff_t strideB,
+               double* x, std::ptrdiff_t strideX, std::uint8_t* singular = nullptr);
+
+/**
+ * @brief det[k] = det(a_k) for count n x n matrices.
+ * @throws MatrixInvalidInitialization if a dimension or stride is invalid.
+ */
+void batchDeterminant(int count, int n, const double* a, std::ptrdiff_t strideA, double* det);
+
+/**
+ * @brief inv_k = a_k⁻¹ for count n x n matrices.
+ * @param singular If not null, receives count flags (nonzero: a_k singular, inv_k set to zero).
+ * @return Number of singular matrices.
+ * @throws MatrixInvalidInitialization if a dimension or stride is invalid.
+ */
+int batchInverse(int count, int n, const double* a, std::ptrdiff_t strideA,
+                 double* inverse, std::ptrdiff_t strideInverse, std::uint8_t* singular = nullptr);
@@ -34,7 +34,18 @@ public:
 class MatrixTooLarge : public MatrixException {
 public:
     MatrixTooLarge()
-        : MatrixException("Matrix too large - exceeds 10 million elements.") {}
+        : MatrixException("Matrix too large - exceeds 4 billion elements.") {}
+
+protected:
+    explicit MatrixTooLarge(const std::string& message)
+        : MatrixException(message) {}
+};
+
+class MatrixExceedsMemory : public MatrixTooLarge {
+public:
+    explicit MatrixExceedsMemory(unsigned long long bytes)
+        : MatrixTooLarge("Matrix too large - needs " + std::to_string(bytes >> 20) +
+                         " MiB, more than this machine's memory. Use create_disk for it.") {}
 };
 
 class MatrixNotSquare : public MatrixException {
@@ -47,4 +58,35 @@ class MatrixSingular : public MatrixException {
 public:
     MatrixSingular():
     MatrixException("Matrix is singular and cannot be inverted.") {}
-};
\ No newline at end of file
+};
+
+class OutOfCoreStorageError : public MatrixException {
+public:
+    explicit OutOfCoreStorageError(const std::string& detail):
+    MatrixException("Out-of-core storage failed: " + detail + ".") {}
+};
+
+class MatrixInvalidSparseStructure : public MatrixException {
+public:
+    explicit MatrixInvalidSparseStructure(const std::string& detail):
+    MatrixException("Invalid sparse matrix structure: " + detail + ".") {}
+};
+
+class WorkspaceFileCorrupt : public MatrixException {
+public:
+    explicit WorkspaceFileCorrupt(const std::string& detail):
+    MatrixException("Invalid workspace file: " + detail + ".") {}
+};
+
+class WorkspaceFileBadValue : public MatrixException {
+public:
+    WorkspaceFileBadValue(const std::string& matrixName, int row, int col):
+    MatrixException("Failed to read value for matrix ' " + matrixName + " ' element at (" +
+                    std::to_string(row) + ", " + std::to_string(col) + "). Please check the file format.") {}
+};
+
+class MatrixServerError : public MatrixException {
+public:
+    explicit MatrixServerError(const std::string& detail):
+    MatrixException("Matrix server: " + detail + ".") {}
+};
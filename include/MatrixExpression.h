@@ -0,0 +1,222 @@
+#pragma once
+#include <cstddef>
+#include "MatrixException.h"
+
+template <typename T> class BasicMatrix; // Forward declaration
+
+/**
+ * @class MatrixExpression
+ * @brief CRTP base for lazily evaluated element-wise matrix expressions.
+ *
+ * Element-wise operators (+, -, scalar *, unary -) on matrices do not compute
+ * anything by themselves; they return lightweight expression nodes that hold
+ * their operands. The whole expression tree is evaluated in a single pass
+ * over the destination when it is assigned to (or used to construct) a
+ * Matrix, so `A + B - C * 2.0` allocates one result and sweeps memory once.
+ *
+ * Dimensions are validated eagerly, when a node is built, so a mismatched
+ * expression throws at the point it is written even if it is never assigned.
+ *
+ * Every expression type E provides:
+ *  - `int getRows() const` and `int getCols() const`
+ *  - `elementAt(std::size_t i) const`, the i-th element of the result in
+ *    row-major order. It returns the element type of the operands: float
+ *    for an all-float expression, double as soon as a double matrix is
+ *    involved (the usual arithmetic promotions).
+ *
+ * Every BasicMatrix derives from MatrixExpression<BasicMatrix<T>> and acts
+ * as the leaf.
+ *
+ * @note Nodes keep Matrix operands by reference. Assign an expression to a
+ *       Matrix before its operands go out of scope; do not store it in `auto`.
+ */
+template <typename E>
+class MatrixExpression {
+public:
+    /**
+     * @brief Access the concrete expression.
+     */
+    [[nodiscard]] const E& self() const { return static_cast<const E&>(*this); }
+
+    [[nodiscard]] int getRows() const { return self().getRows(); } ///< Rows of the result.
+    [[nodiscard]] int getCols() const { return self().getCols(); } ///< Columns of the result.
+
+    /**
+     * @brief Number of elements in the result.
+     */
+    [[nodiscard]] std::size_t size() const {
+        return static_cast<std::size_t>(getRows()) * static_cast<std::size_t>(getCols());
+    }
+
+protected:
+    MatrixExpression() = default;
+    ~MatrixExpression() = default;
+};
+
+/**
+ * @brief How an expression node stores an operand of type E.
+ *
+ * Matrices are held by reference (they are the data); intermediate nodes are
+ * small and held by value, since they are usually temporaries.
+ */
+template <typename E>
+struct ExpressionOperand {
+    using type = const E;
+};
+
+template <typename T>
+struct ExpressionOperand<BasicMatrix<T>> {
+    using type = const BasicMatrix<T>&;
+};
+
+/**
+ * @brief Throw MatrixDimensionMismatch unless both operands have the same shape.
+ */
+template <typename L, typename R>
+void checkSameDimensions(const MatrixExpression<L>& lhs, const MatrixExpression<R>& rhs) {
+    if (lhs.getRows() != rhs.getRows() || lhs.getCols() != rhs.getCols()) {
+        throw MatrixDimensionMismatch(lhs.getRows(), lhs.getCols(),
+                                      rhs.getRows(), rhs.getCols());
+    }
+}
+
+// ========================= EXPRESSION NODES =========================
+
+/**
+ * @brief Lazy element-wise sum L + R.
+ */
+template <typename L, typename R>
+class MatrixSum : public MatrixExpression<MatrixSum<L, R>> {
+    typename ExpressionOperand<L>::type _lhs;
+    typename ExpressionOperand<R>::type _rhs;
+
+public:
+    MatrixSum(const L& lhs, const R& rhs) : _lhs(lhs), _rhs(rhs) {
+        checkSameDimensions(lhs, rhs);
+    }
+    [[nodiscard]] int getRows() const { return _lhs.getRows(); }
+    [[nodiscard]] int getCols() const { return _lhs.getCols(); }
+    [[nodiscard]] auto elementAt(std::size_t i) const { return _lhs.elementAt(i) + _rhs.elementAt(i); }
+};
+
+/**
+ * @brief Lazy element-wise difference L - R.
+ */
+template <typename L, typename R>
+class MatrixDifference : public MatrixExpression<MatrixDifference<L, R>> {
+    typename ExpressionOperand<L>::type _lhs;
+    typename ExpressionOperand<R>::type _rhs;
+
+public:
+    MatrixDifference(const L& lhs, const R& rhs) : _lhs(lhs), _rhs(rhs) {
+        checkSameDimensions(lhs, rhs);
+    }
+    [[nodiscard]] int getRows() const { return _lhs.getRows(); }
+    [[nodiscard]] int getCols() const { return _lhs.getCols(); }
+    [[nodiscard]] auto elementAt(std::size_t i) const { return _lhs.elementAt(i) - _rhs.elementAt(i); }
+};
+
+/**
+ * @brief Lazy scaling E * scalar.
+ *
+ * The scalar is rounded to the operand's element type, so scaling a float
+ * expression stays in float.
+ */
+template <typename E>
+class MatrixScaled : public MatrixExpression<MatrixScaled<E>> {
+    typename ExpressionOperand<E>::type _operand;
+    double _scalar;
+
+public:
+    MatrixScaled(const E& operand, double scalar) : _operand(operand), _scalar(scalar) {}
+    [[nodiscard]] int getRows() const { return _operand.getRows(); }
+    [[nodiscard]] int getCols() const { return _operand.getCols(); }
+    [[nodiscard]] auto elementAt(std::size_t i) const {
+        using Scalar = decltype(_operand.elementAt(i));
+        return _operand.elementAt(i) * static_cast<Scalar>(_scalar);
+    }
+};
+
+/**
+ * @brief Lazy negation -E.
+ */
+template <typename E>
+class MatrixNegated : public MatrixExpression<MatrixNegated<E>> {
+    typename ExpressionOperand<E>::type _operand;
+
+public:
+    explicit MatrixNegated(const E& operand) : _operand(operand) {}
+    [[nodiscard]] int getRows() const { return _operand.getRows(); }
+    [[nodiscard]] int getCols() const { return _operand.getCols(); }
+    [[nodiscard]] auto elementAt(std::size_t i) const { return -_operand.elementAt(i); }
+};
+
+// ========================= LAZY OPERATORS =========================
+
+/**
+ * @brief Element-wise addition (lazy).
+ * @throws MatrixDimensionMismatch if dimensions differ.
+ */
+template <typename L, typename R>
+MatrixSum<L, R> operator+(const MatrixExpression<L>& lhs, const MatrixExpression<R>& rhs) {
+    return MatrixSum<L, R>(lhs.self(), rhs.self());
+}
+
+/**
+ * @brief Element-wise subtraction (lazy).
+ * @throws MatrixDimensionMismatch if dimensions differ.
+ */
+template <typename L, typename R>
+MatrixDifference<L, R> operator-(const MatrixExpression<L>& lhs, const MatrixExpression<R>& rhs) {
+    return MatrixDifference<L, R>(lhs.self(), rhs.self());
+}
+
+/**
+ * @brief Expression-scalar multiplication (lazy).
+ */
+template <typename E>
+MatrixScaled<E> operator*(const MatrixExpression<E>& expression, double scalar) {
+    return MatrixScaled<E>(expression.self(), scalar);
+}
+
+/**
+ * @brief Scalar-expression multiplication (lazy).
+ */
+template <typename E>
+MatrixScaled<E> operator*(double scalar, const MatrixExpression<E>& expression) {
+    return MatrixScaled<E>(expression.self(), scalar);
+}
+
+/**
+ * @brief Unary negation (lazy).
+ */
+template <typename E>
+MatrixNegated<E> operator-(const MatrixExpression<E>& expression) {
+    return MatrixNegated<E>(expression.self());
+}
+
+/**
+ * @brief Element-wise equality of two expressions, without materializing either.
+ * @return True if both have equal dimensions and elements.
+ */
+template <typename L, typename R>
+bool expressionsEqual(const MatrixExpression<L>& lhs, const MatrixExpression<R>& rhs) {
+    if (lhs.getRows() != rhs.getRows() || lhs.getCols() != rhs.getCols())
+        return false;
+    const std::size_t n = lhs.size();
+    for (std::size_t i = 0; i < n; ++i) {
+        if (lhs.self().elementAt(i) != rhs.self().elementAt(i))
+            return false;
+    }
+    return true;
+}
+
+template <typename L, typename R>
+bool operator==(const MatrixExpression<L>& lhs, const MatrixExpression<R>& rhs) {
+    return expressionsEqual(lhs, rhs);
+}
+
+template <typename L, typename R>
+bool operator!=(const MatrixExpression<L>& lhs, const MatrixExpression<R>& rhs) {
+    return !expressionsEqual(lhs, rhs);
+}
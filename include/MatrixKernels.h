@@ -0,0 +1,188 @@
+#pragma once
+#include <cstddef>
+
+/**
+ * @namespace MatrixKernels
+ * @brief Low-level numeric kernels operating on raw row-major buffers.
+ *
+ * These routines are the computational back end of the Matrix class. They
+ * work on contiguous row-major storage with an explicit leading dimension
+ * (the distance, in elements, between the starts of two consecutive rows),
+ * so they can be applied both to whole matrices and to sub-blocks of them.
+ *
+ * The kernels perform no validation: dimension checks and exception
+ * reporting are the responsibility of the caller.
+ *
+ * Every kernel used by Matrix has a double and a float overload; the float
+ * versions process twice as many elements per SIMD register.
+ */
+namespace MatrixKernels {
+
+    /**
+     * @brief General matrix multiply: C = alpha * A * B + beta * C.
+     *
+     * Uses a packed, cache-blocked algorithm: B is packed into KC x NC panels
+     * sized for the L2/L3 cache, A into MC x KC blocks sized for L2, and a
+     * register-tiled micro-kernel accumulates MR x NR tiles of C from
+     * contiguous micro-panels. Very small products skip packing entirely.
+     * If the current ExecutionPolicy selects the Strassen multiply, large
+     * products go through gemmStrassen() instead.
+     *
+     * @param m Number of rows of A and C.
+     * @param n Number of columns of B and C.
+     * @param k Number of columns of A and rows of B.
+     * @param alpha Scalar applied to the product A * B.
+     * @param A Pointer to the first element of A.
+     * @param lda Leading dimension of A (>= k).
+     * @param B Pointer to the first element of B.
+     * @param ldb Leading dimension of B (>= n).
+     * @param beta Scalar applied to the existing contents of C (0 overwrites C).
+     * @param C Pointer to the first element of C.
+     * @param ldc Leading dimension of C (>= n).
+     */
+    void gemm(int m, int n, int k,
+              double alpha, const double* A, int lda,
+              const double* B, int ldb,
+              double beta, double* C, int ldc);
+    void gemm(int m, int n, int k,
+              float alpha, const float* A, int lda,
+              const float* B, int ldb,
+              float beta, float* C, int ldc); ///< Single-precision gemm().
+
+    /**
+     * @brief Products with every dimension at least this large are split by
+     *        gemmStrassen(); smaller blocks use the blocked kernel.
+     *
+     * Below about this size the extra additions and scratch traffic of a
+     * Strassen level cost more than the eighth of the multiply-adds it saves.
+     */
+    constexpr int STRASSEN_CROSSOVER = 512;
+
+    /**
+     * @brief gemm() by Strassen's recursion, with the same contract.
+     *
+     * Each level splits A, B and C into quadrants and forms C from seven
+     * quadrant products instead of eight, recursing until a dimension drops
+     * below STRASSEN_CROSSOVER, where the blocked kernel takes over. Any
+     * shape works: odd rows, columns or inner dimensions are peeled off and
+     * handled with the blocked kernel. At the top level the seven products
+     * run concurrently under a parallel policy. The result does not depend
+     * on the number of threads.
+     *
+     * Needs about one extra copy of the data in scratch (just under three
+     * quarter-size blocks per level, more while the seven top-level products
+     * run in parallel). Strassen's rounding error grows somewhat faster with
+     * the size than the classical product's; it is normwise, not
+     * elementwise, accurate.
+     */
+    void gemmStrassen(int m, int n, int k,
+                      double alpha, const double* A, int lda,
+                      const double* B, int ldb,
+                      double beta, double* C, int ldc);
+    void gemmStrassen(int m, int n, int k,
+                      float alpha, const float* A, int lda,
+                      const float* B, int ldb,
+                      float beta, float* C, int ldc); ///< Single-precision gemmStrassen().
+
+    /**
+     * @brief Reference triple-loop multiply with the same contract as gemm().
+     *
+     * Kept as a straightforward, obviously-correct baseline for tests.
+     * It is not used by any production code path.
+     */
+    void gemmReference(int m, int n, int k,
+                       double alpha, const double* A, int lda,
+                       const double* B, int ldb,
+                       double beta, double* C, int ldc);
+
+    // ==== Transpose kernels ====
+
+    /**
+     * @brief Out-of-place transpose: dst = src^T.
+     *
+     * Cache-oblivious: the larger dimension is halved recursively until a
+     * tile fits comfortably in L1, so both the reads and the strided writes
+     * stay cache resident at every level of the hierarchy.
+     *
+     * @param rows Number of rows of src (columns of dst).
+     * @param cols Number of columns of src (rows of dst).
+     * @param src Pointer to the first element of src.
+     * @param lds Leading dimension of src (>= cols).
+     * @param dst Pointer to the first element of dst (must not overlap src).
+     * @param ldd Leading dimension of dst (>= rows).
+     */
+    void transpose(int rows, int cols, const double* src, int lds, double* dst, int ldd);
+    void transpose(int rows, int cols, const float* src, int lds, float* dst, int ldd); ///< Single-precision transpose().
+
+    /**
+     * @brief In-place transpose of an n x n matrix.
+     *
+     * Swaps tile (i, j) with tile (j, i) pairwise and transposes diagonal
+     * tiles in place; no extra memory is used.
+     */
+    void transposeSquareInPlace(int n, double* a, int lda);
+    void transposeSquareInPlace(int n, float* a, int lda); ///< Single-precision transposeSquareInPlace().
+
+    /**
+     * @brief In-place transpose of a contiguous rows x cols matrix.
+     *
+     * On return the buffer holds the cols x rows transpose, row-major.
+     * Square matrices use transposeSquareInPlace(); rectangular ones follow
+     * the cycles of the permutation k -> k * rows mod (rows * cols - 1),
+     * which needs one bit of bookkeeping per element instead of a second
+     * copy of the matrix.
+     */
+    void transposeInPlace(int rows, int cols, double* a);
+    void transposeInPlace(int rows, int cols, float* a); ///< Single-precision transposeInPlace().
+
+    // ==== Element-wise kernels ====
+    // Implemented with explicit SIMD (SSE2 / AVX2 / AVX-512 on x86-64, NEON on
+    // AArch64). The widest instruction set supported by the running CPU is
+    // selected once, on first use. All back ends perform the same operations
+    // in the same order, so results are bitwise identical across machines.
+
+    /**
+     * @brief y[i] += x[i] for i in [0, n).
+     */
+    void add(std::size_t n, const double* x, double* y);
+    void add(std::size_t n, const float* x, float* y); ///< Single-precision add().
+
+    /**
+     * @brief y[i] -= x[i] for i in [0, n).
+     */
+    void subtract(std::size_t n, const double* x, double* y);
+    void subtract(std::size_t n, const float* x, float* y); ///< Single-precision subtract().
+
+    /**
+     * @brief y[i] *= alpha for i in [0, n).
+     */
+    void scale(std::size_t n, double alpha, double* y);
+    void scale(std::size_t n, float alpha, float* y); ///< Single-precision scale().
+
+    /**
+     * @brief y[i] = -x[i] for i in [0, n). x and y may alias.
+     */
+    void negate(std::size_t n, const double* x, double* y);
+    void negate(std::size_t n, const float* x, float* y); ///< Single-precision negate().
+
+    /**
+     * @brief Fused y[i] += alpha * x[i] for i in [0, n) (BLAS axpy).
+     */
+    void axpy(std::size_t n, double alpha, const double* x, double* y);
+    void axpy(std::size_t n, float alpha, const float* x, float* y); ///< Single-precision axpy().
+
+    /**
+     * @brief Apply a 3x3 matrix to n 3D vectors stored as three component arrays.
+     *
+     * Vector j is (x[j], y[j], z[j]) and is replaced, in place, by m times it
+     * (m is row-major). That is exactly the layout of a row-major 3 x n
+     * matrix whose columns are the vectors: x, y and z are its three rows.
+     */
+    void transform3(std::size_t n, const double* m, double* x, double* y, double* z);
+
+    /**
+     * @brief Name of the SIMD back end selected for this CPU
+     *        ("avx512", "avx2", "sse2", "neon" or "scalar").
+     */
+    const char* simdBackendName();
+}
@@ -0,0 +1,157 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "Matrix.h"
+
+/**
+ * @namespace MatrixProtocol
+ * @brief The binary request/response protocol of MatrixServer.
+ *
+ * Every message is a frame: a 9-byte header followed by a payload.
+ *
+ *     u32 payloadLength | u32 requestId | u8 code | payload (payloadLength bytes)
+ *
+ * In a request, code is the Opcode; in a response, it is the Status and
+ * requestId echoes the request's. A connection stays open for any number
+ * of requests, and requests may be pipelined: the server answers them in
+ * the order they were sent.
+ *
+ * All values are little-endian:
+ *  - u8, u16, u32, i32 integers; f64 IEEE 754 doubles
+ *  - str: u16 byte count, then the bytes
+ *  - matrix: u32 rows, u32 cols, then rows * cols f64 in row-major order,
+ *    the layout of Matrix itself, so a matrix is copied as one block
+ *
+ * A Failed response carries the workspace's message as a str; so does
+ * BadRequest (an unknown opcode or a malformed payload). A request whose
+ * length exceeds the server's limit (at most MAX_PAYLOAD) closes the
+ * connection.
+ */
+namespace MatrixProtocol {
+
+    constexpr std::size_t HEADER_BYTES = 9;
+    constexpr std::uint32_t MAX_PAYLOAD = std::uint32_t(1) << 31; ///< 2 GiB
+
+    /**
+     * @brief Request codes, with their payload -> response payload.
+     */
+    enum class Opcode : std::uint8_t {
+        Ping = 0x00,      ///< (empty) -> (empty)
+        Put = 0x01,       ///< str name, matrix -> (empty)
+        Get = 0x02,       ///< str name -> matrix
+        Delete = 0x03,    ///< str name -> (empty)
+        List = 0x04,      ///< (empty) -> u32 count, count x str name
+        Add = 0x10,       ///< str result, str a, str b -> (empty)
+        Subtract = 0x11,  ///< str result, str a, str b -> (empty)
+        Multiply = 0x12,  ///< str result, str a, str b -> (empty)
+        Scale = 0x13,     ///< str result, str a, f64 scalar -> (empty)
+        Transpose = 0x14, ///< str name (in place) -> (empty)
+        Inverse = 0x15,   ///< str result, str a -> (empty)
+        Solve = 0x16,     ///< str result, str A, str b -> (empty); uses the server's solver settings
+        LeastSquares = 0x17, ///< str result, str A, str b -> i32 rank, f64 relative residual
+        Rank = 0x20,      ///< str name -> i32
+        Determinant = 0x21, ///< str name -> f64
+        Save = 0x30,      ///< str filename -> (empty)
+        Load = 0x31       ///< str filename -> (empty)
+    };
+
+    /**
+     * @brief Response codes.
+     */
+    enum class Status : std::uint8_t {
+        Ok = 0,         ///< Payload as listed for the opcode.
+        Failed = 1,     ///< The operation failed; payload: str message.
+        BadRequest = 2  ///< Unknown opcode or malformed payload; payload: str message.
+    };
+
+    /**
+     * @brief A decoded frame header.
+     */
+    struct Header {
+        std::uint32_t payloadLength = 0;
+        std::uint32_t requestId = 0;
+        std::uint8_t code = 0;
+    };
+
+    /**
+     * @brief Decode a header from HEADER_BYTES bytes.
+     */
+    Header decodeHeader(const char* bytes);
+
+    /**
+     * @class Writer
+     * @brief Appends encoded values to a buffer, e.g. one or more frames.
+     */
+    class Writer {
+    public:
+        explicit Writer(std::string& buffer) : _buffer(buffer) {}
+
+        /**
+         * @brief Start a frame; its length is filled in by endFrame().
+         */
+        void beginFrame(std::uint32_t requestId, std::uint8_t code);
+
+        /**
+         * @brief Finish the frame begun last by writing its payload length.
+         * @throws MatrixServerError if the payload exceeds MAX_PAYLOAD; the
+         *         partial frame is then removed from the buffer.
+         */
+        void endFrame();
+
+        void u8(std::uint8_t value);
+        void u16(std::uint16_t value);
+        void u32(std::uint32_t value);
+        void i32(std::int32_t value);
+        void f64(double value);
+
+        /**
+         * @throws MatrixServerError if the string is longer than 65535 bytes.
+         */
+        void str(const std::string& value);
+
+        /**
+         * @throws MatrixServerError if the matrix alone exceeds MAX_PAYLOAD
+         *         (nothing is written then).
+         */
+        void matrix(const Matrix& value);
+
+    private:
+        std::string& _buffer;
+        std::size_t _frameStart = 0;
+    };
+
+    /**
+     * @class Reader
+     * @brief Decodes values from a payload.
+     *
+     * Every read throws MatrixServerError if the payload ends too early.
+     */
+    class Reader {
+    public:
+        Reader(const char* data, std::size_t size) : _data(data), _end(data + size) {}
+
+        std::uint8_t u8();
+        std::uint16_t u16();
+        std::uint32_t u32();
+        std::int32_t i32();
+        double f64();
+        std::string str();
+
+        /**
+         * @throws MatrixServerError if the dimensions are invalid or do not match the payload.
+         */
+        Matrix matrix();
+
+        /**
+         * @throws MatrixServerError unless the whole payload has been read.
+         */
+        void finish() const;
+
+    private:
+        const char* _data;
+        const char* _end;
+
+        const char* take(std::size_t bytes);
+    };
+}
@@ -0,0 +1,183 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ConcurrentWorkspace.h"
+#include "Matrix.h"
+#include "MatrixProtocol.h"
+
+/**
+ * @class MatrixServer
+ * @brief Serves a ConcurrentWorkspace over TCP with the binary MatrixProtocol.
+ *
+ * Every connection is served by its own thread, for as long as the client
+ * keeps it open. Requests on one connection run in order. All requests
+ * that have already arrived are answered in one write, so pipelined
+ * requests cost one round trip. Connections share the workspace, so
+ * requests from different clients run concurrently whenever they touch
+ * different matrices (see ConcurrentWorkspace).
+ *
+ * Matrices travel as contiguous doubles, bit for bit, with no text
+ * formatting in between. The messages the workspace prints for a failed
+ * operation become the Failed response's message.
+ *
+ * A request larger than the server's limit (maxRequestBytes()) closes
+ * its connection. The receive buffer only grows as bytes arrive, so a
+ * header alone never makes the server allocate its payload.
+ *
+ * Available on POSIX systems; elsewhere listen() throws.
+ */
+class MatrixServer {
+public:
+    static constexpr std::uint32_t DEFAULT_MAX_REQUEST = std::uint32_t(1) << 28; ///< 256 MiB
+
+
+    /**
+     * @brief A server for the given workspace, which must outlive it.
+     */
+    explicit MatrixServer(ConcurrentWorkspace& workspace);
+
+    /**
+     * @brief Stops serving and closes every connection.
+     */
+    ~MatrixServer();
+
+    MatrixServer(const MatrixServer&) = delete;
+    MatrixServer& operator=(const MatrixServer&) = delete;
+
+    /**
+     * @brief Binds and listens on a local address.
+     * @param host Numeric IPv4 address to bind, e.g. 127.0.0.1 or 0.0.0.0.
+     * @param port Port to bind; 0 picks a free one.
+     * @return The port bound.
+     * @throws MatrixServerError if the address cannot be bound.
+     */
+    int listen(const std::string& host, int port);
+
+    /**
+     * @brief Sets the largest request payload accepted; call before serve().
+     * @param bytes Limit in bytes, capped at MatrixProtocol::MAX_PAYLOAD.
+     */
+    void setMaxRequestBytes(std::uint32_t bytes);
+
+    [[nodiscard]] std::uint32_t maxRequestBytes() const { return _maxRequest; } ///< Largest request payload accepted.
+
+    /**
+     * @brief Accepts and serves connections until stop() is called.
+     *
+     * Returns once every connection has been closed.
+     */
+    void serve();
+
+    /**
+     * @brief Makes serve() return; callable from any thread and from a signal handler.
+     */
+    void stop() noexcept;
+
+    /**
+     * @brief Encodes the response to one request frame (exposed for testing).
+     * @param header The request's header.
+     * @param payload The request's payload.
+     * @param response Receives the response frame, appended.
+     */
+    void handleRequest(const MatrixProtocol::Header& header, const char* payload, std::string& response);
+
+    /**
+     * @brief Connection threads not yet joined (exposed for testing).
+     *
+     * Threads of closed connections are joined by serve() when it accepts
+     * the next connection, so this stays near the number of open ones.
+     */
+    [[nodiscard]] std::size_t connectionThreads();
+
+private:
+    ConcurrentWorkspace& _workspace;
+    std::atomic<int> _listener{-1};
+    std::atomic<bool> _stopping{false};
+    std::uint32_t _maxRequest = DEFAULT_MAX_REQUEST;
+
+    std::mutex _connectionsMutex;
+    std::vector<int> _connections; ///< Open client sockets, shut down by serve() when stopping.
+    std::vector<std::thread> _threads;
+    std::vector<std::thread::id> _finished; ///< Threads in _threads whose connection has closed.
+
+    void serveConnection(int socket);
+
+    /**
+     * @brief Joins the threads of connections that have closed.
+     */
+    void joinFinished();
+};
+
+/**
+ * @class MatrixClient
+ * @brief Blocking client for MatrixServer.
+ *
+ * The typed calls (put(), get(), multiply(), ...) send one request each
+ * and wait for its response; they throw MatrixServerError with the
+ * server's message when it fails. To pipeline, call send() several times
+ * and then receive() the responses, which come back in the same order.
+ */
+class MatrixClient {
+public:
+    /**
+     * @brief A decoded response frame.
+     */
+    struct Response {
+        std::uint32_t requestId = 0;
+        MatrixProtocol::Status status = MatrixProtocol::Status::Ok;
+        std::string payload;
+
+        [[nodiscard]] bool ok() const { return status == MatrixProtocol::Status::Ok; }
+        [[nodiscard]] std::string message() const; ///< The message of a failed response.
+    };
+
+    /**
+     * @brief Connects to a server.
+     * @throws MatrixServerError if the connection fails.
+     */
+    MatrixClient(const std::string& host, int port);
+    ~MatrixClient();
+
+    MatrixClient(const MatrixClient&) = delete;
+    MatrixClient& operator=(const MatrixClient&) = delete;
+
+    /**
+     * @brief Sends a request without waiting for its response.
+     * @param opcode The operation.
+     * @param payload The encoded arguments (see MatrixProtocol::Writer).
+     * @return The request's id.
+     */
+    std::uint32_t send(MatrixProtocol::Opcode opcode, const std::string& payload = std::string());
+
+    /**
+     * @brief Receives the next response.
+     * @throws MatrixServerError if the connection closes.
+     */
+    Response receive();
+
+    /**
+     * @brief send() and receive(), throwing MatrixServerError unless the response is Ok.
+     */
+    Response call(MatrixProtocol::Opcode opcode, const std::string& payload = std::string());
+
+    void ping();
+    void put(const std::string& name, const Matrix& matrix);
+    [[nodiscard]] Matrix get(const std::string& name);
+    void remove(const std::string& name);
+    [[nodiscard]] std::vector<std::string> list();
+    void add(const std::string& result, const std::string& a, const std::string& b);
+    void subtract(const std::string& result, const std::string& a, const std::string& b);
+    void multiply(const std::string& result, const std::string& a, const std::string& b);
+    void solve(const std::string& result, const std::string& a, const std::string& b);
+    [[nodiscard]] int rank(const std::string& name);
+    [[nodiscard]] double determinant(const std::string& name);
+
+private:
+    int _socket = -1;
+    std::uint32_t _nextId = 0;
+    std::string _received; ///< Bytes received but not yet returned by receive().
+};
@@ -0,0 +1,164 @@
+#pragma once
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Matrix.h"
+
+/**
+ * @class OutOfCoreMatrix
+ * @brief Dense double matrix stored in a memory-mapped file, for matrices larger than RAM.
+ *
+ * The elements are kept in TILE x TILE tiles, each contiguous and row-major,
+ * with the tiles themselves in row-major order; edge tiles are zero padded.
+ * The backing file is created in std::filesystem::temp_directory_path()
+ * (set TMPDIR to choose the disk) and unlinked immediately, so it never
+ * outlives the matrix. The operating system pages tiles in as they are
+ * touched and writes them back under memory pressure, so a matrix is only
+ * bounded by free disk space and address space, not by RAM or by Matrix's
+ * element limit.
+ *
+ * multiply(), transpose() and solve() stream whole tiles through the
+ * blocked kernels in MatrixKernels: every kernel call works on a few
+ * 512 KiB tiles, which keeps the resident set small while each tile is
+ * reused TILE times once loaded.
+ *
+ * Where memory mapping is unavailable, the tiles are kept in memory instead.
+ *
+ * Move-only: copying a file-backed matrix is explicit (see copy()).
+ */
+class OutOfCoreMatrix {
+public:
+    static constexpr int TILE = 256; ///< Tile edge, in elements (a tile is 512 KiB).
+
+    using value_type = double; ///< Element type.
+
+    // ==== Construction ====
+
+    /**
+     * @brief Empty 0x0 matrix without storage.
+     */
+    OutOfCoreMatrix() = default;
+
+    /**
+     * @brief Matrix with every element set to initValue, backed by a new temporary file.
+     * @throws MatrixInvalidInitialization if a dimension is not positive.
+     * @throws OutOfCoreStorageError if the backing file cannot be created or mapped.
+     */
+    OutOfCoreMatrix(int rows, int cols, double initValue = 0.0);
+
+    /**
+     * @brief Copy of an in-memory matrix.
+     * @throws OutOfCoreStorageError if the backing file cannot be created or mapped.
+     */
+    explicit OutOfCoreMatrix(const Matrix& matrix);
+
+    ~OutOfCoreMatrix();
+
+    OutOfCoreMatrix(const OutOfCoreMatrix&) = delete;
+    OutOfCoreMatrix& operator=(const OutOfCoreMatrix&) = delete;
+    OutOfCoreMatrix(OutOfCoreMatrix&& other) noexcept;
+    OutOfCoreMatrix& operator=(OutOfCoreMatrix&& other) noexcept;
+
+    /**
+     * @brief Copy into a new backing file.
+     */
+    [[nodiscard]] OutOfCoreMatrix copy() const;
+
+    /**
+     * @brief Copy into an in-memory Matrix.
+     * @throws MatrixTooLarge if the matrix exceeds Matrix's element limit.
+     */
+    [[nodiscard]] Matrix toMatrix() const;
+
+    // ==== Basic Information ====
+
+    [[nodiscard]] int getRows() const { return _rows; } ///< Row count.
+    [[nodiscard]] int getCols() const { return _cols; } ///< Column count.
+    [[nodiscard]] int tileRows() const { return (_rows + TILE - 1) / TILE; } ///< Rows of tiles.
+    [[nodiscard]] int tileCols() const { return (_cols + TILE - 1) / TILE; } ///< Columns of tiles.
+
+    /**
+     * @brief Size of the backing storage, padding included.
+     */
+    [[nodiscard]] std::size_t storageBytes() const { return _bytes; }
+
+    // ==== Element Access ====
+
+    /**
+     * @brief Read an element.
+     * @throws MatrixOutOfBounds if the position is outside the matrix.
+     */
+    double operator()(int row, int col) const;
+
+    /**
+     * @brief Modify an element.
+     * @throws MatrixOutOfBounds if the position is outside the matrix.
+     */
+    double& operator()(int row, int col);
+
+    /**
+     * @brief The TILE x TILE block at tile position (tileRow, tileCol), row-major.
+     */
+    [[nodiscard]] double* tile(int tileRow, int tileCol);
+    [[nodiscard]] const double* tile(int tileRow, int tileCol) const; ///< @copydoc tile(int, int)
+
+    // ==== Operations ====
+
+    /**
+     * @brief Matrix product, tile by tile: C(i, j) = sum over k of A(i, k) * B(k, j).
+     * @throws MatrixDimensionMismatch if the inner dimensions differ.
+     */
+    OutOfCoreMatrix operator*(const OutOfCoreMatrix& other) const;
+
+    /**
+     * @brief Product with an in-memory matrix (e.g. a vector), streaming over this matrix once.
+     * @throws MatrixDimensionMismatch if the inner dimensions differ.
+     */
+    Matrix operator*(const Matrix& other) const;
+
+    /**
+     * @brief Transpose: tile (i, j) of the result is the transpose of tile (j, i).
+     */
+    [[nodiscard]] OutOfCoreMatrix transpose() const;
+
+    /**
+     * @brief Solve AX = B by blocked LU factorization with partial pivoting.
+     *
+     * The factors are computed into a temporary copy of A, one column of
+     * tiles (a panel) at a time. Every pivot is searched over the whole
+     * column, the panel is factored in memory, and the trailing tiles are
+     * updated with one gemm per tile. B and X are held in memory.
+     *
+     * @param b Right-hand side with getRows() rows and any number of columns.
+     * @return Solution X with the same shape as b.
+     * @throws MatrixNotSquare if the matrix is not square.
+     * @throws MatrixDimensionMismatch if b has the wrong number of rows.
+     * @throws MatrixSingular if a (near-)zero pivot is encountered.
+     */
+    [[nodiscard]] Matrix solve(const Matrix& b) const;
+
+    /**
+     * @brief Print the matrix in Matrix's format, streaming the tiles row by row.
+     */
+    friend std::ostream& operator<<(std::ostream& os, const OutOfCoreMatrix& matrix);
+
+private:
+    int _rows = 0;
+    int _cols = 0;
+    double* _data = nullptr; ///< Mapped (or, without mmap, allocated) tiles.
+    std::size_t _bytes = 0;  ///< Size of the mapping.
+
+    /**
+     * @brief Offset of an element from _data, without bounds checks.
+     */
+    [[nodiscard]] std::size_t offset(int row, int col) const;
+
+    /**
+     * @brief Factor this (square) matrix in place, LAPACK getrf style.
+     * @param pivots Receives, for each row i, the row it was swapped with at step i.
+     */
+    void factorInPlace(std::vector<int>& pivots);
+
+    void release() noexcept;
+};
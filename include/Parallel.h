@@ -0,0 +1,122 @@
+#pragma once
+#include <functional>
+#include <string>
+
+/**
+ * @struct ExecutionPolicy
+ * @brief How Matrix operations may use threads.
+ *
+ * Serial keeps all work on the calling thread. Parallel lets large
+ * operations split their work across the shared thread pool, using at most
+ * `threads` threads (0 means one per hardware thread). `multiply` picks the
+ * algorithm for large products (see MatrixKernels::gemmStrassen()).
+ */
+struct ExecutionPolicy {
+    enum class Mode { Serial, Parallel };
+    enum class Multiply { Blocked, Strassen };
+
+    Mode mode = Mode::Parallel;            ///< Serial or parallel execution.
+    unsigned threads = 0;                  ///< Thread limit for Parallel mode (0 = hardware threads).
+    Multiply multiply = Multiply::Blocked; ///< Algorithm for large matrix products.
+
+    static ExecutionPolicy serial() { return { Mode::Serial, 1 }; }
+    static ExecutionPolicy parallel(unsigned threads = 0) { return { Mode::Parallel, threads }; }
+
+    /**
+     * @brief Number of threads this policy allows (at least 1).
+     */
+    [[nodiscard]] unsigned maxThreads() const;
+
+    /**
+     * @brief Human-readable form, e.g. "serial" or "parallel (8 threads), Strassen multiply".
+     */
+    [[nodiscard]] std::string describe() const;
+};
+
+/**
+ * @namespace Parallel
+ * @brief Fork-join helpers for splitting numeric loops across cores.
+ *
+ * Work is expressed as a half-open index range that is cut into contiguous
+ * chunks which run as tasks on ThreadPool::shared(). Which policy applies
+ * is decided per thread: the innermost ScopedPolicy if there is one,
+ * otherwise the process-wide default.
+ */
+namespace Parallel {
+
+    /**
+     * @brief Operations doing less work than this (element updates or
+     *        multiply-adds) stay on the calling thread.
+     */
+    constexpr long long MIN_PARALLEL_WORK = 1LL << 16;
+
+    /**
+     * @brief Smallest chunk of a range worth its own task, given the work
+     *        per index, so that no chunk carries less than MIN_PARALLEL_WORK.
+     */
+    int minChunkFor(long long workPerIndex);
+
+    /**
+     * @brief Process-wide default policy (initially parallel on all hardware threads).
+     */
+    ExecutionPolicy defaultPolicy();
+
+    /**
+     * @brief Replace the process-wide default policy.
+     */
+    void setDefaultPolicy(const ExecutionPolicy& policy);
+
+    /**
+     * @brief Policy in effect on the calling thread.
+     */
+    ExecutionPolicy currentPolicy();
+
+    /**
+     * @brief Number of threads parallelFor() may use under the current policy.
+     */
+    unsigned workerCount();
+
+    /**
+     * @class ScopedPolicy
+     * @brief Overrides the policy for the calling thread (and the tasks it
+     *        spawns) until it goes out of scope.
+     *
+     * @code
+     * {
+     *     Parallel::ScopedPolicy serial(ExecutionPolicy::serial());
+     *     Matrix c = a * b; // single-threaded
+     * }
+     * @endcode
+     */
+    class ScopedPolicy {
+    public:
+        explicit ScopedPolicy(const ExecutionPolicy& policy);
+        ~ScopedPolicy();
+        ScopedPolicy(const ScopedPolicy&) = delete;
+        ScopedPolicy& operator=(const ScopedPolicy&) = delete;
+
+    private:
+        ExecutionPolicy _policy;
+        const ExecutionPolicy* _previous;
+    };
+
+    /**
+     * @brief Run body over [begin, end) split into contiguous chunks.
+     *
+     * The range is divided into at most workerCount() chunks of at least
+     * minChunk indices each; body(chunkBegin, chunkEnd) is called once per
+     * chunk, concurrently. The calling thread processes one chunk itself and
+     * helps with queued pool tasks until every chunk has finished. If only
+     * one chunk results, body runs inline on the calling thread.
+     *
+     * If any invocation throws, the first exception is rethrown on the
+     * calling thread after all chunks have finished.
+     *
+     * @param begin First index.
+     * @param end One past the last index.
+     * @param minChunk Minimum number of indices per chunk (>= 1).
+     * @param body Callable invoked as body(chunkBegin, chunkEnd).
+     */
+    void parallelFor(int begin, int end, int minChunk,
+                     const std::function<void(int, int)>& body);
+}
@@ -0,0 +1,182 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @namespace Profiler
+ * @brief Call counters and an optional timeline for the library's hot paths.
+ *
+ * Each instrumented scope, such as the matrix product, the LU factorization
+ * or a Workspace operation, owns a Site that accumulates its calls, the time
+ * spent in it, the bytes it allocated through MatrixMemory and the
+ * floating-point operations it performed. Scopes nest and times are
+ * inclusive: Workspace::binaryMatrixOp contains the Matrix::multiply it
+ * runs. Counters are updated with relaxed atomics, so a scope costs two
+ * clock reads and a few additions.
+ *
+ * While a trace is recording, every scope also becomes a complete event
+ * ("ph": "X") of a Chrome trace, viewable in chrome://tracing or Perfetto.
+ *
+ * Instrumentation is compiled in with MATRIX_PROFILING (CMake option
+ * MATRIX_PROFILING, on by default); without it the MATRIX_PROFILE macros
+ * expand to nothing and no Site is ever registered.
+ */
+namespace Profiler {
+
+    /**
+     * @brief Totals of one instrumented scope.
+     */
+    struct Counters {
+        std::string name;
+        std::uint64_t calls = 0;
+        std::uint64_t nanoseconds = 0;    ///< Inclusive wall time.
+        std::uint64_t bytesAllocated = 0; ///< Requested from MatrixMemory on the calling thread.
+        std::uint64_t flops = 0;          ///< Floating-point operations (nominal counts).
+    };
+
+    /**
+     * @class Site
+     * @brief Counters of one instrumented scope; obtained from site() and never destroyed.
+     */
+    class Site {
+    public:
+        explicit Site(std::string name) : _name(std::move(name)) {}
+        Site(const Site&) = delete;
+        Site& operator=(const Site&) = delete;
+
+        [[nodiscard]] const std::string& name() const { return _name; }
+
+        void record(std::uint64_t nanoseconds, std::uint64_t bytes, double flops) noexcept {
+            _calls.fetch_add(1, std::memory_order_relaxed);
+            _nanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+            _bytes.fetch_add(bytes, std::memory_order_relaxed);
+            _flops.fetch_add(static_cast<std::uint64_t>(flops), std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] Counters snapshot() const;
+        void reset() noexcept;
+
+    private:
+        std::string _name;
+        std::atomic<std::uint64_t> _calls{0};
+        std::atomic<std::uint64_t> _nanoseconds{0};
+        std::atomic<std::uint64_t> _bytes{0};
+        std::atomic<std::uint64_t> _flops{0};
+    };
+
+    /**
+     * @brief The site called name, registered on first use (thread-safe).
+     */
+    Site& site(const std::string& name);
+
+    /**
+     * @brief Counters of every site called at least once, sorted by name.
+     */
+    [[nodiscard]] std::vector<Counters> statistics();
+
+    /**
+     * @brief Zero every site's counters.
+     */
+    void reset();
+
+    /**
+     * @brief Whether the MATRIX_PROFILE macros were compiled in.
+     */
+    [[nodiscard]] constexpr bool compiledIn() {
+#ifdef MATRIX_PROFILING
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // ==== Timeline ====
+
+    constexpr std::size_t MAX_TRACE_EVENTS = std::size_t(1) << 20; ///< Later events are dropped (and counted).
+
+    /**
+     * @brief Start recording a timeline (discarding any previous one).
+     */
+    void startTrace();
+
+    [[nodiscard]] bool isTracing(); ///< Whether a timeline is being recorded.
+
+    /**
+     * @brief Stop recording and write the timeline as Chrome trace JSON.
+     * @param path Target file (replaced if it exists).
+     * @return Number of events written.
+     * @throws std::runtime_error if the file cannot be written.
+     */
+    std::size_t writeTrace(const std::string& path);
+
+    /**
+     * @brief Events dropped because the timeline was full.
+     */
+    [[nodiscard]] std::size_t droppedTraceEvents();
+
+    // ==== Instrumentation ====
+
+    /**
+     * @brief Bytes requested from MatrixMemory by the calling thread so far.
+     */
+    inline thread_local std::uint64_t threadAllocatedBytes = 0;
+
+    /**
+     * @brief Append a finished scope to the timeline, if one is recording.
+     */
+    void traceEvent(const Site& site, std::chrono::steady_clock::time_point start,
+                    std::chrono::steady_clock::time_point end, std::uint64_t bytes, double flops);
+
+    /**
+     * @class ScopedTimer
+     * @brief Records the enclosing scope into a Site when it ends.
+     */
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(Site& site, double flops = 0.0) noexcept
+            : _site(site), _flops(flops), _bytes(threadAllocatedBytes), _start(std::chrono::steady_clock::now()) {}
+
+        ~ScopedTimer() {
+            const auto end = std::chrono::steady_clock::now();
+            const std::uint64_t bytes = threadAllocatedBytes - _bytes;
+            _site.record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - _start).count()),
+                         bytes, _flops);
+            if (isTracing())
+                traceEvent(_site, _start, end, bytes, _flops);
+        }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        Site& _site;
+        double _flops;
+        std::uint64_t _bytes;
+        std::chrono::steady_clock::time_point _start;
+    };
+}
+
+#define MATRIX_PROFILE_CONCAT_IMPL(a, b) a##b
+#define MATRIX_PROFILE_CONCAT(a, b) MATRIX_PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef MATRIX_PROFILING
+/// Time the rest of the enclosing scope as `name` (a string literal), crediting it with `flops`.
+#define MATRIX_PROFILE_WORK(name, flops)                                                              \
+    static Profiler::Site& MATRIX_PROFILE_CONCAT(profileSite_, __LINE__) = Profiler::site(name);      \
+    Profiler::ScopedTimer MATRIX_PROFILE_CONCAT(profileTimer_, __LINE__)(                            \
+        MATRIX_PROFILE_CONCAT(profileSite_, __LINE__), static_cast<double>(flops))
+/// Time the rest of the enclosing scope as `name` (a string literal).
+#define MATRIX_PROFILE(name) MATRIX_PROFILE_WORK(name, 0)
+/// Time the rest of the enclosing scope under a name computed at run time.
+#define MATRIX_PROFILE_DYNAMIC(nameExpression) \
+    Profiler::ScopedTimer MATRIX_PROFILE_CONCAT(profileTimer_, __LINE__)(Profiler::site(nameExpression))
+#else
+#define MATRIX_PROFILE_WORK(name, flops) ((void)0)
+#define MATRIX_PROFILE(name) ((void)0)
+#define MATRIX_PROFILE_DYNAMIC(nameExpression) ((void)0)
+#endif
@@ -0,0 +1,110 @@
+#pragma once
+#include <vector>
+#include "Matrix.h"
+
+/**
+ * @class QRDecomposition
+ * @brief Householder QR with column pivoting, AP = QR, for any shape.
+ *
+ * Column pivoting brings the column with the largest remaining norm to the
+ * front at every step, so the diagonal of R decreases in magnitude and
+ * reveals the rank: it is the number of |R(i, i)| above
+ * max(rows, cols) * machine epsilon * |R(0, 0)|. As |R(0, 0)| is the
+ * largest column norm of A, the tolerance scales with the matrix. Once the
+ * diagonal drops below it the remaining columns are numerically dependent,
+ * and factoring stops.
+ *
+ * The factors are stored packed in one rows x cols matrix: R on and above
+ * the diagonal, the Householder vectors (whose leading 1 is implicit)
+ * below it. The column permutation P is kept as a vector.
+ *
+ * Factoring is blocked: the reflectors of a panel of columns are
+ * accumulated and applied to the rest of the matrix with one
+ * MatrixKernels::gemm, and only the pivot row and column are updated
+ * eagerly (the LAPACK xLAQPS scheme). The other half of the work, forming
+ * the accumulated update, is split across the thread pool.
+ *
+ * One factorization gives the rank, the classification of Ax = b and its
+ * least-squares solution, with O(rows * rank) work per right-hand side
+ * after the O(rows * cols * rank) factoring.
+ */
+class QRDecomposition {
+private:
+    Matrix _qr;                     ///< Packed factors: R on and above the diagonal, reflectors below it.
+    std::vector<double> _tau;       ///< Reflector i is I - _tau[i] * v * vᵀ.
+    std::vector<int> _permutation;  ///< Column j of AP is column _permutation[j] of A.
+    int _rank;                      ///< Number of reflectors, i.e. |R(i, i)| above the tolerance.
+    double _largestNorm;            ///< Largest column norm of A, |R(0, 0)|.
+    double _tolerance;              ///< Threshold on |R(i, i)| for the rank.
+
+    /**
+     * @brief Factor columns [first, first + width) with pivoting and update the rest.
+     * @param exhausted Set if the next pivot fell below the tolerance; the
+     *        rest of the matrix is then left as it is.
+     * @return Number of columns factored: less than width if pivots ran out or
+     *         a column norm needs recomputing.
+     */
+    int factorPanel(int first, int width, std::vector<double>& norms, std::vector<double>& referenceNorms,
+                    std::vector<double>& update, bool& exhausted);
+
+    /**
+     * @brief b := Qᵀ b, applying the _rank reflectors to every column of b.
+     */
+    void applyQTranspose(Matrix& b) const;
+
+    /**
+     * @brief x = P [R11⁻¹ c(0:rank, :); 0], the basic solution from c = Qᵀ b.
+     */
+    [[nodiscard]] Matrix backSubstitute(const Matrix& c) const;
+
+public:
+    /**
+     * @brief Factor a matrix of any shape.
+     * @param matrix Matrix to factor.
+     */
+    explicit QRDecomposition(const Matrix& matrix);
+
+    [[nodiscard]] int rows() const; ///< Rows of the factored matrix.
+    [[nodiscard]] int cols() const; ///< Columns of the factored matrix.
+
+    /**
+     * @brief Numerical rank: the number of |R(i, i)| above tolerance().
+     */
+    [[nodiscard]] int rank() const;
+
+    /**
+     * @brief The rank threshold, max(rows, cols) * epsilon * |R(0, 0)|.
+     */
+    [[nodiscard]] double tolerance() const;
+
+    /**
+     * @brief The column permutation: column j of AP is column permutation()[j] of A.
+     */
+    [[nodiscard]] const std::vector<int>& permutation() const;
+
+    /**
+     * @brief Classify and solve AX = B.
+     *
+     * NoSolution if B has a component outside the range of A (relative to
+     * the tolerance), Infinite if A has fewer independent columns than
+     * columns, and otherwise Unique, with x and its relative residual.
+     * Overdetermined systems whose equations agree are Unique.
+     *
+     * @param b Right-hand side with rows() rows and any number of columns.
+     * @throws MatrixDimensionMismatch if b has the wrong number of rows.
+     */
+    [[nodiscard]] SolveResult solve(const Matrix& b) const;
+
+    /**
+     * @brief Least-squares solution: X minimizing ||AX - B|| column by column.
+     *
+     * If A is rank-deficient, this is the basic solution, which is zero in
+     * the columns that pivoting found dependent.
+     *
+     * @param b Right-hand side with rows() rows and any number of columns.
+     * @param residual If not null, receives the relative residual ||B - AX|| / ||B||.
+     * @return X, cols() x b.getCols().
+     * @throws MatrixDimensionMismatch if b has the wrong number of rows.
+     */
+    [[nodiscard]] Matrix leastSquares(const Matrix& b, double* residual = nullptr) const;
+};
@@ -0,0 +1,209 @@
+#pragma once
+#include <cstddef>
+#include <iostream>
+#include <vector>
+#include "Matrix.h"
+
+/**
+ * @class SparseMatrix
+ * @brief Matrix stored in compressed sparse row (CSR) form.
+ *
+ * Only the non-zero elements are kept: for each row, the column indices of
+ * its non-zeros (strictly increasing) and their values, with rowStart()[i]
+ * giving the offset of row i's first entry. Memory is O(rows + nonZeros()),
+ * so dimensions are not bound by the dense element limit.
+ *
+ * The compressed sparse column (CSC) form of a matrix is the CSR form of its
+ * transpose; transpose() builds it in O(rows + cols + nonZeros()).
+ *
+ * Products and sums with dense matrices produce a dense Matrix; products and
+ * sums of two sparse matrices stay sparse. Large products are split across
+ * the thread pool by rows (see Parallel::parallelFor).
+ */
+class SparseMatrix {
+private:
+    int _rows;                          ///< Number of matrix rows.
+    int _cols;                          ///< Number of matrix columns.
+    std::vector<std::size_t> _rowStart; ///< _rowStart[i] is the offset of row i's first entry (rows + 1 offsets).
+    std::vector<int> _colIndex;         ///< Column of each stored entry, increasing within a row.
+    std::vector<double> _values;        ///< Value of each stored entry.
+
+    /**
+     * @brief Drop stored entries whose value is exactly zero.
+     */
+    void prune();
+
+    /**
+     * @brief Offset of element (row, col) in the entry arrays, or nonZeros() if it is not stored.
+     */
+    [[nodiscard]] std::size_t find(int row, int col) const;
+
+    /**
+     * @brief this + sign * other, merging the two matrices row by row.
+     * @throws MatrixDimensionMismatch if dimensions differ.
+     */
+    [[nodiscard]] SparseMatrix combine(const SparseMatrix& other, double sign) const;
+
+public:
+    /**
+     * @struct Triplet
+     * @brief One (row, column, value) entry, used to build a matrix.
+     */
+    struct Triplet {
+        int row;
+        int col;
+        double value;
+    };
+
+    // ==== Constructors ====
+
+    /**
+     * @brief Default constructor (creates an empty 0x0 matrix).
+     */
+    SparseMatrix() : _rows(0), _cols(0), _rowStart(1, 0) {}
+
+    /**
+     * @brief Constructor creating an all-zero matrix.
+     * @param rows Number of rows.
+     * @param cols Number of columns.
+     * @throws MatrixInvalidInitialization if rows or cols <= 0.
+     */
+    SparseMatrix(int rows, int cols);
+
+    /**
+     * @brief Convert a dense matrix, keeping elements whose magnitude exceeds dropTolerance.
+     * @param dense Matrix to convert.
+     * @param dropTolerance Elements with |value| <= dropTolerance are not stored.
+     */
+    explicit SparseMatrix(const Matrix& dense, double dropTolerance = 0.0);
+
+    /**
+     * @brief Build a matrix from unordered entries.
+     *
+     * Entries for the same element are summed; elements that end up zero are
+     * not stored.
+     *
+     * @param rows Number of rows.
+     * @param cols Number of columns.
+     * @param entries Entries to store, in any order.
+     * @throws MatrixInvalidInitialization if rows or cols <= 0.
+     * @throws MatrixOutOfBounds if an entry lies outside the matrix.
+     */
+    static SparseMatrix fromTriplets(int rows, int cols, std::vector<Triplet> entries);
+
+    /**
+     * @brief Adopt ready-made CSR arrays, after checking that they are consistent.
+     * @throws MatrixInvalidInitialization if rows or cols <= 0.
+     * @throws MatrixInvalidSparseStructure if the arrays do not describe a valid CSR matrix.
+     */
+    static SparseMatrix fromCSR(int rows, int cols,
+                                std::vector<std::size_t> rowStart,
+                                std::vector<int> colIndex,
+                                std::vector<double> values);
+
+    /**
+     * @brief Convert to a dense matrix.
+     * @throws MatrixTooLarge if the dense form exceeds Matrix's element limit.
+     */
+    [[nodiscard]] Matrix toDense() const;
+
+    // ==== Comparison Operators ====
+
+    bool operator==(const SparseMatrix& other) const; ///< Same dimensions and exactly the same stored entries.
+    bool operator!=(const SparseMatrix& other) const; ///< Negation of operator==.
+
+    // ==== Basic Information ====
+
+    [[nodiscard]] int getRows() const { return _rows; } ///< Row count.
+    [[nodiscard]] int getCols() const { return _cols; } ///< Column count.
+
+    /**
+     * @brief Number of stored (non-zero) elements.
+     */
+    [[nodiscard]] std::size_t nonZeros() const { return _values.size(); }
+
+    /**
+     * @brief Fraction of the elements that are stored, in [0, 1].
+     */
+    [[nodiscard]] double density() const;
+
+    // ==== Raw CSR arrays, for kernels and bulk I/O ====
+
+    [[nodiscard]] const std::vector<std::size_t>& rowStart() const { return _rowStart; } ///< Row offsets (rows + 1).
+    [[nodiscard]] const std::vector<int>& colIndex() const { return _colIndex; }          ///< Entry columns.
+    [[nodiscard]] const std::vector<double>& values() const { return _values; }           ///< Entry values.
+
+    // ==== Element Access ====
+
+    /**
+     * @brief Value of an element (0 if it is not stored). O(log of the row's entries).
+     * @throws MatrixOutOfBounds if indices are invalid.
+     */
+    [[nodiscard]] double operator()(int row, int col) const;
+
+    /**
+     * @brief Set an element, inserting or removing its entry as needed.
+     *
+     * Costs O(nonZeros()) when the set of stored entries changes, so build
+     * large matrices with fromTriplets() instead.
+     *
+     * @throws MatrixOutOfBounds if indices are invalid.
+     */
+    void set(int row, int col, double value);
+
+    // ==== Arithmetic ====
+
+    /**
+     * @brief Transpose (equivalently, the CSC form of this matrix).
+     */
+    [[nodiscard]] SparseMatrix transpose() const;
+
+    SparseMatrix operator+(const SparseMatrix& other) const; ///< Sparse addition (row-wise merge).
+    SparseMatrix operator-(const SparseMatrix& other) const; ///< Sparse subtraction (row-wise merge).
+    SparseMatrix operator*(double scalar) const;             ///< Scalar multiplication.
+
+    /**
+     * @brief Sparse x dense product; costs O(nonZeros() * other.getCols()).
+     * @throws MatrixDimensionMismatch if getCols() != other.getRows().
+     */
+    Matrix operator*(const Matrix& other) const;
+
+    /**
+     * @brief Sparse x sparse product (Gustavson's row-by-row algorithm).
+     * @throws MatrixDimensionMismatch if getCols() != other.getRows().
+     */
+    SparseMatrix operator*(const SparseMatrix& other) const;
+
+    /**
+     * @brief Add alpha times this matrix to a dense matrix in place.
+     * @throws MatrixDimensionMismatch if dimensions differ.
+     */
+    void addTo(Matrix& dense, double alpha = 1.0) const;
+
+    // ==== I/O ====
+
+    /**
+     * @brief Print the dimensions and every stored entry, one per line.
+     *
+     * Example:
+     * @code
+     * 3x4 sparse, 2 non-zeros
+     * (0, 1): 2.500
+     * (2, 3): -1.000
+     * @endcode
+     */
+    friend std::ostream& operator<<(std::ostream& os, const SparseMatrix& matrix);
+};
+
+SparseMatrix operator*(double scalar, const SparseMatrix& matrix); ///< Scalar multiplication.
+
+/**
+ * @brief Dense x sparse product; costs O(lhs.getRows() * rhs.nonZeros()) at most.
+ * @throws MatrixDimensionMismatch if lhs.getCols() != rhs.getRows().
+ */
+Matrix operator*(const Matrix& lhs, const SparseMatrix& rhs);
+
+Matrix operator+(const SparseMatrix& lhs, const Matrix& rhs); ///< Mixed addition (dense result).
+Matrix operator+(const Matrix& lhs, const SparseMatrix& rhs); ///< Mixed addition (dense result).
+Matrix operator-(const SparseMatrix& lhs, const Matrix& rhs); ///< Mixed subtraction (dense result).
+Matrix operator-(const Matrix& lhs, const SparseMatrix& rhs); ///< Mixed subtraction (dense result).
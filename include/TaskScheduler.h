@@ -0,0 +1,115 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ThreadPool.h"
+
+/**
+ * @class TaskScheduler
+ * @brief Runs tasks that read and write named resources concurrently, in dependency order.
+ *
+ * Each task declares the names it reads and the names it writes. A task
+ * waits for every earlier task that writes one of its names, and a task
+ * writing a name also waits for the earlier tasks reading it; tasks
+ * touching disjoint names, or only reading the same ones, run side by
+ * side on the scheduler's workers. A task typically works on its own copy
+ * of the names it touches, taken when it starts (see Workspace::snapshot()),
+ * so its work never races with the owner's state.
+ *
+ * A task goes through three steps. start() runs on the owner thread, the
+ * thread that submits, once the task's dependencies have committed, and
+ * returns the work to run on a worker. commit() runs on the owner thread
+ * as soon as that work has finished, to publish its results; tasks
+ * waiting on it are started right after. retire() runs on the owner
+ * thread too, strictly in submission order, e.g. to print results in the
+ * order they were asked for.
+ *
+ * Only the owner thread may call submit(), poll() and waitAll(); the three
+ * steps never run concurrently with each other, so they may share state
+ * without locks.
+ */
+class TaskScheduler {
+public:
+    using Work = std::function<void()>;
+
+    /**
+     * @struct Task
+     * @brief A unit of work and the names it touches.
+     */
+    struct Task {
+        std::vector<std::string> reads;   ///< Names read (and not written).
+        std::vector<std::string> writes;  ///< Names created, modified or deleted.
+        std::function<Work()> start;      ///< Owner thread: prepares and returns the work.
+        std::function<void()> commit;     ///< Owner thread: publishes the results (optional).
+        std::function<void()> retire;     ///< Owner thread, in submission order (optional).
+    };
+
+    /**
+     * @brief Create a scheduler running work on the given number of threads.
+     * @param workers Worker threads (at least one is used).
+     */
+    explicit TaskScheduler(unsigned workers);
+
+    /**
+     * @brief Finish every submitted task (see waitAll()).
+     */
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    /**
+     * @brief Queue a task; it starts at once if it depends on no unfinished task.
+     *
+     * Also commits and retires whatever has finished in the meantime.
+     * @throws Whatever a task's work threw, as poll() does.
+     */
+    void submit(Task task);
+
+    /**
+     * @brief Commit and retire finished tasks, without blocking.
+     * @throws Whatever a task's work threw, once that task is committed.
+     */
+    void poll();
+
+    /**
+     * @brief Block until every submitted task has been committed and retired.
+     * @throws Whatever a task's work threw, once that task is committed.
+     */
+    void waitAll();
+
+    /**
+     * @brief Tasks submitted but not yet retired.
+     */
+    [[nodiscard]] std::size_t pending() const { return _tasks.size(); }
+
+private:
+    struct Entry {
+        Task task;
+        std::size_t unmetDependencies = 0;
+        std::vector<std::uint64_t> dependents; ///< Tasks waiting for this one's commit.
+        bool committed = false;
+        std::exception_ptr error;             ///< Set by the worker if the work threw.
+    };
+
+    std::map<std::uint64_t, Entry> _tasks;                     ///< Unretired tasks, by submission number.
+    std::unordered_map<std::string, std::uint64_t> _lastWriter; ///< Latest uncommitted writer of each name.
+    std::unordered_map<std::string, std::vector<std::uint64_t>> _readers; ///< Uncommitted readers since that writer.
+    std::uint64_t _nextId = 0;
+
+    std::mutex _mutex;
+    std::condition_variable _finishedSignal;
+    std::vector<std::uint64_t> _finished; ///< Tasks whose work is done but not yet committed; guarded by _mutex.
+
+    ThreadPool _pool; ///< Declared last, so its workers stop before the state they report to goes away.
+
+    void launch(std::uint64_t id);
+    void commitFinished(std::vector<std::uint64_t> finished);
+    void retireCommitted();
+};
@@ -0,0 +1,85 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class ThreadPool
+ * @brief Fixed-size work-stealing thread pool.
+ *
+ * Every worker owns a task deque. A worker pushes the tasks it spawns onto
+ * the back of its own deque and pops from the back (newest first, so nested
+ * work stays cache-hot); when its deque is empty it steals from the front of
+ * the other workers' deques. Tasks submitted from outside the pool are
+ * spread round-robin across the deques.
+ *
+ * Threads waiting for their own tasks to finish should call
+ * tryRunPendingTask() instead of blocking, which keeps nested parallel
+ * regions from deadlocking the pool.
+ *
+ * Matrix kernels use the process-wide instance returned by shared(), which
+ * starts its workers on first use only.
+ */
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * @brief Create a pool with the given number of worker threads.
+     * @param workers Number of threads (0 is allowed: tasks then only run
+     *        when a caller executes them via tryRunPendingTask()).
+     */
+    explicit ThreadPool(unsigned workers);
+
+    /**
+     * @brief Stop the workers. Tasks still queued are discarded.
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Process-wide pool with one worker per hardware thread but one
+     *        (the calling thread is expected to take part in the work).
+     */
+    static ThreadPool& shared();
+
+    /**
+     * @brief Number of worker threads.
+     */
+    [[nodiscard]] unsigned size() const;
+
+    /**
+     * @brief Queue a task for execution on some worker.
+     */
+    void submit(Task task);
+
+    /**
+     * @brief Run one queued task on the calling thread, if there is one.
+     * @return True if a task was run.
+     */
+    bool tryRunPendingTask();
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> _queues; ///< One deque per worker (at least one).
+    std::vector<std::thread> _workers;
+    std::atomic<unsigned> _nextQueue{0};             ///< Round-robin cursor for outside submissions.
+    std::atomic<long> _pending{0};                   ///< Tasks queued but not yet taken.
+    std::mutex _sleepMutex;
+    std::condition_variable _wake;
+    bool _stopping = false;                          ///< Guarded by _sleepMutex.
+
+    void workerLoop(unsigned index);
+    bool takeTask(int preferredQueue, Task& task);
+};
@@ -1,8 +1,18 @@
 #pragma once
+#include <cstdint>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <functional>
+#include <iostream>
+#include <vector>
 #include "Matrix.h"
+#include "LUDecomposition.h"
+#include "MatrixBatch.h"
+#include "SparseMatrix.h"
+#include "OutOfCoreMatrix.h"
+#include "Parallel.h"
+#include "IterativeSolvers.h"
 
 /**
  * @class Workspace
@@ -12,6 +22,17 @@
  * It stores matrices in memory, supports creation, manipulation, and persistence,
  * and provides safe, exception-aware wrappers for all mathematical operations.
  *
+ * Matrices are stored dense (Matrix), sparse (SparseMatrix) or dense in
+ * single precision (FloatMatrix), under one shared set of names. Operations
+ * pick the sparse kernels when an operand is sparse; operations without a
+ * sparse kernel work on a dense copy. Element-wise operations and products
+ * of two float32 matrices stay in float32; everything else, and any mix
+ * with a float64 matrix, works on a double copy. Matrices too large for
+ * memory are stored on disk (OutOfCoreMatrix); products and direct solves
+ * involving them run out of core, other operations on an in-memory copy.
+ * A name can also hold a batch of same-shaped matrices (MatrixBatch), which
+ * only the batch operations take.
+ *
  * Each matrix is identified by a unique string name, and the Workspace offers
  * both interactive (e.g., assignMatrix) and programmatic (e.g., multiplyMatrices)
  * operations. The class is also responsible for loading and saving entire
@@ -29,6 +50,220 @@ private:
      */
     std::unordered_map<std::string, Matrix> workspace;
 
+    /**
+     * @brief Stores the sparse matrices, indexed by their names.
+     *
+     * Shares its names with workspace: a name is in at most one of the two maps.
+     */
+    std::unordered_map<std::string, SparseMatrix> sparseWorkspace;
+
+    /**
+     * @brief Stores the float32 matrices, indexed by their names.
+     *
+     * Shares its names with workspace and sparseWorkspace.
+     */
+    std::unordered_map<std::string, FloatMatrix> floatWorkspace;
+
+    /**
+     * @brief Stores the out-of-core matrices, indexed by their names.
+     *
+     * Shares its names with the other maps.
+     */
+    std::unordered_map<std::string, OutOfCoreMatrix> diskWorkspace;
+
+    /**
+     * @brief Stores the matrix batches, indexed by their names.
+     *
+     * Shares its names with the other maps.
+     */
+    std::unordered_map<std::string, MatrixBatch> batchWorkspace;
+
+    /**
+     * @brief Results computed from one version of a matrix, reused until it changes.
+     */
+    struct DerivedData {
+        std::uint64_t version = 0;                    ///< Matrix version the results belong to.
+        std::optional<int> rank;                      ///< rank()
+        std::optional<double> determinant;            ///< determinant()
+        std::optional<LUDecomposition> factorization; ///< LU factors (square matrices only).
+        std::optional<Matrix> inverse;                ///< inverse()
+    };
+
+    /**
+     * @brief Version counter per matrix name, bumped by every change to it.
+     *
+     * Setting elements, assign, transpose, 3d_rotate, conversions, deletion
+     * and storing a new matrix under the name all go through
+     * invalidateDerivedData(). Counters are never reset, so a matrix
+     * re-created under an old name gets a fresh version.
+     */
+    std::unordered_map<std::string, std::uint64_t> versions;
+
+    /**
+     * @brief Cached rank, determinant, LU factors and inverse, indexed by matrix name.
+     *
+     * Mutable so that the const queries (rank, det) can fill it in.
+     */
+    mutable std::unordered_map<std::string, DerivedData> derivedData;
+
+    /**
+     * @brief Solver used by solveMatrix() (direct elimination by default).
+     */
+    SolverOptions solverOptions;
+
+    /**
+     * @brief Buffer pool bytes kept cached between commands (see endCommand()).
+     */
+    static constexpr std::size_t IDLE_CACHE_BYTES = std::size_t(32) << 20;
+
+    /**
+     * @brief Where the user-facing messages go (std::cout by default, see setOutput()).
+     */
+    std::ostream* outputStream = &std::cout;
+
+    /**
+     * @brief Stores a matrix under the given name, replacing any previous one.
+     * @param matName Name to store the matrix under.
+     * @param matrix Matrix to store (moved into the workspace).
+     */
+    void storeMatrix(const std::string& matName, Matrix&& matrix);
+
+    /**
+     * @brief Stores a sparse matrix under the given name, replacing any previous matrix.
+     * @param matName Name to store the matrix under.
+     * @param matrix Matrix to store (moved into the workspace).
+     */
+    void storeMatrix(const std::string& matName, SparseMatrix&& matrix);
+
+    /**
+     * @brief Stores a float32 matrix under the given name, replacing any previous matrix.
+     * @param matName Name to store the matrix under.
+     * @param matrix Matrix to store (moved into the workspace).
+     */
+    void storeMatrix(const std::string& matName, FloatMatrix&& matrix);
+
+    /**
+     * @brief Stores an out-of-core matrix under the given name, replacing any previous matrix.
+     * @param matName Name to store the matrix under.
+     * @param matrix Matrix to store (moved into the workspace).
+     */
+    void storeMatrix(const std::string& matName, OutOfCoreMatrix&& matrix);
+
+    /**
+     * @brief Stores a batch under the given name, replacing any previous matrix or batch.
+     * @param batchName Name to store the batch under.
+     * @param batch Batch to store (moved into the workspace).
+     */
+    void storeBatch(const std::string& batchName, MatrixBatch&& batch);
+
+    /**
+     * @brief Whether the named matrix is stored sparse.
+     */
+    [[nodiscard]] bool isSparse(const std::string& matName) const;
+
+    /**
+     * @brief Whether the named matrix is stored in single precision.
+     */
+    [[nodiscard]] bool isFloat32(const std::string& matName) const;
+
+    /**
+     * @brief Whether the named matrix is stored out of core.
+     */
+    [[nodiscard]] bool isOnDisk(const std::string& matName) const;
+
+    /**
+     * @brief Whether the name holds a batch rather than a matrix.
+     */
+    [[nodiscard]] bool isBatch(const std::string& matName) const;
+
+    /**
+     * @brief Checks that a batch with the given name exists.
+     * @return True if it does, false otherwise (also prints an error).
+     */
+    [[nodiscard]] bool batchExists(const std::string& batchName) const;
+
+    /**
+     * @brief Reports how many matrices of a batch operation were singular.
+     */
+    void reportSingularCount(const BatchSolveResult& result) const;
+
+    /**
+     * @brief The named matrix in dense double form: the stored one, or a
+     *        conversion of a sparse, float32 or out-of-core one written to converted.
+     * @throws MatrixTooLarge if a sparse or out-of-core matrix is too large to convert.
+     */
+    const Matrix& denseOperand(const std::string& matName, Matrix& converted) const;
+
+    /**
+     * @brief Runs a binary operation where at least one operand is sparse.
+     *
+     * Checks that both matrices exist, picks the kernel matching the operand
+     * kinds, and stores the result (sparse only when both operands are).
+     *
+     * @return True if the operation succeeded, false otherwise.
+     */
+    bool sparseBinaryOp(const std::string& resultName,
+                        const std::string& mat1Name,
+                        const std::string& mat2Name,
+                        const std::function<SparseMatrix(const SparseMatrix&, const SparseMatrix&)>& sparseOp,
+                        const std::function<Matrix(const SparseMatrix&, const Matrix&)>& sparseDenseOp,
+                        const std::function<Matrix(const Matrix&, const SparseMatrix&)>& denseSparseOp);
+
+    /**
+     * @brief Runs a binary operation on two float32 matrices, storing a float32 result.
+     * @return True if the operation succeeded, false otherwise.
+     */
+    bool floatBinaryOp(const std::string& resultName,
+                       const std::string& mat1Name,
+                       const std::string& mat2Name,
+                       const std::function<FloatMatrix(const FloatMatrix&, const FloatMatrix&)>& op);
+
+    /**
+     * @brief Multiplies two matrices of which at least one is out of core.
+     *
+     * The product stays on disk unless the right operand is in memory
+     * (e.g. a vector), in which case it is computed into memory.
+     *
+     * @return True if the multiplication succeeded, false otherwise.
+     */
+    bool diskMultiply(const std::string& resultName,
+                      const std::string& mat1Name,
+                      const std::string& mat2Name);
+
+    /**
+     * @brief Bumps a matrix's version and drops the results cached for it.
+     * @param matName Name of the matrix that changed.
+     */
+    void invalidateDerivedData(const std::string& matName);
+
+    /**
+     * @brief Bumps a dense matrix's version after it changed by the rank-one
+     *        matrix u vᵀ, keeping what can be updated.
+     *
+     * Cached LU factors are updated in place (LUDecomposition::update()) and
+     * a cached inverse by the Sherman-Morrison formula, both in O(n²), so
+     * the next det, solve or lu_solve does not refactor. Rank and
+     * determinant are dropped (the determinant comes back from the updated
+     * factors in O(n)). If the factors refuse the update, everything is
+     * dropped as by invalidateDerivedData().
+     *
+     * @param matName Name of the matrix that changed.
+     * @param u Column vector with the matrix's row count.
+     * @param v Column vector with the matrix's column count.
+     */
+    void updateDerivedData(const std::string& matName, const Matrix& u, const Matrix& v);
+
+    /**
+     * @brief The cache entry for a matrix's current version (emptied if it was stale).
+     */
+    DerivedData& derivedFor(const std::string& matName) const;
+
+    /**
+     * @brief The LU factors of the named (square) matrix, computed and cached if needed.
+     * @throws MatrixNotSquare if the matrix is not square.
+     */
+    const LUDecomposition& factorizationFor(const std::string& matName) const;
+
 public:
     // ========================= CONSTRUCTION =========================
 
@@ -42,23 +277,102 @@ public:
      */
     ~Workspace() = default;
 
+    Workspace(Workspace&&) = default;
+    Workspace& operator=(Workspace&&) = default;
+
+    // ========================= OUTPUT =========================
+
+    /**
+     * @brief Sends the messages of every later operation to stream instead of std::cout.
+     *
+     * The stream must outlive the workspace, or the next setOutput() call.
+     */
+    void setOutput(std::ostream& stream) { outputStream = &stream; }
+
+    /**
+     * @brief The stream operations print their messages to.
+     */
+    [[nodiscard]] std::ostream& output() const { return *outputStream; }
+
+    // ========================= SNAPSHOTS =========================
+
+    /**
+     * @brief Whether snapshot() can copy the named matrices.
+     *
+     * Out-of-core matrices cannot be copied cheaply, so a workspace holding
+     * any of the names on disk cannot hand them to a snapshot.
+     */
+    [[nodiscard]] bool canSnapshot(const std::vector<std::string>& names) const;
+
+    /**
+     * @brief A new workspace holding copies of the named matrices, to run operations on.
+     *
+     * Names that do not exist are simply absent from the snapshot. The copies
+     * keep their versions and cached results, and the snapshot inherits the
+     * solver settings; its output goes to this workspace's stream until
+     * redirected. Dense copies share their storage until written (see
+     * Matrix), so a snapshot of dense matrices costs no element copies.
+     *
+     * @param names Matrices to copy; must satisfy canSnapshot().
+     */
+    [[nodiscard]] Workspace snapshot(const std::vector<std::string>& names) const;
+
+    /**
+     * @brief Brings the results of operations run on a snapshot back into this workspace.
+     *
+     * Every name in writes is replaced by the snapshot's matrix, or deleted
+     * if the snapshot no longer has it, and gets a new version. For names
+     * in reads, results the snapshot cached (rank, determinant, factors,
+     * inverse) are kept if the matrix has not changed here in the meantime.
+     *
+     * @param scratch Workspace returned by snapshot(), consumed.
+     * @param writes Names the operations may have modified, created or deleted.
+     * @param reads Names the operations only read.
+     */
+    void merge(Workspace&& scratch, const std::vector<std::string>& writes, const std::vector<std::string>& reads);
+
     // ========================= QUERY METHODS =========================
 
     /**
-     * @brief Returns the total number of matrices currently stored.
+     * @brief Returns the total number of matrices currently stored (a batch counts once).
      * @return The number of matrices in the workspace.
      */
     [[nodiscard]] size_t getMatrixCount() const;
 
+    /**
+     * @brief Returns the names of all stored matrices, in no particular order.
+     */
+    [[nodiscard]] std::vector<std::string> getMatrixNames() const;
+
     /**
      * @brief Checks whether a matrix with the given name exists.
      * @param matName The name of the matrix to look for.
-     * @return True if the matrix exists, false otherwise (also prints an error).
+     * @return True if the matrix exists, false otherwise (also prints an error,
+     *         which for a batch points to the batch commands).
      */
     [[nodiscard]] bool matrixExists(const std::string& matName) const;
 
+    /**
+     * @brief Copies a matrix out of the workspace, in dense double form.
+     *
+     * Dense matrices are shared copy-on-write, so this copies no elements.
+     *
+     * @param matName The name of the matrix.
+     * @param copy Receives the matrix.
+     * @return True if the matrix exists (and fits Matrix), false otherwise (also prints an error).
+     */
+    bool getMatrix(const std::string& matName, Matrix& copy) const;
+
     // ========================= CREATION & BASIC OPS =========================
 
+    /**
+     * @brief Stores a matrix under the given name, replacing any previous one.
+     * @param matName The name to store it under.
+     * @param matrix The matrix (moved into the workspace).
+     * @return True once stored.
+     */
+    bool putMatrix(const std::string& matName, Matrix&& matrix);
+
     /**
      * @brief Creates a new matrix and stores it in the workspace.
      *
@@ -70,6 +384,97 @@ public:
      */
     bool createMatrix(const std::string& matName, int rows, int cols, double initValue = 0.0);
 
+    /**
+     * @brief Creates a new all-zero sparse matrix and stores it in the workspace.
+     *
+     * Sparse matrices are not subject to the dense element limit.
+     *
+     * @param matName The name of the new matrix.
+     * @param rows Number of rows.
+     * @param cols Number of columns.
+     * @return True if creation succeeded, false otherwise.
+     */
+    bool createSparseMatrix(const std::string& matName, int rows, int cols);
+
+    /**
+     * @brief Creates a new single-precision matrix and stores it in the workspace.
+     *
+     * @param matName The name of the new matrix.
+     * @param rows Number of rows.
+     * @param cols Number of columns.
+     * @param initValue Optional initial value for all elements (default = 0.0).
+     * @return True if creation succeeded, false otherwise.
+     */
+    bool createFloatMatrix(const std::string& matName, int rows, int cols, float initValue = 0.0f);
+
+    /**
+     * @brief Creates a new out-of-core matrix, backed by a temporary file, and stores it in the workspace.
+     *
+     * Out-of-core matrices are not subject to the in-memory element limit.
+     *
+     * @param matName The name of the new matrix.
+     * @param rows Number of rows.
+     * @param cols Number of columns.
+     * @param initValue Optional initial value for all elements (default = 0.0).
+     * @return True if creation succeeded, false otherwise.
+     */
+    bool createDiskMatrix(const std::string& matName, int rows, int cols, double initValue = 0.0);
+
+    /**
+     * @brief Sets a single element of a dense or sparse matrix.
+     *
+     * For a dense matrix the cached factors and inverse are updated for the
+     * change instead of being recomputed (see updateDerivedData()).
+     * @param matName The name of the matrix to modify.
+     * @param row Row index (0-based).
+     * @param col Column index (0-based).
+     * @param value New value.
+     * @return True if the element was set, false otherwise.
+     */
+    bool setElement(const std::string& matName, int row, int col, double value);
+
+    /**
+     * @brief Converts a stored dense matrix to sparse form, dropping its zeros.
+     * @param matName The name of the matrix to convert.
+     * @return True if the matrix exists (and is now sparse).
+     */
+    bool convertToSparse(const std::string& matName);
+
+    /**
+     * @brief Converts a stored sparse matrix to dense form.
+     * @param matName The name of the matrix to convert.
+     * @return True if the matrix is now dense, false if it does not exist or is too large.
+     */
+    bool convertToDense(const std::string& matName);
+
+    /**
+     * @brief Converts a stored dense matrix to single precision, rounding its elements.
+     * @param matName The name of the matrix to convert.
+     * @return True if the matrix is now float32, false if it does not exist or is sparse.
+     */
+    bool convertToFloat32(const std::string& matName);
+
+    /**
+     * @brief Converts a stored float32 matrix to double precision (exactly).
+     * @param matName The name of the matrix to convert.
+     * @return True if the matrix is now float64, false if it does not exist or is sparse.
+     */
+    bool convertToFloat64(const std::string& matName);
+
+    /**
+     * @brief Moves a stored dense matrix out of core.
+     * @param matName The name of the matrix to convert.
+     * @return True if the matrix is now on disk, false if it does not exist, is sparse or float32.
+     */
+    bool convertToDisk(const std::string& matName);
+
+    /**
+     * @brief Loads a stored out-of-core matrix into memory.
+     * @param matName The name of the matrix to convert.
+     * @return True if the matrix is now in memory, false if it does not exist or is too large.
+     */
+    bool convertToMemory(const std::string& matName);
+
     /**
      * @brief Lists all matrices currently stored in the workspace.
      * Prints each matrix name and its contents.
@@ -94,7 +499,9 @@ public:
     /**
      * @brief Allows interactive reassignment of matrix values through console input.
      *
-     * The user is prompted for each element sequentially.
+     * The user is prompted for each element sequentially. If the new
+     * values differ from the old ones in a single row or column, cached
+     * factors are updated rather than dropped (see updateDerivedData()).
      *
      * @param matName The name of the matrix to modify.
      * @return True if assignment completed successfully, false otherwise.
@@ -102,7 +509,7 @@ public:
     bool assignMatrix(const std::string& matName);
 
     /**
-     * @brief Deletes a matrix from the workspace.
+     * @brief Deletes a matrix (or batch) from the workspace.
      * @param matName The name of the matrix to delete.
      * @return True if deletion succeeded, false otherwise.
      */
@@ -111,7 +518,7 @@ public:
     // ========================= MATHEMATICAL OPERATIONS =========================
 
     /**
-     * @brief Computes and prints the rank of a matrix.
+     * @brief Computes and prints the rank of a matrix (cached until the matrix changes).
      * @param matName The name of the matrix.
      * @return True if successful, false otherwise.
      */
@@ -119,11 +526,26 @@ public:
 
     /**
      * @brief Computes and prints the determinant of a matrix.
+     *
+     * Cached until the matrix changes; taken from the LU factors when they
+     * are already stored.
      * @param matName The name of the matrix.
      * @return True if successful, false otherwise.
      */
     [[nodiscard]] bool determinantMatrix(const std::string& matName) const;
 
+    /**
+     * @brief The rank of a matrix, as printed by rankMatrix() (shares its cache).
+     * @return The rank, or nothing if it could not be computed (an error is printed).
+     */
+    [[nodiscard]] std::optional<int> rankOf(const std::string& matName) const;
+
+    /**
+     * @brief The determinant of a matrix, as printed by determinantMatrix() (shares its cache).
+     * @return The determinant, or nothing if it could not be computed (an error is printed).
+     */
+    [[nodiscard]] std::optional<double> determinantOf(const std::string& matName) const;
+
     /**
      * @brief Multiplies a matrix by a scalar and stores the result.
      * @param resultName The name of the resulting matrix.
@@ -139,7 +561,8 @@ public:
      * @brief Generic helper for performing binary operations on two matrices.
      *
      * This function checks that both matrices exist, performs the given operation,
-     * and stores the result under a new name.
+     * and stores the result under a new name. Sparse operands are passed to op
+     * as dense copies.
      *
      * @param resultName Name of the resulting matrix.
      * @param mat1Name Name of the first operand.
@@ -187,6 +610,10 @@ public:
 
     /**
      * @brief Calculates and stores the inverse of a given matrix.
+     *
+     * The inverse is cached until the source matrix changes, and obtained
+     * from its stored LU factors if there are any.
+     *
      * @param resultName The name of the resulting matrix.
      * @param matName The name of the source matrix.
      * @return True if inversion succeeded, false otherwise.
@@ -196,30 +623,216 @@ public:
     /**
      * @brief Solves a linear system of equations Ax = b.
      *
-     * Depending on the system's properties, the method reports:
+     * Uses the solver chosen with setSolver(). With the direct solver, the
+     * method reports:
      *  - Unique solution → stores result under resultName.
      *  - No solution → prints message.
      *  - Infinite solutions → prints message.
      *
+     * An iterative solver stores the solution once it converges and reports
+     * the iterations and relative residual; a sparse A is then solved
+     * without being converted to dense. The direct solver factors an
+     * out-of-core A out of core (see OutOfCoreMatrix::solve()). For any
+     * other square A it uses A's cached LU factors, computing and caching
+     * them on first use; repeated solves against an unchanged A then cost
+     * O(n²). Only a singular or rectangular A is classified by elimination.
+     *
      * @param resultName Name of the matrix to store the solution (if unique).
      * @param A Name of the coefficient matrix.
      * @param b Name of the column vector (right-hand side).
+     * @param status If not null, receives how the system was classified
+     *               (left untouched when the solve fails).
      * @return True if the operation executed successfully.
      */
     bool solveMatrix(const std::string& resultName,
                      const std::string& A,
-                     const std::string& b);
+                     const std::string& b,
+                     SolveStatus* status = nullptr);
+
+    /**
+     * @brief Computes and stores the LU factorization of a square matrix.
+     *
+     * The factors are kept until the matrix changes, so subsequent calls to
+     * solveWithFactorization() against it cost O(n²) instead of O(n³).
+     *
+     * @param matName The name of the matrix to factor.
+     * @return True if the matrix was factored and is non-singular.
+     */
+    bool factorMatrix(const std::string& matName);
+
+    /**
+     * @brief Solves AX = B using the stored LU factors of A.
+     *
+     * A is factored (and the factors stored) first if needed. B may have
+     * several columns, each solved as a separate right-hand side.
+     *
+     * @param resultName Name of the matrix to store the solution in.
+     * @param A Name of the coefficient matrix.
+     * @param b Name of the right-hand side matrix.
+     * @return True if the system was solved successfully.
+     */
+    bool solveWithFactorization(const std::string& resultName,
+                                const std::string& A,
+                                const std::string& b);
+
+    /**
+     * @brief Stores the least-squares solution X minimizing ||AX - B||.
+     *
+     * Works for any shape of A, including overdetermined systems with no
+     * exact solution, from a column-pivoted QR factorization. If A is
+     * rank-deficient, the basic solution is stored (see
+     * QRDecomposition::leastSquares()). Reports the rank and the relative
+     * residual.
+     *
+     * @param resultName Name of the matrix to store the solution in.
+     * @param A Name of the coefficient matrix.
+     * @param b Name of the right-hand side matrix.
+     * @return True if the system was solved successfully.
+     */
+    bool leastSquaresMatrix(const std::string& resultName,
+                            const std::string& A,
+                            const std::string& b);
+
+    // ========================= BATCHES =========================
+
+    /**
+     * @brief Creates a batch of count rows x cols matrices, every element set to initValue.
+     * @return True if the batch was created, false if the dimensions are invalid.
+     */
+    bool createBatch(const std::string& batchName, int count, int rows, int cols, double initValue = 0.0);
+
+    /**
+     * @brief Replaces matrix index of a batch with a copy of a matrix of the same shape.
+     * @return True if the matrix was copied in.
+     */
+    bool insertIntoBatch(const std::string& batchName, int index, const std::string& matName);
+
+    /**
+     * @brief Stores a copy of matrix index of a batch as a matrix.
+     * @return True if the matrix was copied out.
+     */
+    bool extractFromBatch(const std::string& matName, const std::string& batchName, int index);
+
+    /**
+     * @brief Stores the batch of products A_k B_k of two batches.
+     * @return True if the batches have matching counts and compatible shapes.
+     */
+    bool multiplyBatches(const std::string& resultName, const std::string& A, const std::string& B);
+
+    /**
+     * @brief Stores the batch of solutions of A_k X_k = B_k.
+     *
+     * Singular systems do not fail the operation: their solutions are zero
+     * and their count is reported.
+     *
+     * @return True if the batches have matching counts and shapes.
+     */
+    bool solveBatches(const std::string& resultName, const std::string& A, const std::string& B);
+
+    /**
+     * @brief Stores the determinants of a batch of square matrices as a count x 1 matrix.
+     * @return True if the matrices are square.
+     */
+    bool batchDeterminants(const std::string& resultName, const std::string& batchName);
+
+    /**
+     * @brief Stores the batch of inverses of a batch of square matrices (zero for singular ones).
+     * @return True if the matrices are square.
+     */
+    bool invertBatch(const std::string& resultName, const std::string& batchName);
+
+    // ========================= EXECUTION SETTINGS =========================
+
+    /**
+     * @brief Sets the process-wide execution policy used by matrix operations.
+     *
+     * Under a parallel policy, large multiplications, element-wise operations,
+     * transposes and eliminations are split across the shared thread pool;
+     * small ones always run on the calling thread.
+     *
+     * @param policy The new default policy.
+     * @return Always true.
+     */
+    bool setExecutionPolicy(const ExecutionPolicy& policy);
+
+    /**
+     * @brief Prints the execution policy currently in effect.
+     * @return Always true.
+     */
+    [[nodiscard]] bool showExecutionPolicy() const;
+
+    /**
+     * @brief Selects the solver used by solveMatrix().
+     * @param options Method, preconditioner and stopping criteria.
+     * @return True if the options are valid (positive tolerance and iteration cap).
+     */
+    bool setSolver(const SolverOptions& options);
+
+    /**
+     * @brief Prints the solver used by solveMatrix().
+     * @return Always true.
+     */
+    [[nodiscard]] bool showSolver() const;
+
+    // ========================= PROFILING =========================
+
+    /**
+     * @brief Prints the profiling counters of every instrumented operation
+     *        run so far: calls, total and mean time, GFLOP/s and bytes allocated.
+     *
+     * Times are inclusive, so a Workspace operation also counts the Matrix
+     * operations it performed (see Profiler).
+     *
+     * @return True, or false if profiling was not compiled in.
+     */
+    [[nodiscard]] bool showStatistics() const;
+
+    /**
+     * @brief Zeroes the profiling counters.
+     * @return True, or false if profiling was not compiled in.
+     */
+    bool resetStatistics();
+
+    /**
+     * @brief Starts recording a timeline of the instrumented operations.
+     * @return True, or false if profiling was not compiled in.
+     */
+    bool startTrace();
+
+    /**
+     * @brief Stops recording and writes the timeline as Chrome trace JSON
+     *        (open it in chrome://tracing or https://ui.perfetto.dev).
+     * @param filename Target file, relative to the working directory.
+     * @return True if a trace was recording and has been written.
+     */
+    bool stopTrace(const std::string& filename);
+
+    /**
+     * @brief Ends a command: trims the matrix buffer pool to IDLE_CACHE_BYTES.
+     *
+     * Temporaries freed during a command stay cached for reuse by the rest
+     * of it (see MatrixMemory); this call releases what a large command left
+     * behind so that an idle session does not hold on to it.
+     */
+    void endCommand();
 
     // ========================= FILE OPERATIONS =========================
 
     /**
-     * @brief Saves the entire workspace (all matrices) to a text file.
+     * @brief Saves the entire workspace (all matrices) to a file.
      *
-     * Each matrix is written as:
+     * File names ending in ".bin" are written in the binary format described
+     * in WorkspaceFile.h (exact values, memory-mapped on load). Any other name
+     * gets the text format, where each matrix is written as:
      * ```
      * <name> <rows> <cols>
      * <values row by row>
      * ```
+     * Sparse matrices are written as a `<name> <rows> <cols> sparse <count>`
+     * header followed by one `<row> <col> <value>` line per non-zero, and
+     * float32 matrices with a `<name> <rows> <cols> float32` header.
+     * Out-of-core matrices are not saved (convert them with
+     * convertToMemory() first).
      *
      * @param filename The target file name (stored inside "workspaces/" folder).
      * @return True if the workspace was saved successfully.
@@ -227,10 +840,12 @@ public:
     [[nodiscard]] bool saveWorkspaceToFile(const std::string& filename) const;
 
     /**
-     * @brief Loads a workspace from a text file.
+     * @brief Loads a workspace from a file.
      *
-     * Clears the current workspace and reconstructs it from the file contents.
-     * The file must follow the format produced by saveWorkspaceToFile().
+     * Replaces the current workspace with the file contents. The file must
+     * follow one of the formats produced by saveWorkspaceToFile(); which one
+     * is detected from the file contents, not its name. The file is read and
+     * validated completely first, so on failure the workspace is unchanged.
      *
      * @param filename The source file name (from "workspaces/" folder).
      * @return True if loading succeeded, false otherwise.
@@ -243,6 +858,9 @@ public:
      * @brief Safely executes a mutable operation on a single matrix.
      *
      * Wraps exception handling and matrix existence checks to avoid repetition.
+     * Data derived from the matrix is invalidated after the operation. Sparse
+     * and float32 matrices are rejected, as the operation works on dense
+     * double storage.
      *
      * @param matName Name of the matrix to modify.
      * @param op Operation to perform, taking a modifiable Matrix reference.
@@ -255,6 +873,7 @@ public:
      * @brief Safely executes a read-only operation on a single matrix.
      *
      * Similar to handleSingleMatrixOp, but guarantees const access and no modification.
+     * A sparse or float32 matrix is passed to op as a dense double copy.
      *
      * @param matName Name of the matrix to inspect.
      * @param op Operation to perform, taking a const Matrix reference.
@@ -277,4 +896,22 @@ public:
                         double angleDegreesX,
                         double angleDegreesY,
                         double angleDegreesZ);
+
+    /**
+     * @brief Rotates several 3D vector matrices with one precomputed rotation.
+     *
+     * Each matrix may be 3x1 or 3xN (one vector per column), in either
+     * precision. Nothing is rotated unless every matrix exists, is dense and
+     * has 3 rows. A name listed more than once is rotated once.
+     *
+     * @param vecNames the names of the matrices to rotate
+     * @param angleDegreesX the rotation angle around the X axis in degrees
+     * @param angleDegreesY the rotation angle around the Y axis in degrees
+     * @param angleDegreesZ the rotation angle around the Z axis in degrees
+     * @return  True if rotation succeeded, false otherwise
+     */
+    bool rotate3DVectors(const std::vector<std::string>& vecNames,
+                         double angleDegreesX,
+                         double angleDegreesY,
+                         double angleDegreesZ);
 };
@@ -0,0 +1,123 @@
+#pragma once
+#include <string>
+#include <utility>
+#include <vector>
+#include "Matrix.h"
+#include "SparseMatrix.h"
+
+/**
+ * @namespace WorkspaceFile
+ * @brief Workspace file formats: text and binary.
+ *
+ * Text files hold, per matrix, a `<name> <rows> <cols>` header followed by
+ * rows * cols whitespace-separated values. A sparse matrix instead has a
+ * `<name> <rows> <cols> sparse <count>` header followed by count
+ * `<row> <col> <value>` entries, and a float32 matrix a
+ * `<name> <rows> <cols> float32` header before its values. Values are
+ * written in their shortest round-trip form, so reading a file back gives
+ * the exact doubles (or floats).
+ *
+ * Binary layout (all integers in the writer's byte order, checked on load):
+ * ```
+ * Header     64 bytes   magic "AMWSBIN\0", version, byte-order mark,
+ *                       matrix count, offsets and sizes of the tables below
+ * Name table            all matrix names, concatenated
+ * Directory  32 bytes   per matrix: name offset/length, rows, cols, kind
+ *                       (dense, sparse or float32), payload offset
+ * Payloads              each starting on a 64-byte boundary; dense: rows * cols
+ *                       doubles, row-major; sparse: the entry count (uint64),
+ *                       then the CSR arrays (rows + 1 uint64 row offsets,
+ *                       int32 columns padded to 8 bytes, double values);
+ *                       float32: rows * cols floats, row-major
+ * ```
+ *
+ * Loading memory-maps the file and copies each payload straight into its
+ * matrix: there is nothing to parse, and values round-trip bit for bit.
+ * Workspace picks the format by file name when saving and by content (the
+ * magic) when loading.
+ */
+namespace WorkspaceFile {
+
+    constexpr const char* BINARY_EXTENSION = ".bin"; ///< File names ending in this are saved in binary.
+    constexpr std::size_t VALUES_PER_BLOCK = 4096;   ///< Granularity of parallel text decoding.
+
+    /**
+     * @brief Whether a file name asks for the binary format (ends in BINARY_EXTENSION).
+     */
+    [[nodiscard]] bool isBinaryName(const std::string& filename);
+
+    /**
+     * @brief Whether the file at path starts with the binary magic.
+     * @return False if it does not, or cannot be opened.
+     */
+    [[nodiscard]] bool isBinaryFile(const std::string& path);
+
+    /**
+     * @brief Write matrices to path in the text format, through a large buffer.
+     * @param path Target file (replaced if it exists).
+     * @param matrices Name / matrix pairs to store.
+     * @param sparse Name / sparse matrix pairs to store after them.
+     * @param floats Name / float32 matrix pairs to store last.
+     * @throws WorkspaceFileCorrupt if the file cannot be written.
+     */
+    void writeText(const std::string& path,
+                   const std::vector<std::pair<std::string, const Matrix*>>& matrices,
+                   const std::vector<std::pair<std::string, const SparseMatrix*>>& sparse = {},
+                   const std::vector<std::pair<std::string, const FloatMatrix*>>& floats = {});
+
+    /**
+     * @brief Read every matrix of a text workspace file.
+     *
+     * The file is memory-mapped and scanned once to find each matrix header
+     * and the start of every block of VALUES_PER_BLOCK values; the blocks
+     * are then parsed with std::from_chars in parallel, directly into the
+     * matrices' storage. Sparse entries are parsed during the scan.
+     *
+     * Reading stops quietly at the first header that is not
+     * `<name> <int> <int>`, as the format has no explicit end marker.
+     *
+     * @param path Source file.
+     * @param sparse Receives the sparse matrices, in file order. If null,
+     *        they are converted and returned with the dense ones instead.
+     * @param floats Receives the float32 matrices, likewise.
+     * @return Name / matrix pairs, in file order.
+     * @throws WorkspaceFileCorrupt if the file cannot be opened or a sparse
+     *         entry is malformed.
+     * @throws WorkspaceFileBadValue for the first value (in file order) that
+     *         is missing or not a number.
+     * @throws MatrixInvalidInitialization / MatrixTooLarge / MatrixOutOfBounds
+     *         for bad dimensions or entry positions.
+     */
+    [[nodiscard]] std::vector<std::pair<std::string, Matrix>> readText(
+        const std::string& path, std::vector<std::pair<std::string, SparseMatrix>>* sparse = nullptr,
+        std::vector<std::pair<std::string, FloatMatrix>>* floats = nullptr);
+
+    /**
+     * @brief Write matrices to path in the binary format.
+     * @param path Target file (replaced if it exists).
+     * @param matrices Name / matrix pairs to store.
+     * @param sparse Name / sparse matrix pairs to store after them.
+     * @param floats Name / float32 matrix pairs to store last.
+     * @throws WorkspaceFileCorrupt if the file cannot be written.
+     */
+    void writeBinary(const std::string& path,
+                     const std::vector<std::pair<std::string, const Matrix*>>& matrices,
+                     const std::vector<std::pair<std::string, const SparseMatrix*>>& sparse = {},
+                     const std::vector<std::pair<std::string, const FloatMatrix*>>& floats = {});
+
+    /**
+     * @brief Read every matrix of a binary workspace file.
+     * @param path Source file.
+     * @param sparse Receives the sparse matrices, in file order. If null,
+     *        they are converted and returned with the dense ones instead.
+     * @param floats Receives the float32 matrices, likewise.
+     * @return Name / matrix pairs, in file order.
+     * @throws WorkspaceFileCorrupt if the file is truncated, malformed, of an
+     *         unsupported version, or was written with another byte order.
+     * @throws MatrixTooLarge if a stored matrix exceeds the element limit.
+     * @throws MatrixInvalidSparseStructure if stored CSR arrays are inconsistent.
+     */
+    [[nodiscard]] std::vector<std::pair<std::string, Matrix>> readBinary(
+        const std::string& path, std::vector<std::pair<std::string, SparseMatrix>>* sparse = nullptr,
+        std::vector<std::pair<std::string, FloatMatrix>>* floats = nullptr);
+}
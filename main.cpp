@@ -1,8 +1,134 @@
 #include "CLI.h"
+#include "ConcurrentWorkspace.h"
+#include "MatrixServer.h"
+#include "Profiler.h"
+#include <csignal>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
 
-int main() {
-    CLI cli;
-    cli.startCLI();
-    return 0;
+namespace {
+    /**
+     * @brief Runs the interactive session or, with a script, batch mode.
+     * @return The process exit status.
+     */
+    int run(const std::string& script, bool verbose, bool async) {
+        if (script.empty()) {
+            CLI cli;
+            cli.startCLI();
+            return 0;
+        }
 
-}
\ No newline at end of file
+        // Batch mode never mixes C and C++ streams, so skip their synchronization
+        std::ios::sync_with_stdio(false);
+        CLI cli;
+        if (script == "-")
+            return cli.runScript(std::cin, verbose, async);
+        std::ifstream file(script);
+        if (!file) {
+            std::cerr << "Could not open script '" << script << "'." << std::endl;
+            return 2;
+        }
+        return cli.runScript(file, verbose, async);
+    }
+
+    MatrixServer* activeServer = nullptr;
+
+    extern "C" void stopServer(int) {
+        if (activeServer) activeServer->stop();
+    }
+
+    /**
+     * @brief Serves a fresh workspace on [host:]port until SIGINT or SIGTERM.
+     * @return The process exit status.
+     */
+    int serve(const std::string& address, std::uint32_t maxRequestBytes) {
+        const std::size_t colon = address.rfind(':');
+        const std::string host = colon == std::string::npos ? "127.0.0.1" : address.substr(0, colon);
+        const std::string portText = colon == std::string::npos ? address : address.substr(colon + 1);
+        int port;
+        try {
+            std::size_t used = 0;
+            port = std::stoi(portText, &used);
+            if (used != portText.size() || port < 0 || port > 65535) throw std::out_of_range(portText);
+        } catch (const std::exception&) {
+            std::cerr << "Invalid port '" << portText << "'." << std::endl;
+            return 2;
+        }
+
+        ConcurrentWorkspace workspace;
+        MatrixServer server(workspace);
+        server.setMaxRequestBytes(maxRequestBytes);
+        try {
+            port = server.listen(host, port);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 2;
+        }
+        activeServer = &server;
+        std::signal(SIGINT, stopServer);
+        std::signal(SIGTERM, stopServer);
+        std::cerr << "Serving on " << host << ":" << port << "." << std::endl;
+        server.serve();
+        activeServer = nullptr;
+        return 0;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string script, trace, address;
+    bool verbose = false, async = false;
+    std::uint32_t maxRequestBytes = MatrixServer::DEFAULT_MAX_REQUEST;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--script" && i + 1 < argc) {
+            script = argv[++i];
+        } else if (arg == "--verbose") {
+            verbose = true;
+        } else if (arg == "--async") {
+            async = true;
+        } else if (arg == "--serve" && i + 1 < argc) {
+            address = argv[++i];
+        } else if (arg == "--max-request" && i + 1 < argc) {
+            // MiB, up to the protocol's limit
+            const std::string text = argv[++i];
+            std::size_t used = 0;
+            unsigned long mebibytes = 0;
+            try {
+                mebibytes = std::stoul(text, &used);
+            } catch (const std::exception&) {
+                used = 0;
+            }
+            if (used == 0 || used != text.size() || mebibytes == 0 ||
+                mebibytes > MatrixProtocol::MAX_PAYLOAD >> 20) {
+                std::cerr << "Invalid request limit '" << text << "' (MiB, 1 to "
+                          << (MatrixProtocol::MAX_PAYLOAD >> 20) << ")." << std::endl;
+                return 2;
+            }
+            maxRequestBytes = static_cast<std::uint32_t>(mebibytes << 20);
+        } else if (arg == "--trace" && i + 1 < argc && Profiler::compiledIn()) {
+            trace = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--script <file | -> [--verbose] [--async]] [--serve [host:]port [--max-request <MiB>]] [--trace <file>]" << std::endl;
+            return 2;
+        }
+    }
+
+    // --trace records the whole session as a Chrome trace
+    if (!trace.empty())
+        Profiler::startTrace();
+    const int status = address.empty() ? run(script, verbose, async) : serve(address, maxRequestBytes);
+    if (!trace.empty() && Profiler::isTracing()) {
+        try {
+            const std::size_t events = Profiler::writeTrace(trace);
+            std::cerr << "Trace of " << events << " events written to '" << trace << "'." << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << "Could not write trace: " << e.what() << "." << std::endl;
+            return 2;
+        }
+    }
+    return status;
+}
@@ -0,0 +1,207 @@
+#include "ConcurrentWorkspace.h"
+
+#include <algorithm>
+#include <mutex>
+#include <utility>
+
+namespace {
+    enum class LockMode : unsigned char { None, Shared, Exclusive };
+
+    /**
+     * Holds a set of shard locks, taken in ascending shard order and
+     * released in reverse when it goes out of scope.
+     */
+    class ShardLocks {
+    public:
+        template <std::size_t N>
+        ShardLocks(std::array<std::shared_mutex, N>& shards, const std::array<LockMode, N>& modes) {
+            for (std::size_t i = 0; i < N; ++i) {
+                if (modes[i] == LockMode::Exclusive) shards[i].lock();
+                else if (modes[i] == LockMode::Shared) shards[i].lock_shared();
+                else continue;
+                held.emplace_back(&shards[i], modes[i]);
+            }
+        }
+
+        ~ShardLocks() {
+            for (auto it = held.rbegin(); it != held.rend(); ++it) {
+                if (it->second == LockMode::Exclusive) it->first->unlock();
+                else it->first->unlock_shared();
+            }
+        }
+
+        ShardLocks(const ShardLocks&) = delete;
+        ShardLocks& operator=(const ShardLocks&) = delete;
+
+    private:
+        std::vector<std::pair<std::shared_mutex*, LockMode>> held;
+    };
+
+    /**
+     * The names in reads that are not also written.
+     */
+    std::vector<std::string> readOnly(std::vector<std::string> reads, const std::vector<std::string>& writes) {
+        reads.erase(std::remove_if(reads.begin(), reads.end(), [&writes](const std::string& name) {
+            return std::find(writes.begin(), writes.end(), name) != writes.end();
+        }), reads.end());
+        return reads;
+    }
+}
+
+ConcurrentWorkspace::ConcurrentWorkspace(Workspace&& workspace) : workspace(std::move(workspace)) {}
+
+std::size_t ConcurrentWorkspace::shardOf(const std::string& matName) {
+    return std::hash<std::string>{}(matName) % SHARDS;
+}
+
+bool ConcurrentWorkspace::execute(const std::vector<std::string>& reads, const std::vector<std::string>& writes,
+                                  const Operation& op, std::ostream& out) {
+    const std::vector<std::string> onlyRead = readOnly(reads, writes);
+    std::optional<bool> succeeded;
+    {
+        std::array<LockMode, SHARDS> modes{};
+        for (const std::string& name : onlyRead)
+            if (modes[shardOf(name)] == LockMode::None) modes[shardOf(name)] = LockMode::Shared;
+        for (const std::string& name : writes)
+            modes[shardOf(name)] = LockMode::Exclusive;
+        const ShardLocks locks(shards, modes);
+        succeeded = executeOnSnapshot(onlyRead, writes, op, out);
+    }
+    // Out-of-core matrices are worked on in place, which needs the whole workspace
+    return succeeded ? *succeeded : executeExclusive(op, out);
+}
+
+std::optional<bool> ConcurrentWorkspace::executeOnSnapshot(const std::vector<std::string>& reads,
+                                                           const std::vector<std::string>& writes,
+                                                           const Operation& op, std::ostream& out) {
+    std::vector<std::string> names = reads;
+    names.insert(names.end(), writes.begin(), writes.end());
+
+    Workspace scratch;
+    {
+        const std::shared_lock<std::shared_mutex> lock(structure);
+        if (!workspace.canSnapshot(names)) return std::nullopt;
+        scratch = workspace.snapshot(names);
+    }
+    scratch.setOutput(out);
+    const bool succeeded = op(scratch);
+    {
+        // A failed operation publishes nothing but what its reads cached
+        const std::unique_lock<std::shared_mutex> lock(structure);
+        workspace.merge(std::move(scratch), succeeded ? writes : std::vector<std::string>(), reads);
+    }
+    return succeeded;
+}
+
+bool ConcurrentWorkspace::executeExclusive(const Operation& op, std::ostream& out) {
+    std::array<LockMode, SHARDS> modes;
+    modes.fill(LockMode::Exclusive);
+    const ShardLocks locks(shards, modes);
+    const std::unique_lock<std::shared_mutex> lock(structure);
+
+    std::ostream& previous = workspace.output();
+    workspace.setOutput(out);
+    try {
+        const bool succeeded = op(workspace);
+        workspace.setOutput(previous);
+        return succeeded;
+    } catch (...) {
+        workspace.setOutput(previous);
+        throw;
+    }
+}
+
+std::optional<Workspace> ConcurrentWorkspace::snapshotAll() {
+    std::array<LockMode, SHARDS> modes;
+    modes.fill(LockMode::Shared);
+    const ShardLocks locks(shards, modes);
+    const std::shared_lock<std::shared_mutex> lock(structure);
+    const std::vector<std::string> names = workspace.getMatrixNames();
+    if (!workspace.canSnapshot(names)) return std::nullopt;
+    return workspace.snapshot(names);
+}
+
+size_t ConcurrentWorkspace::getMatrixCount() const {
+    const std::shared_lock<std::shared_mutex> lock(structure);
+    return workspace.getMatrixCount();
+}
+
+std::vector<std::string> ConcurrentWorkspace::getMatrixNames() const {
+    const std::shared_lock<std::shared_mutex> lock(structure);
+    return workspace.getMatrixNames();
+}
+
+bool ConcurrentWorkspace::showMatrix(const std::string& matName, std::ostream& out) {
+    return execute({matName}, {}, [&matName](Workspace& w) { return w.showMatrix(matName); }, out);
+}
+
+bool ConcurrentWorkspace::rankMatrix(const std::string& matName, std::ostream& out) {
+    return execute({matName}, {}, [&matName](Workspace& w) { return w.rankMatrix(matName); }, out);
+}
+
+bool ConcurrentWorkspace::determinantMatrix(const std::string& matName, std::ostream& out) {
+    return execute({matName}, {}, [&matName](Workspace& w) { return w.determinantMatrix(matName); }, out);
+}
+
+bool ConcurrentWorkspace::listMatrices(std::ostream& out) {
+    std::optional<Workspace> snapshot = snapshotAll();
+    if (!snapshot)
+        return executeExclusive([](Workspace& w) { return w.listMatrices(); }, out);
+    snapshot->setOutput(out);
+    return snapshot->listMatrices();
+}
+
+bool ConcurrentWorkspace::createMatrix(const std::string& matName, const int rows, const int cols,
+                                       const double initValue, std::ostream& out) {
+    return execute({}, {matName}, [&](Workspace& w) { return w.createMatrix(matName, rows, cols, initValue); }, out);
+}
+
+bool ConcurrentWorkspace::setElement(const std::string& matName, const int row, const int col, const double value,
+                                     std::ostream& out) {
+    return execute({}, {matName}, [&](Workspace& w) { return w.setElement(matName, row, col, value); }, out);
+}
+
+bool ConcurrentWorkspace::deleteMatrix(const std::string& matName, std::ostream& out) {
+    return execute({}, {matName}, [&matName](Workspace& w) { return w.deleteMatrix(matName); }, out);
+}
+
+bool ConcurrentWorkspace::addMatrices(const std::string& resultName, const std::string& mat1Name,
+                                      const std::string& mat2Name, std::ostream& out) {
+    return execute({mat1Name, mat2Name}, {resultName},
+                   [&](Workspace& w) { return w.addMatrices(resultName, mat1Name, mat2Name); }, out);
+}
+
+bool ConcurrentWorkspace::subtractMatrices(const std::string& resultName, const std::string& mat1Name,
+                                           const std::string& mat2Name, std::ostream& out) {
+    return execute({mat1Name, mat2Name}, {resultName},
+                   [&](Workspace& w) { return w.subtractMatrices(resultName, mat1Name, mat2Name); }, out);
+}
+
+bool ConcurrentWorkspace::multiplyMatrices(const std::string& resultName, const std::string& mat1Name,
+                                           const std::string& mat2Name, std::ostream& out) {
+    return execute({mat1Name, mat2Name}, {resultName},
+                   [&](Workspace& w) { return w.multiplyMatrices(resultName, mat1Name, mat2Name); }, out);
+}
+
+bool ConcurrentWorkspace::saveWorkspaceToFile(const std::string& filename, std::ostream& out) {
+    std::optional<Workspace> snapshot = snapshotAll();
+    if (!snapshot) // reports the matrices it skips
+        return executeExclusive([&filename](Workspace& w) { return w.saveWorkspaceToFile(filename); }, out);
+    // The file is written without holding any lock
+    snapshot->setOutput(out);
+    return snapshot->saveWorkspaceToFile(filename);
+}
+
+bool ConcurrentWorkspace::loadWorkspaceFromFile(const std::string& filename, std::ostream& out) {
+    Workspace loaded;
+    loaded.setOutput(out);
+    if (!loaded.loadWorkspaceFromFile(filename)) return false;
+
+    return executeExclusive([&loaded](Workspace& w) {
+        std::vector<std::string> names = w.getMatrixNames();
+        const std::vector<std::string> incoming = loaded.getMatrixNames();
+        names.insert(names.end(), incoming.begin(), incoming.end());
+        w.merge(std::move(loaded), names, {});
+        return true;
+    }, out);
+}
@@ -0,0 +1,119 @@
+#include "../include/FixedMatrix.h"
+#include <cmath>
+#include <type_traits>
+
+namespace {
+	/**
+	 * Sine and cosine of an angle given in degrees. Multiples of 90 degrees are
+	 * reduced exactly, so axis-aligned rotations produce exact 0/1/-1 entries
+	 * instead of values like cos(pi/2) = 6.1e-17.
+	 */
+	void sinCosDegrees(double angleDegrees, double& sine, double& cosine) {
+		const double reduced = std::fmod(angleDegrees, 360.0);
+		const double quarter = reduced / 90.0;
+		if (quarter == std::floor(quarter)) {
+			switch ((static_cast<int>(quarter) % 4 + 4) % 4) {
+				case 0: sine = 0.0;  cosine = 1.0;  return;
+				case 1: sine = 1.0;  cosine = 0.0;  return;
+				case 2: sine = 0.0;  cosine = -1.0; return;
+				default: sine = -1.0; cosine = 0.0; return;
+			}
+		}
+		const double angleRadians = reduced * M_PI / 180.0;
+		sine = std::sin(angleRadians);
+		cosine = std::cos(angleRadians);
+	}
+
+	/**
+	 * Call fn(std::integral_constant<int, N>) for the compile-time N equal to n,
+	 * one of the specialized sizes. Returns false (fn not called) for any other n.
+	 */
+	template <typename Fn>
+	bool withFixedSize(int n, Fn&& fn) {
+		switch (n) {
+			case 2: fn(std::integral_constant<int, 2>{}); return true;
+			case 3: fn(std::integral_constant<int, 3>{}); return true;
+			case 4: fn(std::integral_constant<int, 4>{}); return true;
+			case 8: fn(std::integral_constant<int, 8>{}); return true;
+			default: return false;
+		}
+	}
+
+	template <int Rows, int Cols>
+	FixedMatrix<Rows, Cols> load(const double* values) {
+		FixedMatrix<Rows, Cols> result;
+		std::copy(values, values + Rows * Cols, result.data());
+		return result;
+	}
+}
+
+namespace FixedKernels {
+
+	bool multiply(int m, int k, int n, const double* a, const double* b, double* c) {
+		if (m != k || (n != m && n != 1)) return false;
+		return withFixedSize(m, [&](auto size) {
+			constexpr int N = decltype(size)::value;
+			if (n == 1) multiply<N, N, 1>(a, b, c);
+			else multiply<N, N, N>(a, b, c);
+		});
+	}
+
+	bool determinant(int n, const double* a, double& det) {
+		return withFixedSize(n, [&](auto size) {
+			constexpr int N = decltype(size)::value;
+			det = FixedLU<N>(load<N, N>(a)).determinant();
+		});
+	}
+
+	bool inverse(int n, const double* a, double* inverse) {
+		return withFixedSize(n, [&](auto size) {
+			constexpr int N = decltype(size)::value;
+			const FixedMatrix<N, N> result = FixedLU<N>(load<N, N>(a)).inverse();
+			std::copy(result.data(), result.data() + N * N, inverse);
+		});
+	}
+
+	bool solve(int n, const double* a, const double* b, double* x) {
+		bool solved = false;
+		withFixedSize(n, [&](auto size) {
+			constexpr int N = decltype(size)::value;
+			const FixedLU<N> lu(load<N, N>(a));
+			if (lu.isSingular()) return;
+			const FixedMatrix<N, 1> result = lu.solve(load<N, 1>(b));
+			std::copy(result.data(), result.data() + N, x);
+			solved = true;
+		});
+		return solved;
+	}
+}
+
+namespace Rotation3D {
+
+	Mat3 aboutX(double angleDegrees) {
+		double s, c;
+		sinCosDegrees(angleDegrees, s, c);
+		return Mat3({1.0, 0.0, 0.0,
+		             0.0, c,   -s,
+		             0.0, s,   c});
+	}
+
+	Mat3 aboutY(double angleDegrees) {
+		double s, c;
+		sinCosDegrees(angleDegrees, s, c);
+		return Mat3({c,   0.0, s,
+		             0.0, 1.0, 0.0,
+		             -s,  0.0, c});
+	}
+
+	Mat3 aboutZ(double angleDegrees) {
+		double s, c;
+		sinCosDegrees(angleDegrees, s, c);
+		return Mat3({c,   -s,  0.0,
+		             s,   c,   0.0,
+		             0.0, 0.0, 1.0});
+	}
+
+	Mat3 fromAngles(double angleDegreesX, double angleDegreesY, double angleDegreesZ) {
+		return aboutZ(angleDegreesZ) * aboutY(angleDegreesY) * aboutX(angleDegreesX);
+	}
+}
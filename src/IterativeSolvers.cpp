@@ -0,0 +1,476 @@
+#include "../include/IterativeSolvers.h"
+#include "../include/MatrixException.h"
+#include "../include/Parallel.h"
+#include "../include/Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace {
+	using Vector = std::vector<double>;
+
+	// ==== Matrix-vector products, split by rows across the pool ====
+
+	void multiply(const Matrix& A, const double* x, double* y) {
+		const int rows = A.getRows(), cols = A.getCols();
+		const double* a = A.data();
+		Parallel::parallelFor(0, rows, Parallel::minChunkFor(cols), [&](int r0, int r1) {
+			for (int r = r0; r < r1; ++r) {
+				const double* row = a + static_cast<std::size_t>(r) * cols;
+				double sum = 0.0;
+				for (int c = 0; c < cols; ++c)
+					sum += row[c] * x[c];
+				y[r] = sum;
+			}
+		});
+	}
+
+	void multiply(const SparseMatrix& A, const double* x, double* y) {
+		const std::vector<std::size_t>& rowStart = A.rowStart();
+		const std::vector<int>& colIndex = A.colIndex();
+		const std::vector<double>& values = A.values();
+		const int rows = A.getRows();
+		const long long perRow = static_cast<long long>(A.nonZeros()) / rows + 1;
+		Parallel::parallelFor(0, rows, Parallel::minChunkFor(perRow), [&](int r0, int r1) {
+			for (int r = r0; r < r1; ++r) {
+				double sum = 0.0;
+				for (std::size_t p = rowStart[r]; p < rowStart[r + 1]; ++p)
+					sum += values[p] * x[colIndex[p]];
+				y[r] = sum;
+			}
+		});
+	}
+
+	template <typename MatrixType>
+	void multiply(const MatrixType& A, const Vector& x, Vector& y) {
+		multiply(A, x.data(), y.data());
+	}
+
+	// ==== Vector helpers ====
+
+	double dot(const Vector& a, const Vector& b) {
+		double sum = 0.0;
+		for (std::size_t i = 0; i < a.size(); ++i)
+			sum += a[i] * b[i];
+		return sum;
+	}
+
+	double norm(const Vector& a) {
+		return std::sqrt(dot(a, a));
+	}
+
+	/**
+	 * y += alpha * x
+	 */
+	void axpy(double alpha, const Vector& x, Vector& y) {
+		for (std::size_t i = 0; i < y.size(); ++i)
+			y[i] += alpha * x[i];
+	}
+
+	// ==== Preconditioners ====
+
+	/**
+	 * Applies z = M⁻¹ r for the chosen preconditioner M of A.
+	 */
+	class Preconditioner {
+	public:
+		Preconditioner(PreconditionerType type, const Matrix& A) : _type(type) {
+			if (type == PreconditionerType::ILU0) {
+				factorILU0(SparseMatrix(A));
+			} else if (type == PreconditionerType::Jacobi) {
+				_inverseDiagonal.resize(A.getRows());
+				for (int i = 0; i < A.getRows(); ++i)
+					_inverseDiagonal[i] = invertPivot(A(i, i));
+			}
+		}
+
+		Preconditioner(PreconditionerType type, const SparseMatrix& A) : _type(type) {
+			if (type == PreconditionerType::ILU0) {
+				factorILU0(A);
+			} else if (type == PreconditionerType::Jacobi) {
+				_inverseDiagonal.resize(A.getRows());
+				for (int i = 0; i < A.getRows(); ++i)
+					_inverseDiagonal[i] = invertPivot(A(i, i));
+			}
+		}
+
+		void apply(const Vector& r, Vector& z) const {
+			switch (_type) {
+				case PreconditionerType::None:
+					z = r;
+					return;
+				case PreconditionerType::Jacobi:
+					for (std::size_t i = 0; i < r.size(); ++i)
+						z[i] = r[i] * _inverseDiagonal[i];
+					return;
+				case PreconditionerType::ILU0:
+					applyILU0(r, z);
+					return;
+			}
+		}
+
+	private:
+		PreconditionerType _type;
+		Vector _inverseDiagonal;             // Jacobi
+		std::vector<std::size_t> _rowStart;  // ILU(0): L (unit diagonal) and U packed in A's pattern
+		std::vector<int> _colIndex;
+		Vector _values;
+		std::vector<std::size_t> _diagonal;  // offset of each row's diagonal entry
+
+		static double invertPivot(double pivot) {
+			if (pivot == 0.0) throw MatrixSingular();
+			return 1.0 / pivot;
+		}
+
+		void factorILU0(const SparseMatrix& A) {
+			const int n = A.getRows();
+			_rowStart = A.rowStart();
+			_colIndex = A.colIndex();
+			_values = A.values();
+			_diagonal.resize(n);
+			for (int i = 0; i < n; ++i) {
+				const auto first = _colIndex.begin() + static_cast<std::ptrdiff_t>(_rowStart[i]);
+				const auto last = _colIndex.begin() + static_cast<std::ptrdiff_t>(_rowStart[i + 1]);
+				const auto it = std::lower_bound(first, last, i);
+				if (it == last || *it != i) throw MatrixSingular();
+				_diagonal[i] = static_cast<std::size_t>(it - _colIndex.begin());
+			}
+
+			// IKJ elimination restricted to the existing entries: position[c]
+			// is the offset of row i's entry in column c, if it has one.
+			constexpr std::size_t NONE = static_cast<std::size_t>(-1);
+			std::vector<std::size_t> position(n, NONE);
+			for (int i = 0; i < n; ++i) {
+				for (std::size_t p = _rowStart[i]; p < _rowStart[i + 1]; ++p)
+					position[_colIndex[p]] = p;
+
+				for (std::size_t p = _rowStart[i]; p < _diagonal[i]; ++p) {
+					const int k = _colIndex[p];
+					_values[p] /= _values[_diagonal[k]];
+					for (std::size_t q = _diagonal[k] + 1; q < _rowStart[k + 1]; ++q) {
+						const std::size_t target = position[_colIndex[q]];
+						if (target != NONE)
+							_values[target] -= _values[p] * _values[q];
+					}
+				}
+				if (_values[_diagonal[i]] == 0.0) throw MatrixSingular();
+
+				for (std::size_t p = _rowStart[i]; p < _rowStart[i + 1]; ++p)
+					position[_colIndex[p]] = NONE;
+			}
+		}
+
+		void applyILU0(const Vector& r, Vector& z) const {
+			const int n = static_cast<int>(r.size());
+			for (int i = 0; i < n; ++i) {
+				double sum = r[i];
+				for (std::size_t p = _rowStart[i]; p < _diagonal[i]; ++p)
+					sum -= _values[p] * z[_colIndex[p]];
+				z[i] = sum;
+			}
+			for (int i = n - 1; i >= 0; --i) {
+				double sum = z[i];
+				for (std::size_t p = _diagonal[i] + 1; p < _rowStart[i + 1]; ++p)
+					sum -= _values[p] * z[_colIndex[p]];
+				z[i] = sum / _values[_diagonal[i]];
+			}
+		}
+	};
+
+	// ==== Shared set-up and result ====
+
+	template <typename MatrixType>
+	Vector checkedRightHandSide(const MatrixType& A, const Matrix& b) {
+		if (A.getRows() != A.getCols())
+			throw MatrixNotSquare();
+		if (b.getRows() != A.getRows() || b.getCols() != 1)
+			throw MatrixDimensionMismatch(A.getRows(), A.getCols(), b.getRows(), b.getCols());
+		return Vector(b.data(), b.data() + b.getRows());
+	}
+
+	/**
+	 * Package x with its true relative residual; it counts as converged only
+	 * if that residual meets the tolerance.
+	 */
+	template <typename MatrixType>
+	SolveResult finish(const MatrixType& A, const Vector& b, const Vector& x,
+	                   int iterations, const SolverOptions& options) {
+		Vector r(b.size());
+		multiply(A, x, r);
+		for (std::size_t i = 0; i < r.size(); ++i)
+			r[i] = b[i] - r[i];
+		const double bNorm = norm(b);
+		const double residual = bNorm == 0.0 ? norm(r) : norm(r) / bNorm;
+
+		if (!(residual <= options.tolerance))
+			return { SolveStatus::NotConverged, Matrix(), iterations, residual };
+		Matrix solution(static_cast<int>(x.size()), 1);
+		std::copy(x.begin(), x.end(), solution.data());
+		return { SolveStatus::Unique, std::move(solution), iterations, residual };
+	}
+
+	// ==== Solvers ====
+
+	template <typename MatrixType>
+	SolveResult conjugateGradientImpl(const MatrixType& A, const Matrix& bMatrix, const SolverOptions& options) {
+		const Vector b = checkedRightHandSide(A, bMatrix);
+		const Preconditioner M(options.preconditioner, A);
+		const std::size_t n = b.size();
+		const double target = options.tolerance * norm(b);
+
+		Vector x(n, 0.0), r = b, z(n), p(n), Ap(n);
+		M.apply(r, z);
+		p = z;
+		double rz = dot(r, z);
+
+		int iterations = 0;
+		while (iterations < options.maxIterations && norm(r) > target) {
+			multiply(A, p, Ap);
+			const double pAp = dot(p, Ap);
+			if (!(pAp > 0.0)) break; // A is not positive definite along p
+			const double alpha = rz / pAp;
+			axpy(alpha, p, x);
+			axpy(-alpha, Ap, r);
+			++iterations;
+
+			M.apply(r, z);
+			const double rzNext = dot(r, z);
+			const double beta = rzNext / rz;
+			rz = rzNext;
+			for (std::size_t i = 0; i < n; ++i)
+				p[i] = z[i] + beta * p[i];
+		}
+		return finish(A, b, x, iterations, options);
+	}
+
+	template <typename MatrixType>
+	SolveResult bicgstabImpl(const MatrixType& A, const Matrix& bMatrix, const SolverOptions& options) {
+		const Vector b = checkedRightHandSide(A, bMatrix);
+		const Preconditioner M(options.preconditioner, A);
+		const std::size_t n = b.size();
+		const double target = options.tolerance * norm(b);
+
+		Vector x(n, 0.0), r = b, rHat = b, p(n, 0.0), v(n, 0.0);
+		Vector pHat(n), s(n), sHat(n), t(n);
+		double rho = 1.0, alpha = 1.0, omega = 1.0;
+
+		int iterations = 0;
+		while (iterations < options.maxIterations && norm(r) > target) {
+			++iterations;
+			const double rhoNext = dot(rHat, r);
+			if (rhoNext == 0.0) break; // breakdown: r is orthogonal to the shadow residual
+			const double beta = (rhoNext / rho) * (alpha / omega);
+			rho = rhoNext;
+			for (std::size_t i = 0; i < n; ++i)
+				p[i] = r[i] + beta * (p[i] - omega * v[i]);
+
+			M.apply(p, pHat);
+			multiply(A, pHat, v);
+			const double rHatV = dot(rHat, v);
+			if (rHatV == 0.0) break;
+			alpha = rho / rHatV;
+			for (std::size_t i = 0; i < n; ++i)
+				s[i] = r[i] - alpha * v[i];
+
+			if (norm(s) <= target) {
+				axpy(alpha, pHat, x);
+				r = s;
+				break;
+			}
+
+			M.apply(s, sHat);
+			multiply(A, sHat, t);
+			const double tt = dot(t, t);
+			omega = tt == 0.0 ? 0.0 : dot(t, s) / tt;
+			for (std::size_t i = 0; i < n; ++i) {
+				x[i] += alpha * pHat[i] + omega * sHat[i];
+				r[i] = s[i] - omega * t[i];
+			}
+			if (omega == 0.0) break; // stagnation: the stabilizing step made no progress
+		}
+		return finish(A, b, x, iterations, options);
+	}
+
+	template <typename MatrixType>
+	SolveResult gmresImpl(const MatrixType& A, const Matrix& bMatrix, const SolverOptions& options) {
+		const Vector b = checkedRightHandSide(A, bMatrix);
+		const Preconditioner M(options.preconditioner, A);
+		const std::size_t n = b.size();
+		const int m = std::max(1, std::min(options.restart, static_cast<int>(n)));
+		const double target = options.tolerance * norm(b);
+
+		Vector x(n, 0.0), r(n), w(n), z(n);
+		std::vector<Vector> V(m + 1, Vector(n));           // orthonormal Krylov basis
+		Vector H(static_cast<std::size_t>(m + 1) * m);     // Hessenberg matrix, row-major (m + 1) x m
+		Vector cs(m), sn(m), g(m + 1), y(m);                // Givens rotations, rotated residual, coefficients
+		auto h = [&H, m](int i, int j) -> double& { return H[static_cast<std::size_t>(i) * m + j]; };
+
+		int iterations = 0;
+		while (iterations < options.maxIterations) {
+			multiply(A, x, w);
+			for (std::size_t i = 0; i < n; ++i)
+				r[i] = b[i] - w[i];
+			const double beta = norm(r);
+			if (beta <= target) break;
+			for (std::size_t i = 0; i < n; ++i)
+				V[0][i] = r[i] / beta;
+			std::fill(g.begin(), g.end(), 0.0);
+			g[0] = beta;
+
+			int k = 0;
+			while (k < m && iterations < options.maxIterations) {
+				M.apply(V[k], z);
+				multiply(A, z, w);
+				++iterations;
+
+				// Modified Gram-Schmidt against the basis so far
+				for (int i = 0; i <= k; ++i) {
+					h(i, k) = dot(w, V[i]);
+					axpy(-h(i, k), V[i], w);
+				}
+				const double next = norm(w);
+				h(k + 1, k) = next;
+
+				// Keep H upper triangular: apply the previous rotations, then a new one
+				for (int i = 0; i < k; ++i) {
+					const double upper = cs[i] * h(i, k) + sn[i] * h(i + 1, k);
+					h(i + 1, k) = -sn[i] * h(i, k) + cs[i] * h(i + 1, k);
+					h(i, k) = upper;
+				}
+				const double d = std::hypot(h(k, k), next);
+				cs[k] = d == 0.0 ? 1.0 : h(k, k) / d;
+				sn[k] = d == 0.0 ? 0.0 : next / d;
+				h(k, k) = d;
+				h(k + 1, k) = 0.0;
+				g[k + 1] = -sn[k] * g[k];
+				g[k] = cs[k] * g[k];
+				++k;
+
+				if (std::abs(g[k]) <= target || next == 0.0) break; // converged, or the space is exhausted
+				for (std::size_t i = 0; i < n; ++i)
+					V[k][i] = w[i] / next;
+			}
+
+			// Minimize over the subspace: solve the triangular system H y = g
+			for (int i = k - 1; i >= 0; --i) {
+				double sum = g[i];
+				for (int j = i + 1; j < k; ++j)
+					sum -= h(i, j) * y[j];
+				y[i] = h(i, i) == 0.0 ? 0.0 : sum / h(i, i);
+			}
+			std::fill(w.begin(), w.end(), 0.0);
+			for (int j = 0; j < k; ++j)
+				axpy(y[j], V[j], w);
+			M.apply(w, z);
+			axpy(1.0, z, x);
+
+			if (std::abs(g[k]) <= target) break;
+		}
+		return finish(A, b, x, iterations, options);
+	}
+
+	template <typename MatrixType>
+	SolveResult solveImpl(const MatrixType& A, const Matrix& b, const SolverOptions& options) {
+		MATRIX_PROFILE("IterativeSolvers::solve");
+		switch (options.method) {
+			case SolverMethod::ConjugateGradient: return conjugateGradientImpl(A, b, options);
+			case SolverMethod::GMRES:             return gmresImpl(A, b, options);
+			case SolverMethod::BiCGSTAB:          return bicgstabImpl(A, b, options);
+			default:                              break;
+		}
+		if constexpr (std::is_same_v<MatrixType, SparseMatrix>)
+			return A.toDense().solve(b);
+		else
+			return A.solve(b);
+	}
+}
+
+std::string SolverOptions::describe() const {
+	if (method == SolverMethod::Direct) return "direct";
+	std::ostringstream out;
+	out << IterativeSolvers::methodName(method) << " (";
+	if (preconditioner == PreconditionerType::None)
+		out << "no";
+	else
+		out << IterativeSolvers::preconditionerName(preconditioner);
+	out << " preconditioner, tolerance "
+	    << tolerance << ", at most " << maxIterations << " iterations)";
+	return out.str();
+}
+
+namespace IterativeSolvers {
+
+	std::string methodName(SolverMethod method) {
+		switch (method) {
+			case SolverMethod::ConjugateGradient: return "cg";
+			case SolverMethod::GMRES:             return "gmres";
+			case SolverMethod::BiCGSTAB:          return "bicgstab";
+			default:                              return "direct";
+		}
+	}
+
+	std::string preconditionerName(PreconditionerType preconditioner) {
+		switch (preconditioner) {
+			case PreconditionerType::Jacobi: return "jacobi";
+			case PreconditionerType::ILU0:   return "ilu0";
+			default:                         return "none";
+		}
+	}
+
+	bool parseMethod(const std::string& name, SolverMethod& method) {
+		for (SolverMethod candidate : {SolverMethod::Direct, SolverMethod::ConjugateGradient,
+		                               SolverMethod::GMRES, SolverMethod::BiCGSTAB}) {
+			if (methodName(candidate) == name) {
+				method = candidate;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool parsePreconditioner(const std::string& name, PreconditionerType& preconditioner) {
+		for (PreconditionerType candidate : {PreconditionerType::None, PreconditionerType::Jacobi,
+		                                     PreconditionerType::ILU0}) {
+			if (preconditionerName(candidate) == name) {
+				preconditioner = candidate;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	SolveResult conjugateGradient(const Matrix& A, const Matrix& b, const SolverOptions& options) {
+		return conjugateGradientImpl(A, b, options);
+	}
+
+	SolveResult conjugateGradient(const SparseMatrix& A, const Matrix& b, const SolverOptions& options) {
+		return conjugateGradientImpl(A, b, options);
+	}
+
+	SolveResult gmres(const Matrix& A, const Matrix& b, const SolverOptions& options) {
+		return gmresImpl(A, b, options);
+	}
+
+	SolveResult gmres(const SparseMatrix& A, const Matrix& b, const SolverOptions& options) {
+		return gmresImpl(A, b, options);
+	}
+
+	SolveResult bicgstab(const Matrix& A, const Matrix& b, const SolverOptions& options) {
+		return bicgstabImpl(A, b, options);
+	}
+
+	SolveResult bicgstab(const SparseMatrix& A, const Matrix& b, const SolverOptions& options) {
+		return bicgstabImpl(A, b, options);
+	}
+
+	SolveResult solve(const Matrix& A, const Matrix& b, const SolverOptions& options) {
+		return solveImpl(A, b, options);
+	}
+
+	SolveResult solve(const SparseMatrix& A, const Matrix& b, const SolverOptions& options) {
+		return solveImpl(A, b, options);
+	}
+}
@@ -0,0 +1,259 @@
+#include "../include/LUDecomposition.h"
+#include "../include/MatrixException.h"
+#include "../include/MatrixKernels.h"
+#include "../include/Parallel.h"
+#include "../include/Profiler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	constexpr int PANEL_WIDTH = 128;         // columns factored per panel, rows per solve block
+	constexpr int BLOCKED_MIN_SIZE = 128;    // below this a single panel is faster
+	constexpr int SOLVE_COLS_PER_TASK = 256; // triangular-solve columns per worker, at least
+}
+
+LUDecomposition::LUDecomposition(const Matrix& matrix)
+	:_lu(matrix), _pivots(), _swapCount(0), _singular(false), _updates(), _updateRatio(1.0) {
+	MATRIX_PROFILE_WORK("LUDecomposition::factor", 2.0 / 3.0 * matrix.getRows() * matrix.getRows() * matrix.getRows());
+	if (matrix.getRows() != matrix.getCols())
+		throw MatrixNotSquare();
+	_lu.detach(); // factored in place: stop sharing the input's elements
+
+	const int n = _lu.getRows();
+	_pivots.resize(n);
+	for (int i = 0; i < n; ++i) _pivots[i] = i;
+
+	if (n < BLOCKED_MIN_SIZE) {
+		factorPanel(0, n);
+		return;
+	}
+
+	// Right-looking blocked LU. For every panel of PANEL_WIDTH columns:
+	//   1. factor the tall panel A[k:n, k:k+nb] with partial pivoting,
+	//   2. solve U12 = L11^-1 A12 for the block row to its right,
+	//   3. update the trailing matrix A22 -= L21 * U12 with GEMM.
+	// Step 3 carries almost all of the O(n³) work; gemm splits it across the
+	// thread pool itself. Step 2 is split by column blocks.
+	for (int k = 0; k < n; k += PANEL_WIDTH) {
+		const int nb = std::min(PANEL_WIDTH, n - k);
+		const int next = k + nb;
+		factorPanel(k, nb);
+		if (next >= n) break;
+
+		Parallel::parallelFor(next, n, SOLVE_COLS_PER_TASK, [&](int c0, int c1) {
+			for (int i = k + 1; i < next; ++i) {
+				const double* l = _lu.rowPtr(i);
+				double* row = _lu.rowPtr(i) + c0;
+				for (int p = k; p < i; ++p)
+					MatrixKernels::axpy(c1 - c0, -l[p], _lu.rowPtr(p) + c0, row);
+			}
+		});
+
+		MatrixKernels::gemm(n - next, n - next, nb,
+		                    -1.0, _lu.rowPtr(next) + k, n,
+		                    _lu.rowPtr(k) + next, n,
+		                    1.0, _lu.rowPtr(next) + next, n);
+	}
+}
+
+void LUDecomposition::factorPanel(int first, int width) {
+	const int n = _lu.getRows();
+	const int last = first + width;
+
+	for (int i = first; i < last; ++i) {
+		// partial pivoting
+		double maxEl = std::abs(_lu.at(i, i));
+		int maxRow = i;
+		for (int k = i + 1; k < n; ++k) {
+			double v = std::abs(_lu.at(k, i));
+			if (v > maxEl) { maxEl = v; maxRow = k; }
+		}
+
+		// A (near-)zero pivot makes the matrix singular. Skip the column,
+		// exactly like Matrix::forwardElimination does, so the determinant
+		// still comes out as the product of the diagonal. Nothing is
+		// eliminated, so this column of L is zero.
+		if (maxEl < Matrix::EPSILON) {
+			_singular = true;
+			for (int k = i + 1; k < n; ++k) _lu.at(k, i) = 0.0;
+			continue;
+		}
+
+		// Whole rows are swapped, so the multipliers already stored to the
+		// left and the not yet updated columns to the right follow along.
+		if (maxRow != i) {
+			_lu.swapRows(i, maxRow);
+			std::swap(_pivots[i], _pivots[maxRow]);
+			_swapCount++;
+		}
+
+		// Eliminate below the pivot inside the panel, storing the multipliers
+		// in place of the eliminated entries (they form the strict lower
+		// triangle of L).
+		const double* pivotRow = _lu.rowPtr(i);
+		for (int k = i + 1; k < n; ++k) {
+			double* row = _lu.rowPtr(k);
+			double c = -row[i] / pivotRow[i];
+			MatrixKernels::axpy(last - i - 1, c, pivotRow + i + 1, row + i + 1);
+			row[i] = -c;
+		}
+	}
+}
+
+int LUDecomposition::size() const {
+	return _lu.getRows();
+}
+
+bool LUDecomposition::isSingular() const {
+	return _singular;
+}
+
+double LUDecomposition::determinant() const {
+	const int n = size();
+	double det = 1.0;
+	for (int i = 0; i < n; i++) {
+		det *= _lu.at(i, i);
+	}
+	det *= _updateRatio; // determinant lemma; exactly 1 without updates
+	if (std::abs(det) < Matrix::EPSILON) // consider as zero
+		det = 0.0; // Avoid negative zero
+
+	// Adjust sign for row swaps
+	if (_swapCount % 2 != 0)
+		det = det != 0.0 ? -det : 0.0; // Avoid negative zero
+
+	return det;
+}
+
+void LUDecomposition::substitute(Matrix& x) const {
+	const int n = size();
+	const int ldx = x.getCols();
+
+	// Columns of x are independent right-hand sides, so blocks of them are
+	// solved concurrently (this is what makes inverse() parallel). Within a
+	// column block the triangular solves are blocked by PANEL_WIDTH rows:
+	// the contribution of all previously solved rows is applied with one
+	// GEMM, leaving only a small triangle to substitute row by row.
+	Parallel::parallelFor(0, x.getCols(), SOLVE_COLS_PER_TASK, [&](int c0, int c1) {
+		const int cols = c1 - c0;
+		double* xc = x.rowPtr(0) + c0;
+
+		// Forward substitution with the unit lower triangle: Ly = Pb
+		for (int b = 0; b < n; b += PANEL_WIDTH) {
+			const int e = std::min(b + PANEL_WIDTH, n);
+			MatrixKernels::gemm(e - b, cols, b,
+			                    -1.0, _lu.rowPtr(b), n,
+			                    xc, ldx,
+			                    1.0, xc + static_cast<size_t>(b) * ldx, ldx);
+			for (int i = b + 1; i < e; ++i) {
+				const double* l = _lu.rowPtr(i);
+				double* row = x.rowPtr(i) + c0;
+				for (int k = b; k < i; ++k)
+					MatrixKernels::axpy(cols, -l[k], x.rowPtr(k) + c0, row);
+			}
+		}
+
+		// Back substitution with the upper triangle: Ux = y
+		for (int e = n; e > 0; e -= PANEL_WIDTH) {
+			const int b = std::max(e - PANEL_WIDTH, 0);
+			MatrixKernels::gemm(e - b, cols, n - e,
+			                    -1.0, _lu.rowPtr(b) + e, n,
+			                    xc + static_cast<size_t>(e) * ldx, ldx,
+			                    1.0, xc + static_cast<size_t>(b) * ldx, ldx);
+			for (int i = e - 1; i >= b; --i) {
+				const double* u = _lu.rowPtr(i);
+				double* row = x.rowPtr(i) + c0;
+				for (int k = i + 1; k < e; ++k)
+					MatrixKernels::axpy(cols, -u[k], x.rowPtr(k) + c0, row);
+				for (int j = 0; j < cols; ++j)
+					row[j] /= u[i];
+			}
+		}
+	});
+}
+
+Matrix LUDecomposition::solve(const Matrix& b) const {
+	MATRIX_PROFILE_WORK("LUDecomposition::solve", 2.0 * size() * size() * b.getCols());
+	const int n = size();
+	if (b.getRows() != n)
+		throw MatrixDimensionMismatch(n, n, b.getRows(), b.getCols());
+	if (_singular)
+		throw MatrixSingular();
+
+	// Apply the row permutation to b
+	Matrix x(n, b.getCols());
+	for (int i = 0; i < n; ++i) {
+		const double* src = b.rowPtr(_pivots[i]);
+		std::copy(src, src + b.getCols(), x.rowPtr(i));
+	}
+	substitute(x);
+	applyUpdates(x);
+	return x;
+}
+
+Matrix LUDecomposition::inverse() const {
+	MATRIX_PROFILE_WORK("LUDecomposition::inverse", 2.0 * size() * size() * size());
+	if (_singular)
+		throw MatrixSingular();
+
+	// Solve A X = I: the permuted identity has a single 1 per row
+	const int n = size();
+	Matrix x(n, n, 0.0);
+	for (int i = 0; i < n; ++i)
+		x.at(i, _pivots[i]) = 1.0;
+	substitute(x);
+	applyUpdates(x);
+	return x;
+}
+
+void LUDecomposition::applyUpdates(Matrix& x) const {
+	const int n = size();
+	const int cols = x.getCols();
+	std::vector<double> s(cols);
+	// Sherman-Morrison, one change at a time starting with the oldest:
+	// (A + u vᵀ)⁻¹ b = A⁻¹ b - w (vᵀ A⁻¹ b) / (1 + vᵀ w), with w = A⁻¹ u
+	for (const RankOneUpdate& update : _updates) {
+		std::fill(s.begin(), s.end(), 0.0);
+		for (int i = 0; i < n; ++i)
+			if (update.v[i] != 0.0)
+				MatrixKernels::axpy(cols, update.v[i], x.rowPtr(i), s.data());
+		for (int i = 0; i < n; ++i)
+			if (update.w[i] != 0.0)
+				MatrixKernels::axpy(cols, -update.w[i] / update.ratio, s.data(), x.rowPtr(i));
+	}
+}
+
+bool LUDecomposition::update(const Matrix& u, const Matrix& v) {
+	MATRIX_PROFILE_WORK("LUDecomposition::update", 2.0 * size() * size());
+	const int n = size();
+	if (u.getRows() != n || u.getCols() != 1)
+		throw MatrixDimensionMismatch(n, 1, u.getRows(), u.getCols());
+	if (v.getRows() != n || v.getCols() != 1)
+		throw MatrixDimensionMismatch(n, 1, v.getRows(), v.getCols());
+	const auto isZero = [n](const Matrix& vector) {
+		for (int i = 0; i < n; ++i)
+			if (vector.at(i, 0) != 0.0) return false;
+		return true;
+	};
+	if (isZero(u) || isZero(v))
+		return true; // nothing changes
+	if (_singular || static_cast<int>(_updates.size()) >= MAX_UPDATES)
+		return false;
+
+	// w = A⁻¹ u for A including the earlier changes
+	const Matrix w = solve(u);
+	double ratio = 1.0;
+	for (int i = 0; i < n; ++i)
+		ratio += v.at(i, 0) * w.at(i, 0);
+	if (std::abs(ratio) < UPDATE_TOLERANCE)
+		return false;
+
+	_updates.push_back({ std::vector<double>(w.data(), w.data() + n),
+	                     std::vector<double>(v.data(), v.data() + n), ratio });
+	_updateRatio *= ratio;
+	return true;
+}
+
+int LUDecomposition::updateCount() const {
+	return static_cast<int>(_updates.size());
+}
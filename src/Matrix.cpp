@@ -1,63 +1,152 @@
 #include "../include/Matrix.h"
+#include "../include/FixedMatrix.h"
 #include "../include/MatrixException.h"
+#include "../include/MatrixKernels.h"
+#include "../include/LUDecomposition.h"
+#include "../include/QRDecomposition.h"
+#include "../include/Parallel.h"
+#include "../include/Profiler.h"
 #include <iomanip>
+#include <cmath>
+#include <algorithm>
+#include <utility>
+#include <functional>
+#include <type_traits>
+#include <new>
+#include <unistd.h>
+
+namespace {
+	/**
+	 * Apply one elimination step, body(first, last), to rows [begin, end),
+	 * spreading the rows across the thread pool when the step is large
+	 * enough. Every row is updated independently, so the result does not
+	 * depend on how the rows are split.
+	 */
+	void updateRows(int begin, int end, int rowLength, const std::function<void(int, int)>& body) {
+		Parallel::parallelFor(begin, end, Parallel::minChunkFor(rowLength), body);
+	}
 
-int Matrix::index(int row, int col) const {
+	/**
+	 * Bytes of physical memory, or 0 where the system does not say. An
+	 * allocation beyond it would only be paged to death or killed, so it is
+	 * refused up front rather than left to the allocator.
+	 */
+	unsigned long long physicalMemory() {
+		const long pages = sysconf(_SC_PHYS_PAGES);
+		const long pageSize = sysconf(_SC_PAGESIZE);
+		return pages > 0 && pageSize > 0 ? static_cast<unsigned long long>(pages) * pageSize : 0;
+	}
+}
+
+template <typename T>
+std::size_t BasicMatrix<T>::index(int row, int col) const {
 	if (row < 0 || row >= _rows || col < 0 || col >= _cols) {
 		throw MatrixOutOfBounds(_rows, _cols);
 	}
-	return row * _cols + col;
+	return static_cast<std::size_t>(row) * _cols + col;
+}
+
+template <typename T>
+const std::shared_ptr<typename BasicMatrix<T>::Storage>& BasicMatrix<T>::emptyStorage() {
+	static const std::shared_ptr<Storage> empty = std::make_shared<Storage>();
+	return empty;
+}
+
+template <typename T>
+void BasicMatrix<T>::detach() {
+	if (_storage.use_count() > 1)
+		_storage = std::make_shared<Storage>(*_storage);
 }
 
-Matrix::Matrix(int rows, int cols, double initValue)
+template <typename T>
+BasicMatrix<T>::BasicMatrix(int rows, int cols, T initValue)
 	:_rows(rows), _cols(cols){
 	if (rows <= 0 || cols <= 0) {
 		throw MatrixInvalidInitialization();
 	}
 
-	if (rows * cols >= MATRIX_LIMIT_ERROR )
+	// 64-bit product: rows * cols may exceed INT_MAX
+	const long long elements = static_cast<long long>(rows) * cols;
+	if (elements >= MATRIX_LIMIT_ERROR )
 		throw MatrixTooLarge();
 
-	if (rows * cols >= MATRIX_LIMIT_WARNING )
+	const unsigned long long bytes = static_cast<unsigned long long>(elements) * sizeof(T);
+	static const unsigned long long memory = physicalMemory();
+	if (memory != 0 && bytes > memory)
+		throw MatrixExceedsMemory(bytes);
+
+	if (elements >= MATRIX_LIMIT_WARNING )
 		std::cerr << "Warning: large matrix may slow down performance.\n";
-	_matrix.resize(rows * cols, initValue);
+	try {
+		_storage = std::make_shared<Storage>(static_cast<std::size_t>(elements), initValue);
+	} catch (const std::bad_alloc&) {
+		throw MatrixExceedsMemory(bytes);
+	}
 }
 
-Matrix& Matrix::operator=(const Matrix& other) {
+template <typename T>
+BasicMatrix<T>::BasicMatrix(BasicMatrix<T>&& other) noexcept
+	:_storage(std::exchange(other._storage, emptyStorage())), _rows(other._rows), _cols(other._cols) {
+	other._rows = 0;
+	other._cols = 0;
+}
+
+template <typename T>
+BasicMatrix<T>& BasicMatrix<T>::operator=(const BasicMatrix<T>& other) {
 	if (this != &other) {
 		_rows = other._rows;
 		_cols = other._cols;
-		_matrix = other._matrix;
+		_storage = other._storage;
 	}
 	return *this;
 }
-bool Matrix::operator==(const Matrix& other) const {
-	if (_rows != other._rows || _cols != other._cols || _matrix != other._matrix){
-		return false;
+
+template <typename T>
+BasicMatrix<T>& BasicMatrix<T>::operator=(BasicMatrix<T>&& other) noexcept {
+	if (this != &other) {
+		_rows = other._rows;
+		_cols = other._cols;
+		_storage = std::exchange(other._storage, emptyStorage());
+		other._rows = 0;
+		other._cols = 0;
 	}
-	return true;
+	return *this;
+}
+template <typename T>
+bool BasicMatrix<T>::operator==(const BasicMatrix<T>& other) const {
+	if (_rows != other._rows || _cols != other._cols)
+		return false;
+	// Copies that still share their elements are equal without comparing them
+	return _storage == other._storage || *_storage == *other._storage;
 }
 
-bool Matrix::operator!=(const Matrix& other) const {
+template <typename T>
+bool BasicMatrix<T>::operator!=(const BasicMatrix<T>& other) const {
 	return !(*this == other);
 }
 
-const double& Matrix::operator()(int row, int column) const {
-	return _matrix[index(row, column)];
+template <typename T>
+const T& BasicMatrix<T>::operator()(int row, int column) const {
+	return (*_storage)[index(row, column)];
 }
 
-double& Matrix::operator()(int row, int column) {
-	return _matrix[index(row, column)];
+template <typename T>
+T& BasicMatrix<T>::operator()(int row, int column) {
+	const std::size_t i = index(row, column);
+	detach();
+	return (*_storage)[i];
 }
 
-std::ostream& operator<<(std::ostream& os, const Matrix& matrix) {
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const BasicMatrix<T>& matrix) {
 	os << std::fixed << std::setprecision(3);
 	const int width = 7;
 
 	for (int row = 0; row < matrix._rows; ++row) {
+		const T* values = matrix.rowPtr(row);
 		os << "|";
 		for (int col = 0; col < matrix._cols; ++col) {
-			os << std::setw(width) << matrix(row, col) << "|";
+			os << std::setw(width) << values[col] << "|";
 		}
 		os << '\n';
 	}
@@ -66,112 +155,166 @@ std::ostream& operator<<(std::ostream& os, const Matrix& matrix) {
 }
 
 
-Matrix& Matrix::operator-=(const Matrix& other){
+template <typename T>
+BasicMatrix<T>& BasicMatrix<T>::operator-=(const BasicMatrix<T>& other){
+	MATRIX_PROFILE_WORK("Matrix::subtract", _storage->size());
 	if (_rows != other._rows || _cols != other._cols) {
 		throw MatrixDimensionMismatch(_rows, _cols, other._rows, other._cols);
 	}
-	for (size_t i = 0; i < _matrix.size(); ++i)
-		_matrix[i] -= other._matrix[i];
+	detach();
+	const T* src = other._storage->data();
+	T* dst = _storage->data();
+	forEachSlice([=](std::size_t first, std::size_t count) {
+		MatrixKernels::subtract(count, src + first, dst + first);
+	});
 	return *this;
 }
 
-Matrix Matrix::operator-(const Matrix& other) const {
-	Matrix result(*this);
-	result -= other;
-	return result;
-}
-
-Matrix& Matrix::operator+=(const Matrix& other){
+template <typename T>
+BasicMatrix<T>& BasicMatrix<T>::operator+=(const BasicMatrix<T>& other){
+	MATRIX_PROFILE_WORK("Matrix::add", _storage->size());
 	if (_rows != other._rows || _cols != other._cols) {
 		throw MatrixDimensionMismatch(_rows, _cols, other._rows, other._cols);
 	}
-	for (size_t i = 0; i < _matrix.size(); ++i)
-		_matrix[i] += other._matrix[i];
+	detach();
+	const T* src = other._storage->data();
+	T* dst = _storage->data();
+	forEachSlice([=](std::size_t first, std::size_t count) {
+		MatrixKernels::add(count, src + first, dst + first);
+	});
 	return *this;
 }
 
-Matrix Matrix::operator*(const double& scalar) const {
-	Matrix result(*this);
-	result *= scalar;
-	return result;
+template <typename T>
+BasicMatrix<T> operator+(BasicMatrix<T>&& lhs, BasicMatrix<T>&& rhs) {
+	lhs += rhs;
+	return std::move(lhs);
 }
 
-Matrix Matrix::operator+(const Matrix& other) const {
-	Matrix result(*this);
-	result += other;
-	return result;
+template <typename T>
+BasicMatrix<T> operator*(BasicMatrix<T>&& matrix, double scalar) {
+	matrix *= scalar;
+	return std::move(matrix);
 }
 
-Matrix operator*(const double& scalar, const Matrix& matrix) {
-	Matrix result = matrix * scalar;
-	return result;
+template <typename T>
+BasicMatrix<T> operator*(double scalar, BasicMatrix<T>&& matrix) {
+	matrix *= scalar;
+	return std::move(matrix);
 }
 
-Matrix& Matrix::operator*=(const double& scalar) {
-	for (auto& val : _matrix)
-		val *= scalar;
+template <typename T>
+BasicMatrix<T>& BasicMatrix<T>::operator*=(const T& scalar) {
+	MATRIX_PROFILE_WORK("Matrix::scale", _storage->size());
+	const T alpha = scalar;
+	detach();
+	T* dst = _storage->data();
+	forEachSlice([=](std::size_t first, std::size_t count) {
+		MatrixKernels::scale(count, alpha, dst + first);
+	});
+	return *this;
+}
+
+template <typename T>
+BasicMatrix<T>& BasicMatrix<T>::axpy(T alpha, const BasicMatrix<T>& other) {
+	MATRIX_PROFILE_WORK("Matrix::axpy", 2.0 * _storage->size());
+	if (_rows != other._rows || _cols != other._cols) {
+		throw MatrixDimensionMismatch(_rows, _cols, other._rows, other._cols);
+	}
+	detach();
+	const T* src = other._storage->data();
+	T* dst = _storage->data();
+	forEachSlice([=](std::size_t first, std::size_t count) {
+		MatrixKernels::axpy(count, alpha, src + first, dst + first);
+	});
 	return *this;
 }
 
-Matrix Matrix::operator-() const{
-	Matrix result = *this;
-	return -1 * result;
+template <typename T>
+BasicMatrix<T> operator-(BasicMatrix<T>&& matrix) {
+	matrix *= T(-1);
+	return std::move(matrix);
 }
 
-Matrix Matrix::transpose() const{
-	Matrix result(_cols, _rows);
-	for (int row = 0; row < _rows; row++) {
-		for (int col = 0; col < _cols; col++) {
-			result(col, row) = (*this)(row, col);
-		}
-	}
+template <typename T>
+void BasicMatrix<T>::forEachSlice(const std::function<void(std::size_t, std::size_t)>& body) const {
+	const std::size_t size = _storage->size();
+	const std::size_t slices = (size + SLICE_SIZE - 1) / SLICE_SIZE;
+	Parallel::parallelFor(0, static_cast<int>(slices), Parallel::minChunkFor(SLICE_SIZE), [&](int s0, int s1) {
+		const std::size_t first = static_cast<std::size_t>(s0) * SLICE_SIZE;
+		const std::size_t last = std::min(static_cast<std::size_t>(s1) * SLICE_SIZE, size);
+		body(first, last - first);
+	});
+}
+
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::transpose() const{
+	MATRIX_PROFILE("Matrix::transpose");
+	BasicMatrix result(_cols, _rows);
+	MatrixKernels::transpose(_rows, _cols, _storage->data(), _cols, result._storage->data(), _rows);
 	return result;
 }
 
-Matrix Matrix::operator*(const Matrix& other) const {
+template <typename T>
+BasicMatrix<T>& BasicMatrix<T>::transposeInPlace() {
+	MATRIX_PROFILE("Matrix::transposeInPlace");
+	detach();
+	MatrixKernels::transposeInPlace(_rows, _cols, _storage->data());
+	std::swap(_rows, _cols);
+	return *this;
+}
+
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::operator*(const BasicMatrix<T>& other) const {
+	MATRIX_PROFILE_WORK("Matrix::multiply", 2.0 * _rows * _cols * other._cols);
 	if (_cols != other._rows) {
 		throw MatrixDimensionMismatch(_rows, _cols, other._rows, other._cols);
 	}
-	Matrix result(_rows, other._cols, 0.0);
-	for (int row = 0; row < _rows; row++) {
-		for (int col = 0; col < other._cols; col++) {
-			double sum = 0.0;
-			for (int k = 0; k < _cols; k++) {
-				sum += (*this)(row, k) * other(k, col);
-			}
-			result(row, col) = sum;
-		}
+	BasicMatrix result(_rows, other._cols, T(0));
+	if constexpr (std::is_same_v<T, double>) {
+		// Small square products (and matrix-vector products) have unrolled kernels
+		if (FixedKernels::multiply(_rows, _cols, other._cols, _storage->data(),
+		                           other._storage->data(), result._storage->data()))
+			return result;
 	}
+	MatrixKernels::gemm(_rows, other._cols, _cols,
+	                    T(1), _storage->data(), _cols,
+	                    other._storage->data(), other._cols,
+	                    T(0), result._storage->data(), result._cols);
 	return result;
 }
 
-Matrix& Matrix::operator*=(const Matrix& other) {
-	*this = Matrix(*this * other);
+template <typename T>
+BasicMatrix<T>& BasicMatrix<T>::operator*=(const BasicMatrix<T>& other) {
+	*this = *this * other;
 	return *this;
 }
 
-int Matrix::getRows() const {
+template <typename T>
+int BasicMatrix<T>::getRows() const {
 	return _rows;
 }
 
-int Matrix::getCols() const {
+template <typename T>
+int BasicMatrix<T>::getCols() const {
 	return _cols;
 }
 
-void Matrix::swapRows(int row1, int row2) {
+template <typename T>
+void BasicMatrix<T>::swapRows(int row1, int row2) {
 	if (row1 == row2) return;
-	int cols = getCols();
-	for (int j = 0; j < cols; j++) {
-		std::swap((*this)(row1, j), (*this)(row2, j));
-	}
+	T* first = rowPtr(row1);
+	std::swap_ranges(first, first + _cols, rowPtr(row2));
 }
 
 
-Matrix Matrix::gaussianElimination(Matrix* right, bool fullReduction, int* swapCount) const {
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::gaussianElimination(BasicMatrix<T>* right, bool fullReduction, int* swapCount) const {
+	MATRIX_PROFILE("Matrix::gaussianElimination");
 	bool throwOnZeroPivot = (right != nullptr) || fullReduction;
 
 	// Perform forward elimination and count swaps
-	Matrix result = this->forwardElimination(right, throwOnZeroPivot, swapCount);
+	BasicMatrix result = this->forwardElimination(right, throwOnZeroPivot, swapCount);
 
 	if (!fullReduction) {
 		// Return the upper-triangular
@@ -179,66 +322,76 @@ Matrix Matrix::gaussianElimination(Matrix* right, bool fullReduction, int* swapC
 	}
 
 	// Full reduction (: normalize pivot rows and eliminate above
+	// (result and *right were detached by forwardElimination)
 	const int n = result.getRows();
 	const int m = result.getCols();
 	const int rCols = right ? right->getCols() : 0;
 
 	for (int i = 0; i < n; ++i) {
+		T* pivotRow = result.rowPtr(i);
+		T* pivotRight = right ? right->rowPtr(i) : nullptr;
+
 		// Find pivot column in this row
 		int pivotCol = -1;
 		for (int j = 0; j < m; ++j) {
-			if (std::abs(result(i, j)) > EPSILON) { pivotCol = j; break; }
+			if (std::abs(pivotRow[j]) > EPSILON) { pivotCol = j; break; }
 		}
 		if (pivotCol == -1) continue; // zero row
 
-		double pivot = result(i, pivotCol);
+		T pivot = pivotRow[pivotCol];
 		// Normalize pivot row
 		for (int j = pivotCol; j < m; ++j)
-			result(i, j) /= pivot;
+			pivotRow[j] /= pivot;
 
 		if (right) {
 			for (int j = 0; j < rCols; ++j)
-				(*right)(i, j) /= pivot;
+				pivotRight[j] /= pivot;
 		}
 
 		// Eliminate other rows using this pivot
-		for (int k = 0; k < n; ++k) {
-			if (k == i) continue;
-			double c = result(k, pivotCol);
-			if (std::abs(c) < EPSILON) continue;
+		updateRows(0, n, m - pivotCol + rCols, [&](int first, int last) {
+			for (int k = first; k < last; ++k) {
+				if (k == i) continue;
+				T* row = result.rowPtr(k);
+				T c = row[pivotCol];
+				if (std::abs(c) < EPSILON) continue;
 
-			for (int j = pivotCol; j < m; ++j)
-				result(k, j) -= c * result(i, j);
+				MatrixKernels::axpy(m - pivotCol, -c, pivotRow + pivotCol, row + pivotCol);
 
-			if (right) {
-				for (int j = 0; j < rCols; ++j)
-					(*right)(k, j) -= c * (*right)(i, j);
+				if (right)
+					MatrixKernels::axpy(rCols, -c, pivotRight, right->rowPtr(k));
 			}
-		}
+		});
 	}
 
 	return result;
 }
 
 
-Matrix Matrix::forwardElimination(Matrix* right, bool throwOnZeroPivot, int* swapCount) const {
-	Matrix result(*this);
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::forwardElimination(BasicMatrix<T>* right, bool throwOnZeroPivot, int* swapCount) const {
+	MATRIX_PROFILE("Matrix::forwardElimination");
+	BasicMatrix result(*this);
+	result.detach();
+	if (right) right->detach();
 	const int n = result.getRows();
 	const int m = result.getCols();
 	int localSwapCount = 0;
 	int lim = std::min(n, m);
 
+	const int rCols = right ? right->getCols() : 0;
+
 	for (int i = 0; i < lim; ++i) {
 		// partial pivoting
-		double maxEl = std::abs(result(i, i));
+		T maxEl = std::abs(result.at(i, i));
 		int maxRow = i;
 		for (int k = i + 1; k < n; ++k) {
-			double v = std::abs(result(k, i));
+			T v = std::abs(result.at(k, i));
 			if (v > maxEl) { maxEl = v; maxRow = k; }
 		}
 
 		// Handle near-zero pivot
-		if (std::abs(result(maxRow, i)) < EPSILON) {
+		if (std::abs(result.at(maxRow, i)) < EPSILON) {
 			if (throwOnZeroPivot)
 				throw MatrixSingular();
 			// Skip this column/pivot; continue to next column
@@ -254,12 +407,17 @@ Matrix Matrix::forwardElimination(Matrix* right, bool throwOnZeroPivot, int* swa
 		}
 
 		// Eliminate below pivot
-		for (int k = i + 1; k < n; ++k) {
-			double c = -result(k, i) / result(i, i);
-			for (int j = i; j < m; ++j) result(k, j) += c * result(i, j);
-			if (right) for (int j = 0; j < right->getCols(); ++j)
-				(*right)(k, j) += c * (*right)(i, j);
-		}
+		const T* pivotRow = result.rowPtr(i);
+		const T* pivotRight = right ? right->rowPtr(i) : nullptr;
+		updateRows(i + 1, n, m - i + rCols, [&](int first, int last) {
+			for (int k = first; k < last; ++k) {
+				T* row = result.rowPtr(k);
+				T c = -row[i] / pivotRow[i];
+				MatrixKernels::axpy(m - i, c, pivotRow + i, row + i);
+				if (right)
+					MatrixKernels::axpy(rCols, c, pivotRight, right->rowPtr(k));
+			}
+		});
 	}
 
 	if (swapCount) *swapCount = localSwapCount;
@@ -267,165 +425,212 @@ Matrix Matrix::forwardElimination(Matrix* right, bool throwOnZeroPivot, int* swa
 }
 
 
-double Matrix::determinant() const {
+template <typename T>
+double BasicMatrix<T>::determinant() const {
+	MATRIX_PROFILE("Matrix::determinant");
 	if (_rows != _cols)
 		throw MatrixNotSquare();
 
-	int swapCount = 0;
-	Matrix result = gaussianElimination(NOT_SOLVE, NO_REDUCTION, &swapCount);
-
-	double det = 1.0;
-	for (int i = 0; i < _rows; i++) {
-		det *= result(i, i);
+	if constexpr (std::is_same_v<T, double>) {
+		double det;
+		if (FixedKernels::determinant(_rows, _storage->data(), det))
+			return det;
 	}
-	if (std::abs(det) < EPSILON) // consider as zero
-		det = 0.0; // Avoid negative zero
-
-	// Adjust sign for row swaps
-	if (swapCount % 2 != 0)
-		det =  det != 0.0 ? -det : 0.0; // Avoid negative zero
 
-	return det;
+	// LU with partial pivoting is the forward elimination pass; det(A) is
+	// the signed product of U's diagonal.
+	return LUDecomposition(*this).determinant();
 }
 
 
-int Matrix::rank() const {
-
-	Matrix echelon = this->forwardElimination(NOT_SOLVE, false, NO_DET);
-	const int rows = echelon.getRows();
-	const int cols = echelon.getCols();
-
-	// Count non-zero rows
-	int nonZeroRows = 0;
-	for (int i = 0; i < rows; ++i) {
-		for (int j = 0; j < cols; ++j) {
-			if (std::abs(echelon(i, j)) > EPSILON) { ++nonZeroRows; break; }
-		}
-	}
-
-	// Count non-zero columns
-	int nonZeroCols = 0;
-	for (int j = 0; j < cols; ++j) {
-		for (int i = 0; i < rows; ++i) {
-			if (std::abs(echelon(i, j)) > EPSILON) { ++nonZeroCols; break; }
-		}
-	}
-
-	// return the minimum of non-zero rows and columns
-	return std::min(nonZeroRows, nonZeroCols);
+template <typename T>
+int BasicMatrix<T>::rank() const {
+	MATRIX_PROFILE("Matrix::rank");
+	// Pivoted QR: the rank is where R's diagonal drops below a tolerance
+	// relative to the largest column norm
+	return QRDecomposition(Matrix(*this)).rank();
 }
 
-Matrix Matrix::inverse() const {
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::inverse() const {
+	MATRIX_PROFILE("Matrix::inverse");
 	if (_rows != _cols)
 		throw MatrixNotSquare();
 
-	// Build augmented matrix [A | I]
-	Matrix augmented = this->augment(Matrix::identity(_rows));
-
-	// Perform full reduction on the augmented matrix. This will throw
-	// MatrixSingular if the matrix is not invertible.
-	Matrix reduced = augmented.gaussianElimination(NOT_SOLVE, FULL_REDUCTION, NO_DET);
-
-	// Extract right half as the inverse
-	Matrix inv(_rows, _cols);
-	for (int i = 0; i < _rows; ++i) {
-		for (int j = 0; j < _cols; ++j) {
-			inv(i, j) = reduced(i, _cols + j);
+	if constexpr (std::is_same_v<T, double>) {
+		if (FixedKernels::isSpecialized(_rows)) {
+			BasicMatrix result(_rows, _cols);
+			FixedKernels::inverse(_rows, _storage->data(), result._storage->data());
+			return result;
 		}
 	}
 
-	return inv;
+	// Solve A X = I from the LU factors. This will throw MatrixSingular if
+	// the matrix is not invertible.
+	return LUDecomposition(*this).inverse();
 }
 
-Matrix Matrix::identity(int size) {
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::identity(int size) {
 	if (size <= 0) {
 		throw MatrixInvalidInitialization();
 	}
-	Matrix result(size, size, 0.0);
+	BasicMatrix result(size, size, T(0));
 	for (int i = 0; i < size; i++) {
-		result(i, i) = 1.0;
+		result.at(i, i) = T(1);
 	}
 	return result;
 }
 
-Matrix Matrix::augment(const Matrix& right) const {
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::augment(const BasicMatrix<T>& right) const {
 	if (_rows != right.getRows())
 		throw MatrixDimensionMismatch(_rows, _cols, right.getRows(), right.getCols());
 
-	Matrix result(_rows, _cols + right.getCols());
+	BasicMatrix result(_rows, _cols + right.getCols());
 	for (int i = 0; i < _rows; i++) {
-		for (int j = 0; j < _cols; j++)
-			result(i, j) = (*this)(i, j);
-		for (int j = 0; j < right.getCols(); j++)
-			result(i, _cols + j) = right(i, j);
+		const T* left = rowPtr(i);
+		const T* extra = right.rowPtr(i);
+		T* out = result.rowPtr(i);
+		std::copy(left, left + _cols, out);
+		std::copy(extra, extra + right.getCols(), out + _cols);
 	}
 	return result;
 }
 
-SolveResult Matrix::solve(const Matrix& b) const {
+namespace {
+	/**
+	 * ||b - Ax|| / ||b|| (or ||Ax|| when b is zero).
+	 */
+	double relativeResidual(const Matrix& A, const Matrix& x, const Matrix& b) {
+		const Matrix r = b - A * x;
+		double rr = 0.0, bb = 0.0;
+		for (int i = 0; i < b.getRows(); ++i) {
+			rr += r(i, 0) * r(i, 0);
+			bb += b(i, 0) * b(i, 0);
+		}
+		return bb == 0.0 ? std::sqrt(rr) : std::sqrt(rr / bb);
+	}
+}
+
+template <typename T>
+SolveResult BasicMatrix<T>::solve(const BasicMatrix<T>& b) const {
+	MATRIX_PROFILE("Matrix::solve");
 	if (_rows != b.getRows() || b.getCols() != 1)
 		throw MatrixDimensionMismatch(_rows, _cols, b.getRows(), b.getCols());
 
-	// Compute rank of A and [A|b]
-	int rankA = this->rank();
+	// Square systems are the common case: a single LU factorization both
+	// detects singularity and produces the unique solution.
+	if (_rows == _cols) {
+		if constexpr (std::is_same_v<T, double>) {
+			if (FixedKernels::isSpecialized(_rows)) {
+				Matrix x(_rows, 1);
+				if (FixedKernels::solve(_rows, _storage->data(), b._storage->data(), x.data())) {
+					const double residual = relativeResidual(*this, x, b);
+					return { SolveStatus::Unique, std::move(x), 0, residual };
+				}
+				return QRDecomposition(*this).solve(b);
+			}
+		}
+		LUDecomposition lu(*this);
+		if (!lu.isSingular()) {
+			Matrix x = lu.solve(b);
+			const double residual = relativeResidual(*this, x, b);
+			return { SolveStatus::Unique, std::move(x), 0, residual };
+		}
+	}
 
-	// Build augmented matrix [A|b]
-	Matrix augmented = this->augment(b);
-	int rankAb = augmented.rank();
+	// Singular or rectangular: one pivoted QR classifies the system and,
+	// if it has a unique solution (also overdetermined), solves it
+	return QRDecomposition(*this).solve(b);
+}
 
-	// check for no solution or infinite solutions
-	if (rankAb > rankA)
-		return { SolveStatus::NoSolution, Matrix() };
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::XRotationMatrix(double angleDegrees) {
+	return Rotation3D::aboutX(angleDegrees).toMatrix();
+}
 
-	if (rankA < _cols)
-		return { SolveStatus::Infinite, Matrix() };
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::YRotationMatrix(double angleDegrees) {
+	return Rotation3D::aboutY(angleDegrees).toMatrix();
+}
 
-	// If reach here, rankA == rankAb == number of variables => unique solution
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::ZRotationMatrix(double angleDegrees) {
+	return Rotation3D::aboutZ(angleDegrees).toMatrix();
+}
 
-	Matrix right(b);
-	// Perform Gaussian elimination with full reduction to find solution
-	this->gaussianElimination(&right, FULL_REDUCTION, NO_DET);
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::createRotationMatrix(double angleDegreesX, double angleDegreesY, double angleDegreesZ){
+	return Rotation3D::fromAngles(angleDegreesX, angleDegreesY, angleDegreesZ).toMatrix();
+}
 
-	// right now holds x
-	return { SolveStatus::Unique, right };
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::rotate3D(double angleDegreesX, double angleDegreesY, double angleDegreesZ) const {
+	BasicMatrix rotated(*this);
+	rotated.rotate3DInPlace(Rotation3D::fromAngles(angleDegreesX, angleDegreesY, angleDegreesZ));
+	return rotated;
 }
 
-Matrix Matrix::XRotationMatrix(double angleDegrees) {
-	Matrix rotation(3,3);
-	double angleRadians = angleDegrees * M_PI / 180.0;
-	rotation(0,0) = 1; rotation(0,1) = 0;                     rotation(0,2) = 0;
-	rotation(1,0) = 0; rotation(1,1) = cos(angleRadians);     rotation(1,2) = -sin(angleRadians);
-	rotation(2,0) = 0; rotation(2,1) = sin(angleRadians);     rotation(2,2) = cos(angleRadians);
-	return rotation;
+template <typename T>
+void BasicMatrix<T>::rotate3DInPlace(const Mat3& rotation) {
+	MATRIX_PROFILE_WORK("Matrix::rotate3D", 15.0 * _cols);
+	if (_rows != 3)
+		throw MatrixDimensionMismatch(3, 3, _rows, _cols);
+
+	// The rows hold the x, y and z components of the column vectors
+	detach();
+	T* x = _storage->data();
+	T* y = x + _cols;
+	T* z = y + _cols;
+	T m[9];
+	for (int k = 0; k < 9; ++k)
+		m[k] = static_cast<T>(rotation.data()[k]);
+	Parallel::parallelFor(0, _cols, Parallel::minChunkFor(15), [&](int first, int last) {
+		if constexpr (std::is_same_v<T, double>) {
+			MatrixKernels::transform3(static_cast<std::size_t>(last - first), m,
+			                          x + first, y + first, z + first);
+		} else {
+			for (int j = first; j < last; ++j) {
+				const T vx = x[j], vy = y[j], vz = z[j];
+				x[j] = m[0] * vx + m[1] * vy + m[2] * vz;
+				y[j] = m[3] * vx + m[4] * vy + m[5] * vz;
+				z[j] = m[6] * vx + m[7] * vy + m[8] * vz;
+			}
+		}
+	});
 }
 
-Matrix Matrix::YRotationMatrix(double angleDegrees) {
-	Matrix rotation(3,3);
-	double angleRadians = angleDegrees * M_PI / 180.0;
-	rotation(0,0) = cos(angleRadians);     rotation(0,1) = 0; rotation(0,2) = sin(angleRadians);
-	rotation(1,0) = 0;                     rotation(1,1) = 1; rotation(1,2) = 0;
-	rotation(2,0) = -sin(angleRadians);    rotation(2,1) = 0; rotation(2,2) = cos(angleRadians);
-	return rotation;
+// ==== Single precision ====
+// The LU factorization and the rank-based classification of solve() run in
+// double; a float matrix is promoted for them. The determinant and solution
+// are returned in double, the inverse is rounded back to float.
+
+template <>
+double BasicMatrix<float>::determinant() const {
+	return Matrix(*this).determinant();
 }
 
-Matrix Matrix::ZRotationMatrix(double angleDegrees) {
-	Matrix rotation(3,3);
-	double angleRadians = angleDegrees * M_PI / 180.0;
-	rotation(0,0) = cos(angleRadians);     rotation(0,1) = -sin(angleRadians);    rotation(0,2) = 0;
-	rotation(1,0) = sin(angleRadians);     rotation(1,1) = cos(angleRadians);     rotation(1,2) = 0;
-	rotation(2,0) = 0;                     rotation(2,1) = 0;                     rotation(2,2) = 1;
-	return rotation;
+template <>
+FloatMatrix BasicMatrix<float>::inverse() const {
+	return FloatMatrix(Matrix(*this).inverse());
 }
 
-Matrix Matrix::createRotationMatrix(double angleDegreesX, double angleDegreesY, double angleDegreesZ){
-	Matrix rotationX = XRotationMatrix(angleDegreesX);
-	Matrix rotationY = YRotationMatrix(angleDegreesY);
-	Matrix rotationZ = ZRotationMatrix(angleDegreesZ);
-	Matrix rotation = rotationZ * rotationY * rotationX;
-	return rotation;
+template <>
+SolveResult BasicMatrix<float>::solve(const FloatMatrix& b) const {
+	return Matrix(*this).solve(Matrix(b));
 }
 
-Matrix Matrix::rotate3D(double angleDegreesX, double angleDegreesY, double angleDegreesZ) const {
-	Matrix rotation = createRotationMatrix(angleDegreesX, angleDegreesY, angleDegreesZ);
-	return rotation * (*this);
-}
\ No newline at end of file
+template class BasicMatrix<double>;
+template class BasicMatrix<float>;
+
+template std::ostream& operator<<(std::ostream&, const Matrix&);
+template std::ostream& operator<<(std::ostream&, const FloatMatrix&);
+template Matrix operator+(Matrix&&, Matrix&&);
+template FloatMatrix operator+(FloatMatrix&&, FloatMatrix&&);
+template Matrix operator*(Matrix&&, double);
+template FloatMatrix operator*(FloatMatrix&&, double);
+template Matrix operator*(double, Matrix&&);
+template FloatMatrix operator*(double, FloatMatrix&&);
+template Matrix operator-(Matrix&&);
+template FloatMatrix operator-(FloatMatrix&&);
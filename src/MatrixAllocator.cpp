@@ -0,0 +1,145 @@
+#include "../include/MatrixAllocator.h"
+#include "../include/Profiler.h"
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+	using std::size_t;
+
+	constexpr size_t DEFAULT_CACHE_LIMIT = size_t(256) << 20; // 256 MiB
+
+	/**
+	 * Round a request up to its size class: a multiple of ALIGNMENT, and
+	 * above 256 bytes one of the four evenly spaced sizes in its power-of-two
+	 * range (e.g. 1024, 1280, 1536, 1792, 2048).
+	 */
+	size_t sizeClass(size_t bytes) {
+		constexpr size_t a = MatrixMemory::ALIGNMENT;
+		if (bytes <= 4 * a)
+			return bytes == 0 ? a : (bytes + a - 1) / a * a;
+		size_t power = 4 * a;
+		while (power * 2 < bytes)
+			power *= 2;
+		const size_t step = power / 4;
+		return (bytes + step - 1) / step * step;
+	}
+
+	void* systemAllocate(size_t bytes) {
+		return ::operator new(bytes, std::align_val_t(MatrixMemory::ALIGNMENT));
+	}
+
+	void systemFree(void* buffer) noexcept {
+		::operator delete(buffer, std::align_val_t(MatrixMemory::ALIGNMENT));
+	}
+
+	/**
+	 * Free lists keyed by size class, under one lock. Matrices allocate whole
+	 * buffers rather than individual elements, so contention is negligible.
+	 */
+	class Pool {
+	public:
+		void* allocate(size_t bytes) {
+			const size_t size = sizeClass(bytes);
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				++_stats.allocations;
+				auto it = _free.find(size);
+				if (it != _free.end() && !it->second.empty()) {
+					void* buffer = it->second.back();
+					it->second.pop_back();
+					_stats.cachedBytes -= size;
+					++_stats.reused;
+					return buffer;
+				}
+			}
+			return systemAllocate(size);
+		}
+
+		void deallocate(void* buffer, size_t bytes) noexcept {
+			if (buffer == nullptr) return;
+			const size_t size = sizeClass(bytes);
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				if (_stats.cachedBytes + size <= _stats.cacheLimit) {
+					try {
+						_free[size].push_back(buffer);
+						_stats.cachedBytes += size;
+						return;
+					} catch (...) {
+						// No room to record it: fall through and release it
+					}
+				}
+			}
+			systemFree(buffer);
+		}
+
+		MatrixMemory::Statistics statistics() {
+			std::lock_guard<std::mutex> lock(_mutex);
+			return _stats;
+		}
+
+		void setCacheLimit(size_t bytes) {
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stats.cacheLimit = bytes;
+			trimLocked(bytes);
+		}
+
+		void trim(size_t keepBytes) {
+			std::lock_guard<std::mutex> lock(_mutex);
+			trimLocked(keepBytes);
+		}
+
+	private:
+		std::mutex _mutex;
+		std::map<size_t, std::vector<void*>> _free;
+		MatrixMemory::Statistics _stats{0, 0, 0, DEFAULT_CACHE_LIMIT};
+
+		void trimLocked(size_t keepBytes) {
+			for (auto it = _free.rbegin(); it != _free.rend() && _stats.cachedBytes > keepBytes; ++it) {
+				std::vector<void*>& buffers = it->second;
+				while (!buffers.empty() && _stats.cachedBytes > keepBytes) {
+					systemFree(buffers.back());
+					buffers.pop_back();
+					_stats.cachedBytes -= it->first;
+				}
+			}
+		}
+	};
+
+	/**
+	 * The pool is never destroyed: matrices with static or thread storage
+	 * duration may still release their buffers during program exit.
+	 */
+	Pool& pool() {
+		static Pool* instance = new Pool();
+		return *instance;
+	}
+}
+
+namespace MatrixMemory {
+
+	void* allocate(size_t bytes) {
+#ifdef MATRIX_PROFILING
+		Profiler::threadAllocatedBytes += bytes;
+#endif
+		return pool().allocate(bytes);
+	}
+
+	void deallocate(void* buffer, size_t bytes) noexcept {
+		pool().deallocate(buffer, bytes);
+	}
+
+	Statistics statistics() {
+		return pool().statistics();
+	}
+
+	void setCacheLimit(size_t bytes) {
+		pool().setCacheLimit(bytes);
+	}
+
+	void trim(size_t keepBytes) {
+		pool().trim(keepBytes);
+	}
+}
@@ -0,0 +1,548 @@
+#include "../include/MatrixBatch.h"
+#include "../include/MatrixException.h"
+#include "../include/Parallel.h"
+#include "../include/Profiler.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define MATRIX_SIMD_X86 1
+#endif
+
+// As in SimdKernels.cpp, each kernel is built once per instruction set and
+// picked at run time. The kernels are written as plain loops over the
+// LANES matrices of a block; forcing them inline into the per-ISA wrappers
+// lets the compiler vectorize those loops for the wrapper's target.
+#if defined(MATRIX_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define MATRIX_TARGET(isa) __attribute__((target(isa)))
+#define MATRIX_RUNTIME_DISPATCH 1
+#endif
+#if defined(__GNUC__) || defined(__clang__)
+#define MATRIX_ALWAYS_INLINE __attribute__((always_inline)) inline
+#elif defined(_MSC_VER)
+#define MATRIX_ALWAYS_INLINE __forceinline
+#else
+#define MATRIX_ALWAYS_INLINE inline
+#endif
+
+namespace {
+
+	constexpr int L = MatrixBatch::LANES;
+	constexpr double EPS = ScalarTraits<double>::epsilon; // Matrix::EPSILON
+
+	/**
+	 * Lanes of element (i, j) of a block whose matrices have cols columns.
+	 */
+	MATRIX_ALWAYS_INLINE std::size_t lanes(int i, int j, int cols) {
+		return (static_cast<std::size_t>(i) * cols + j) * L;
+	}
+
+	/**
+	 * 1 / pivot, or 0 for a pivot LUDecomposition would treat as zero.
+	 */
+	MATRIX_ALWAYS_INLINE double reciprocalOrZero(double pivot) {
+		return std::abs(pivot) < EPS ? 0.0 : 1.0 / pivot;
+	}
+
+	// ==== Kernels on one block ====
+
+	/**
+	 * c = a * b lane by lane, for m x k by k x n matrices.
+	 */
+	MATRIX_ALWAYS_INLINE void multiplyBody(const double* a, const double* b, double* c, int m, int k, int n) {
+		for (int i = 0; i < m; ++i) {
+			for (int j = 0; j < n; ++j) {
+				alignas(64) double sum[L] = {};
+				for (int p = 0; p < k; ++p) {
+					const double* x = a + lanes(i, p, k);
+					const double* y = b + lanes(p, j, n);
+					for (int l = 0; l < L; ++l) sum[l] += x[l] * y[l];
+				}
+				std::copy(sum, sum + L, c + lanes(i, j, n));
+			}
+		}
+	}
+
+	/**
+	 * LU with partial pivoting of every n x n matrix of the block, in place.
+	 *
+	 * The pivot search and row swaps differ per matrix and are scalar; the
+	 * elimination, all but O(n²) of the work, runs on all lanes at once. A
+	 * column without a usable pivot is skipped (its multipliers are zero)
+	 * and its lane flagged singular.
+	 *
+	 * @param perm perm[i * L + l]: row of lane l's matrix now at row i.
+	 * @param sign sign[l]: determinant sign of lane l's row swaps.
+	 */
+	MATRIX_ALWAYS_INLINE void factorBody(double* lu, int* perm, double* sign, std::uint8_t* singular, int n) {
+		for (int l = 0; l < L; ++l) {
+			sign[l] = 1.0;
+			singular[l] = 0;
+			for (int i = 0; i < n; ++i) perm[i * L + l] = i;
+		}
+		for (int k = 0; k < n; ++k) {
+			alignas(64) double inverse[L];
+			for (int l = 0; l < L; ++l) {
+				int pivot = k;
+				double maxEl = std::abs(lu[lanes(k, k, n) + l]);
+				for (int i = k + 1; i < n; ++i) {
+					const double v = std::abs(lu[lanes(i, k, n) + l]);
+					if (v > maxEl) {
+						maxEl = v;
+						pivot = i;
+					}
+				}
+				if (maxEl < EPS) {
+					singular[l] = 1;
+					inverse[l] = 0.0;
+					continue;
+				}
+				if (pivot != k) {
+					for (int j = 0; j < n; ++j) std::swap(lu[lanes(k, j, n) + l], lu[lanes(pivot, j, n) + l]);
+					std::swap(perm[k * L + l], perm[pivot * L + l]);
+					sign[l] = -sign[l];
+				}
+				inverse[l] = 1.0 / lu[lanes(k, k, n) + l];
+			}
+
+			const double* pivotRow = lu + lanes(k, 0, n);
+			for (int i = k + 1; i < n; ++i) {
+				double* row = lu + lanes(i, 0, n);
+				alignas(64) double factor[L];
+				for (int l = 0; l < L; ++l) {
+					factor[l] = row[k * L + l] * inverse[l];
+					row[k * L + l] = factor[l];
+				}
+				for (int j = k + 1; j < n; ++j)
+					for (int l = 0; l < L; ++l) row[j * L + l] -= factor[l] * pivotRow[j * L + l];
+			}
+		}
+	}
+
+	/**
+	 * x := U⁻¹ L⁻¹ x lane by lane, from the packed factors of factorBody();
+	 * x is n x nrhs and already permuted.
+	 */
+	MATRIX_ALWAYS_INLINE void substituteBody(const double* lu, double* x, int n, int nrhs) {
+		for (int i = 1; i < n; ++i) {
+			double* row = x + lanes(i, 0, nrhs);
+			for (int p = 0; p < i; ++p) {
+				const double* factor = lu + lanes(i, p, n);
+				const double* source = x + lanes(p, 0, nrhs);
+				for (int j = 0; j < nrhs; ++j)
+					for (int l = 0; l < L; ++l) row[j * L + l] -= factor[l] * source[j * L + l];
+			}
+		}
+		for (int i = n - 1; i >= 0; --i) {
+			double* row = x + lanes(i, 0, nrhs);
+			for (int p = i + 1; p < n; ++p) {
+				const double* factor = lu + lanes(i, p, n);
+				const double* source = x + lanes(p, 0, nrhs);
+				for (int j = 0; j < nrhs; ++j)
+					for (int l = 0; l < L; ++l) row[j * L + l] -= factor[l] * source[j * L + l];
+			}
+			alignas(64) double inverse[L];
+			const double* diagonal = lu + lanes(i, i, n);
+			for (int l = 0; l < L; ++l) inverse[l] = reciprocalOrZero(diagonal[l]);
+			for (int j = 0; j < nrhs; ++j)
+				for (int l = 0; l < L; ++l) row[j * L + l] *= inverse[l];
+		}
+	}
+
+	/**
+	 * Table of block kernels for one instruction set.
+	 */
+	struct BatchKernels {
+		const char* name;
+		void (*multiply)(const double*, const double*, double*, int, int, int);
+		void (*factor)(double*, int*, double*, std::uint8_t*, int);
+		void (*substitute)(const double*, double*, int, int);
+	};
+
+	void multiplyBaseline(const double* a, const double* b, double* c, int m, int k, int n) {
+		multiplyBody(a, b, c, m, k, n);
+	}
+
+	void factorBaseline(double* lu, int* perm, double* sign, std::uint8_t* singular, int n) {
+		factorBody(lu, perm, sign, singular, n);
+	}
+
+	void substituteBaseline(const double* lu, double* x, int n, int nrhs) {
+		substituteBody(lu, x, n, nrhs);
+	}
+
+	constexpr BatchKernels BASELINE_KERNELS = { "baseline", multiplyBaseline, factorBaseline, substituteBaseline };
+
+#if defined(MATRIX_RUNTIME_DISPATCH)
+
+	MATRIX_TARGET("avx2,fma") void multiplyAvx2(const double* a, const double* b, double* c, int m, int k, int n) {
+		multiplyBody(a, b, c, m, k, n);
+	}
+
+	MATRIX_TARGET("avx2,fma") void factorAvx2(double* lu, int* perm, double* sign, std::uint8_t* singular, int n) {
+		factorBody(lu, perm, sign, singular, n);
+	}
+
+	MATRIX_TARGET("avx2,fma") void substituteAvx2(const double* lu, double* x, int n, int nrhs) {
+		substituteBody(lu, x, n, nrhs);
+	}
+
+	MATRIX_TARGET("avx512f") void multiplyAvx512(const double* a, const double* b, double* c, int m, int k, int n) {
+		multiplyBody(a, b, c, m, k, n);
+	}
+
+	MATRIX_TARGET("avx512f") void factorAvx512(double* lu, int* perm, double* sign, std::uint8_t* singular, int n) {
+		factorBody(lu, perm, sign, singular, n);
+	}
+
+	MATRIX_TARGET("avx512f") void substituteAvx512(const double* lu, double* x, int n, int nrhs) {
+		substituteBody(lu, x, n, nrhs);
+	}
+
+	constexpr BatchKernels AVX2_KERNELS = { "avx2", multiplyAvx2, factorAvx2, substituteAvx2 };
+	constexpr BatchKernels AVX512_KERNELS = { "avx512", multiplyAvx512, factorAvx512, substituteAvx512 };
+
+#endif
+
+	const BatchKernels& selectKernels() {
+#if defined(MATRIX_RUNTIME_DISPATCH)
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512f")) return AVX512_KERNELS;
+		if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return AVX2_KERNELS;
+#endif
+		return BASELINE_KERNELS;
+	}
+
+	const BatchKernels& kernels() {
+		static const BatchKernels& selected = selectKernels();
+		return selected;
+	}
+
+	// ==== Whole blocks ====
+
+	/**
+	 * Per-thread buffers for factoring one block.
+	 */
+	struct BlockScratch {
+		std::vector<double, PooledAllocator<double>> lu;
+		std::vector<int> perm;
+		double sign[L];
+		std::uint8_t singular[L];
+
+		explicit BlockScratch(int n) : lu(static_cast<std::size_t>(n) * n * L), perm(static_cast<std::size_t>(n) * L) {}
+	};
+
+	/**
+	 * Factor the n x n block a into scratch.
+	 */
+	void factorBlock(const BatchKernels& k, const double* a, int n, BlockScratch& scratch) {
+		std::copy(a, a + scratch.lu.size(), scratch.lu.begin());
+		k.factor(scratch.lu.data(), scratch.perm.data(), scratch.sign, scratch.singular, n);
+	}
+
+	/**
+	 * x = A⁻¹ b for the block factored into scratch (b null: the identity,
+	 * nrhs = n). Singular lanes of x are set to zero.
+	 */
+	void solveBlock(const BatchKernels& k, const BlockScratch& scratch, const double* b, double* x, int n, int nrhs) {
+		for (int i = 0; i < n; ++i) {
+			for (int l = 0; l < L; ++l) {
+				const int source = scratch.perm[i * L + l];
+				for (int j = 0; j < nrhs; ++j)
+					x[lanes(i, j, nrhs) + l] = b ? b[lanes(source, j, nrhs) + l] : (source == j ? 1.0 : 0.0);
+			}
+		}
+		k.substitute(scratch.lu.data(), x, n, nrhs);
+		for (int l = 0; l < L; ++l) {
+			if (!scratch.singular[l]) continue;
+			for (int e = 0; e < n * nrhs; ++e) x[static_cast<std::size_t>(e) * L + l] = 0.0;
+		}
+	}
+
+	/**
+	 * det of lane l of the block factored into scratch, as LUDecomposition::determinant().
+	 */
+	double laneDeterminant(const BlockScratch& scratch, int n, int l) {
+		if (scratch.singular[l]) return 0.0;
+		double det = scratch.sign[l];
+		for (int i = 0; i < n; ++i) det *= scratch.lu[lanes(i, i, n) + l];
+		return std::abs(det) < EPS ? 0.0 : det;
+	}
+
+	/**
+	 * Run body(firstBlock, lastBlock) over the blocks on the thread pool,
+	 * given the multiply-adds per block.
+	 */
+	void forEachBlock(int blocks, long long workPerBlock, const std::function<void(int, int)>& body) {
+		Parallel::parallelFor(0, blocks, Parallel::minChunkFor(workPerBlock), body);
+	}
+
+	void requireSquare(const MatrixBatch& batch) {
+		if (batch.rows() != batch.cols())
+			throw MatrixNotSquare();
+	}
+
+	// ==== Strided arrays ====
+
+	void checkStrided(int count, int rows, int cols, std::ptrdiff_t stride) {
+		if (count < 0 || rows <= 0 || cols <= 0 || stride < static_cast<std::ptrdiff_t>(rows) * cols)
+			throw MatrixInvalidInitialization();
+	}
+
+	/**
+	 * Interleave the matrices of block b from a strided array; lanes past
+	 * count get the identity (square) or zero.
+	 */
+	void packBlock(const double* data, std::ptrdiff_t stride, int count, int b, int rows, int cols, double* block) {
+		for (int l = 0; l < L; ++l) {
+			const int index = b * L + l;
+			const double* source = index < count ? data + index * stride : nullptr;
+			for (int i = 0; i < rows; ++i)
+				for (int j = 0; j < cols; ++j)
+					block[lanes(i, j, cols) + l] = source ? source[i * cols + j] : (rows == cols && i == j ? 1.0 : 0.0);
+		}
+	}
+
+	void unpackBlock(const double* block, int count, int b, int rows, int cols, double* data, std::ptrdiff_t stride) {
+		for (int l = 0; l < L && b * L + l < count; ++l) {
+			double* target = data + (b * L + l) * stride;
+			for (int i = 0; i < rows; ++i)
+				for (int j = 0; j < cols; ++j)
+					target[i * cols + j] = block[lanes(i, j, cols) + l];
+		}
+	}
+
+	using Block = std::vector<double, PooledAllocator<double>>;
+
+	Block blockBuffer(int rows, int cols) {
+		return Block(static_cast<std::size_t>(rows) * cols * L);
+	}
+}
+
+// ==== MatrixBatch ====
+
+MatrixBatch::MatrixBatch(const int count, const int rows, const int cols, const double initValue)
+	:_count(count), _rows(rows), _cols(cols) {
+	if (count < 0 || rows <= 0 || cols <= 0)
+		throw MatrixInvalidInitialization();
+	const long long elements = static_cast<long long>(blocks()) * L * rows * cols;
+	if (elements >= Matrix::MATRIX_LIMIT_ERROR)
+		throw MatrixTooLarge();
+	_data.assign(static_cast<std::size_t>(elements), initValue);
+}
+
+MatrixBatch MatrixBatch::fromStrided(const double* data, const int count, const int rows, const int cols,
+                                     const std::ptrdiff_t stride) {
+	checkStrided(count, rows, cols, stride);
+	MatrixBatch batch(count, rows, cols);
+	for (int b = 0; b < batch.blocks(); ++b)
+		packBlock(data, stride, count, b, rows, cols, batch.block(b));
+	return batch;
+}
+
+void MatrixBatch::toStrided(double* data, const std::ptrdiff_t stride) const {
+	for (int b = 0; b < blocks(); ++b)
+		unpackBlock(block(b), _count, b, _rows, _cols, data, stride);
+}
+
+std::size_t MatrixBatch::offset(const int index, const int row, const int col) const {
+	if (index < 0 || index >= _count)
+		throw MatrixOutOfBounds(_count, 1);
+	if (row < 0 || row >= _rows || col < 0 || col >= _cols)
+		throw MatrixOutOfBounds(_rows, _cols);
+	return static_cast<std::size_t>(index / L) * blockSize() + lanes(row, col, _cols) + index % L;
+}
+
+double& MatrixBatch::operator()(const int index, const int row, const int col) {
+	return _data[offset(index, row, col)];
+}
+
+double MatrixBatch::operator()(const int index, const int row, const int col) const {
+	return _data[offset(index, row, col)];
+}
+
+Matrix MatrixBatch::matrix(const int index) const {
+	const std::size_t first = offset(index, 0, 0);
+	Matrix result(_rows, _cols);
+	for (int i = 0; i < _rows; ++i)
+		for (int j = 0; j < _cols; ++j)
+			result(i, j) = _data[first + lanes(i, j, _cols)];
+	return result;
+}
+
+void MatrixBatch::setMatrix(const int index, const Matrix& matrix) {
+	if (matrix.getRows() != _rows || matrix.getCols() != _cols)
+		throw MatrixDimensionMismatch(_rows, _cols, matrix.getRows(), matrix.getCols());
+	const std::size_t first = offset(index, 0, 0);
+	for (int i = 0; i < _rows; ++i)
+		for (int j = 0; j < _cols; ++j)
+			_data[first + lanes(i, j, _cols)] = matrix(i, j);
+}
+
+// ==== Batches ====
+
+MatrixBatch batchMultiply(const MatrixBatch& a, const MatrixBatch& b) {
+	if (a.count() != b.count() || a.cols() != b.rows())
+		throw MatrixDimensionMismatch(a.rows(), a.cols(), b.rows(), b.cols());
+	MATRIX_PROFILE_WORK("batchMultiply", 2.0 * a.count() * a.rows() * a.cols() * b.cols());
+	if (a.count() == 0) return MatrixBatch();
+	const int m = a.rows(), inner = a.cols(), n = b.cols();
+	MatrixBatch c(a.count(), m, n);
+	const BatchKernels& k = kernels();
+	forEachBlock(c.blocks(), static_cast<long long>(L) * m * inner * n, [&](int b0, int b1) {
+		for (int blk = b0; blk < b1; ++blk)
+			k.multiply(a.block(blk), b.block(blk), c.block(blk), m, inner, n);
+	});
+	return c;
+}
+
+BatchSolveResult batchSolve(const MatrixBatch& a, const MatrixBatch& b) {
+	requireSquare(a);
+	if (a.count() != b.count() || a.rows() != b.rows())
+		throw MatrixDimensionMismatch(a.rows(), a.cols(), b.rows(), b.cols());
+	MATRIX_PROFILE_WORK("batchSolve", a.count() * (2.0 / 3.0 * a.rows() + 2.0 * b.cols()) * a.rows() * a.rows());
+	BatchSolveResult result;
+	if (a.count() == 0) return result;
+	const int n = a.rows(), nrhs = b.cols();
+	result.x = MatrixBatch(a.count(), n, nrhs);
+	result.singular.assign(a.count(), 0);
+	const BatchKernels& k = kernels();
+	forEachBlock(a.blocks(), static_cast<long long>(L) * n * n * (n + nrhs), [&](int b0, int b1) {
+		BlockScratch scratch(n);
+		for (int blk = b0; blk < b1; ++blk) {
+			factorBlock(k, a.block(blk), n, scratch);
+			solveBlock(k, scratch, b.block(blk), result.x.block(blk), n, nrhs);
+			for (int l = 0; l < L && blk * L + l < a.count(); ++l)
+				result.singular[blk * L + l] = scratch.singular[l];
+		}
+	});
+	result.singularCount = static_cast<int>(std::count(result.singular.begin(), result.singular.end(), 1));
+	return result;
+}
+
+std::vector<double> batchDeterminant(const MatrixBatch& a) {
+	requireSquare(a);
+	MATRIX_PROFILE_WORK("batchDeterminant", a.count() * 2.0 / 3.0 * a.rows() * a.rows() * a.rows());
+	std::vector<double> det(a.count());
+	const int n = a.rows();
+	const BatchKernels& k = kernels();
+	forEachBlock(a.blocks(), static_cast<long long>(L) * n * n * n, [&](int b0, int b1) {
+		BlockScratch scratch(n);
+		for (int blk = b0; blk < b1; ++blk) {
+			factorBlock(k, a.block(blk), n, scratch);
+			for (int l = 0; l < L && blk * L + l < a.count(); ++l)
+				det[blk * L + l] = laneDeterminant(scratch, n, l);
+		}
+	});
+	return det;
+}
+
+BatchSolveResult batchInverse(const MatrixBatch& a) {
+	requireSquare(a);
+	MATRIX_PROFILE_WORK("batchInverse", a.count() * 2.0 * a.rows() * a.rows() * a.rows());
+	BatchSolveResult result;
+	if (a.count() == 0) return result;
+	const int n = a.rows();
+	result.x = MatrixBatch(a.count(), n, n);
+	result.singular.assign(a.count(), 0);
+	const BatchKernels& k = kernels();
+	forEachBlock(a.blocks(), static_cast<long long>(L) * 2 * n * n * n, [&](int b0, int b1) {
+		BlockScratch scratch(n);
+		for (int blk = b0; blk < b1; ++blk) {
+			factorBlock(k, a.block(blk), n, scratch);
+			solveBlock(k, scratch, nullptr, result.x.block(blk), n, n);
+			for (int l = 0; l < L && blk * L + l < a.count(); ++l)
+				result.singular[blk * L + l] = scratch.singular[l];
+		}
+	});
+	result.singularCount = static_cast<int>(std::count(result.singular.begin(), result.singular.end(), 1));
+	return result;
+}
+
+// ==== Strided arrays ====
+
+void batchMultiply(const int count, const int m, const int inner, const int n,
+                   const double* a, const std::ptrdiff_t strideA,
+                   const double* b, const std::ptrdiff_t strideB,
+                   double* c, const std::ptrdiff_t strideC) {
+	checkStrided(count, m, inner, strideA);
+	checkStrided(count, inner, n, strideB);
+	checkStrided(count, m, n, strideC);
+	MATRIX_PROFILE_WORK("batchMultiply", 2.0 * count * m * inner * n);
+	const BatchKernels& k = kernels();
+	forEachBlock((count + L - 1) / L, static_cast<long long>(L) * m * inner * n, [&](int b0, int b1) {
+		Block x = blockBuffer(m, inner), y = blockBuffer(inner, n), z = blockBuffer(m, n);
+		for (int blk = b0; blk < b1; ++blk) {
+			packBlock(a, strideA, count, blk, m, inner, x.data());
+			packBlock(b, strideB, count, blk, inner, n, y.data());
+			k.multiply(x.data(), y.data(), z.data(), m, inner, n);
+			unpackBlock(z.data(), count, blk, m, n, c, strideC);
+		}
+	});
+}
+
+int batchSolve(const int count, const int n, const int nrhs,
+               const double* a, const std::ptrdiff_t strideA,
+               const double* b, const std::ptrdiff_t strideB,
+               double* x, const std::ptrdiff_t strideX, std::uint8_t* singular) {
+	checkStrided(count, n, n, strideA);
+	checkStrided(count, n, nrhs, strideB);
+	checkStrided(count, n, nrhs, strideX);
+	MATRIX_PROFILE_WORK("batchSolve", count * (2.0 / 3.0 * n + 2.0 * nrhs) * n * n);
+	std::vector<std::uint8_t> flags(count);
+	const BatchKernels& k = kernels();
+	forEachBlock((count + L - 1) / L, static_cast<long long>(L) * n * n * (n + nrhs), [&](int b0, int b1) {
+		BlockScratch scratch(n);
+		Block packedA = blockBuffer(n, n), packedB = blockBuffer(n, nrhs), solution = blockBuffer(n, nrhs);
+		for (int blk = b0; blk < b1; ++blk) {
+			packBlock(a, strideA, count, blk, n, n, packedA.data());
+			packBlock(b, strideB, count, blk, n, nrhs, packedB.data());
+			factorBlock(k, packedA.data(), n, scratch);
+			solveBlock(k, scratch, packedB.data(), solution.data(), n, nrhs);
+			unpackBlock(solution.data(), count, blk, n, nrhs, x, strideX);
+			for (int l = 0; l < L && blk * L + l < count; ++l)
+				flags[blk * L + l] = scratch.singular[l];
+		}
+	});
+	if (singular) std::copy(flags.begin(), flags.end(), singular);
+	return static_cast<int>(std::count(flags.begin(), flags.end(), 1));
+}
+
+void batchDeterminant(const int count, const int n, const double* a, const std::ptrdiff_t strideA, double* det) {
+	checkStrided(count, n, n, strideA);
+	MATRIX_PROFILE_WORK("batchDeterminant", count * 2.0 / 3.0 * n * n * n);
+	const BatchKernels& k = kernels();
+	forEachBlock((count + L - 1) / L, static_cast<long long>(L) * n * n * n, [&](int b0, int b1) {
+		BlockScratch scratch(n);
+		Block packed = blockBuffer(n, n);
+		for (int blk = b0; blk < b1; ++blk) {
+			packBlock(a, strideA, count, blk, n, n, packed.data());
+			factorBlock(k, packed.data(), n, scratch);
+			for (int l = 0; l < L && blk * L + l < count; ++l)
+				det[blk * L + l] = laneDeterminant(scratch, n, l);
+		}
+	});
+}
+
+int batchInverse(const int count, const int n, const double* a, const std::ptrdiff_t strideA,
+                 double* inverse, const std::ptrdiff_t strideInverse, std::uint8_t* singular) {
+	checkStrided(count, n, n, strideA);
+	checkStrided(count, n, n, strideInverse);
+	MATRIX_PROFILE_WORK("batchInverse", count * 2.0 * n * n * n);
+	std::vector<std::uint8_t> flags(count);
+	const BatchKernels& k = kernels();
+	forEachBlock((count + L - 1) / L, static_cast<long long>(L) * 2 * n * n * n, [&](int b0, int b1) {
+		BlockScratch scratch(n);
+		Block packed = blockBuffer(n, n), result = blockBuffer(n, n);
+		for (int blk = b0; blk < b1; ++blk) {
+			packBlock(a, strideA, count, blk, n, n, packed.data());
+			factorBlock(k, packed.data(), n, scratch);
+			solveBlock(k, scratch, nullptr, result.data(), n, n);
+			unpackBlock(result.data(), count, blk, n, n, inverse, strideInverse);
+			for (int l = 0; l < L && blk * L + l < count; ++l)
+				flags[blk * L + l] = scratch.singular[l];
+		}
+	});
+	if (singular) std::copy(flags.begin(), flags.end(), singular);
+	return static_cast<int>(std::count(flags.begin(), flags.end(), 1));
+}
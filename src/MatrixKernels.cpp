@@ -0,0 +1,578 @@
+#include "../include/MatrixKernels.h"
+#include "../include/MatrixAllocator.h"
+#include "../include/Parallel.h"
+#include "../include/Profiler.h"
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace {
+
+	// ==== Blocking parameters ====
+	// MR x NR is the register tile computed by the micro-kernel. KC x NR doubles
+	// of packed B (16 KiB) stay in L1, MC x KC of packed A (256 KiB) in L2 and
+	// the KC x NC panel of packed B in L3. Floats are half as wide, so the
+	// float tile is twice as many columns across in the same registers.
+	constexpr int MR = 4;
+	constexpr int MC = 128;
+	constexpr int KC = 256;
+	constexpr int NC = 2048;
+
+	template <typename T>
+	constexpr int NR = 8 * static_cast<int>(sizeof(double) / sizeof(T));
+
+	/**
+	 * Element offset of the start of a row. Widened before multiplying, so
+	 * matrices with more than INT_MAX elements are addressed correctly.
+	 */
+	inline std::ptrdiff_t offset(int row, int ld) {
+		return static_cast<std::ptrdiff_t>(row) * ld;
+	}
+
+	// Products with fewer multiply-adds than this are not worth packing.
+	constexpr long long SMALL_PRODUCT = 32LL * 32 * 32;
+
+	/**
+	 * Pack an mc x kc block of A into MR-row micro-panels. Inside each panel
+	 * the MR values of one column are contiguous; rows past mc are zero padded
+	 * so the micro-kernel never needs edge handling on reads.
+	 */
+	template <typename T>
+	void packA(int mc, int kc, const T* A, int lda, T* packed) {
+		for (int i = 0; i < mc; i += MR) {
+			const int rows = std::min(MR, mc - i);
+			for (int p = 0; p < kc; ++p) {
+				for (int r = 0; r < rows; ++r)
+					packed[r] = A[offset(i + r, lda) + p];
+				for (int r = rows; r < MR; ++r)
+					packed[r] = T(0);
+				packed += MR;
+			}
+		}
+	}
+
+	/**
+	 * Pack a kc x nc panel of B into NR-column micro-panels. Inside each panel
+	 * the NR values of one row are contiguous; columns past nc are zero padded.
+	 */
+	template <typename T>
+	void packB(int kc, int nc, const T* B, int ldb, T* packed) {
+		for (int j = 0; j < nc; j += NR<T>) {
+			const int cols = std::min(NR<T>, nc - j);
+			for (int p = 0; p < kc; ++p) {
+				const T* row = B + offset(p, ldb) + j;
+				for (int c = 0; c < cols; ++c)
+					packed[c] = row[c];
+				for (int c = cols; c < NR<T>; ++c)
+					packed[c] = T(0);
+				packed += NR<T>;
+			}
+		}
+	}
+
+	/**
+	 * Register-tiled micro-kernel: C[0:mr, 0:nr] += alpha * a * b, where a is an
+	 * MR x kc micro-panel and b a kc x NR micro-panel. The accumulator tile is
+	 * kept in locals so the compiler can hold it in vector registers.
+	 */
+	template <typename T>
+	void microKernel(int kc, T alpha, const T* a, const T* b,
+	                 T* C, int ldc, int mr, int nr) {
+		T acc[MR][NR<T>] = {};
+		for (int p = 0; p < kc; ++p) {
+			for (int r = 0; r < MR; ++r) {
+				const T av = a[r];
+				for (int c = 0; c < NR<T>; ++c)
+					acc[r][c] += av * b[c];
+			}
+			a += MR;
+			b += NR<T>;
+		}
+		for (int r = 0; r < mr; ++r) {
+			T* row = C + offset(r, ldc);
+			for (int c = 0; c < nr; ++c)
+				row[c] += alpha * acc[r][c];
+		}
+	}
+
+	/**
+	 * Apply the beta factor to C once up front, so the blocked loops only
+	 * ever accumulate. beta == 0 overwrites C (and discards NaNs in it).
+	 */
+	template <typename T>
+	void scaleC(int m, int n, T beta, T* C, int ldc) {
+		if (beta == T(1)) return;
+		for (int i = 0; i < m; ++i) {
+			T* row = C + offset(i, ldc);
+			if (beta == T(0)) std::fill(row, row + n, T(0));
+			else for (int j = 0; j < n; ++j) row[j] *= beta;
+		}
+	}
+
+	/**
+	 * Unpacked i-k-j loop for tiny products (e.g. 3x3 rotation chains), where
+	 * packing costs more than it saves. Inner loop is unit stride on B and C.
+	 */
+	template <typename T>
+	void gemmSmall(int m, int n, int k, T alpha, const T* A, int lda,
+	               const T* B, int ldb, T* C, int ldc) {
+		for (int i = 0; i < m; ++i) {
+			T* cRow = C + offset(i, ldc);
+			for (int p = 0; p < k; ++p) {
+				const T a = alpha * A[offset(i, lda) + p];
+				const T* bRow = B + offset(p, ldb);
+				for (int j = 0; j < n; ++j)
+					cRow[j] += a * bRow[j];
+			}
+		}
+	}
+
+	/**
+	 * The packed, cache-blocked product C += alpha * A * B (C already scaled).
+	 */
+	template <typename T>
+	void gemmBlocked(int m, int n, int k,
+	                 T alpha, const T* A, int lda,
+	                 const T* B, int ldb,
+	                 T* C, int ldc) {
+		// Packing buffers are reused across calls on the same thread, and
+		// cache-line aligned so micro-panels never straddle a line boundary.
+		thread_local std::vector<T, PooledAllocator<T>> packedA;
+		thread_local std::vector<T, PooledAllocator<T>> packedB;
+		packedA.resize(static_cast<size_t>(MC) * KC);
+		packedB.resize(static_cast<size_t>(KC) * (NC + NR<T>));
+
+		for (int jc = 0; jc < n; jc += NC) {
+			const int nc = std::min(NC, n - jc);
+			for (int pc = 0; pc < k; pc += KC) {
+				const int kc = std::min(KC, k - pc);
+				packB(kc, nc, B + offset(pc, ldb) + jc, ldb, packedB.data());
+
+				for (int ic = 0; ic < m; ic += MC) {
+					const int mc = std::min(MC, m - ic);
+					packA(mc, kc, A + offset(ic, lda) + pc, lda, packedA.data());
+
+					for (int jr = 0; jr < nc; jr += NR<T>) {
+						const int nr = std::min(NR<T>, nc - jr);
+						const T* b = packedB.data() + jr * kc;
+						for (int ir = 0; ir < mc; ir += MR) {
+							const int mr = std::min(MR, mc - ir);
+							const T* a = packedA.data() + ir * kc;
+							microKernel(kc, alpha, a, b,
+							            C + offset(ic + ir, ldc) + jc + jr, ldc, mr, nr);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	// Leaf edge of the recursive transpose: a 16 x 16 source tile and its
+	// destination tile (4 KiB together in doubles) sit well inside L1.
+	constexpr int TRANSPOSE_TILE = 16;
+
+	template <typename T>
+	void transposeTile(int rows, int cols, const T* src, int lds, T* dst, int ldd) {
+		for (int i = 0; i < rows; ++i) {
+			const T* s = src + offset(i, lds);
+			for (int j = 0; j < cols; ++j)
+				dst[offset(j, ldd) + i] = s[j];
+		}
+	}
+
+	template <typename T>
+	void transposeRecursive(int rows, int cols, const T* src, int lds, T* dst, int ldd) {
+		if (rows <= TRANSPOSE_TILE && cols <= TRANSPOSE_TILE) {
+			transposeTile(rows, cols, src, lds, dst, ldd);
+		} else if (rows >= cols) {
+			const int half = rows / 2;
+			transposeRecursive(half, cols, src, lds, dst, ldd);
+			transposeRecursive(rows - half, cols, src + offset(half, lds), lds, dst + half, ldd);
+		} else {
+			const int half = cols / 2;
+			transposeRecursive(rows, half, src, lds, dst, ldd);
+			transposeRecursive(rows, cols - half, src + half, lds, dst + offset(half, ldd), ldd);
+		}
+	}
+
+	/**
+	 * C += alpha * A * B with the blocked kernel (C already scaled).
+	 */
+	template <typename T>
+	void gemmAccumulate(int m, int n, int k,
+	                    T alpha, const T* A, int lda,
+	                    const T* B, int ldb,
+	                    T* C, int ldc) {
+		if (m <= 0 || n <= 0 || k <= 0) return;
+		if (static_cast<long long>(m) * n * k < SMALL_PRODUCT) {
+			gemmSmall(m, n, k, alpha, A, lda, B, ldb, C, ldc);
+			return;
+		}
+
+		// Independent blocks of C go to different threads: row blocks when C
+		// is tall, column blocks when it is wide. Each task packs its own
+		// panels into thread-local buffers.
+		if (m >= n) {
+			const int rowsPerTask = std::max(MR, Parallel::minChunkFor(static_cast<long long>(n) * k));
+			Parallel::parallelFor(0, m, rowsPerTask, [&](int r0, int r1) {
+				gemmBlocked(r1 - r0, n, k, alpha, A + offset(r0, lda), lda, B, ldb, C + offset(r0, ldc), ldc);
+			});
+		} else {
+			const int colsPerTask = std::max(NR<T>, Parallel::minChunkFor(static_cast<long long>(m) * k));
+			Parallel::parallelFor(0, n, colsPerTask, [&](int c0, int c1) {
+				gemmBlocked(m, c1 - c0, k, alpha, A, lda, B + c0, ldb, C + c0, ldc);
+			});
+		}
+	}
+
+	// ==== Strassen ====
+
+	template <typename T>
+	using Scratch = std::vector<T, PooledAllocator<T>>;
+
+	/**
+	 * A read-only rows x cols block: either a quadrant of an input, in place,
+	 * or the sum or difference of two quadrants, formed into scratch.
+	 */
+	template <typename T>
+	struct Operand {
+		const T* data;
+		int ld;
+	};
+
+	template <typename T>
+	Operand<T> combine(int rows, int cols, const T* p, int ldp, const T* q, int ldq, bool subtract, Scratch<T>& out) {
+		out.resize(static_cast<std::size_t>(rows) * cols);
+		for (int i = 0; i < rows; ++i) {
+			T* row = out.data() + offset(i, cols);
+			std::copy(p + offset(i, ldp), p + offset(i, ldp) + cols, row);
+			if (subtract) MatrixKernels::subtract(cols, q + offset(i, ldq), row);
+			else MatrixKernels::add(cols, q + offset(i, ldq), row);
+		}
+		return { out.data(), cols };
+	}
+
+	/**
+	 * The quadrants of the even-sized cores of A (mh x kh each) and B (kh x nh each).
+	 */
+	template <typename T>
+	struct Quadrants {
+		int mh, nh, kh;
+		const T* A[2][2];
+		int lda;
+		const T* B[2][2];
+		int ldb;
+	};
+
+	/**
+	 * Strassen's seven products M1..M7 and, for each, the quadrants of C it
+	 * is added to (+1) or subtracted from (-1), indexed [product][row][col]:
+	 *   M1 = (A11 + A22)(B11 + B22)   C11 += M1, C22 += M1
+	 *   M2 = (A21 + A22) B11          C21 += M2, C22 -= M2
+	 *   M3 = A11 (B12 - B22)          C12 += M3, C22 += M3
+	 *   M4 = A22 (B21 - B11)          C11 += M4, C21 += M4
+	 *   M5 = (A11 + A12) B22          C11 -= M5, C12 += M5
+	 *   M6 = (A21 - A11)(B11 + B12)   C22 += M6
+	 *   M7 = (A12 - A22)(B21 + B22)   C11 += M7
+	 */
+	constexpr int STRASSEN_SIGNS[7][2][2] = {
+		{ { 1, 0 }, { 0, 1 } },
+		{ { 0, 0 }, { 1, -1 } },
+		{ { 0, 1 }, { 0, 1 } },
+		{ { 1, 0 }, { 1, 0 } },
+		{ { -1, 1 }, { 0, 0 } },
+		{ { 0, 0 }, { 0, 1 } },
+		{ { 1, 0 }, { 0, 0 } },
+	};
+
+	template <typename T>
+	void strassenAccumulate(int m, int n, int k, T alpha, const T* A, int lda, const T* B, int ldb, T* C, int ldc);
+
+	/**
+	 * M = (product `which`), overwriting M (mh x nh, contiguous).
+	 */
+	template <typename T>
+	void strassenProduct(int which, const Quadrants<T>& q, Scratch<T>& left, Scratch<T>& right, Scratch<T>& M) {
+		const int mh = q.mh, nh = q.nh, kh = q.kh;
+		Operand<T> a{}, b{};
+		switch (which) {
+		case 0:
+			a = combine(mh, kh, q.A[0][0], q.lda, q.A[1][1], q.lda, false, left);
+			b = combine(kh, nh, q.B[0][0], q.ldb, q.B[1][1], q.ldb, false, right);
+			break;
+		case 1:
+			a = combine(mh, kh, q.A[1][0], q.lda, q.A[1][1], q.lda, false, left);
+			b = { q.B[0][0], q.ldb };
+			break;
+		case 2:
+			a = { q.A[0][0], q.lda };
+			b = combine(kh, nh, q.B[0][1], q.ldb, q.B[1][1], q.ldb, true, right);
+			break;
+		case 3:
+			a = { q.A[1][1], q.lda };
+			b = combine(kh, nh, q.B[1][0], q.ldb, q.B[0][0], q.ldb, true, right);
+			break;
+		case 4:
+			a = combine(mh, kh, q.A[0][0], q.lda, q.A[0][1], q.lda, false, left);
+			b = { q.B[1][1], q.ldb };
+			break;
+		case 5:
+			a = combine(mh, kh, q.A[1][0], q.lda, q.A[0][0], q.lda, true, left);
+			b = combine(kh, nh, q.B[0][0], q.ldb, q.B[0][1], q.ldb, false, right);
+			break;
+		default:
+			a = combine(mh, kh, q.A[0][1], q.lda, q.A[1][1], q.lda, true, left);
+			b = combine(kh, nh, q.B[1][0], q.ldb, q.B[1][1], q.ldb, false, right);
+			break;
+		}
+		M.assign(static_cast<std::size_t>(mh) * nh, T(0));
+		strassenAccumulate(mh, nh, kh, T(1), a.data, a.ld, b.data, b.ld, M.data(), nh);
+	}
+
+	/**
+	 * C quadrant (row, col) += sign * alpha * M, for every quadrant M feeds.
+	 */
+	template <typename T>
+	void strassenScatter(int which, const T* M, int mh, int nh, T alpha, T* C, int ldc) {
+		for (int r = 0; r < 2; ++r)
+			for (int c = 0; c < 2; ++c) {
+				const int sign = STRASSEN_SIGNS[which][r][c];
+				if (sign == 0) continue;
+				T* quadrant = C + offset(r * mh, ldc) + c * nh;
+				for (int i = 0; i < mh; ++i)
+					MatrixKernels::axpy(nh, sign * alpha, M + offset(i, nh), quadrant + offset(i, ldc));
+			}
+	}
+
+	/**
+	 * C += alpha * A * B by Strassen's recursion (C already scaled).
+	 *
+	 * Odd dimensions are peeled: the recursion covers the even-sized core
+	 * and the leftover row, column and inner index are added with the
+	 * blocked kernel. Blocks smaller than STRASSEN_CROSSOVER in any
+	 * dimension go to the blocked kernel as a whole.
+	 *
+	 * At the top level the seven products run concurrently, each into its
+	 * own buffer, and are then added to C in a fixed order; deeper levels
+	 * compute them one after another, reusing three buffers. Either way every
+	 * element of C sees the same operations in the same order, so the result
+	 * does not depend on the number of threads.
+	 */
+	template <typename T>
+	void strassenAccumulate(int m, int n, int k, T alpha, const T* A, int lda, const T* B, int ldb, T* C, int ldc) {
+		if (std::min({ m, n, k }) < MatrixKernels::STRASSEN_CROSSOVER) {
+			gemmAccumulate(m, n, k, alpha, A, lda, B, ldb, C, ldc);
+			return;
+		}
+		thread_local int depth = 0;
+
+		Quadrants<T> q;
+		q.mh = m / 2;
+		q.nh = n / 2;
+		q.kh = k / 2;
+		q.lda = lda;
+		q.ldb = ldb;
+		for (int r = 0; r < 2; ++r)
+			for (int c = 0; c < 2; ++c) {
+				q.A[r][c] = A + offset(r * q.mh, lda) + c * q.kh;
+				q.B[r][c] = B + offset(r * q.kh, ldb) + c * q.nh;
+			}
+		const int m2 = 2 * q.mh, n2 = 2 * q.nh, k2 = 2 * q.kh;
+
+		if (depth == 0 && Parallel::workerCount() > 1) {
+			std::vector<Scratch<T>> products(7);
+			Parallel::parallelFor(0, 7, 1, [&](int p0, int p1) {
+				++depth;
+				Scratch<T> left, right;
+				for (int p = p0; p < p1; ++p)
+					strassenProduct(p, q, left, right, products[p]);
+				--depth;
+			});
+			for (int p = 0; p < 7; ++p)
+				strassenScatter(p, products[p].data(), q.mh, q.nh, alpha, C, ldc);
+		} else {
+			++depth;
+			Scratch<T> left, right, M;
+			for (int p = 0; p < 7; ++p) {
+				strassenProduct(p, q, left, right, M);
+				strassenScatter(p, M.data(), q.mh, q.nh, alpha, C, ldc);
+			}
+			--depth;
+		}
+
+		// The peeled inner index, column and row
+		if (k2 < k)
+			gemmAccumulate(m2, n2, k - k2, alpha, A + k2, lda, B + offset(k2, ldb), ldb, C, ldc);
+		if (n2 < n)
+			gemmAccumulate(m2, n - n2, k, alpha, A, lda, B + n2, ldb, C + n2, ldc);
+		if (m2 < m)
+			gemmAccumulate(m - m2, n, k, alpha, A + offset(m2, lda), lda, B, ldb, C + offset(m2, ldc), ldc);
+	}
+
+	template <typename T>
+	void gemmImpl(int m, int n, int k,
+	              T alpha, const T* A, int lda,
+	              const T* B, int ldb,
+	              T beta, T* C, int ldc, bool strassen) {
+		MATRIX_PROFILE_WORK("MatrixKernels::gemm", 2.0 * m * n * k);
+		if (m <= 0 || n <= 0) return;
+		scaleC(m, n, beta, C, ldc);
+		if (k <= 0 || alpha == T(0)) return;
+		if (strassen) strassenAccumulate(m, n, k, alpha, A, lda, B, ldb, C, ldc);
+		else gemmAccumulate(m, n, k, alpha, A, lda, B, ldb, C, ldc);
+	}
+
+	bool policyWantsStrassen() {
+		return Parallel::currentPolicy().multiply == ExecutionPolicy::Multiply::Strassen;
+	}
+
+	template <typename T>
+	void gemmReferenceImpl(int m, int n, int k,
+	                       T alpha, const T* A, int lda,
+	                       const T* B, int ldb,
+	                       T beta, T* C, int ldc) {
+		for (int row = 0; row < m; row++) {
+			for (int col = 0; col < n; col++) {
+				T sum = T(0);
+				for (int p = 0; p < k; p++) {
+					sum += A[offset(row, lda) + p] * B[offset(p, ldb) + col];
+				}
+				T& out = C[offset(row, ldc) + col];
+				out = alpha * sum + (beta == T(0) ? T(0) : beta * out);
+			}
+		}
+	}
+
+	template <typename T>
+	void transposeImpl(int rows, int cols, const T* src, int lds, T* dst, int ldd) {
+		MATRIX_PROFILE("MatrixKernels::transpose");
+		if (rows <= 0 || cols <= 0) return;
+		// Bands of source rows map to disjoint bands of destination columns
+		Parallel::parallelFor(0, rows, std::max(TRANSPOSE_TILE, Parallel::minChunkFor(cols)), [&](int r0, int r1) {
+			transposeRecursive(r1 - r0, cols, src + offset(r0, lds), lds, dst + r0, ldd);
+		});
+	}
+
+	template <typename T>
+	void transposeSquareInPlaceImpl(int n, T* a, int lda) {
+		// Tile row bi swaps with tile column bi, so tile rows are independent.
+		// Row bi carries (tiles - bi) tiles; pairing it with row tiles-1-bi
+		// gives every task the same amount of work.
+		const int tiles = (n + TRANSPOSE_TILE - 1) / TRANSPOSE_TILE;
+		auto transposeTileRow = [&](int tileRow) {
+			const int bi = tileRow * TRANSPOSE_TILE;
+			const int ei = std::min(bi + TRANSPOSE_TILE, n);
+
+			// Diagonal tile: swap across its own diagonal
+			for (int i = bi; i < ei; ++i)
+				for (int j = i + 1; j < ei; ++j)
+					std::swap(a[offset(i, lda) + j], a[offset(j, lda) + i]);
+
+			// Off-diagonal tiles: exchange tile (bi, bj) with tile (bj, bi)
+			for (int bj = ei; bj < n; bj += TRANSPOSE_TILE) {
+				const int ej = std::min(bj + TRANSPOSE_TILE, n);
+				for (int i = bi; i < ei; ++i)
+					for (int j = bj; j < ej; ++j)
+						std::swap(a[offset(i, lda) + j], a[offset(j, lda) + i]);
+			}
+		};
+
+		const int pairs = (tiles + 1) / 2;
+		const long long workPerPair = static_cast<long long>(TRANSPOSE_TILE) * n;
+		Parallel::parallelFor(0, pairs, Parallel::minChunkFor(workPerPair), [&](int p0, int p1) {
+			for (int p = p0; p < p1; ++p) {
+				transposeTileRow(p);
+				if (tiles - 1 - p != p) transposeTileRow(tiles - 1 - p);
+			}
+		});
+	}
+
+	template <typename T>
+	void transposeInPlaceImpl(int rows, int cols, T* a) {
+		MATRIX_PROFILE("MatrixKernels::transposeInPlace");
+		if (rows == cols) {
+			transposeSquareInPlaceImpl(rows, a, cols);
+			return;
+		}
+		if (rows <= 1 || cols <= 1) return; // a vector's layout is its own transpose
+
+		// Element k = r * cols + c moves to c * rows + r, which equals
+		// k * rows mod (size - 1) for every k except the last one. The first
+		// and last elements stay put; all others lie on disjoint cycles.
+		const size_t size = static_cast<size_t>(rows) * cols;
+		const size_t modulus = size - 1;
+		std::vector<bool> moved(size, false);
+		for (size_t start = 1; start < modulus; ++start) {
+			if (moved[start]) continue;
+			T carried = a[start];
+			size_t k = start;
+			do {
+				k = (k * static_cast<size_t>(rows)) % modulus;
+				std::swap(carried, a[k]);
+				moved[k] = true;
+			} while (k != start);
+		}
+	}
+}
+
+namespace MatrixKernels {
+
+	void gemm(int m, int n, int k,
+	          double alpha, const double* A, int lda,
+	          const double* B, int ldb,
+	          double beta, double* C, int ldc) {
+		gemmImpl(m, n, k, alpha, A, lda, B, ldb, beta, C, ldc, policyWantsStrassen());
+	}
+
+	void gemm(int m, int n, int k,
+	          float alpha, const float* A, int lda,
+	          const float* B, int ldb,
+	          float beta, float* C, int ldc) {
+		gemmImpl(m, n, k, alpha, A, lda, B, ldb, beta, C, ldc, policyWantsStrassen());
+	}
+
+	void gemmStrassen(int m, int n, int k,
+	                  double alpha, const double* A, int lda,
+	                  const double* B, int ldb,
+	                  double beta, double* C, int ldc) {
+		gemmImpl(m, n, k, alpha, A, lda, B, ldb, beta, C, ldc, true);
+	}
+
+	void gemmStrassen(int m, int n, int k,
+	                  float alpha, const float* A, int lda,
+	                  const float* B, int ldb,
+	                  float beta, float* C, int ldc) {
+		gemmImpl(m, n, k, alpha, A, lda, B, ldb, beta, C, ldc, true);
+	}
+
+	void gemmReference(int m, int n, int k,
+	                   double alpha, const double* A, int lda,
+	                   const double* B, int ldb,
+	                   double beta, double* C, int ldc) {
+		gemmReferenceImpl(m, n, k, alpha, A, lda, B, ldb, beta, C, ldc);
+	}
+
+	void transpose(int rows, int cols, const double* src, int lds, double* dst, int ldd) {
+		transposeImpl(rows, cols, src, lds, dst, ldd);
+	}
+
+	void transpose(int rows, int cols, const float* src, int lds, float* dst, int ldd) {
+		transposeImpl(rows, cols, src, lds, dst, ldd);
+	}
+
+	void transposeSquareInPlace(int n, double* a, int lda) {
+		transposeSquareInPlaceImpl(n, a, lda);
+	}
+
+	void transposeSquareInPlace(int n, float* a, int lda) {
+		transposeSquareInPlaceImpl(n, a, lda);
+	}
+
+	void transposeInPlace(int rows, int cols, double* a) {
+		transposeInPlaceImpl(rows, cols, a);
+	}
+
+	void transposeInPlace(int rows, int cols, float* a) {
+		transposeInPlaceImpl(rows, cols, a);
+	}
+}
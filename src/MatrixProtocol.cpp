@@ -0,0 +1,181 @@
+#include "MatrixProtocol.h"
+
+#include <cstring>
+#include <limits>
+#include "MatrixException.h"
+
+namespace {
+    bool hostIsLittleEndian() {
+        const std::uint16_t probe = 1;
+        unsigned char first;
+        std::memcpy(&first, &probe, 1);
+        return first == 1;
+    }
+
+    void putLittleEndian(char* out, std::uint64_t value, std::size_t bytes) {
+        for (std::size_t i = 0; i < bytes; ++i)
+            out[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+
+    std::uint64_t getLittleEndian(const char* in, std::size_t bytes) {
+        std::uint64_t value = 0;
+        for (std::size_t i = 0; i < bytes; ++i)
+            value |= static_cast<std::uint64_t>(static_cast<unsigned char>(in[i])) << (8 * i);
+        return value;
+    }
+
+    std::uint64_t doubleBits(double value) {
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof bits);
+        return bits;
+    }
+
+    double bitsDouble(std::uint64_t bits) {
+        double value;
+        std::memcpy(&value, &bits, sizeof value);
+        return value;
+    }
+}
+
+namespace MatrixProtocol {
+
+    Header decodeHeader(const char* bytes) {
+        Header header;
+        header.payloadLength = static_cast<std::uint32_t>(getLittleEndian(bytes, 4));
+        header.requestId = static_cast<std::uint32_t>(getLittleEndian(bytes + 4, 4));
+        header.code = static_cast<std::uint8_t>(bytes[8]);
+        return header;
+    }
+
+    // ==== Writer ====
+
+    void Writer::beginFrame(const std::uint32_t requestId, const std::uint8_t code) {
+        _frameStart = _buffer.size();
+        u32(0); // patched by endFrame()
+        u32(requestId);
+        u8(code);
+    }
+
+    void Writer::endFrame() {
+        const std::size_t payload = _buffer.size() - _frameStart - HEADER_BYTES;
+        if (payload > MAX_PAYLOAD) {
+            _buffer.resize(_frameStart); // a wrapped length field would break the framing
+            throw MatrixServerError("frame payload of " + std::to_string(payload) + " bytes exceeds the limit of " +
+                                    std::to_string(MAX_PAYLOAD));
+        }
+        putLittleEndian(&_buffer[_frameStart], payload, 4);
+    }
+
+    void Writer::u8(const std::uint8_t value) {
+        _buffer.push_back(static_cast<char>(value));
+    }
+
+    void Writer::u16(const std::uint16_t value) {
+        char bytes[2];
+        putLittleEndian(bytes, value, 2);
+        _buffer.append(bytes, 2);
+    }
+
+    void Writer::u32(const std::uint32_t value) {
+        char bytes[4];
+        putLittleEndian(bytes, value, 4);
+        _buffer.append(bytes, 4);
+    }
+
+    void Writer::i32(const std::int32_t value) {
+        u32(static_cast<std::uint32_t>(value));
+    }
+
+    void Writer::f64(const double value) {
+        char bytes[8];
+        putLittleEndian(bytes, doubleBits(value), 8);
+        _buffer.append(bytes, 8);
+    }
+
+    void Writer::str(const std::string& value) {
+        if (value.size() > std::numeric_limits<std::uint16_t>::max())
+            throw MatrixServerError("string of " + std::to_string(value.size()) + " bytes is too long");
+        u16(static_cast<std::uint16_t>(value.size()));
+        _buffer.append(value);
+    }
+
+    void Writer::matrix(const Matrix& value) {
+        const std::size_t count = static_cast<std::size_t>(value.getRows()) * value.getCols();
+        if (count > (MAX_PAYLOAD - 8) / sizeof(double))
+            throw MatrixServerError("matrix of " + std::to_string(value.getRows()) + " x " +
+                                    std::to_string(value.getCols()) + " is too large for one frame");
+        u32(static_cast<std::uint32_t>(value.getRows()));
+        u32(static_cast<std::uint32_t>(value.getCols()));
+        const double* data = value.data();
+        if (hostIsLittleEndian()) {
+            _buffer.append(reinterpret_cast<const char*>(data), count * sizeof(double));
+            return;
+        }
+        const std::size_t start = _buffer.size();
+        _buffer.resize(start + count * sizeof(double));
+        for (std::size_t i = 0; i < count; ++i)
+            putLittleEndian(&_buffer[start + i * sizeof(double)], doubleBits(data[i]), 8);
+    }
+
+    // ==== Reader ====
+
+    const char* Reader::take(const std::size_t bytes) {
+        if (static_cast<std::size_t>(_end - _data) < bytes)
+            throw MatrixServerError("truncated payload");
+        const char* at = _data;
+        _data += bytes;
+        return at;
+    }
+
+    std::uint8_t Reader::u8() {
+        return static_cast<std::uint8_t>(*take(1));
+    }
+
+    std::uint16_t Reader::u16() {
+        return static_cast<std::uint16_t>(getLittleEndian(take(2), 2));
+    }
+
+    std::uint32_t Reader::u32() {
+        return static_cast<std::uint32_t>(getLittleEndian(take(4), 4));
+    }
+
+    std::int32_t Reader::i32() {
+        return static_cast<std::int32_t>(u32());
+    }
+
+    double Reader::f64() {
+        return bitsDouble(getLittleEndian(take(8), 8));
+    }
+
+    std::string Reader::str() {
+        const std::uint16_t length = u16();
+        return std::string(take(length), length);
+    }
+
+    Matrix Reader::matrix() {
+        const std::uint32_t rows = u32(), cols = u32();
+        if (rows == 0 || cols == 0 || rows > std::numeric_limits<std::int32_t>::max() ||
+            cols > std::numeric_limits<std::int32_t>::max())
+            throw MatrixServerError("invalid matrix dimensions " + std::to_string(rows) + " x " + std::to_string(cols));
+        // Check against the payload before allocating anything
+        const std::uint64_t count = std::uint64_t(rows) * cols;
+        if (count > static_cast<std::uint64_t>(_end - _data) / sizeof(double))
+            throw MatrixServerError("truncated payload");
+        const char* bytes = take(static_cast<std::size_t>(count) * sizeof(double));
+
+        Matrix value(static_cast<int>(rows), static_cast<int>(cols));
+        double* data = value.data();
+        if (hostIsLittleEndian()) {
+            std::memcpy(data, bytes, static_cast<std::size_t>(count) * sizeof(double));
+        } else {
+            for (std::size_t i = 0; i < count; ++i)
+                data[i] = bitsDouble(getLittleEndian(bytes + i * sizeof(double), 8));
+        }
+        return value;
+    }
+
+    void Reader::finish() const {
+        if (_data != _end)
+            throw MatrixServerError("unexpected trailing bytes in payload");
+    }
+}
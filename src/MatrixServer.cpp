@@ -0,0 +1,586 @@
+#include "MatrixServer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <sstream>
+#include "MatrixException.h"
+#include "QRDecomposition.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MATRIX_SERVER_SOCKETS 1
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using MatrixProtocol::Opcode;
+using MatrixProtocol::Status;
+
+namespace {
+    constexpr std::size_t RECEIVE_CHUNK = std::size_t(1) << 16;
+
+#ifdef MATRIX_SERVER_SOCKETS
+#ifdef MSG_NOSIGNAL
+    constexpr int SEND_FLAGS = MSG_NOSIGNAL; // a closed peer is an error, not SIGPIPE
+#else
+    constexpr int SEND_FLAGS = 0;
+#endif
+
+    /**
+     * Resolve a numeric or named IPv4 address; the result must be freed with freeaddrinfo().
+     */
+    addrinfo* resolve(const std::string& host, int port, bool passive) {
+        addrinfo hints{};
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = passive ? AI_PASSIVE : 0;
+        addrinfo* result = nullptr;
+        const int status = ::getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &result);
+        if (status != 0)
+            throw MatrixServerError("cannot resolve '" + host + "': " + ::gai_strerror(status));
+        return result;
+    }
+
+    void setNoDelay(int socket) {
+        const int enable = 1;
+        ::setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof enable);
+    }
+
+    bool sendAll(int socket, const std::string& bytes) {
+        std::size_t sent = 0;
+        while (sent < bytes.size()) {
+            const ssize_t n = ::send(socket, bytes.data() + sent, bytes.size() - sent, SEND_FLAGS);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            sent += static_cast<std::size_t>(n);
+        }
+        return true;
+    }
+
+    /**
+     * Append what the socket has to buffer; false once the peer has closed.
+     */
+    bool receiveSome(int socket, std::string& buffer) {
+        char chunk[RECEIVE_CHUNK];
+        while (true) {
+            const ssize_t n = ::recv(socket, chunk, sizeof chunk, 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            buffer.append(chunk, static_cast<std::size_t>(n));
+            return true;
+        }
+    }
+#endif
+
+    /**
+     * Workspace files live in the server's workspaces/ folder: no paths.
+     */
+    bool isPlainFileName(const std::string& filename) {
+        return !filename.empty() && filename.find('/') == std::string::npos &&
+               filename.find('\\') == std::string::npos && filename != "." && filename != "..";
+    }
+
+    /**
+     * The workspace's messages, without the trailing newline, as an error.
+     */
+    std::string failureMessage(const std::ostringstream& messages) {
+        std::string message = messages.str();
+        while (!message.empty() && (message.back() == '\n' || message.back() == ' '))
+            message.pop_back();
+        return message.empty() ? "Operation failed." : message;
+    }
+}
+
+// ========================= SERVER =========================
+
+MatrixServer::MatrixServer(ConcurrentWorkspace& workspace) : _workspace(workspace) {}
+
+MatrixServer::~MatrixServer() {
+    stop();
+#ifdef MATRIX_SERVER_SOCKETS
+    const int listener = _listener.exchange(-1);
+    if (listener >= 0) ::close(listener);
+#endif
+}
+
+int MatrixServer::listen(const std::string& host, const int port) {
+#ifdef MATRIX_SERVER_SOCKETS
+    addrinfo* address = resolve(host, port, true);
+    const int listener = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+    if (listener < 0) {
+        ::freeaddrinfo(address);
+        throw MatrixServerError(std::string("cannot create socket: ") + std::strerror(errno));
+    }
+    const int reuse = 1;
+    ::setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof reuse);
+    if (::bind(listener, address->ai_addr, address->ai_addrlen) != 0 || ::listen(listener, SOMAXCONN) != 0) {
+        const std::string reason = std::strerror(errno);
+        ::freeaddrinfo(address);
+        ::close(listener);
+        throw MatrixServerError("cannot listen on " + host + ":" + std::to_string(port) + ": " + reason);
+    }
+    ::freeaddrinfo(address);
+
+    sockaddr_in bound{};
+    socklen_t length = sizeof bound;
+    ::getsockname(listener, reinterpret_cast<sockaddr*>(&bound), &length);
+    _listener = listener;
+    return ntohs(bound.sin_port);
+#else
+    (void)host;
+    (void)port;
+    throw MatrixServerError("sockets are not available on this platform");
+#endif
+}
+
+void MatrixServer::setMaxRequestBytes(const std::uint32_t bytes) {
+    _maxRequest = std::min(bytes, MatrixProtocol::MAX_PAYLOAD);
+}
+
+void MatrixServer::serve() {
+#ifdef MATRIX_SERVER_SOCKETS
+    while (!_stopping) {
+        const int client = ::accept(_listener, nullptr, nullptr);
+        if (client < 0) {
+            if (_stopping) break;
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            break;
+        }
+        setNoDelay(client);
+        joinFinished();
+        std::lock_guard<std::mutex> lock(_connectionsMutex);
+        _connections.push_back(client);
+        _threads.emplace_back([this, client] {
+            serveConnection(client);
+            std::lock_guard<std::mutex> lock(_connectionsMutex);
+            _connections.erase(std::find(_connections.begin(), _connections.end(), client));
+            ::close(client);
+            _finished.push_back(std::this_thread::get_id());
+        });
+    }
+
+    // Wake every connection blocked in recv(), then wait for them to finish
+    std::vector<std::thread> threads;
+    {
+        std::lock_guard<std::mutex> lock(_connectionsMutex);
+        for (const int client : _connections)
+            ::shutdown(client, SHUT_RDWR);
+        threads.swap(_threads);
+        _finished.clear();
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+#endif
+}
+
+void MatrixServer::joinFinished() {
+    std::vector<std::thread> finished;
+    {
+        std::lock_guard<std::mutex> lock(_connectionsMutex);
+        const auto done = std::partition(_threads.begin(), _threads.end(), [this](const std::thread& thread) {
+            return std::find(_finished.begin(), _finished.end(), thread.get_id()) == _finished.end();
+        });
+        std::move(done, _threads.end(), std::back_inserter(finished));
+        _threads.erase(done, _threads.end());
+        _finished.clear();
+    }
+    // Each has at most its return left to run
+    for (std::thread& thread : finished)
+        thread.join();
+}
+
+std::size_t MatrixServer::connectionThreads() {
+    std::lock_guard<std::mutex> lock(_connectionsMutex);
+    return _threads.size();
+}
+
+void MatrixServer::stop() noexcept {
+    _stopping = true;
+#ifdef MATRIX_SERVER_SOCKETS
+    const int listener = _listener.load();
+    if (listener >= 0) ::shutdown(listener, SHUT_RDWR); // wakes accept(); async-signal-safe
+#endif
+}
+
+void MatrixServer::serveConnection(const int socket) {
+#ifdef MATRIX_SERVER_SOCKETS
+    std::string received, responses;
+    while (!_stopping && receiveSome(socket, received)) {
+        // Answer every complete request received so far, then send the answers together
+        std::size_t offset = 0;
+        while (received.size() - offset >= MatrixProtocol::HEADER_BYTES) {
+            const MatrixProtocol::Header header = MatrixProtocol::decodeHeader(received.data() + offset);
+            if (header.payloadLength > _maxRequest) return;
+            const std::size_t frame = MatrixProtocol::HEADER_BYTES + header.payloadLength;
+            if (received.size() - offset < frame) break; // grown by what arrives, not by the header's claim
+            handleRequest(header, received.data() + offset + MatrixProtocol::HEADER_BYTES, responses);
+            offset += frame;
+        }
+        received.erase(0, offset);
+        if (!responses.empty()) {
+            if (!sendAll(socket, responses)) return;
+            responses.clear();
+        }
+    }
+#else
+    (void)socket;
+#endif
+}
+
+void MatrixServer::handleRequest(const MatrixProtocol::Header& header, const char* payload, std::string& response) {
+    MatrixProtocol::Writer writer(response);
+    std::string result;
+    MatrixProtocol::Writer out(result);
+    std::ostringstream messages;
+    Status status = Status::Ok;
+
+    try {
+        MatrixProtocol::Reader in(payload, header.payloadLength);
+        auto names = [&in](int count) {
+            std::vector<std::string> read(count);
+            for (std::string& name : read) name = in.str();
+            return read;
+        };
+        bool succeeded = true;
+
+        switch (static_cast<Opcode>(header.code)) {
+            case Opcode::Ping:
+                in.finish();
+                break;
+            case Opcode::Put: {
+                const std::string name = in.str();
+                Matrix matrix = in.matrix();
+                in.finish();
+                succeeded = _workspace.execute({}, {name}, [&](Workspace& w) {
+                    return w.putMatrix(name, std::move(matrix));
+                }, messages);
+                break;
+            }
+            case Opcode::Get: {
+                const std::string name = in.str();
+                in.finish();
+                Matrix copy;
+                succeeded = _workspace.execute({name}, {}, [&](Workspace& w) { return w.getMatrix(name, copy); },
+                                               messages);
+                if (succeeded) {
+                    try {
+                        out.matrix(copy);
+                    } catch (const MatrixServerError&) {
+                        messages << "Result too large: matrix '" << name << "' (" << copy.getRows() << " x "
+                                 << copy.getCols() << ") does not fit in one " << MatrixProtocol::MAX_PAYLOAD
+                                 << "-byte frame." << std::endl;
+                        succeeded = false;
+                    }
+                }
+                break;
+            }
+            case Opcode::Delete: {
+                const std::string name = in.str();
+                in.finish();
+                succeeded = _workspace.deleteMatrix(name, messages);
+                break;
+            }
+            case Opcode::List: {
+                in.finish();
+                const std::vector<std::string> all = _workspace.getMatrixNames();
+                out.u32(static_cast<std::uint32_t>(all.size()));
+                for (const std::string& name : all) out.str(name);
+                break;
+            }
+            case Opcode::Add:
+            case Opcode::Subtract:
+            case Opcode::Multiply: {
+                const std::vector<std::string> args = names(3);
+                in.finish();
+                const Opcode op = static_cast<Opcode>(header.code);
+                succeeded = op == Opcode::Add      ? _workspace.addMatrices(args[0], args[1], args[2], messages)
+                          : op == Opcode::Subtract ? _workspace.subtractMatrices(args[0], args[1], args[2], messages)
+                                                   : _workspace.multiplyMatrices(args[0], args[1], args[2], messages);
+                break;
+            }
+            case Opcode::Scale: {
+                const std::vector<std::string> args = names(2);
+                const double scalar = in.f64();
+                in.finish();
+                succeeded = _workspace.execute({args[1]}, {args[0]}, [&](Workspace& w) {
+                    return w.scalarMultiplyMatrix(args[0], args[1], scalar);
+                }, messages);
+                break;
+            }
+            case Opcode::Transpose: {
+                const std::string name = in.str();
+                in.finish();
+                succeeded = _workspace.execute({}, {name}, [&](Workspace& w) { return w.transposeMatrix(name); },
+                                               messages);
+                break;
+            }
+            case Opcode::Inverse: {
+                const std::vector<std::string> args = names(2);
+                in.finish();
+                succeeded = _workspace.execute({args[1]}, {args[0]}, [&](Workspace& w) {
+                    return w.inverseMatrix(args[0], args[1]);
+                }, messages);
+                break;
+            }
+            case Opcode::Solve: {
+                const std::vector<std::string> args = names(3);
+                in.finish();
+                succeeded = _workspace.execute({args[1], args[2]}, {args[0]}, [&](Workspace& w) {
+                    // Only a unique solution counts: the CLI also reports "no solution" as done
+                    SolveStatus status = SolveStatus::NoSolution;
+                    return w.solveMatrix(args[0], args[1], args[2], &status) && status == SolveStatus::Unique;
+                }, messages);
+                break;
+            }
+            case Opcode::LeastSquares: {
+                const std::vector<std::string> args = names(3);
+                in.finish();
+                int rank = 0;
+                double residual = 0.0;
+                succeeded = _workspace.execute({args[1], args[2]}, {args[0]}, [&](Workspace& w) {
+                    Matrix a, b;
+                    if (!w.getMatrix(args[1], a) || !w.getMatrix(args[2], b)) return false;
+                    try {
+                        const QRDecomposition qr(a);
+                        rank = qr.rank();
+                        return w.putMatrix(args[0], qr.leastSquares(b, &residual));
+                    } catch (const MatrixException& e) {
+                        w.output() << e.what() << std::endl; // the system's fault, not the request's
+                        return false;
+                    }
+                }, messages);
+                if (succeeded) {
+                    out.i32(rank);
+                    out.f64(residual);
+                }
+                break;
+            }
+            case Opcode::Rank: {
+                const std::string name = in.str();
+                in.finish();
+                std::optional<int> rank;
+                succeeded = _workspace.execute({name}, {}, [&](Workspace& w) {
+                    rank = w.rankOf(name);
+                    return rank.has_value();
+                }, messages);
+                if (succeeded) out.i32(*rank);
+                break;
+            }
+            case Opcode::Determinant: {
+                const std::string name = in.str();
+                in.finish();
+                std::optional<double> determinant;
+                succeeded = _workspace.execute({name}, {}, [&](Workspace& w) {
+                    determinant = w.determinantOf(name);
+                    return determinant.has_value();
+                }, messages);
+                if (succeeded) out.f64(*determinant);
+                break;
+            }
+            case Opcode::Save:
+            case Opcode::Load: {
+                const std::string filename = in.str();
+                in.finish();
+                if (!isPlainFileName(filename))
+                    throw MatrixServerError("invalid file name '" + filename + "'");
+                succeeded = static_cast<Opcode>(header.code) == Opcode::Save
+                                ? _workspace.saveWorkspaceToFile(filename, messages)
+                                : _workspace.loadWorkspaceFromFile(filename, messages);
+                break;
+            }
+            default:
+                throw MatrixServerError("unknown opcode " + std::to_string(header.code));
+        }
+
+        if (!succeeded) {
+            status = Status::Failed;
+            result.clear();
+            out.str(failureMessage(messages));
+        }
+    } catch (const MatrixException& e) {
+        // Malformed requests, and matrices the payload cannot describe
+        status = Status::BadRequest;
+        result.clear();
+        out.str(e.what());
+    } catch (const std::exception& e) {
+        status = Status::Failed;
+        result.clear();
+        out.str(e.what());
+    }
+
+    writer.beginFrame(header.requestId, static_cast<std::uint8_t>(status));
+    response.append(result);
+    try {
+        writer.endFrame();
+    } catch (const MatrixServerError&) {
+        // endFrame() dropped the frame; answer with the reason instead
+        result.clear();
+        out.str("Result too large: it does not fit in one " + std::to_string(MatrixProtocol::MAX_PAYLOAD) +
+                "-byte frame.");
+        writer.beginFrame(header.requestId, static_cast<std::uint8_t>(Status::Failed));
+        response.append(result);
+        writer.endFrame();
+    }
+}
+
+// ========================= CLIENT =========================
+
+std::string MatrixClient::Response::message() const {
+    try {
+        MatrixProtocol::Reader in(payload.data(), payload.size());
+        return in.str();
+    } catch (const MatrixServerError&) {
+        return "invalid error response";
+    }
+}
+
+MatrixClient::MatrixClient(const std::string& host, const int port) {
+#ifdef MATRIX_SERVER_SOCKETS
+    addrinfo* address = resolve(host, port, false);
+    _socket = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+    if (_socket < 0 || ::connect(_socket, address->ai_addr, address->ai_addrlen) != 0) {
+        const std::string reason = std::strerror(errno);
+        ::freeaddrinfo(address);
+        if (_socket >= 0) ::close(_socket);
+        throw MatrixServerError("cannot connect to " + host + ":" + std::to_string(port) + ": " + reason);
+    }
+    ::freeaddrinfo(address);
+    setNoDelay(_socket);
+#else
+    (void)host;
+    (void)port;
+    throw MatrixServerError("sockets are not available on this platform");
+#endif
+}
+
+MatrixClient::~MatrixClient() {
+#ifdef MATRIX_SERVER_SOCKETS
+    if (_socket >= 0) ::close(_socket);
+#endif
+}
+
+std::uint32_t MatrixClient::send(const Opcode opcode, const std::string& payload) {
+    const std::uint32_t id = _nextId++;
+    std::string frame;
+    MatrixProtocol::Writer writer(frame);
+    writer.beginFrame(id, static_cast<std::uint8_t>(opcode));
+    frame.append(payload);
+    writer.endFrame();
+#ifdef MATRIX_SERVER_SOCKETS
+    if (!sendAll(_socket, frame))
+        throw MatrixServerError("connection closed while sending");
+#endif
+    return id;
+}
+
+MatrixClient::Response MatrixClient::receive() {
+#ifdef MATRIX_SERVER_SOCKETS
+    while (true) {
+        if (_received.size() >= MatrixProtocol::HEADER_BYTES) {
+            const MatrixProtocol::Header header = MatrixProtocol::decodeHeader(_received.data());
+            const std::size_t frame = MatrixProtocol::HEADER_BYTES + header.payloadLength;
+            if (_received.size() >= frame) {
+                Response response;
+                response.requestId = header.requestId;
+                response.status = static_cast<Status>(header.code);
+                response.payload = _received.substr(MatrixProtocol::HEADER_BYTES, header.payloadLength);
+                _received.erase(0, frame);
+                return response;
+            }
+            _received.reserve(frame);
+        }
+        if (!receiveSome(_socket, _received))
+            throw MatrixServerError("connection closed by the server");
+    }
+#else
+    throw MatrixServerError("sockets are not available on this platform");
+#endif
+}
+
+MatrixClient::Response MatrixClient::call(const Opcode opcode, const std::string& payload) {
+    send(opcode, payload);
+    Response response = receive();
+    if (!response.ok())
+        throw MatrixServerError(response.message());
+    return response;
+}
+
+void MatrixClient::ping() {
+    call(Opcode::Ping);
+}
+
+void MatrixClient::put(const std::string& name, const Matrix& matrix) {
+    std::string payload;
+    MatrixProtocol::Writer out(payload);
+    out.str(name);
+    out.matrix(matrix);
+    call(Opcode::Put, payload);
+}
+
+Matrix MatrixClient::get(const std::string& name) {
+    std::string payload;
+    MatrixProtocol::Writer(payload).str(name);
+    const Response response = call(Opcode::Get, payload);
+    MatrixProtocol::Reader in(response.payload.data(), response.payload.size());
+    return in.matrix();
+}
+
+void MatrixClient::remove(const std::string& name) {
+    std::string payload;
+    MatrixProtocol::Writer(payload).str(name);
+    call(Opcode::Delete, payload);
+}
+
+std::vector<std::string> MatrixClient::list() {
+    const Response response = call(Opcode::List);
+    MatrixProtocol::Reader in(response.payload.data(), response.payload.size());
+    std::vector<std::string> names(in.u32());
+    for (std::string& name : names) name = in.str();
+    return names;
+}
+
+namespace {
+    std::string threeNames(const std::string& a, const std::string& b, const std::string& c) {
+        std::string payload;
+        MatrixProtocol::Writer out(payload);
+        out.str(a);
+        out.str(b);
+        out.str(c);
+        return payload;
+    }
+}
+
+void MatrixClient::add(const std::string& result, const std::string& a, const std::string& b) {
+    call(Opcode::Add, threeNames(result, a, b));
+}
+
+void MatrixClient::subtract(const std::string& result, const std::string& a, const std::string& b) {
+    call(Opcode::Subtract, threeNames(result, a, b));
+}
+
+void MatrixClient::multiply(const std::string& result, const std::string& a, const std::string& b) {
+    call(Opcode::Multiply, threeNames(result, a, b));
+}
+
+void MatrixClient::solve(const std::string& result, const std::string& a, const std::string& b) {
+    call(Opcode::Solve, threeNames(result, a, b));
+}
+
+int MatrixClient::rank(const std::string& name) {
+    std::string payload;
+    MatrixProtocol::Writer(payload).str(name);
+    const Response response = call(Opcode::Rank, payload);
+    return MatrixProtocol::Reader(response.payload.data(), response.payload.size()).i32();
+}
+
+double MatrixClient::determinant(const std::string& name) {
+    std::string payload;
+    MatrixProtocol::Writer(payload).str(name);
+    const Response response = call(Opcode::Determinant, payload);
+    return MatrixProtocol::Reader(response.payload.data(), response.payload.size()).f64();
+}
@@ -0,0 +1,432 @@
+#include "../include/OutOfCoreMatrix.h"
+#include "../include/MatrixAllocator.h"
+#include "../include/MatrixException.h"
+#include "../include/MatrixKernels.h"
+#include "../include/Parallel.h"
+#include "../include/Profiler.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <limits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define OUT_OF_CORE_MMAP 1
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+	constexpr int T = OutOfCoreMatrix::TILE;
+	constexpr std::size_t TILE_ELEMENTS = std::size_t(T) * T;
+
+	/**
+	 * Rows (or columns) of the tile at tileIndex that lie inside a dimension
+	 * of length extent; less than TILE only for the last tile.
+	 */
+	int tileExtent(int tileIndex, int extent) {
+		return std::min(T, extent - tileIndex * T);
+	}
+
+	std::size_t storageSize(int rows, int cols) {
+		const std::size_t tiles = std::size_t((rows + T - 1) / T) * std::size_t((cols + T - 1) / T);
+		if (tiles > std::numeric_limits<std::size_t>::max() / (TILE_ELEMENTS * sizeof(double)))
+			throw OutOfCoreStorageError("a " + std::to_string(rows) + "x" + std::to_string(cols) +
+			                            " matrix does not fit in the address space");
+		return tiles * TILE_ELEMENTS * sizeof(double);
+	}
+
+	/**
+	 * Zero-filled storage of the given size. With mmap it is a shared mapping
+	 * of a sparse temporary file that is unlinked straight away: the mapping
+	 * keeps the file alive, and the kernel reclaims it when the mapping goes.
+	 */
+	double* mapStorage(std::size_t bytes) {
+#ifdef OUT_OF_CORE_MMAP
+		std::string pattern;
+		try {
+			pattern = (std::filesystem::temp_directory_path() / "matrix-tiles-XXXXXX").string();
+		} catch (const std::filesystem::filesystem_error& e) {
+			throw OutOfCoreStorageError(std::string("no temporary directory (") + e.what() + ")");
+		}
+		std::vector<char> path(pattern.begin(), pattern.end());
+		path.push_back('\0');
+
+		const int fd = ::mkstemp(path.data());
+		if (fd < 0)
+			throw OutOfCoreStorageError("cannot create '" + pattern + "' (" + std::strerror(errno) + ")");
+		::unlink(path.data());
+		if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+			const int error = errno;
+			::close(fd);
+			throw OutOfCoreStorageError("cannot reserve " + std::to_string(bytes) + " bytes (" + std::strerror(error) + ")");
+		}
+		void* mapped = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		const int error = errno;
+		::close(fd); // the mapping stays valid
+		if (mapped == MAP_FAILED)
+			throw OutOfCoreStorageError("cannot map " + std::to_string(bytes) + " bytes (" + std::strerror(error) + ")");
+		return static_cast<double*>(mapped);
+#else
+		void* buffer = MatrixMemory::allocate(bytes);
+		std::memset(buffer, 0, bytes);
+		return static_cast<double*>(buffer);
+#endif
+	}
+
+	void unmapStorage(double* data, std::size_t bytes) noexcept {
+#ifdef OUT_OF_CORE_MMAP
+		::munmap(data, bytes);
+#else
+		MatrixMemory::deallocate(data, bytes);
+#endif
+	}
+}
+
+// ==== Construction ====
+
+OutOfCoreMatrix::OutOfCoreMatrix(int rows, int cols, double initValue) {
+	if (rows <= 0 || cols <= 0) {
+		throw MatrixInvalidInitialization();
+	}
+	_bytes = storageSize(rows, cols);
+	_data = mapStorage(_bytes);
+	_rows = rows;
+	_cols = cols;
+
+	if (initValue != 0.0) {
+		// Only the elements inside the matrix: padding stays zero
+		Parallel::parallelFor(0, tileRows(), 1, [&](int first, int last) {
+			for (int ti = first; ti < last; ++ti) {
+				const int h = tileExtent(ti, _rows);
+				for (int tj = 0; tj < tileCols(); ++tj) {
+					double* block = tile(ti, tj);
+					const int w = tileExtent(tj, _cols);
+					for (int r = 0; r < h; ++r)
+						std::fill(block + r * T, block + r * T + w, initValue);
+				}
+			}
+		});
+	}
+}
+
+OutOfCoreMatrix::OutOfCoreMatrix(const Matrix& matrix) : OutOfCoreMatrix(matrix.getRows(), matrix.getCols()) {
+	const double* source = matrix.data();
+	Parallel::parallelFor(0, tileRows(), 1, [&](int first, int last) {
+		for (int ti = first; ti < last; ++ti) {
+			const int h = tileExtent(ti, _rows);
+			for (int tj = 0; tj < tileCols(); ++tj) {
+				double* block = tile(ti, tj);
+				const int w = tileExtent(tj, _cols);
+				for (int r = 0; r < h; ++r) {
+					const double* row = source + (std::size_t(ti) * T + r) * _cols + std::size_t(tj) * T;
+					std::copy(row, row + w, block + r * T);
+				}
+			}
+		}
+	});
+}
+
+OutOfCoreMatrix::~OutOfCoreMatrix() {
+	release();
+}
+
+OutOfCoreMatrix::OutOfCoreMatrix(OutOfCoreMatrix&& other) noexcept
+	: _rows(other._rows), _cols(other._cols), _data(other._data), _bytes(other._bytes) {
+	other._rows = other._cols = 0;
+	other._data = nullptr;
+	other._bytes = 0;
+}
+
+OutOfCoreMatrix& OutOfCoreMatrix::operator=(OutOfCoreMatrix&& other) noexcept {
+	if (this != &other) {
+		release();
+		std::swap(_rows, other._rows);
+		std::swap(_cols, other._cols);
+		std::swap(_data, other._data);
+		std::swap(_bytes, other._bytes);
+	}
+	return *this;
+}
+
+void OutOfCoreMatrix::release() noexcept {
+	if (_data) unmapStorage(_data, _bytes);
+	_data = nullptr;
+	_bytes = 0;
+	_rows = _cols = 0;
+}
+
+OutOfCoreMatrix OutOfCoreMatrix::copy() const {
+	if (!_data) return OutOfCoreMatrix();
+	OutOfCoreMatrix result(_rows, _cols);
+	std::memcpy(result._data, _data, _bytes);
+	return result;
+}
+
+Matrix OutOfCoreMatrix::toMatrix() const {
+	Matrix result(_rows, _cols);
+	double* target = result.data();
+	Parallel::parallelFor(0, tileRows(), 1, [&](int first, int last) {
+		for (int ti = first; ti < last; ++ti) {
+			const int h = tileExtent(ti, _rows);
+			for (int tj = 0; tj < tileCols(); ++tj) {
+				const double* block = tile(ti, tj);
+				const int w = tileExtent(tj, _cols);
+				for (int r = 0; r < h; ++r)
+					std::copy(block + r * T, block + r * T + w,
+					          target + (std::size_t(ti) * T + r) * _cols + std::size_t(tj) * T);
+			}
+		}
+	});
+	return result;
+}
+
+// ==== Element Access ====
+
+std::size_t OutOfCoreMatrix::offset(int row, int col) const {
+	const std::size_t tileIndex = std::size_t(row / T) * tileCols() + col / T;
+	return tileIndex * TILE_ELEMENTS + std::size_t(row % T) * T + col % T;
+}
+
+double OutOfCoreMatrix::operator()(int row, int col) const {
+	if (row < 0 || row >= _rows || col < 0 || col >= _cols) {
+		throw MatrixOutOfBounds(_rows, _cols);
+	}
+	return _data[offset(row, col)];
+}
+
+double& OutOfCoreMatrix::operator()(int row, int col) {
+	if (row < 0 || row >= _rows || col < 0 || col >= _cols) {
+		throw MatrixOutOfBounds(_rows, _cols);
+	}
+	return _data[offset(row, col)];
+}
+
+double* OutOfCoreMatrix::tile(int tileRow, int tileCol) {
+	return _data + (std::size_t(tileRow) * tileCols() + tileCol) * TILE_ELEMENTS;
+}
+
+const double* OutOfCoreMatrix::tile(int tileRow, int tileCol) const {
+	return _data + (std::size_t(tileRow) * tileCols() + tileCol) * TILE_ELEMENTS;
+}
+
+// ==== Operations ====
+
+OutOfCoreMatrix OutOfCoreMatrix::operator*(const OutOfCoreMatrix& other) const {
+	MATRIX_PROFILE_WORK("OutOfCoreMatrix::multiply", 2.0 * _rows * _cols * other._cols);
+	if (_cols != other._rows) {
+		throw MatrixDimensionMismatch(_rows, _cols, other._rows, other._cols);
+	}
+	OutOfCoreMatrix result(_rows, other._cols);
+
+	// One result tile at a time, so only it and a row and column of operand tiles are hot
+	for (int i = 0; i < tileRows(); ++i) {
+		const int h = tileExtent(i, _rows);
+		for (int j = 0; j < other.tileCols(); ++j) {
+			const int w = tileExtent(j, other._cols);
+			double* target = result.tile(i, j);
+			for (int k = 0; k < tileCols(); ++k) {
+				MatrixKernels::gemm(h, w, tileExtent(k, _cols),
+				                    1.0, tile(i, k), T, other.tile(k, j), T,
+				                    1.0, target, T);
+			}
+		}
+	}
+	return result;
+}
+
+Matrix OutOfCoreMatrix::operator*(const Matrix& other) const {
+	MATRIX_PROFILE_WORK("OutOfCoreMatrix::multiply", 2.0 * _rows * _cols * other.getCols());
+	if (_cols != other.getRows()) {
+		throw MatrixDimensionMismatch(_rows, _cols, other.getRows(), other.getCols());
+	}
+	const int p = other.getCols();
+	Matrix result(_rows, p);
+	for (int i = 0; i < tileRows(); ++i) {
+		double* target = result.data() + std::size_t(i) * T * p;
+		for (int k = 0; k < tileCols(); ++k) {
+			MatrixKernels::gemm(tileExtent(i, _rows), p, tileExtent(k, _cols),
+			                    1.0, tile(i, k), T, other.data() + std::size_t(k) * T * p, p,
+			                    1.0, target, p);
+		}
+	}
+	return result;
+}
+
+OutOfCoreMatrix OutOfCoreMatrix::transpose() const {
+	MATRIX_PROFILE("OutOfCoreMatrix::transpose");
+	OutOfCoreMatrix result(_cols, _rows);
+	Parallel::parallelFor(0, tileRows(), 1, [&](int first, int last) {
+		for (int i = first; i < last; ++i)
+			for (int j = 0; j < tileCols(); ++j)
+				MatrixKernels::transpose(tileExtent(i, _rows), tileExtent(j, _cols), tile(i, j), T, result.tile(j, i), T);
+	});
+	return result;
+}
+
+void OutOfCoreMatrix::factorInPlace(std::vector<int>& pivots) {
+	const int n = _rows;
+	const int tiles = tileRows();
+	pivots.assign(n, 0);
+	std::vector<double> panel;
+
+	for (int k = 0; k < tiles; ++k) {
+		const int c0 = k * T;
+		const int w = tileExtent(k, n);
+		const int h = n - c0;
+
+		// Gather the panel (tile column k from the diagonal down) into memory
+		panel.resize(std::size_t(h) * w);
+		for (int r = 0; r < h; ++r) {
+			const double* source = tile((c0 + r) / T, k) + ((c0 + r) % T) * T;
+			std::copy(source, source + w, panel.data() + std::size_t(r) * w);
+		}
+
+		// Unblocked LU of the h x w panel, pivoting over the whole column
+		for (int c = 0; c < w; ++c) {
+			int pivotRow = c;
+			double maxElement = std::abs(panel[std::size_t(c) * w + c]);
+			for (int r = c + 1; r < h; ++r) {
+				const double value = std::abs(panel[std::size_t(r) * w + c]);
+				if (value > maxElement) {
+					maxElement = value;
+					pivotRow = r;
+				}
+			}
+			if (maxElement < ScalarTraits<double>::epsilon) {
+				throw MatrixSingular();
+			}
+			pivots[c0 + c] = c0 + pivotRow;
+			if (pivotRow != c) {
+				std::swap_ranges(panel.data() + std::size_t(c) * w, panel.data() + std::size_t(c + 1) * w,
+				                 panel.data() + std::size_t(pivotRow) * w);
+			}
+
+			const double* pivotValues = panel.data() + std::size_t(c) * w;
+			const double pivot = pivotValues[c];
+			Parallel::parallelFor(c + 1, h, Parallel::minChunkFor(w - c), [&](int first, int last) {
+				for (int r = first; r < last; ++r) {
+					double* row = panel.data() + std::size_t(r) * w;
+					row[c] /= pivot;
+					MatrixKernels::axpy(w - c - 1, -row[c], pivotValues + c + 1, row + c + 1);
+				}
+			});
+		}
+
+		// Scatter it back
+		for (int r = 0; r < h; ++r) {
+			const double* source = panel.data() + std::size_t(r) * w;
+			std::copy(source, source + w, tile((c0 + r) / T, k) + ((c0 + r) % T) * T);
+		}
+
+		// Apply the panel's row swaps to every other tile column
+		Parallel::parallelFor(0, tiles, 1, [&](int first, int last) {
+			for (int j = first; j < last; ++j) {
+				if (j == k) continue;
+				for (int c = 0; c < w; ++c) {
+					const int a = c0 + c;
+					const int b = pivots[a];
+					if (a == b) continue;
+					double* rowA = tile(a / T, j) + (a % T) * T;
+					std::swap_ranges(rowA, rowA + T, tile(b / T, j) + (b % T) * T);
+				}
+			}
+		});
+
+		// Block row of U: solve L(k, k) * U(k, j) = A(k, j), L unit lower triangular
+		const double* diagonal = tile(k, k);
+		Parallel::parallelFor(k + 1, tiles, 1, [&](int first, int last) {
+			for (int j = first; j < last; ++j) {
+				double* block = tile(k, j);
+				for (int r = 1; r < w; ++r)
+					for (int s = 0; s < r; ++s)
+						MatrixKernels::axpy(T, -diagonal[r * T + s], block + s * T, block + r * T);
+			}
+		});
+
+		// Trailing update: A(i, j) -= L(i, k) * U(k, j)
+		for (int i = k + 1; i < tiles; ++i) {
+			const int hi = tileExtent(i, n);
+			for (int j = k + 1; j < tiles; ++j) {
+				MatrixKernels::gemm(hi, tileExtent(j, n), w,
+				                    -1.0, tile(i, k), T, tile(k, j), T,
+				                    1.0, tile(i, j), T);
+			}
+		}
+	}
+}
+
+Matrix OutOfCoreMatrix::solve(const Matrix& b) const {
+	MATRIX_PROFILE("OutOfCoreMatrix::solve");
+	if (_rows != _cols) {
+		throw MatrixNotSquare();
+	}
+	if (b.getRows() != _rows) {
+		throw MatrixDimensionMismatch(_rows, _cols, b.getRows(), b.getCols());
+	}
+
+	OutOfCoreMatrix lu = copy();
+	std::vector<int> pivots;
+	lu.factorInPlace(pivots);
+
+	const int n = _rows;
+	const int tiles = tileRows();
+	const int p = b.getCols();
+	Matrix x(b);
+	auto row = [&](int r) { return x.data() + std::size_t(r) * p; };
+
+	for (int i = 0; i < n; ++i) {
+		if (pivots[i] != i) std::swap_ranges(row(i), row(i) + p, row(pivots[i]));
+	}
+
+	// Forward substitution with the unit lower triangle, one tile column at a time
+	for (int k = 0; k < tiles; ++k) {
+		const int c0 = k * T;
+		const int w = tileExtent(k, n);
+		const double* diagonal = lu.tile(k, k);
+		for (int r = 1; r < w; ++r)
+			for (int s = 0; s < r; ++s)
+				MatrixKernels::axpy(p, -diagonal[r * T + s], row(c0 + s), row(c0 + r));
+		for (int i = k + 1; i < tiles; ++i) {
+			MatrixKernels::gemm(tileExtent(i, n), p, w,
+			                    -1.0, lu.tile(i, k), T, row(c0), p,
+			                    1.0, row(i * T), p);
+		}
+	}
+
+	// Backward substitution with the upper triangle, one tile row at a time
+	for (int k = tiles - 1; k >= 0; --k) {
+		const int c0 = k * T;
+		const int w = tileExtent(k, n);
+		for (int j = k + 1; j < tiles; ++j) {
+			MatrixKernels::gemm(w, p, tileExtent(j, n),
+			                    -1.0, lu.tile(k, j), T, row(j * T), p,
+			                    1.0, row(c0), p);
+		}
+		const double* diagonal = lu.tile(k, k);
+		for (int r = w - 1; r >= 0; --r) {
+			for (int s = r + 1; s < w; ++s)
+				MatrixKernels::axpy(p, -diagonal[r * T + s], row(c0 + s), row(c0 + r));
+			MatrixKernels::scale(p, 1.0 / diagonal[r * T + r], row(c0 + r));
+		}
+	}
+	return x;
+}
+
+std::ostream& operator<<(std::ostream& os, const OutOfCoreMatrix& matrix) {
+	os << std::fixed << std::setprecision(3);
+	const int width = 7;
+
+	for (int row = 0; row < matrix._rows; ++row) {
+		os << "|";
+		for (int col = 0; col < matrix._cols; ++col) {
+			os << std::setw(width) << matrix._data[matrix.offset(row, col)] << "|";
+		}
+		os << '\n';
+	}
+
+	return os;
+}
@@ -0,0 +1,127 @@
+#include "../include/Parallel.h"
+#include "../include/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace {
+	// Process-wide default, stored as atomics so reads never lock
+	std::atomic<bool> defaultSerial{false};
+	std::atomic<unsigned> defaultThreads{0};
+	std::atomic<bool> defaultStrassen{false};
+
+	// Innermost ScopedPolicy of this thread, if any
+	thread_local const ExecutionPolicy* scopedPolicy = nullptr;
+
+	unsigned hardwareThreads() {
+		unsigned n = std::thread::hardware_concurrency();
+		return n == 0 ? 1 : n;
+	}
+}
+
+unsigned ExecutionPolicy::maxThreads() const {
+	if (mode == Mode::Serial) return 1;
+	return threads == 0 ? hardwareThreads() : threads;
+}
+
+std::string ExecutionPolicy::describe() const {
+	const unsigned n = maxThreads();
+	const std::string threading = mode == Mode::Serial
+		? "serial"
+		: "parallel (" + std::to_string(n) + (n == 1 ? " thread)" : " threads)");
+	return multiply == Multiply::Strassen ? threading + ", Strassen multiply" : threading;
+}
+
+namespace Parallel {
+
+	int minChunkFor(long long workPerIndex) {
+		if (workPerIndex <= 0) return 1;
+		const long long chunk = (MIN_PARALLEL_WORK + workPerIndex - 1) / workPerIndex;
+		return static_cast<int>(std::max(1LL, chunk));
+	}
+
+	ExecutionPolicy defaultPolicy() {
+		ExecutionPolicy policy = defaultSerial.load(std::memory_order_relaxed)
+			? ExecutionPolicy::serial()
+			: ExecutionPolicy::parallel(defaultThreads.load(std::memory_order_relaxed));
+		if (defaultStrassen.load(std::memory_order_relaxed))
+			policy.multiply = ExecutionPolicy::Multiply::Strassen;
+		return policy;
+	}
+
+	void setDefaultPolicy(const ExecutionPolicy& policy) {
+		defaultThreads.store(policy.threads, std::memory_order_relaxed);
+		defaultSerial.store(policy.mode == ExecutionPolicy::Mode::Serial, std::memory_order_relaxed);
+		defaultStrassen.store(policy.multiply == ExecutionPolicy::Multiply::Strassen, std::memory_order_relaxed);
+	}
+
+	ExecutionPolicy currentPolicy() {
+		return scopedPolicy ? *scopedPolicy : defaultPolicy();
+	}
+
+	unsigned workerCount() {
+		return currentPolicy().maxThreads();
+	}
+
+	ScopedPolicy::ScopedPolicy(const ExecutionPolicy& policy)
+		:_policy(policy), _previous(scopedPolicy) {
+		scopedPolicy = &_policy;
+	}
+
+	ScopedPolicy::~ScopedPolicy() {
+		scopedPolicy = _previous;
+	}
+
+	void parallelFor(int begin, int end, int minChunk,
+	                 const std::function<void(int, int)>& body) {
+		if (end <= begin) return;
+		const int total = end - begin;
+		minChunk = std::max(minChunk, 1);
+
+		const ExecutionPolicy policy = currentPolicy();
+		const int chunks = std::min<long long>(policy.maxThreads(), total / minChunk);
+		if (chunks <= 1) {
+			body(begin, end);
+			return;
+		}
+
+		// Spread the remainder over the first chunks so sizes differ by at most one
+		const int base = total / chunks;
+		const int extra = total % chunks;
+
+		std::atomic<int> remaining{chunks};
+		std::exception_ptr failure;
+		std::mutex failureMutex;
+		auto run = [&](int b, int e) {
+			try {
+				// Nested parallel regions inside a task follow the caller's policy
+				ScopedPolicy inherit(policy);
+				body(b, e);
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(failureMutex);
+				if (!failure) failure = std::current_exception();
+			}
+			remaining.fetch_sub(1, std::memory_order_acq_rel);
+		};
+
+		ThreadPool& pool = ThreadPool::shared();
+		int chunkBegin = begin;
+		for (int c = 0; c < chunks - 1; ++c) {
+			const int chunkEnd = chunkBegin + base + (c < extra ? 1 : 0);
+			pool.submit([&run, chunkBegin, chunkEnd] { run(chunkBegin, chunkEnd); });
+			chunkBegin = chunkEnd;
+		}
+		run(chunkBegin, end); // the caller takes the last chunk
+
+		// Help out instead of blocking: this also runs our own chunks if every
+		// worker is busy (or the pool has none), so nesting cannot deadlock.
+		while (remaining.load(std::memory_order_acquire) > 0) {
+			if (!pool.tryRunPendingTask())
+				std::this_thread::yield();
+		}
+
+		if (failure) std::rethrow_exception(failure);
+	}
+}
@@ -0,0 +1,174 @@
+#include "../include/Profiler.h"
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+	using Clock = std::chrono::steady_clock;
+
+	/**
+	 * Sites live for the whole program: their addresses are cached in
+	 * function-local statics at every instrumented scope.
+	 */
+	struct Registry {
+		std::mutex mutex;
+		std::map<std::string, std::unique_ptr<Profiler::Site>> sites;
+	};
+
+	Registry& registry() {
+		static Registry* instance = new Registry();
+		return *instance;
+	}
+
+	struct Event {
+		const Profiler::Site* site;
+		Clock::time_point start;
+		Clock::time_point end;
+		int thread;
+		std::uint64_t bytes;
+		double flops;
+	};
+
+	struct Trace {
+		std::atomic<bool> recording{false};
+		std::mutex mutex;
+		Clock::time_point epoch;
+		std::vector<Event> events;
+		std::map<std::thread::id, int> threads; ///< Small, stable ids for the "tid" field.
+		std::size_t dropped = 0;
+	};
+
+	Trace& trace() {
+		static Trace* instance = new Trace();
+		return *instance;
+	}
+
+	void writeEscaped(std::ostream& out, const std::string& text) {
+		for (char c : text) {
+			if (c == '"' || c == '\\') out << '\\';
+			out << c;
+		}
+	}
+
+	double microseconds(Clock::duration d) {
+		return std::chrono::duration<double, std::micro>(d).count();
+	}
+}
+
+namespace Profiler {
+
+	Counters Site::snapshot() const {
+		return { _name,
+		         _calls.load(std::memory_order_relaxed),
+		         _nanoseconds.load(std::memory_order_relaxed),
+		         _bytes.load(std::memory_order_relaxed),
+		         _flops.load(std::memory_order_relaxed) };
+	}
+
+	void Site::reset() noexcept {
+		_calls.store(0, std::memory_order_relaxed);
+		_nanoseconds.store(0, std::memory_order_relaxed);
+		_bytes.store(0, std::memory_order_relaxed);
+		_flops.store(0, std::memory_order_relaxed);
+	}
+
+	Site& site(const std::string& name) {
+		Registry& r = registry();
+		std::lock_guard<std::mutex> lock(r.mutex);
+		std::unique_ptr<Site>& entry = r.sites[name];
+		if (!entry) entry = std::make_unique<Site>(name);
+		return *entry;
+	}
+
+	std::vector<Counters> statistics() {
+		Registry& r = registry();
+		std::lock_guard<std::mutex> lock(r.mutex);
+		std::vector<Counters> result;
+		for (const auto& [name, site] : r.sites) {
+			Counters counters = site->snapshot();
+			if (counters.calls > 0) result.push_back(std::move(counters));
+		}
+		return result;
+	}
+
+	void reset() {
+		Registry& r = registry();
+		std::lock_guard<std::mutex> lock(r.mutex);
+		for (auto& [name, site] : r.sites)
+			site->reset();
+	}
+
+	void startTrace() {
+		Trace& t = trace();
+		std::lock_guard<std::mutex> lock(t.mutex);
+		t.events.clear();
+		t.threads.clear();
+		t.dropped = 0;
+		t.epoch = Clock::now();
+		t.recording.store(true, std::memory_order_release);
+	}
+
+	bool isTracing() {
+		return trace().recording.load(std::memory_order_relaxed);
+	}
+
+	std::size_t droppedTraceEvents() {
+		Trace& t = trace();
+		std::lock_guard<std::mutex> lock(t.mutex);
+		return t.dropped;
+	}
+
+	void traceEvent(const Site& site, Clock::time_point start, Clock::time_point end, std::uint64_t bytes, double flops) {
+		Trace& t = trace();
+		std::lock_guard<std::mutex> lock(t.mutex);
+		if (!t.recording.load(std::memory_order_relaxed) || start < t.epoch) return;
+		if (t.events.size() >= MAX_TRACE_EVENTS) {
+			++t.dropped;
+			return;
+		}
+		const auto thread = t.threads.emplace(std::this_thread::get_id(), static_cast<int>(t.threads.size())).first;
+		t.events.push_back({ &site, start, end, thread->second, bytes, flops });
+	}
+
+	std::size_t writeTrace(const std::string& path) {
+		Trace& t = trace();
+		std::vector<Event> events;
+		Clock::time_point epoch;
+		{
+			std::lock_guard<std::mutex> lock(t.mutex);
+			t.recording.store(false, std::memory_order_relaxed);
+			events.swap(t.events);
+			epoch = t.epoch;
+		}
+
+		std::ofstream out(path);
+		if (!out)
+			throw std::runtime_error("cannot write '" + path + "'");
+
+		// Chrome trace event format: timestamps and durations in microseconds.
+		// The category is the part of the name before "::".
+		out << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+		for (std::size_t i = 0; i < events.size(); ++i) {
+			const Event& e = events[i];
+			const std::string& name = e.site->name();
+			out << "{\"name\": \"";
+			writeEscaped(out, name);
+			out << "\", \"cat\": \"";
+			writeEscaped(out, name.substr(0, name.find("::")));
+			out << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << e.thread
+			    << ", \"ts\": " << microseconds(e.start - epoch)
+			    << ", \"dur\": " << microseconds(e.end - e.start)
+			    << ", \"args\": {\"bytes\": " << e.bytes << ", \"flops\": " << std::setprecision(0) << e.flops
+			    << std::setprecision(3) << "}}" << (i + 1 < events.size() ? ",\n" : "\n");
+		}
+		out << "]}\n";
+		if (!out)
+			throw std::runtime_error("cannot write '" + path + "'");
+		return events.size();
+	}
+}
@@ -0,0 +1,271 @@
+#include "../include/QRDecomposition.h"
+#include "../include/MatrixException.h"
+#include "../include/MatrixKernels.h"
+#include "../include/Parallel.h"
+#include "../include/Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace {
+	constexpr int PANEL_WIDTH = 32; // reflectors accumulated before each trailing update
+	constexpr double EPS = std::numeric_limits<double>::epsilon();
+
+	inline std::ptrdiff_t offset(int row, int ld) {
+		return static_cast<std::ptrdiff_t>(row) * ld;
+	}
+
+	/**
+	 * Norm of column col over rows [first, rows), accumulated with scaling
+	 * so that neither tiny nor huge elements lose precision.
+	 */
+	double columnNorm(const double* a, int rows, int cols, int first, int col) {
+		double scale = 0.0, sum = 1.0;
+		for (int i = first; i < rows; ++i) {
+			const double v = std::abs(a[offset(i, cols) + col]);
+			if (v == 0.0) continue;
+			if (scale < v) {
+				sum = 1.0 + sum * (scale / v) * (scale / v);
+				scale = v;
+			} else {
+				sum += (v / scale) * (v / scale);
+			}
+		}
+		return scale * std::sqrt(sum);
+	}
+
+	double frobeniusNorm(const Matrix& m) {
+		double sum = 0.0;
+		const double* data = m.data();
+		const std::size_t count = static_cast<std::size_t>(m.getRows()) * m.getCols();
+		for (std::size_t i = 0; i < count; ++i) sum += data[i] * data[i];
+		return std::sqrt(sum);
+	}
+}
+
+QRDecomposition::QRDecomposition(const Matrix& matrix)
+	:_qr(matrix), _tau(), _permutation(), _rank(0), _largestNorm(0.0), _tolerance(0.0) {
+	const int m = matrix.getRows(), n = matrix.getCols();
+	MATRIX_PROFILE_WORK("QRDecomposition::factor", 2.0 * m * n * std::min(m, n));
+	_qr.detach(); // factored in place: stop sharing the input's elements
+	_permutation.resize(n);
+	std::iota(_permutation.begin(), _permutation.end(), 0);
+	const int steps = std::min(m, n);
+	_tau.assign(steps, 0.0);
+	if (steps == 0) return;
+
+	// norms[j] tracks the norm of column j below the factored rows, updated
+	// cheaply after every step; referenceNorms[j] is its last exact value
+	std::vector<double> norms(n);
+	for (int j = 0; j < n; ++j)
+		norms[j] = columnNorm(_qr.data(), m, n, 0, j);
+	std::vector<double> referenceNorms(norms);
+	_largestNorm = *std::max_element(norms.begin(), norms.end());
+	_tolerance = std::max(m, n) * EPS * _largestNorm;
+
+	std::vector<double> update(static_cast<std::size_t>(PANEL_WIDTH) * n);
+	bool exhausted = false;
+	while (_rank < steps && !exhausted)
+		_rank += factorPanel(_rank, std::min(PANEL_WIDTH, steps - _rank), norms, referenceNorms, update, exhausted);
+}
+
+int QRDecomposition::factorPanel(const int first, const int width, std::vector<double>& norms,
+                                 std::vector<double>& referenceNorms, std::vector<double>& update,
+                                 bool& exhausted) {
+	const int m = _qr.getRows(), n = _qr.getCols();
+	double* a = _qr.data();
+	auto at = [a, n](int i, int j) -> double& { return a[offset(i, n) + j]; };
+
+	// Row i of `update` holds F(:, i) of the panel: the rest of the matrix,
+	// as stored, minus V * Fᵀ is what it is after the panel's reflectors
+	std::fill(update.begin(), update.end(), 0.0);
+	auto f = [&update, n](int i, int j) -> double& { return update[offset(i, n) + j]; };
+
+	std::vector<int> stale; // columns whose updated norm lost too much precision
+	const double staleThreshold = std::sqrt(EPS);
+	int done = 0;
+	for (int j = 0; j < width; ++j) {
+		const int c = first + j;
+
+		// Pivot: the column with the largest remaining norm comes next
+		const int pivot = static_cast<int>(std::max_element(norms.begin() + c, norms.end()) - norms.begin());
+		if (pivot != c) {
+			for (int i = 0; i < m; ++i) std::swap(at(i, c), at(i, pivot));
+			for (int i = 0; i < j; ++i) std::swap(f(i, c), f(i, pivot));
+			std::swap(norms[c], norms[pivot]);
+			std::swap(referenceNorms[c], referenceNorms[pivot]);
+			std::swap(_permutation[c], _permutation[pivot]);
+		}
+
+		// Bring column c up to date with the panel's earlier reflectors
+		for (int i = c; i < m; ++i) {
+			double sum = 0.0;
+			for (int p = 0; p < j; ++p) sum += at(i, first + p) * f(p, c);
+			at(i, c) -= sum;
+		}
+
+		// Reflector zeroing column c below the diagonal
+		const double alpha = at(c, c);
+		const double below = columnNorm(a, m, n, c + 1, c);
+		const double beta = below == 0.0 ? alpha : -std::copysign(std::hypot(alpha, below), alpha);
+		if (std::abs(beta) <= _tolerance) {
+			// The rest is numerically dependent: R(0:c, :) is final, nothing else is needed
+			exhausted = true;
+			return done;
+		}
+		double tau = 0.0;
+		if (below != 0.0) {
+			tau = (beta - alpha) / beta;
+			const double scale = 1.0 / (alpha - beta);
+			for (int i = c + 1; i < m; ++i) at(i, c) *= scale;
+		}
+		at(c, c) = beta;
+		_tau[c] = tau;
+		done = j + 1;
+
+		// F(:, j) = tau * (A(c:m, c+1:n)ᵀ v - F w) with w = V(c:m, 0:j)ᵀ v,
+		// for the columns right of c only; v(c) is the implicit 1
+		if (tau != 0.0 && c + 1 < n) {
+			double* fj = update.data() + offset(j, n);
+			Parallel::parallelFor(c + 1, n, std::max(64, Parallel::minChunkFor(m - c)), [&](int c0, int c1) {
+				MatrixKernels::axpy(c1 - c0, tau, &at(c, c0), fj + c0);
+				for (int i = c + 1; i < m; ++i)
+					MatrixKernels::axpy(c1 - c0, tau * at(i, c), &at(i, c0), fj + c0);
+			});
+			for (int p = 0; p < j; ++p) {
+				double w = at(c, first + p);
+				for (int i = c + 1; i < m; ++i) w += at(i, first + p) * at(i, c);
+				if (w != 0.0) MatrixKernels::axpy(n - c - 1, -tau * w, &f(p, c + 1), fj + c + 1);
+			}
+		}
+
+		// Row c is final now: R(c, c+1:n) = A(c, c+1:n) - V(c, 0:j+1) F(c+1:n, 0:j+1)ᵀ
+		for (int p = 0; p <= j; ++p) {
+			const double v = p == j ? 1.0 : at(c, first + p);
+			if (v != 0.0) MatrixKernels::axpy(n - c - 1, -v, &f(p, c + 1), &at(c, c + 1));
+		}
+
+		// Remove row c from the remaining column norms
+		for (int col = c + 1; col < n; ++col) {
+			if (norms[col] == 0.0) continue;
+			const double ratio = std::abs(at(c, col)) / norms[col];
+			const double remaining = std::max(0.0, (1.0 - ratio) * (1.0 + ratio));
+			const double drift = norms[col] / referenceNorms[col];
+			if (remaining * drift * drift <= staleThreshold) stale.push_back(col);
+			else norms[col] *= std::sqrt(remaining);
+		}
+		if (!stale.empty()) break; // their norms need the updated columns
+	}
+
+	// Apply the panel to the rows below it: A22 -= V2 * F2ᵀ
+	const int next = first + done;
+	if (done > 0 && next < m && next < n) {
+		MatrixKernels::gemm(m - next, n - next, done,
+		                    -1.0, a + offset(next, n) + first, n,
+		                    update.data() + next, n,
+		                    1.0, a + offset(next, n) + next, n);
+	}
+	for (const int col : stale)
+		norms[col] = referenceNorms[col] = columnNorm(a, m, n, next, col);
+	return done;
+}
+
+int QRDecomposition::rows() const {
+	return _qr.getRows();
+}
+
+int QRDecomposition::cols() const {
+	return _qr.getCols();
+}
+
+int QRDecomposition::rank() const {
+	return _rank;
+}
+
+double QRDecomposition::tolerance() const {
+	return _tolerance;
+}
+
+const std::vector<int>& QRDecomposition::permutation() const {
+	return _permutation;
+}
+
+void QRDecomposition::applyQTranspose(Matrix& b) const {
+	const int m = _qr.getRows(), n = _qr.getCols(), p = b.getCols();
+	const double* a = _qr.data();
+	double* x = b.data();
+	std::vector<double> w(p);
+	for (int k = 0; k < _rank; ++k) {
+		if (_tau[k] == 0.0) continue;
+		// w = vᵀ B(k:m, :), then B(k:m, :) -= tau * v * w
+		std::copy(x + offset(k, p), x + offset(k, p) + p, w.begin());
+		for (int i = k + 1; i < m; ++i)
+			MatrixKernels::axpy(p, a[offset(i, n) + k], x + offset(i, p), w.data());
+		MatrixKernels::axpy(p, -_tau[k], w.data(), x + offset(k, p));
+		for (int i = k + 1; i < m; ++i)
+			MatrixKernels::axpy(p, -_tau[k] * a[offset(i, n) + k], w.data(), x + offset(i, p));
+	}
+}
+
+Matrix QRDecomposition::backSubstitute(const Matrix& c) const {
+	const int n = _qr.getCols(), p = c.getCols();
+	const double* r = _qr.data();
+	Matrix y(std::max(_rank, 1), p, 0.0);
+	for (int i = _rank - 1; i >= 0; --i) {
+		double* row = y.rowPtr(i);
+		std::copy(c.rowPtr(i), c.rowPtr(i) + p, row);
+		for (int l = i + 1; l < _rank; ++l)
+			MatrixKernels::axpy(p, -r[offset(i, n) + l], y.rowPtr(l), row);
+		MatrixKernels::scale(p, 1.0 / r[offset(i, n) + i], row);
+	}
+
+	// Undo the column permutation; dependent columns stay zero
+	Matrix x(n, p, 0.0);
+	for (int i = 0; i < _rank; ++i)
+		std::copy(y.rowPtr(i), y.rowPtr(i) + p, x.rowPtr(_permutation[i]));
+	return x;
+}
+
+SolveResult QRDecomposition::solve(const Matrix& b) const {
+	MATRIX_PROFILE("QRDecomposition::solve");
+	const int m = _qr.getRows(), n = _qr.getCols();
+	if (b.getRows() != m)
+		throw MatrixDimensionMismatch(m, n, b.getRows(), b.getCols());
+
+	// Qᵀb splits into the part in the range of A (rows below the rank) and
+	// the residual, which no x can reduce (the rows from the rank on)
+	Matrix c(b);
+	applyQTranspose(c);
+	double outside = 0.0;
+	for (int i = _rank; i < m; ++i)
+		for (int j = 0; j < c.getCols(); ++j)
+			outside += c(i, j) * c(i, j);
+	outside = std::sqrt(outside);
+	const double bNorm = frobeniusNorm(b);
+
+	if (outside > std::max(m, n + 1) * EPS * std::max(_largestNorm, bNorm))
+		return { SolveStatus::NoSolution, Matrix() };
+	if (_rank < n)
+		return { SolveStatus::Infinite, Matrix() };
+	return { SolveStatus::Unique, backSubstitute(c), 0, bNorm == 0.0 ? outside : outside / bNorm };
+}
+
+Matrix QRDecomposition::leastSquares(const Matrix& b, double* residual) const {
+	MATRIX_PROFILE("QRDecomposition::leastSquares");
+	const int m = _qr.getRows(), n = _qr.getCols();
+	if (b.getRows() != m)
+		throw MatrixDimensionMismatch(m, n, b.getRows(), b.getCols());
+
+	Matrix c(b);
+	applyQTranspose(c);
+	if (residual) {
+		double outside = 0.0;
+		for (int i = _rank; i < m; ++i)
+			for (int j = 0; j < c.getCols(); ++j)
+				outside += c(i, j) * c(i, j);
+		const double bNorm = frobeniusNorm(b);
+		*residual = bNorm == 0.0 ? std::sqrt(outside) : std::sqrt(outside) / bNorm;
+	}
+	return backSubstitute(c);
+}
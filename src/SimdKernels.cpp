@@ -0,0 +1,594 @@
+#include "../include/MatrixKernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define MATRIX_SIMD_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define MATRIX_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+// GCC and Clang need per-function target attributes to emit AVX code in a
+// translation unit compiled for the baseline ISA; MSVC accepts the
+// intrinsics unconditionally.
+#if defined(MATRIX_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define MATRIX_TARGET(isa) __attribute__((target(isa)))
+#define MATRIX_RUNTIME_DISPATCH 1
+#else
+#define MATRIX_TARGET(isa)
+#endif
+
+namespace {
+
+	using std::size_t;
+
+	/**
+	 * Table of element-wise kernels for one instruction set.
+	 */
+	struct ElementwiseKernels {
+		const char* name;
+		void (*add)(size_t, const double*, double*);
+		void (*subtract)(size_t, const double*, double*);
+		void (*scale)(size_t, double, double*);
+		void (*negate)(size_t, const double*, double*);
+		void (*axpy)(size_t, double, const double*, double*);
+		void (*transform3)(size_t, const double*, double*, double*, double*);
+		void (*addFloat)(size_t, const float*, float*);
+		void (*subtractFloat)(size_t, const float*, float*);
+		void (*scaleFloat)(size_t, float, float*);
+		void (*negateFloat)(size_t, const float*, float*);
+		void (*axpyFloat)(size_t, float, const float*, float*);
+	};
+
+	// ==== Scalar (portable fallback, also handles vector tails) ====
+
+	void addScalar(size_t n, const double* x, double* y) {
+		for (size_t i = 0; i < n; ++i) y[i] += x[i];
+	}
+
+	void subtractScalar(size_t n, const double* x, double* y) {
+		for (size_t i = 0; i < n; ++i) y[i] -= x[i];
+	}
+
+	void scaleScalar(size_t n, double alpha, double* y) {
+		for (size_t i = 0; i < n; ++i) y[i] *= alpha;
+	}
+
+	void negateScalar(size_t n, const double* x, double* y) {
+		for (size_t i = 0; i < n; ++i) y[i] = -1.0 * x[i];
+	}
+
+	void axpyScalar(size_t n, double alpha, const double* x, double* y) {
+		for (size_t i = 0; i < n; ++i) y[i] += alpha * x[i];
+	}
+
+	void transform3Scalar(size_t n, const double* m, double* x, double* y, double* z) {
+		for (size_t i = 0; i < n; ++i) {
+			const double xi = x[i], yi = y[i], zi = z[i];
+			x[i] = m[0] * xi + m[1] * yi + m[2] * zi;
+			y[i] = m[3] * xi + m[4] * yi + m[5] * zi;
+			z[i] = m[6] * xi + m[7] * yi + m[8] * zi;
+		}
+	}
+
+	// Single precision
+
+	void addFloatScalar(size_t n, const float* x, float* y) {
+		for (size_t i = 0; i < n; ++i) y[i] += x[i];
+	}
+
+	void subtractFloatScalar(size_t n, const float* x, float* y) {
+		for (size_t i = 0; i < n; ++i) y[i] -= x[i];
+	}
+
+	void scaleFloatScalar(size_t n, float alpha, float* y) {
+		for (size_t i = 0; i < n; ++i) y[i] *= alpha;
+	}
+
+	void negateFloatScalar(size_t n, const float* x, float* y) {
+		for (size_t i = 0; i < n; ++i) y[i] = -1.0f * x[i];
+	}
+
+	void axpyFloatScalar(size_t n, float alpha, const float* x, float* y) {
+		for (size_t i = 0; i < n; ++i) y[i] += alpha * x[i];
+	}
+
+	constexpr ElementwiseKernels SCALAR_KERNELS = {
+		"scalar", addScalar, subtractScalar, scaleScalar, negateScalar, axpyScalar, transform3Scalar,
+		addFloatScalar, subtractFloatScalar, scaleFloatScalar, negateFloatScalar, axpyFloatScalar
+	};
+
+#if defined(MATRIX_SIMD_X86)
+
+	// ==== SSE2 (baseline on every x86-64 CPU) ====
+
+	void addSse2(size_t n, const double* x, double* y) {
+		size_t i = 0;
+		for (; i + 2 <= n; i += 2)
+			_mm_storeu_pd(y + i, _mm_add_pd(_mm_loadu_pd(y + i), _mm_loadu_pd(x + i)));
+		addScalar(n - i, x + i, y + i);
+	}
+
+	void subtractSse2(size_t n, const double* x, double* y) {
+		size_t i = 0;
+		for (; i + 2 <= n; i += 2)
+			_mm_storeu_pd(y + i, _mm_sub_pd(_mm_loadu_pd(y + i), _mm_loadu_pd(x + i)));
+		subtractScalar(n - i, x + i, y + i);
+	}
+
+	void scaleSse2(size_t n, double alpha, double* y) {
+		const __m128d a = _mm_set1_pd(alpha);
+		size_t i = 0;
+		for (; i + 2 <= n; i += 2)
+			_mm_storeu_pd(y + i, _mm_mul_pd(_mm_loadu_pd(y + i), a));
+		scaleScalar(n - i, alpha, y + i);
+	}
+
+	void negateSse2(size_t n, const double* x, double* y) {
+		const __m128d minusOne = _mm_set1_pd(-1.0);
+		size_t i = 0;
+		for (; i + 2 <= n; i += 2)
+			_mm_storeu_pd(y + i, _mm_mul_pd(_mm_loadu_pd(x + i), minusOne));
+		negateScalar(n - i, x + i, y + i);
+	}
+
+	void axpySse2(size_t n, double alpha, const double* x, double* y) {
+		const __m128d a = _mm_set1_pd(alpha);
+		size_t i = 0;
+		for (; i + 2 <= n; i += 2)
+			_mm_storeu_pd(y + i, _mm_add_pd(_mm_loadu_pd(y + i), _mm_mul_pd(a, _mm_loadu_pd(x + i))));
+		axpyScalar(n - i, alpha, x + i, y + i);
+	}
+
+	void transform3Sse2(size_t n, const double* m, double* x, double* y, double* z) {
+		__m128d r[9];
+		for (int k = 0; k < 9; ++k) r[k] = _mm_set1_pd(m[k]);
+		size_t i = 0;
+		for (; i + 2 <= n; i += 2) {
+			const __m128d xi = _mm_loadu_pd(x + i), yi = _mm_loadu_pd(y + i), zi = _mm_loadu_pd(z + i);
+			_mm_storeu_pd(x + i, _mm_add_pd(_mm_add_pd(_mm_mul_pd(r[0], xi), _mm_mul_pd(r[1], yi)), _mm_mul_pd(r[2], zi)));
+			_mm_storeu_pd(y + i, _mm_add_pd(_mm_add_pd(_mm_mul_pd(r[3], xi), _mm_mul_pd(r[4], yi)), _mm_mul_pd(r[5], zi)));
+			_mm_storeu_pd(z + i, _mm_add_pd(_mm_add_pd(_mm_mul_pd(r[6], xi), _mm_mul_pd(r[7], yi)), _mm_mul_pd(r[8], zi)));
+		}
+		transform3Scalar(n - i, m, x + i, y + i, z + i);
+	}
+
+	// Single precision
+
+	void addFloatSse2(size_t n, const float* x, float* y) {
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4)
+			_mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_loadu_ps(x + i)));
+		addFloatScalar(n - i, x + i, y + i);
+	}
+
+	void subtractFloatSse2(size_t n, const float* x, float* y) {
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4)
+			_mm_storeu_ps(y + i, _mm_sub_ps(_mm_loadu_ps(y + i), _mm_loadu_ps(x + i)));
+		subtractFloatScalar(n - i, x + i, y + i);
+	}
+
+	void scaleFloatSse2(size_t n, float alpha, float* y) {
+		const __m128 a = _mm_set1_ps(alpha);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4)
+			_mm_storeu_ps(y + i, _mm_mul_ps(_mm_loadu_ps(y + i), a));
+		scaleFloatScalar(n - i, alpha, y + i);
+	}
+
+	void negateFloatSse2(size_t n, const float* x, float* y) {
+		const __m128 minusOne = _mm_set1_ps(-1.0f);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4)
+			_mm_storeu_ps(y + i, _mm_mul_ps(_mm_loadu_ps(x + i), minusOne));
+		negateFloatScalar(n - i, x + i, y + i);
+	}
+
+	void axpyFloatSse2(size_t n, float alpha, const float* x, float* y) {
+		const __m128 a = _mm_set1_ps(alpha);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4)
+			_mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(a, _mm_loadu_ps(x + i))));
+		axpyFloatScalar(n - i, alpha, x + i, y + i);
+	}
+
+	constexpr ElementwiseKernels SSE2_KERNELS = {
+		"sse2", addSse2, subtractSse2, scaleSse2, negateSse2, axpySse2, transform3Sse2,
+		addFloatSse2, subtractFloatSse2, scaleFloatSse2, negateFloatSse2, axpyFloatSse2
+	};
+
+	// ==== AVX2 ====
+
+	MATRIX_TARGET("avx2")
+	void addAvx2(size_t n, const double* x, double* y) {
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4)
+			_mm256_storeu_pd(y + i, _mm256_add_pd(_mm256_loadu_pd(y + i), _mm256_loadu_pd(x + i)));
+		addScalar(n - i, x + i, y + i);
+	}
+
+	MATRIX_TARGET("avx2")
+	void subtractAvx2(size_t n, const double* x, double* y) {
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4)
+			_mm256_storeu_pd(y + i, _mm256_sub_pd(_mm256_loadu_pd(y + i), _mm256_loadu_pd(x + i)));
+		subtractScalar(n - i, x + i, y + i);
+	}
+
+	MATRIX_TARGET("avx2")
+	void scaleAvx2(size_t n, double alpha, double* y) {
+		const __m256d a = _mm256_set1_pd(alpha);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4)
+			_mm256_storeu_pd(y + i, _mm256_mul_pd(_mm256_loadu_pd(y + i), a));
+		scaleScalar(n - i, alpha, y + i);
+	}
+
+	MATRIX_TARGET("avx2")
+	void negateAvx2(size_t n, const double* x, double* y) {
+		const __m256d minusOne = _mm256_set1_pd(-1.0);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4)
+			_mm256_storeu_pd(y + i, _mm256_mul_pd(_mm256_loadu_pd(x + i), minusOne));
+		negateScalar(n - i, x + i, y + i);
+	}
+
+	MATRIX_TARGET("avx2")
+	void axpyAvx2(size_t n, double alpha, const double* x, double* y) {
+		const __m256d a = _mm256_set1_pd(alpha);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4)
+			_mm256_storeu_pd(y + i, _mm256_add_pd(_mm256_loadu_pd(y + i), _mm256_mul_pd(a, _mm256_loadu_pd(x + i))));
+		axpyScalar(n - i, alpha, x + i, y + i);
+	}
+
+	MATRIX_TARGET("avx2")
+	void transform3Avx2(size_t n, const double* m, double* x, double* y, double* z) {
+		__m256d r[9];
+		for (int k = 0; k < 9; ++k) r[k] = _mm256_set1_pd(m[k]);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			const __m256d xi = _mm256_loadu_pd(x + i), yi = _mm256_loadu_pd(y + i), zi = _mm256_loadu_pd(z + i);
+			_mm256_storeu_pd(x + i, _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(r[0], xi), _mm256_mul_pd(r[1], yi)), _mm256_mul_pd(r[2], zi)));
+			_mm256_storeu_pd(y + i, _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(r[3], xi), _mm256_mul_pd(r[4], yi)), _mm256_mul_pd(r[5], zi)));
+			_mm256_storeu_pd(z + i, _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(r[6], xi), _mm256_mul_pd(r[7], yi)), _mm256_mul_pd(r[8], zi)));
+		}
+		transform3Scalar(n - i, m, x + i, y + i, z + i);
+	}
+
+	// Single precision
+
+	MATRIX_TARGET("avx2")
+	void addFloatAvx2(size_t n, const float* x, float* y) {
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8)
+			_mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_loadu_ps(x + i)));
+		addFloatScalar(n - i, x + i, y + i);
+	}
+
+	MATRIX_TARGET("avx2")
+	void subtractFloatAvx2(size_t n, const float* x, float* y) {
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8)
+			_mm256_storeu_ps(y + i, _mm256_sub_ps(_mm256_loadu_ps(y + i), _mm256_loadu_ps(x + i)));
+		subtractFloatScalar(n - i, x + i, y + i);
+	}
+
+	MATRIX_TARGET("avx2")
+	void scaleFloatAvx2(size_t n, float alpha, float* y) {
+		const __m256 a = _mm256_set1_ps(alpha);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8)
+			_mm256_storeu_ps(y + i, _mm256_mul_ps(_mm256_loadu_ps(y + i), a));
+		scaleFloatScalar(n - i, alpha, y + i);
+	}
+
+	MATRIX_TARGET("avx2")
+	void negateFloatAvx2(size_t n, const float* x, float* y) {
+		const __m256 minusOne = _mm256_set1_ps(-1.0f);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8)
+			_mm256_storeu_ps(y + i, _mm256_mul_ps(_mm256_loadu_ps(x + i), minusOne));
+		negateFloatScalar(n - i, x + i, y + i);
+	}
+
+	MATRIX_TARGET("avx2")
+	void axpyFloatAvx2(size_t n, float alpha, const float* x, float* y) {
+		const __m256 a = _mm256_set1_ps(alpha);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8)
+			_mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_mul_ps(a, _mm256_loadu_ps(x + i))));
+		axpyFloatScalar(n - i, alpha, x + i, y + i);
+	}
+
+	constexpr ElementwiseKernels AVX2_KERNELS = {
+		"avx2", addAvx2, subtractAvx2, scaleAvx2, negateAvx2, axpyAvx2, transform3Avx2,
+		addFloatAvx2, subtractFloatAvx2, scaleFloatAvx2, negateFloatAvx2, axpyFloatAvx2
+	};
+
+	// ==== AVX-512 ====
+
+	MATRIX_TARGET("avx512f")
+	void addAvx512(size_t n, const double* x, double* y) {
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8)
+			_mm512_storeu_pd(y + i, _mm512_add_pd(_mm512_loadu_pd(y + i), _mm512_loadu_pd(x + i)));
+		addScalar(n - i, x + i, y + i);
+	}
+
+	MATRIX_TARGET("avx512f")
+	void subtractAvx512(size_t n, const double* x, double* y) {
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8)
+			_mm512_storeu_pd(y + i, _mm512_sub_pd(_mm512_loadu_pd(y + i), _mm512_loadu_pd(x + i)));
+		subtractScalar(n - i, x + i, y + i);
+	}
+
+	MATRIX_TARGET("avx512f")
+	void scaleAvx512(size_t n, double alpha, double* y) {
+		const __m512d a = _mm512_set1_pd(alpha);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8)
+			_mm512_storeu_pd(y + i, _mm512_mul_pd(_mm512_loadu_pd(y + i), a));
+		scaleScalar(n - i, alpha, y + i);
+	}
+
+	MATRIX_TARGET("avx512f")
+	void negateAvx512(size_t n, const double* x, double* y) {
+		const __m512d minusOne = _mm512_set1_pd(-1.0);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8)
+			_mm512_storeu_pd(y + i, _mm512_mul_pd(_mm512_loadu_pd(x + i), minusOne));
+		negateScalar(n - i, x + i, y + i);
+	}
+
+	MATRIX_TARGET("avx512f")
+	void axpyAvx512(size_t n, double alpha, const double* x, double* y) {
+		const __m512d a = _mm512_set1_pd(alpha);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8)
+			_mm512_storeu_pd(y + i, _mm512_add_pd(_mm512_loadu_pd(y + i), _mm512_mul_pd(a, _mm512_loadu_pd(x + i))));
+		axpyScalar(n - i, alpha, x + i, y + i);
+	}
+
+	MATRIX_TARGET("avx512f")
+	void transform3Avx512(size_t n, const double* m, double* x, double* y, double* z) {
+		__m512d r[9];
+		for (int k = 0; k < 9; ++k) r[k] = _mm512_set1_pd(m[k]);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			const __m512d xi = _mm512_loadu_pd(x + i), yi = _mm512_loadu_pd(y + i), zi = _mm512_loadu_pd(z + i);
+			_mm512_storeu_pd(x + i, _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(r[0], xi), _mm512_mul_pd(r[1], yi)), _mm512_mul_pd(r[2], zi)));
+			_mm512_storeu_pd(y + i, _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(r[3], xi), _mm512_mul_pd(r[4], yi)), _mm512_mul_pd(r[5], zi)));
+			_mm512_storeu_pd(z + i, _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(r[6], xi), _mm512_mul_pd(r[7], yi)), _mm512_mul_pd(r[8], zi)));
+		}
+		transform3Scalar(n - i, m, x + i, y + i, z + i);
+	}
+
+	// Single precision
+
+	MATRIX_TARGET("avx512f")
+	void addFloatAvx512(size_t n, const float* x, float* y) {
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16)
+			_mm512_storeu_ps(y + i, _mm512_add_ps(_mm512_loadu_ps(y + i), _mm512_loadu_ps(x + i)));
+		addFloatScalar(n - i, x + i, y + i);
+	}
+
+	MATRIX_TARGET("avx512f")
+	void subtractFloatAvx512(size_t n, const float* x, float* y) {
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16)
+			_mm512_storeu_ps(y + i, _mm512_sub_ps(_mm512_loadu_ps(y + i), _mm512_loadu_ps(x + i)));
+		subtractFloatScalar(n - i, x + i, y + i);
+	}
+
+	MATRIX_TARGET("avx512f")
+	void scaleFloatAvx512(size_t n, float alpha, float* y) {
+		const __m512 a = _mm512_set1_ps(alpha);
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16)
+			_mm512_storeu_ps(y + i, _mm512_mul_ps(_mm512_loadu_ps(y + i), a));
+		scaleFloatScalar(n - i, alpha, y + i);
+	}
+
+	MATRIX_TARGET("avx512f")
+	void negateFloatAvx512(size_t n, const float* x, float* y) {
+		const __m512 minusOne = _mm512_set1_ps(-1.0f);
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16)
+			_mm512_storeu_ps(y + i, _mm512_mul_ps(_mm512_loadu_ps(x + i), minusOne));
+		negateFloatScalar(n - i, x + i, y + i);
+	}
+
+	MATRIX_TARGET("avx512f")
+	void axpyFloatAvx512(size_t n, float alpha, const float* x, float* y) {
+		const __m512 a = _mm512_set1_ps(alpha);
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16)
+			_mm512_storeu_ps(y + i, _mm512_add_ps(_mm512_loadu_ps(y + i), _mm512_mul_ps(a, _mm512_loadu_ps(x + i))));
+		axpyFloatScalar(n - i, alpha, x + i, y + i);
+	}
+
+	constexpr ElementwiseKernels AVX512_KERNELS = {
+		"avx512", addAvx512, subtractAvx512, scaleAvx512, negateAvx512, axpyAvx512, transform3Avx512,
+		addFloatAvx512, subtractFloatAvx512, scaleFloatAvx512, negateFloatAvx512, axpyFloatAvx512
+	};
+
+#elif defined(MATRIX_SIMD_NEON)
+
+	// ==== NEON (baseline on every AArch64 CPU) ====
+
+	void addNeon(size_t n, const double* x, double* y) {
+		size_t i = 0;
+		for (; i + 2 <= n; i += 2)
+			vst1q_f64(y + i, vaddq_f64(vld1q_f64(y + i), vld1q_f64(x + i)));
+		addScalar(n - i, x + i, y + i);
+	}
+
+	void subtractNeon(size_t n, const double* x, double* y) {
+		size_t i = 0;
+		for (; i + 2 <= n; i += 2)
+			vst1q_f64(y + i, vsubq_f64(vld1q_f64(y + i), vld1q_f64(x + i)));
+		subtractScalar(n - i, x + i, y + i);
+	}
+
+	void scaleNeon(size_t n, double alpha, double* y) {
+		const float64x2_t a = vdupq_n_f64(alpha);
+		size_t i = 0;
+		for (; i + 2 <= n; i += 2)
+			vst1q_f64(y + i, vmulq_f64(vld1q_f64(y + i), a));
+		scaleScalar(n - i, alpha, y + i);
+	}
+
+	void negateNeon(size_t n, const double* x, double* y) {
+		const float64x2_t minusOne = vdupq_n_f64(-1.0);
+		size_t i = 0;
+		for (; i + 2 <= n; i += 2)
+			vst1q_f64(y + i, vmulq_f64(vld1q_f64(x + i), minusOne));
+		negateScalar(n - i, x + i, y + i);
+	}
+
+	void axpyNeon(size_t n, double alpha, const double* x, double* y) {
+		const float64x2_t a = vdupq_n_f64(alpha);
+		size_t i = 0;
+		for (; i + 2 <= n; i += 2)
+			vst1q_f64(y + i, vaddq_f64(vld1q_f64(y + i), vmulq_f64(a, vld1q_f64(x + i))));
+		axpyScalar(n - i, alpha, x + i, y + i);
+	}
+
+	void transform3Neon(size_t n, const double* m, double* x, double* y, double* z) {
+		float64x2_t r[9];
+		for (int k = 0; k < 9; ++k) r[k] = vdupq_n_f64(m[k]);
+		size_t i = 0;
+		for (; i + 2 <= n; i += 2) {
+			const float64x2_t xi = vld1q_f64(x + i), yi = vld1q_f64(y + i), zi = vld1q_f64(z + i);
+			vst1q_f64(x + i, vaddq_f64(vaddq_f64(vmulq_f64(r[0], xi), vmulq_f64(r[1], yi)), vmulq_f64(r[2], zi)));
+			vst1q_f64(y + i, vaddq_f64(vaddq_f64(vmulq_f64(r[3], xi), vmulq_f64(r[4], yi)), vmulq_f64(r[5], zi)));
+			vst1q_f64(z + i, vaddq_f64(vaddq_f64(vmulq_f64(r[6], xi), vmulq_f64(r[7], yi)), vmulq_f64(r[8], zi)));
+		}
+		transform3Scalar(n - i, m, x + i, y + i, z + i);
+	}
+
+	// Single precision
+
+	void addFloatNeon(size_t n, const float* x, float* y) {
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4)
+			vst1q_f32(y + i, vaddq_f32(vld1q_f32(y + i), vld1q_f32(x + i)));
+		addFloatScalar(n - i, x + i, y + i);
+	}
+
+	void subtractFloatNeon(size_t n, const float* x, float* y) {
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4)
+			vst1q_f32(y + i, vsubq_f32(vld1q_f32(y + i), vld1q_f32(x + i)));
+		subtractFloatScalar(n - i, x + i, y + i);
+	}
+
+	void scaleFloatNeon(size_t n, float alpha, float* y) {
+		const float32x4_t a = vdupq_n_f32(alpha);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4)
+			vst1q_f32(y + i, vmulq_f32(vld1q_f32(y + i), a));
+		scaleFloatScalar(n - i, alpha, y + i);
+	}
+
+	void negateFloatNeon(size_t n, const float* x, float* y) {
+		const float32x4_t minusOne = vdupq_n_f32(-1.0f);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4)
+			vst1q_f32(y + i, vmulq_f32(vld1q_f32(x + i), minusOne));
+		negateFloatScalar(n - i, x + i, y + i);
+	}
+
+	void axpyFloatNeon(size_t n, float alpha, const float* x, float* y) {
+		const float32x4_t a = vdupq_n_f32(alpha);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4)
+			vst1q_f32(y + i, vaddq_f32(vld1q_f32(y + i), vmulq_f32(a, vld1q_f32(x + i))));
+		axpyFloatScalar(n - i, alpha, x + i, y + i);
+	}
+
+	constexpr ElementwiseKernels NEON_KERNELS = {
+		"neon", addNeon, subtractNeon, scaleNeon, negateNeon, axpyNeon, transform3Neon,
+		addFloatNeon, subtractFloatNeon, scaleFloatNeon, negateFloatNeon, axpyFloatNeon
+	};
+
+#endif
+
+	/**
+	 * Pick the widest back end the running CPU (and OS) supports.
+	 */
+	const ElementwiseKernels& selectKernels() {
+#if defined(MATRIX_RUNTIME_DISPATCH)
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512f")) return AVX512_KERNELS;
+		if (__builtin_cpu_supports("avx2")) return AVX2_KERNELS;
+		return SSE2_KERNELS;
+#elif defined(MATRIX_SIMD_X86)
+		return SSE2_KERNELS;
+#elif defined(MATRIX_SIMD_NEON)
+		return NEON_KERNELS;
+#else
+		return SCALAR_KERNELS;
+#endif
+	}
+
+	const ElementwiseKernels& kernels() {
+		static const ElementwiseKernels& selected = selectKernels();
+		return selected;
+	}
+}
+
+namespace MatrixKernels {
+
+	void add(size_t n, const double* x, double* y) {
+		kernels().add(n, x, y);
+	}
+
+	void subtract(size_t n, const double* x, double* y) {
+		kernels().subtract(n, x, y);
+	}
+
+	void scale(size_t n, double alpha, double* y) {
+		kernels().scale(n, alpha, y);
+	}
+
+	void negate(size_t n, const double* x, double* y) {
+		kernels().negate(n, x, y);
+	}
+
+	void axpy(size_t n, double alpha, const double* x, double* y) {
+		kernels().axpy(n, alpha, x, y);
+	}
+
+	void add(size_t n, const float* x, float* y) {
+		kernels().addFloat(n, x, y);
+	}
+
+	void subtract(size_t n, const float* x, float* y) {
+		kernels().subtractFloat(n, x, y);
+	}
+
+	void scale(size_t n, float alpha, float* y) {
+		kernels().scaleFloat(n, alpha, y);
+	}
+
+	void negate(size_t n, const float* x, float* y) {
+		kernels().negateFloat(n, x, y);
+	}
+
+	void axpy(size_t n, float alpha, const float* x, float* y) {
+		kernels().axpyFloat(n, alpha, x, y);
+	}
+
+	void transform3(size_t n, const double* m, double* x, double* y, double* z) {
+		kernels().transform3(n, m, x, y, z);
+	}
+
+	const char* simdBackendName() {
+		return kernels().name;
+	}
+}
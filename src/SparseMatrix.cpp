@@ -0,0 +1,453 @@
+#include "../include/SparseMatrix.h"
+#include "../include/MatrixException.h"
+#include "../include/Parallel.h"
+#include "../include/Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <utility>
+
+namespace {
+	void checkDimensions(int rows, int cols) {
+		if (rows <= 0 || cols <= 0)
+			throw MatrixInvalidInitialization();
+	}
+
+	/**
+	 * Rows per parallelFor task for a row-wise kernel doing totalWork
+	 * multiply-adds over rows rows, assuming the work is spread evenly.
+	 */
+	int rowsPerTask(long long totalWork, int rows) {
+		return Parallel::minChunkFor(totalWork / std::max(rows, 1) + 1);
+	}
+}
+
+// ==== Construction ====
+
+SparseMatrix::SparseMatrix(int rows, int cols)
+	:_rows(rows), _cols(cols) {
+	checkDimensions(rows, cols);
+	_rowStart.assign(static_cast<std::size_t>(rows) + 1, 0);
+}
+
+SparseMatrix::SparseMatrix(const Matrix& dense, double dropTolerance)
+	:_rows(dense.getRows()), _cols(dense.getCols()) {
+	_rowStart.reserve(static_cast<std::size_t>(_rows) + 1);
+	_rowStart.push_back(0);
+	const double* values = dense.data();
+	for (int r = 0; r < _rows; ++r) {
+		for (int c = 0; c < _cols; ++c) {
+			const double value = *values++;
+			if (!(std::abs(value) <= dropTolerance)) { // keeps NaN
+				_colIndex.push_back(c);
+				_values.push_back(value);
+			}
+		}
+		_rowStart.push_back(_values.size());
+	}
+}
+
+SparseMatrix SparseMatrix::fromTriplets(int rows, int cols, std::vector<Triplet> entries) {
+	SparseMatrix result(rows, cols);
+	for (const Triplet& entry : entries) {
+		if (entry.row < 0 || entry.row >= rows || entry.col < 0 || entry.col >= cols)
+			throw MatrixOutOfBounds(rows, cols);
+	}
+	std::sort(entries.begin(), entries.end(), [](const Triplet& a, const Triplet& b) {
+		return a.row != b.row ? a.row < b.row : a.col < b.col;
+	});
+
+	result._colIndex.reserve(entries.size());
+	result._values.reserve(entries.size());
+	std::size_t i = 0;
+	while (i < entries.size()) {
+		const Triplet& first = entries[i];
+		double sum = 0.0;
+		for (; i < entries.size() && entries[i].row == first.row && entries[i].col == first.col; ++i)
+			sum += entries[i].value;
+		if (sum != 0.0) {
+			result._colIndex.push_back(first.col);
+			result._values.push_back(sum);
+			++result._rowStart[first.row + 1];
+		}
+	}
+	for (int r = 0; r < rows; ++r)
+		result._rowStart[r + 1] += result._rowStart[r];
+	return result;
+}
+
+SparseMatrix SparseMatrix::fromCSR(int rows, int cols,
+                                   std::vector<std::size_t> rowStart,
+                                   std::vector<int> colIndex,
+                                   std::vector<double> values) {
+	checkDimensions(rows, cols);
+	if (rowStart.size() != static_cast<std::size_t>(rows) + 1 || rowStart.front() != 0)
+		throw MatrixInvalidSparseStructure("row offsets must have rows + 1 entries starting at 0");
+	if (rowStart.back() != colIndex.size() || colIndex.size() != values.size())
+		throw MatrixInvalidSparseStructure("row offsets, columns and values disagree on the entry count");
+	for (int r = 0; r < rows; ++r) {
+		if (rowStart[r] > rowStart[r + 1])
+			throw MatrixInvalidSparseStructure("row offsets must not decrease");
+		for (std::size_t p = rowStart[r]; p < rowStart[r + 1]; ++p) {
+			if (colIndex[p] < 0 || colIndex[p] >= cols)
+				throw MatrixInvalidSparseStructure("column index out of range in row " + std::to_string(r));
+			if (p > rowStart[r] && colIndex[p] <= colIndex[p - 1])
+				throw MatrixInvalidSparseStructure("columns must increase within row " + std::to_string(r));
+		}
+	}
+
+	SparseMatrix result;
+	result._rows = rows;
+	result._cols = cols;
+	result._rowStart = std::move(rowStart);
+	result._colIndex = std::move(colIndex);
+	result._values = std::move(values);
+	return result;
+}
+
+Matrix SparseMatrix::toDense() const {
+	Matrix dense(_rows, _cols);
+	double* out = dense.data();
+	for (int r = 0; r < _rows; ++r) {
+		double* row = out + static_cast<std::size_t>(r) * _cols;
+		for (std::size_t p = _rowStart[r]; p < _rowStart[r + 1]; ++p)
+			row[_colIndex[p]] = _values[p];
+	}
+	return dense;
+}
+
+// ==== Queries & element access ====
+
+bool SparseMatrix::operator==(const SparseMatrix& other) const {
+	return _rows == other._rows && _cols == other._cols &&
+	       _rowStart == other._rowStart && _colIndex == other._colIndex && _values == other._values;
+}
+
+bool SparseMatrix::operator!=(const SparseMatrix& other) const {
+	return !(*this == other);
+}
+
+double SparseMatrix::density() const {
+	if (_rows == 0 || _cols == 0) return 0.0;
+	return static_cast<double>(nonZeros()) / (static_cast<double>(_rows) * _cols);
+}
+
+std::size_t SparseMatrix::find(int row, int col) const {
+	const auto first = _colIndex.begin() + static_cast<std::ptrdiff_t>(_rowStart[row]);
+	const auto last = _colIndex.begin() + static_cast<std::ptrdiff_t>(_rowStart[row + 1]);
+	const auto it = std::lower_bound(first, last, col);
+	if (it == last || *it != col) return nonZeros();
+	return static_cast<std::size_t>(it - _colIndex.begin());
+}
+
+double SparseMatrix::operator()(int row, int col) const {
+	if (row < 0 || row >= _rows || col < 0 || col >= _cols)
+		throw MatrixOutOfBounds(_rows, _cols);
+	const std::size_t p = find(row, col);
+	return p == nonZeros() ? 0.0 : _values[p];
+}
+
+void SparseMatrix::set(int row, int col, double value) {
+	if (row < 0 || row >= _rows || col < 0 || col >= _cols)
+		throw MatrixOutOfBounds(_rows, _cols);
+
+	const std::size_t p = find(row, col);
+	if (p != nonZeros()) {
+		if (value != 0.0) {
+			_values[p] = value;
+			return;
+		}
+		_colIndex.erase(_colIndex.begin() + static_cast<std::ptrdiff_t>(p));
+		_values.erase(_values.begin() + static_cast<std::ptrdiff_t>(p));
+		for (int r = row + 1; r <= _rows; ++r) --_rowStart[r];
+		return;
+	}
+	if (value == 0.0) return;
+
+	const auto first = _colIndex.begin() + static_cast<std::ptrdiff_t>(_rowStart[row]);
+	const auto last = _colIndex.begin() + static_cast<std::ptrdiff_t>(_rowStart[row + 1]);
+	const std::ptrdiff_t at = std::lower_bound(first, last, col) - _colIndex.begin();
+	_colIndex.insert(_colIndex.begin() + at, col);
+	_values.insert(_values.begin() + at, value);
+	for (int r = row + 1; r <= _rows; ++r) ++_rowStart[r];
+}
+
+void SparseMatrix::prune() {
+	std::size_t out = 0;
+	std::size_t begin = _rowStart[0];
+	for (int r = 0; r < _rows; ++r) {
+		const std::size_t end = _rowStart[r + 1];
+		for (std::size_t p = begin; p < end; ++p) {
+			if (_values[p] == 0.0) continue;
+			_colIndex[out] = _colIndex[p];
+			_values[out] = _values[p];
+			++out;
+		}
+		_rowStart[r + 1] = out;
+		begin = end;
+	}
+	_colIndex.resize(out);
+	_values.resize(out);
+}
+
+// ==== Arithmetic ====
+
+SparseMatrix SparseMatrix::transpose() const {
+	SparseMatrix result;
+	result._rows = _cols;
+	result._cols = _rows;
+	result._rowStart.assign(static_cast<std::size_t>(_cols) + 1, 0);
+	result._colIndex.resize(nonZeros());
+	result._values.resize(nonZeros());
+
+	// Counting sort by column; scanning rows in order keeps each output row sorted
+	for (int c : _colIndex) ++result._rowStart[c + 1];
+	for (int c = 0; c < _cols; ++c) result._rowStart[c + 1] += result._rowStart[c];
+
+	std::vector<std::size_t> next(result._rowStart.begin(), result._rowStart.end() - 1);
+	for (int r = 0; r < _rows; ++r) {
+		for (std::size_t p = _rowStart[r]; p < _rowStart[r + 1]; ++p) {
+			const std::size_t to = next[_colIndex[p]]++;
+			result._colIndex[to] = r;
+			result._values[to] = _values[p];
+		}
+	}
+	return result;
+}
+
+SparseMatrix SparseMatrix::combine(const SparseMatrix& other, double sign) const {
+	MATRIX_PROFILE("SparseMatrix::combine");
+	if (_rows != other._rows || _cols != other._cols)
+		throw MatrixDimensionMismatch(_rows, _cols, other._rows, other._cols);
+
+	SparseMatrix result;
+	result._rows = _rows;
+	result._cols = _cols;
+	result._rowStart.reserve(static_cast<std::size_t>(_rows) + 1);
+	result._colIndex.reserve(nonZeros() + other.nonZeros());
+	result._values.reserve(nonZeros() + other.nonZeros());
+
+	auto emit = [&result](int col, double value) {
+		if (value == 0.0) return;
+		result._colIndex.push_back(col);
+		result._values.push_back(value);
+	};
+
+	for (int r = 0; r < _rows; ++r) {
+		std::size_t p = _rowStart[r], q = other._rowStart[r];
+		const std::size_t pEnd = _rowStart[r + 1], qEnd = other._rowStart[r + 1];
+		while (p < pEnd && q < qEnd) {
+			if (_colIndex[p] < other._colIndex[q]) {
+				emit(_colIndex[p], _values[p]);
+				++p;
+			} else if (other._colIndex[q] < _colIndex[p]) {
+				emit(other._colIndex[q], sign * other._values[q]);
+				++q;
+			} else {
+				emit(_colIndex[p], _values[p] + sign * other._values[q]);
+				++p;
+				++q;
+			}
+		}
+		for (; p < pEnd; ++p) emit(_colIndex[p], _values[p]);
+		for (; q < qEnd; ++q) emit(other._colIndex[q], sign * other._values[q]);
+		result._rowStart.push_back(result._values.size());
+	}
+	return result;
+}
+
+SparseMatrix SparseMatrix::operator+(const SparseMatrix& other) const {
+	return combine(other, 1.0);
+}
+
+SparseMatrix SparseMatrix::operator-(const SparseMatrix& other) const {
+	return combine(other, -1.0);
+}
+
+SparseMatrix SparseMatrix::operator*(double scalar) const {
+	SparseMatrix result(*this);
+	for (double& value : result._values) value *= scalar;
+	result.prune(); // e.g. scalar == 0
+	return result;
+}
+
+SparseMatrix operator*(double scalar, const SparseMatrix& matrix) {
+	return matrix * scalar;
+}
+
+Matrix SparseMatrix::operator*(const Matrix& other) const {
+	MATRIX_PROFILE_WORK("SparseMatrix::multiplyDense", 2.0 * nonZeros() * other.getCols());
+	if (_cols != other.getRows())
+		throw MatrixDimensionMismatch(_rows, _cols, other.getRows(), other.getCols());
+
+	const int n = other.getCols();
+	Matrix result(_rows, n);
+	const double* B = other.data();
+	double* C = result.data();
+
+	// Row r of the result is a combination of the rows of other picked by row r's entries
+	const long long work = static_cast<long long>(nonZeros()) * n;
+	Parallel::parallelFor(0, _rows, rowsPerTask(work, _rows), [&](int r0, int r1) {
+		for (int r = r0; r < r1; ++r) {
+			double* out = C + static_cast<std::size_t>(r) * n;
+			for (std::size_t p = _rowStart[r]; p < _rowStart[r + 1]; ++p) {
+				const double a = _values[p];
+				const double* in = B + static_cast<std::size_t>(_colIndex[p]) * n;
+				for (int j = 0; j < n; ++j)
+					out[j] += a * in[j];
+			}
+		}
+	});
+	return result;
+}
+
+Matrix operator*(const Matrix& lhs, const SparseMatrix& rhs) {
+	MATRIX_PROFILE_WORK("SparseMatrix::multiplyDense", 2.0 * lhs.getRows() * rhs.nonZeros());
+	if (lhs.getCols() != rhs.getRows())
+		throw MatrixDimensionMismatch(lhs.getRows(), lhs.getCols(), rhs.getRows(), rhs.getCols());
+
+	const int m = lhs.getRows(), k = lhs.getCols(), n = rhs.getCols();
+	Matrix result(m, n);
+	const double* A = lhs.data();
+	double* C = result.data();
+	const std::vector<std::size_t>& rowStart = rhs.rowStart();
+	const std::vector<int>& colIndex = rhs.colIndex();
+	const std::vector<double>& values = rhs.values();
+
+	// Row r of the result scatters row p of rhs, scaled by lhs(r, p), for every p
+	const long long work = static_cast<long long>(m) * (static_cast<long long>(rhs.nonZeros()) + k);
+	Parallel::parallelFor(0, m, rowsPerTask(work, m), [&](int r0, int r1) {
+		for (int r = r0; r < r1; ++r) {
+			const double* a = A + static_cast<std::size_t>(r) * k;
+			double* out = C + static_cast<std::size_t>(r) * n;
+			for (int p = 0; p < k; ++p) {
+				if (a[p] == 0.0) continue;
+				for (std::size_t q = rowStart[p]; q < rowStart[p + 1]; ++q)
+					out[colIndex[q]] += a[p] * values[q];
+			}
+		}
+	});
+	return result;
+}
+
+SparseMatrix SparseMatrix::operator*(const SparseMatrix& other) const {
+	MATRIX_PROFILE("SparseMatrix::multiply");
+	if (_cols != other._rows)
+		throw MatrixDimensionMismatch(_rows, _cols, other._rows, other._cols);
+
+	const int n = other._cols;
+	SparseMatrix result;
+	result._rows = _rows;
+	result._cols = n;
+	result._rowStart.assign(static_cast<std::size_t>(_rows) + 1, 0);
+
+	long long work = 0;
+	for (int k : _colIndex)
+		work += static_cast<long long>(other._rowStart[k + 1] - other._rowStart[k]);
+	const int chunk = rowsPerTask(work, _rows);
+
+	// Pass 1 (symbolic): count the distinct columns every result row touches.
+	// marker[c] == r records that column c was already seen in row r.
+	Parallel::parallelFor(0, _rows, chunk, [&](int r0, int r1) {
+		std::vector<int> marker(n, -1);
+		for (int r = r0; r < r1; ++r) {
+			std::size_t count = 0;
+			for (std::size_t p = _rowStart[r]; p < _rowStart[r + 1]; ++p) {
+				const int k = _colIndex[p];
+				for (std::size_t q = other._rowStart[k]; q < other._rowStart[k + 1]; ++q) {
+					const int c = other._colIndex[q];
+					if (marker[c] != r) {
+						marker[c] = r;
+						++count;
+					}
+				}
+			}
+			result._rowStart[r + 1] = count;
+		}
+	});
+	for (int r = 0; r < _rows; ++r)
+		result._rowStart[r + 1] += result._rowStart[r];
+	result._colIndex.resize(result._rowStart.back());
+	result._values.resize(result._rowStart.back());
+
+	// Pass 2 (numeric): accumulate each row densely, then emit it in column order
+	Parallel::parallelFor(0, _rows, chunk, [&](int r0, int r1) {
+		std::vector<int> marker(n, -1);
+		std::vector<double> accumulator(n, 0.0);
+		for (int r = r0; r < r1; ++r) {
+			int* cols = result._colIndex.data() + result._rowStart[r];
+			std::size_t count = 0;
+			for (std::size_t p = _rowStart[r]; p < _rowStart[r + 1]; ++p) {
+				const double a = _values[p];
+				const int k = _colIndex[p];
+				for (std::size_t q = other._rowStart[k]; q < other._rowStart[k + 1]; ++q) {
+					const int c = other._colIndex[q];
+					if (marker[c] != r) {
+						marker[c] = r;
+						cols[count++] = c;
+					}
+					accumulator[c] += a * other._values[q];
+				}
+			}
+			std::sort(cols, cols + count);
+			double* vals = result._values.data() + result._rowStart[r];
+			for (std::size_t i = 0; i < count; ++i) {
+				vals[i] = accumulator[cols[i]];
+				accumulator[cols[i]] = 0.0;
+			}
+		}
+	});
+
+	result.prune(); // entries that cancelled out exactly
+	return result;
+}
+
+void SparseMatrix::addTo(Matrix& dense, double alpha) const {
+	if (_rows != dense.getRows() || _cols != dense.getCols())
+		throw MatrixDimensionMismatch(dense.getRows(), dense.getCols(), _rows, _cols);
+	double* out = dense.data();
+	for (int r = 0; r < _rows; ++r) {
+		double* row = out + static_cast<std::size_t>(r) * _cols;
+		for (std::size_t p = _rowStart[r]; p < _rowStart[r + 1]; ++p)
+			row[_colIndex[p]] += alpha * _values[p];
+	}
+}
+
+Matrix operator+(const SparseMatrix& lhs, const Matrix& rhs) {
+	Matrix result(rhs);
+	lhs.addTo(result);
+	return result;
+}
+
+Matrix operator+(const Matrix& lhs, const SparseMatrix& rhs) {
+	Matrix result(lhs);
+	rhs.addTo(result);
+	return result;
+}
+
+Matrix operator-(const SparseMatrix& lhs, const Matrix& rhs) {
+	Matrix result = -rhs;
+	lhs.addTo(result);
+	return result;
+}
+
+Matrix operator-(const Matrix& lhs, const SparseMatrix& rhs) {
+	Matrix result(lhs);
+	rhs.addTo(result, -1.0);
+	return result;
+}
+
+// ==== I/O ====
+
+std::ostream& operator<<(std::ostream& os, const SparseMatrix& matrix) {
+	const std::size_t count = matrix.nonZeros();
+	os << matrix._rows << "x" << matrix._cols << " sparse, "
+	   << count << (count == 1 ? " non-zero" : " non-zeros") << '\n';
+
+	os << std::fixed << std::setprecision(3);
+	for (int r = 0; r < matrix._rows; ++r) {
+		for (std::size_t p = matrix._rowStart[r]; p < matrix._rowStart[r + 1]; ++p)
+			os << "(" << r << ", " << matrix._colIndex[p] << "): " << matrix._values[p] << '\n';
+	}
+	return os;
+}
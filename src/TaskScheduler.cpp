@@ -0,0 +1,123 @@
+#include "../include/TaskScheduler.h"
+#include <algorithm>
+#include <utility>
+
+TaskScheduler::TaskScheduler(unsigned workers)
+	: _pool(std::max(workers, 1u)) {}
+
+TaskScheduler::~TaskScheduler() {
+	try {
+		waitAll();
+	} catch (...) {
+		// A destructor cannot report it; the pool still joins its workers
+	}
+}
+
+void TaskScheduler::submit(Task task) {
+	const std::uint64_t id = _nextId++;
+	Entry& entry = _tasks[id];
+
+	std::vector<std::uint64_t> dependencies;
+	auto dependOnWriter = [&](const std::string& name) {
+		const auto writer = _lastWriter.find(name);
+		if (writer != _lastWriter.end() &&
+			std::find(dependencies.begin(), dependencies.end(), writer->second) == dependencies.end())
+			dependencies.push_back(writer->second);
+	};
+	for (const std::string& name : task.reads) dependOnWriter(name);
+	for (const std::string& name : task.writes) {
+		dependOnWriter(name);
+		// Earlier readers must have taken their copy first
+		const auto readers = _readers.find(name);
+		if (readers == _readers.end()) continue;
+		for (const std::uint64_t reader : readers->second)
+			if (std::find(dependencies.begin(), dependencies.end(), reader) == dependencies.end())
+				dependencies.push_back(reader);
+		_readers.erase(readers);
+	}
+	for (const std::uint64_t dependency : dependencies)
+		_tasks.at(dependency).dependents.push_back(id);
+	for (const std::string& name : task.reads)
+		_readers[name].push_back(id);
+	for (const std::string& name : task.writes)
+		_lastWriter[name] = id;
+
+	entry.task = std::move(task);
+	entry.unmetDependencies = dependencies.size();
+	if (entry.unmetDependencies == 0)
+		launch(id);
+	poll();
+}
+
+void TaskScheduler::launch(const std::uint64_t id) {
+	Entry& entry = _tasks.at(id);
+	Work work = entry.task.start();
+	_pool.submit([this, id, &entry, work = std::move(work)] {
+		try {
+			work();
+		} catch (...) {
+			entry.error = std::current_exception(); // read by the owner only after the lock below
+		}
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_finished.push_back(id);
+		}
+		_finishedSignal.notify_one();
+	});
+}
+
+void TaskScheduler::poll() {
+	std::vector<std::uint64_t> finished;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		finished.swap(_finished);
+	}
+	commitFinished(std::move(finished));
+}
+
+void TaskScheduler::waitAll() {
+	while (true) {
+		poll();
+		if (_tasks.empty()) return;
+		std::unique_lock<std::mutex> lock(_mutex);
+		_finishedSignal.wait(lock, [this] { return !_finished.empty(); });
+	}
+}
+
+void TaskScheduler::commitFinished(std::vector<std::uint64_t> finished) {
+	std::exception_ptr error;
+	for (const std::uint64_t id : finished) {
+		Entry& entry = _tasks.at(id);
+		if (entry.error) {
+			if (!error) error = entry.error;
+		} else if (entry.task.commit) {
+			entry.task.commit();
+		}
+		entry.committed = true;
+
+		for (const std::string& name : entry.task.writes) {
+			const auto writer = _lastWriter.find(name);
+			if (writer != _lastWriter.end() && writer->second == id)
+				_lastWriter.erase(writer);
+		}
+		for (const std::string& name : entry.task.reads) {
+			const auto readers = _readers.find(name);
+			if (readers == _readers.end()) continue;
+			readers->second.erase(std::remove(readers->second.begin(), readers->second.end(), id), readers->second.end());
+			if (readers->second.empty()) _readers.erase(readers);
+		}
+		for (const std::uint64_t dependent : entry.dependents)
+			if (--_tasks.at(dependent).unmetDependencies == 0)
+				launch(dependent);
+	}
+	retireCommitted();
+	if (error) std::rethrow_exception(error);
+}
+
+void TaskScheduler::retireCommitted() {
+	while (!_tasks.empty() && _tasks.begin()->second.committed) {
+		Entry entry = std::move(_tasks.begin()->second);
+		_tasks.erase(_tasks.begin());
+		if (entry.task.retire) entry.task.retire();
+	}
+}
@@ -0,0 +1,117 @@
+#include "../include/ThreadPool.h"
+#include <utility>
+
+namespace {
+	// Which pool (if any) the current thread works for, and its queue index.
+	thread_local const ThreadPool* currentPool = nullptr;
+	thread_local int currentQueue = -1;
+}
+
+ThreadPool::ThreadPool(unsigned workers) {
+	const unsigned queues = workers == 0 ? 1 : workers;
+	_queues.reserve(queues);
+	for (unsigned i = 0; i < queues; ++i)
+		_queues.push_back(std::make_unique<WorkQueue>());
+
+	_workers.reserve(workers);
+	for (unsigned i = 0; i < workers; ++i)
+		_workers.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(_sleepMutex);
+		_stopping = true;
+	}
+	_wake.notify_all();
+	for (std::thread& worker : _workers) worker.join();
+}
+
+ThreadPool& ThreadPool::shared() {
+	// Function-local static: started on first use, thread-safe since C++11
+	static ThreadPool pool([] {
+		unsigned hardware = std::thread::hardware_concurrency();
+		return hardware > 1 ? hardware - 1 : 0u;
+	}());
+	return pool;
+}
+
+unsigned ThreadPool::size() const {
+	return static_cast<unsigned>(_workers.size());
+}
+
+void ThreadPool::submit(Task task) {
+	// Workers keep what they spawn local; outside callers spread their tasks
+	const unsigned queue = (currentPool == this)
+		? static_cast<unsigned>(currentQueue)
+		: _nextQueue.fetch_add(1, std::memory_order_relaxed) % _queues.size();
+	{
+		std::lock_guard<std::mutex> lock(_queues[queue]->mutex);
+		_queues[queue]->tasks.push_back(std::move(task));
+	}
+	{
+		// Publish under the sleep mutex so a worker about to wait cannot miss it
+		std::lock_guard<std::mutex> lock(_sleepMutex);
+		_pending.fetch_add(1, std::memory_order_relaxed);
+	}
+	_wake.notify_one();
+}
+
+bool ThreadPool::takeTask(int preferredQueue, Task& task) {
+	const int count = static_cast<int>(_queues.size());
+
+	// Own queue first, newest task first
+	if (preferredQueue >= 0) {
+		WorkQueue& own = *_queues[preferredQueue];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.tasks.empty()) {
+			task = std::move(own.tasks.back());
+			own.tasks.pop_back();
+			_pending.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	// Steal the oldest task from someone else
+	const int start = preferredQueue >= 0 ? preferredQueue + 1 : 0;
+	for (int i = 0; i < count; ++i) {
+		const int victim = (start + i) % count;
+		if (victim == preferredQueue) continue;
+		WorkQueue& other = *_queues[victim];
+		std::lock_guard<std::mutex> lock(other.mutex);
+		if (!other.tasks.empty()) {
+			task = std::move(other.tasks.front());
+			other.tasks.pop_front();
+			_pending.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool ThreadPool::tryRunPendingTask() {
+	Task task;
+	if (!takeTask(currentPool == this ? currentQueue : -1, task))
+		return false;
+	task();
+	return true;
+}
+
+void ThreadPool::workerLoop(unsigned index) {
+	currentPool = this;
+	currentQueue = static_cast<int>(index);
+
+	while (true) {
+		Task task;
+		if (takeTask(currentQueue, task)) {
+			task();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(_sleepMutex);
+		_wake.wait(lock, [this] {
+			return _stopping || _pending.load(std::memory_order_relaxed) > 0;
+		});
+		if (_stopping) return;
+	}
+}
@@ -1,259 +1,1318 @@
 #include "Workspace.h"
 
+#include <algorithm>
 #include <fstream>
+#include <iomanip>
 #include <sstream>
 #include <filesystem>
+#include <unordered_set>
+#include <utility>
 #include "MatrixException.h"
+#include "MatrixKernels.h"
+#include "WorkspaceFile.h"
+#include "FixedMatrix.h"
+#include "Profiler.h"
+#include "QRDecomposition.h"
+
+namespace {
+    void reportSparseUnsupported(std::ostream& out, const std::string& matName) {
+        out << "Matrix '" << matName << "' is sparse; convert it with 'to_dense "
+            << matName << "' first." << std::endl;
+    }
+
+    void reportFloat32Unsupported(std::ostream& out, const std::string& matName) {
+        out << "Matrix '" << matName << "' is float32; convert it with 'to_float64 "
+            << matName << "' first." << std::endl;
+    }
+
+    void reportOnDiskUnsupported(std::ostream& out, const std::string& matName) {
+        out << "Matrix '" << matName << "' is stored on disk; convert it with 'to_memory "
+            << matName << "' first." << std::endl;
+    }
+
+    /**
+     * Residuals span many orders of magnitude, so print them in scientific
+     * form without touching the output stream's fixed formatting.
+     */
+    std::string formatResidual(double residual) {
+        std::ostringstream out;
+        out << std::scientific << std::setprecision(2) << residual;
+        return out.str();
+    }
+
+    /**
+     * If after - before is zero except in one row or one column, write it
+     * as u vᵀ (u = e_i and v the row's change, or u the column's change and
+     * v = e_j) and return true. Both matrices have the same shape.
+     */
+    bool rankOneChange(const Matrix& before, const Matrix& after, Matrix& u, Matrix& v) {
+        const int rows = after.getRows(), cols = after.getCols();
+        int changedRow = -1, changedCol = -1;
+        bool manyRows = false, manyCols = false;
+        for (int i = 0; i < rows; ++i) {
+            for (int j = 0; j < cols; ++j) {
+                if (after(i, j) == before(i, j)) continue;
+                if (changedRow < 0) changedRow = i;
+                else if (changedRow != i) manyRows = true;
+                if (changedCol < 0) changedCol = j;
+                else if (changedCol != j) manyCols = true;
+            }
+        }
+        u = Matrix(rows, 1);
+        v = Matrix(cols, 1);
+        if (changedRow < 0) return true; // unchanged: u vᵀ = 0
+        if (!manyRows) {
+            u(changedRow, 0) = 1.0;
+            for (int j = 0; j < cols; ++j) v(j, 0) = after(changedRow, j) - before(changedRow, j);
+            return true;
+        }
+        if (!manyCols) {
+            for (int i = 0; i < rows; ++i) u(i, 0) = after(i, changedCol) - before(i, changedCol);
+            v(changedCol, 0) = 1.0;
+            return true;
+        }
+        return false;
+    }
+}
+
+void Workspace::storeMatrix(const std::string& matName, Matrix&& matrix) {
+    workspace[matName] = std::move(matrix);
+    sparseWorkspace.erase(matName);
+    floatWorkspace.erase(matName);
+    diskWorkspace.erase(matName);
+    batchWorkspace.erase(matName);
+    invalidateDerivedData(matName);
+}
+
+void Workspace::storeMatrix(const std::string& matName, SparseMatrix&& matrix) {
+    sparseWorkspace[matName] = std::move(matrix);
+    workspace.erase(matName);
+    floatWorkspace.erase(matName);
+    diskWorkspace.erase(matName);
+    batchWorkspace.erase(matName);
+    invalidateDerivedData(matName);
+}
+
+void Workspace::storeMatrix(const std::string& matName, FloatMatrix&& matrix) {
+    floatWorkspace[matName] = std::move(matrix);
+    workspace.erase(matName);
+    sparseWorkspace.erase(matName);
+    diskWorkspace.erase(matName);
+    batchWorkspace.erase(matName);
+    invalidateDerivedData(matName);
+}
+
+void Workspace::storeMatrix(const std::string& matName, OutOfCoreMatrix&& matrix) {
+    diskWorkspace[matName] = std::move(matrix);
+    workspace.erase(matName);
+    sparseWorkspace.erase(matName);
+    floatWorkspace.erase(matName);
+    batchWorkspace.erase(matName);
+    invalidateDerivedData(matName);
+}
+
+void Workspace::storeBatch(const std::string& batchName, MatrixBatch&& batch) {
+    batchWorkspace[batchName] = std::move(batch);
+    workspace.erase(batchName);
+    sparseWorkspace.erase(batchName);
+    floatWorkspace.erase(batchName);
+    diskWorkspace.erase(batchName);
+    invalidateDerivedData(batchName);
+}
+
+bool Workspace::isSparse(const std::string& matName) const {
+    return sparseWorkspace.find(matName) != sparseWorkspace.end();
+}
+
+bool Workspace::isFloat32(const std::string& matName) const {
+    return floatWorkspace.find(matName) != floatWorkspace.end();
+}
+
+bool Workspace::isOnDisk(const std::string& matName) const {
+    return diskWorkspace.find(matName) != diskWorkspace.end();
+}
+
+bool Workspace::isBatch(const std::string& matName) const {
+    return batchWorkspace.find(matName) != batchWorkspace.end();
+}
+
+bool Workspace::batchExists(const std::string& batchName) const {
+    if (!isBatch(batchName)) {
+        output() << "Batch '" << batchName << "' not found in workspace." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void Workspace::reportSingularCount(const BatchSolveResult& result) const {
+    if (result.singularCount > 0)
+        output() << result.singularCount << " of " << result.singular.size()
+                 << " matrices are singular; their results are zero." << std::endl;
+}
+
+const Matrix& Workspace::denseOperand(const std::string& matName, Matrix& converted) const {
+    const auto sparse = sparseWorkspace.find(matName);
+    if (sparse != sparseWorkspace.end()) {
+        converted = sparse->second.toDense();
+        return converted;
+    }
+    const auto single = floatWorkspace.find(matName);
+    if (single != floatWorkspace.end()) {
+        converted = Matrix(single->second);
+        return converted;
+    }
+    const auto disk = diskWorkspace.find(matName);
+    if (disk != diskWorkspace.end()) {
+        converted = disk->second.toMatrix();
+        return converted;
+    }
+    return workspace.at(matName);
+}
+
+void Workspace::invalidateDerivedData(const std::string& matName) {
+    ++versions[matName];
+    derivedData.erase(matName); // rather than on next use, so a stale inverse frees its memory now
+}
+
+void Workspace::updateDerivedData(const std::string& matName, const Matrix& u, const Matrix& v) {
+    const std::uint64_t previous = versions[matName]++;
+    const auto found = derivedData.find(matName);
+    if (found == derivedData.end()) return;
+    DerivedData& derived = found->second;
+    if (derived.version != previous || !derived.factorization ||
+        !derived.factorization->update(u, v)) {
+        derivedData.erase(found);
+        return;
+    }
+
+    if (derived.inverse) {
+        // (A + u vᵀ)⁻¹ = A⁻¹ - (A⁻¹ u)(vᵀ A⁻¹) / (1 + vᵀ A⁻¹ u)
+        Matrix& inverse = *derived.inverse;
+        const int n = inverse.getRows();
+        const Matrix w = inverse * u;
+        const Matrix z = v.transpose() * inverse;
+        const double* wv = w.data();
+        const double* vv = v.data();
+        double ratio = 1.0;
+        for (int i = 0; i < n; ++i) ratio += vv[i] * wv[i];
+        double* rows = inverse.data(); // detaches once
+        for (int i = 0; i < n; ++i) {
+            const double scale = wv[i] / ratio;
+            if (scale != 0.0)
+                MatrixKernels::axpy(n, -scale, z.data(), rows + static_cast<std::size_t>(i) * n);
+        }
+    }
+    derived.rank.reset();
+    derived.determinant.reset();
+    derived.version = previous + 1;
+}
+
+Workspace::DerivedData& Workspace::derivedFor(const std::string& matName) const {
+    const auto version = versions.find(matName);
+    const std::uint64_t current = version == versions.end() ? 0 : version->second;
+    DerivedData& derived = derivedData[matName];
+    if (derived.version != current) {
+        derived = DerivedData();
+        derived.version = current;
+    }
+    return derived;
+}
+
+const LUDecomposition& Workspace::factorizationFor(const std::string& matName) const {
+    DerivedData& derived = derivedFor(matName);
+    if (!derived.factorization) {
+        Matrix converted;
+        derived.factorization.emplace(denseOperand(matName, converted));
+    }
+    return *derived.factorization;
+}
+
+bool Workspace::canSnapshot(const std::vector<std::string>& names) const {
+    for (const std::string& name : names)
+        if (isOnDisk(name)) return false;
+    return true;
+}
+
+Workspace Workspace::snapshot(const std::vector<std::string>& names) const {
+    Workspace copy;
+    copy.solverOptions = solverOptions;
+    copy.outputStream = outputStream;
+    for (const std::string& name : names) {
+        if (const auto dense = workspace.find(name); dense != workspace.end())
+            copy.workspace.emplace(name, dense->second);
+        else if (const auto sparse = sparseWorkspace.find(name); sparse != sparseWorkspace.end())
+            copy.sparseWorkspace.emplace(name, sparse->second);
+        else if (const auto single = floatWorkspace.find(name); single != floatWorkspace.end())
+            copy.floatWorkspace.emplace(name, single->second);
+        else if (const auto batch = batchWorkspace.find(name); batch != batchWorkspace.end())
+            copy.batchWorkspace.emplace(name, batch->second);
+        if (const auto version = versions.find(name); version != versions.end())
+            copy.versions.emplace(name, version->second);
+        if (const auto derived = derivedData.find(name); derived != derivedData.end())
+            copy.derivedData.emplace(name, derived->second);
+    }
+    return copy;
+}
+
+void Workspace::merge(Workspace&& scratch, const std::vector<std::string>& writes, const std::vector<std::string>& reads) {
+    // Results cached in scratch for the version of a name it ended with.
+    auto currentDerived = [&scratch](const std::string& name) -> DerivedData* {
+        const auto derived = scratch.derivedData.find(name);
+        if (derived == scratch.derivedData.end()) return nullptr;
+        const auto version = scratch.versions.find(name);
+        const std::uint64_t current = version == scratch.versions.end() ? 0 : version->second;
+        return derived->second.version == current ? &derived->second : nullptr;
+    };
+
+    std::unordered_set<std::string> merged;
+    for (const std::string& name : writes) {
+        if (!merged.insert(name).second) continue; // listed twice
+        if (auto dense = scratch.workspace.find(name); dense != scratch.workspace.end())
+            storeMatrix(name, std::move(dense->second));
+        else if (auto sparse = scratch.sparseWorkspace.find(name); sparse != scratch.sparseWorkspace.end())
+            storeMatrix(name, std::move(sparse->second));
+        else if (auto single = scratch.floatWorkspace.find(name); single != scratch.floatWorkspace.end())
+            storeMatrix(name, std::move(single->second));
+        else if (auto batch = scratch.batchWorkspace.find(name); batch != scratch.batchWorkspace.end())
+            storeBatch(name, std::move(batch->second));
+        else {
+            workspace.erase(name);
+            sparseWorkspace.erase(name);
+            floatWorkspace.erase(name);
+            diskWorkspace.erase(name);
+            batchWorkspace.erase(name);
+            invalidateDerivedData(name);
+        }
+        if (DerivedData* derived = currentDerived(name)) {
+            derived->version = versions[name];
+            derivedData[name] = std::move(*derived);
+        }
+    }
+
+    for (const std::string& name : reads) {
+        if (std::find(writes.begin(), writes.end(), name) != writes.end()) continue;
+        DerivedData* computed = currentDerived(name);
+        if (computed == nullptr) continue;
+        const auto version = versions.find(name);
+        if ((version == versions.end() ? 0 : version->second) != computed->version) continue; // changed here since
+        DerivedData& derived = derivedFor(name);
+        if (!derived.rank) derived.rank = computed->rank;
+        if (!derived.determinant) derived.determinant = computed->determinant;
+        if (!derived.factorization) derived.factorization = std::move(computed->factorization);
+        if (!derived.inverse) derived.inverse = std::move(computed->inverse);
+    }
+}
 
 size_t Workspace::getMatrixCount() const{
-    return workspace.size();
+    return workspace.size() + sparseWorkspace.size() + floatWorkspace.size() + diskWorkspace.size() +
+           batchWorkspace.size();
   }
 
+std::vector<std::string> Workspace::getMatrixNames() const {
+    std::vector<std::string> names;
+    names.reserve(getMatrixCount());
+    for (const auto& pair : workspace) names.push_back(pair.first);
+    for (const auto& pair : sparseWorkspace) names.push_back(pair.first);
+    for (const auto& pair : floatWorkspace) names.push_back(pair.first);
+    for (const auto& pair : diskWorkspace) names.push_back(pair.first);
+    for (const auto& pair : batchWorkspace) names.push_back(pair.first);
+    return names;
+}
+
 bool Workspace::matrixExists(const std::string& matName) const {
-    if (workspace.find(matName) == workspace.end()) {
-        std::cout << "Matrix '" << matName << "' not found in workspace." << std::endl;
+    if (workspace.find(matName) == workspace.end() && !isSparse(matName) && !isFloat32(matName) && !isOnDisk(matName)) {
+        if (isBatch(matName))
+            output() << "'" << matName << "' is a batch; copy one of its matrices out with 'batch_get'." << std::endl;
+        else
+            output() << "Matrix '" << matName << "' not found in workspace." << std::endl;
         return false;
     }
     return true;
 }
 
+bool Workspace::getMatrix(const std::string& matName, Matrix& copy) const {
+    return handleReadOnlyMatrixOp(matName, [&copy](const Matrix& m) { copy = m; });
+}
+
+bool Workspace::putMatrix(const std::string& matName, Matrix&& matrix) {
+    const int rows = matrix.getRows(), cols = matrix.getCols();
+    storeMatrix(matName, std::move(matrix));
+    output() << "Matrix '" << matName << "' stored:\n"
+             << "  Dimensions: " << rows << " x " << cols << std::endl;
+    return true;
+}
+
 bool Workspace::createMatrix(const std::string& matName, const int rows, const int cols, const double initValue) {
     Matrix matrix;
     try {
         matrix = Matrix(rows, cols, initValue);
     } catch (const MatrixException& e) {
-        std::cout << e.what() << std::endl;
+        output() << e.what() << std::endl;
+        return false;
+    }
+    storeMatrix(matName, std::move(matrix));
+    output() << "Matrix '" << matName << "' created:\n"
+             << "  Dimensions: " << rows << " x " << cols << std::endl;
+    return true;
+}
+
+bool Workspace::createSparseMatrix(const std::string& matName, const int rows, const int cols) {
+    SparseMatrix matrix;
+    try {
+        matrix = SparseMatrix(rows, cols);
+    } catch (const MatrixException& e) {
+        output() << e.what() << std::endl;
+        return false;
+    }
+    storeMatrix(matName, std::move(matrix));
+    output() << "Sparse matrix '" << matName << "' created:\n"
+             << "  Dimensions: " << rows << " x " << cols << std::endl;
+    return true;
+}
+
+bool Workspace::createFloatMatrix(const std::string& matName, const int rows, const int cols, const float initValue) {
+    FloatMatrix matrix;
+    try {
+        matrix = FloatMatrix(rows, cols, initValue);
+    } catch (const MatrixException& e) {
+        output() << e.what() << std::endl;
+        return false;
+    }
+    storeMatrix(matName, std::move(matrix));
+    output() << "Float32 matrix '" << matName << "' created:\n"
+             << "  Dimensions: " << rows << " x " << cols << std::endl;
+    return true;
+}
+
+bool Workspace::createDiskMatrix(const std::string& matName, const int rows, const int cols, const double initValue) {
+    OutOfCoreMatrix matrix;
+    try {
+        matrix = OutOfCoreMatrix(rows, cols, initValue);
+    } catch (const MatrixException& e) {
+        output() << e.what() << std::endl;
+        return false;
+    }
+    storeMatrix(matName, std::move(matrix));
+    output() << "Out-of-core matrix '" << matName << "' created:\n"
+             << "  Dimensions: " << rows << " x " << cols << std::endl;
+    return true;
+}
+
+bool Workspace::setElement(const std::string& matName, const int row, const int col, const double value) {
+    if (!matrixExists(matName)) return false;
+    try {
+        if (isSparse(matName))
+            sparseWorkspace.at(matName).set(row, col, value);
+        else if (isFloat32(matName))
+            floatWorkspace.at(matName)(row, col) = static_cast<float>(value);
+        else if (isOnDisk(matName))
+            diskWorkspace.at(matName)(row, col) = value;
+        else {
+            Matrix& matrix = workspace.at(matName);
+            const double previous = std::as_const(matrix)(row, col);
+            matrix(row, col) = value;
+            // A + (value - previous) e_row e_colᵀ
+            Matrix u(matrix.getRows(), 1), v(matrix.getCols(), 1);
+            u(row, 0) = value - previous;
+            v(col, 0) = 1.0;
+            updateDerivedData(matName, u, v);
+            return true;
+        }
+    } catch (const MatrixException& e) {
+        output() << e.what() << std::endl;
         return false;
     }
-    workspace[matName] = matrix;
-    std::cout << "Matrix '" << matName << "' created:\n"
-                  << "  Dimensions: " << rows << " x " << cols << std::endl;
+    invalidateDerivedData(matName);
+    return true;
+}
+
+bool Workspace::convertToSparse(const std::string& matName) {
+    if (!matrixExists(matName)) return false;
+    if (isOnDisk(matName)) {
+        reportOnDiskUnsupported(output(), matName);
+        return false;
+    }
+    if (isFloat32(matName))
+        storeMatrix(matName, SparseMatrix(Matrix(floatWorkspace.at(matName))));
+    else if (!isSparse(matName))
+        storeMatrix(matName, SparseMatrix(workspace.at(matName)));
+    const size_t count = sparseWorkspace.at(matName).nonZeros();
+    output() << "Matrix '" << matName << "' is now sparse (" << count
+             << (count == 1 ? " non-zero)." : " non-zeros).") << std::endl;
+    return true;
+}
+
+bool Workspace::convertToDense(const std::string& matName) {
+    if (!matrixExists(matName)) return false;
+    if (isSparse(matName)) {
+        try {
+            storeMatrix(matName, sparseWorkspace.at(matName).toDense());
+        } catch (const MatrixException& e) {
+            output() << e.what() << std::endl;
+            return false;
+        }
+    }
+    output() << "Matrix '" << matName << "' is now dense." << std::endl;
+    return true;
+}
+
+bool Workspace::convertToFloat32(const std::string& matName) {
+    if (!matrixExists(matName)) return false;
+    if (isSparse(matName)) {
+        reportSparseUnsupported(output(), matName);
+        return false;
+    }
+    if (isOnDisk(matName)) {
+        reportOnDiskUnsupported(output(), matName);
+        return false;
+    }
+    if (!isFloat32(matName))
+        storeMatrix(matName, FloatMatrix(workspace.at(matName)));
+    output() << "Matrix '" << matName << "' is now float32." << std::endl;
+    return true;
+}
+
+bool Workspace::convertToFloat64(const std::string& matName) {
+    if (!matrixExists(matName)) return false;
+    if (isSparse(matName)) {
+        reportSparseUnsupported(output(), matName);
+        return false;
+    }
+    if (isFloat32(matName))
+        storeMatrix(matName, Matrix(floatWorkspace.at(matName)));
+    output() << "Matrix '" << matName << "' is now float64." << std::endl;
+    return true;
+}
+
+bool Workspace::convertToDisk(const std::string& matName) {
+    if (!matrixExists(matName)) return false;
+    if (isSparse(matName)) {
+        reportSparseUnsupported(output(), matName);
+        return false;
+    }
+    if (isFloat32(matName)) {
+        reportFloat32Unsupported(output(), matName);
+        return false;
+    }
+    if (!isOnDisk(matName)) {
+        try {
+            storeMatrix(matName, OutOfCoreMatrix(workspace.at(matName)));
+        } catch (const MatrixException& e) {
+            output() << e.what() << std::endl;
+            return false;
+        }
+    }
+    output() << "Matrix '" << matName << "' is now stored on disk." << std::endl;
+    return true;
+}
+
+bool Workspace::convertToMemory(const std::string& matName) {
+    if (!matrixExists(matName)) return false;
+    if (isOnDisk(matName)) {
+        try {
+            storeMatrix(matName, diskWorkspace.at(matName).toMatrix());
+        } catch (const MatrixException& e) {
+            output() << e.what() << std::endl;
+            return false;
+        }
+    }
+    output() << "Matrix '" << matName << "' is now in memory." << std::endl;
     return true;
 }
 
 bool Workspace::listMatrices() const {
-    if (workspace.empty()) {
+    if (workspace.empty() && sparseWorkspace.empty() && floatWorkspace.empty() && diskWorkspace.empty() &&
+        batchWorkspace.empty()) {
         return false;
     }
     for (const auto& matrix : workspace) {
-        std::cout << "Matrix '" << matrix.first << "':\n" << matrix.second << std::endl;
+        output() << "Matrix '" << matrix.first << "':\n" << matrix.second << std::endl;
+    }
+    for (const auto& matrix : sparseWorkspace) {
+        output() << "Matrix '" << matrix.first << "':\n" << matrix.second << std::endl;
+    }
+    for (const auto& matrix : floatWorkspace) {
+        output() << "Matrix '" << matrix.first << "' (float32):\n" << matrix.second << std::endl;
+    }
+    for (const auto& matrix : diskWorkspace) {
+        output() << "Matrix '" << matrix.first << "' (on disk):\n" << matrix.second << std::endl;
+    }
+    for (const auto& batch : batchWorkspace) {
+        output() << "Batch '" << batch.first << "': " << batch.second.count() << " matrices of "
+                 << batch.second.rows() << " x " << batch.second.cols() << std::endl;
     }
     return true;
 }
 
 bool Workspace::showMatrix(const std::string& matName) const {
-    return handleReadOnlyMatrixOp(matName, [&matName](const Matrix& m) {
-        std::cout << "Matrix '" << matName << "':\n" << m << std::endl;
+    if (isSparse(matName)) {
+        output() << "Matrix '" << matName << "':\n" << sparseWorkspace.at(matName) << std::endl;
+        return true;
+    }
+    if (isFloat32(matName)) {
+        output() << "Matrix '" << matName << "' (float32):\n" << floatWorkspace.at(matName) << std::endl;
+        return true;
+    }
+    if (isOnDisk(matName)) {
+        output() << "Matrix '" << matName << "' (on disk):\n" << diskWorkspace.at(matName) << std::endl;
+        return true;
+    }
+    if (isBatch(matName)) {
+        const MatrixBatch& batch = batchWorkspace.at(matName);
+        output() << "Batch '" << matName << "': " << batch.count() << " matrices of "
+                 << batch.rows() << " x " << batch.cols() << std::endl;
+        for (int k = 0; k < batch.count(); ++k)
+            output() << "[" << k << "]:\n" << batch.matrix(k) << std::endl;
+        return true;
+    }
+    return handleReadOnlyMatrixOp(matName, [this, &matName](const Matrix& m) {
+        output() << "Matrix '" << matName << "':\n" << m << std::endl;
     });
 }
 
 bool Workspace::transposeMatrix(const std::string& matName) {
+    if (isSparse(matName)) {
+        SparseMatrix& matrix = sparseWorkspace.at(matName);
+        matrix = matrix.transpose();
+        invalidateDerivedData(matName);
+        return true;
+    }
+    if (isFloat32(matName)) {
+        floatWorkspace.at(matName).transposeInPlace();
+        invalidateDerivedData(matName);
+        return true;
+    }
+    if (isOnDisk(matName)) {
+        OutOfCoreMatrix& matrix = diskWorkspace.at(matName);
+        try {
+            matrix = matrix.transpose();
+        } catch (const MatrixException& e) {
+            output() << e.what() << std::endl;
+            return false;
+        }
+        invalidateDerivedData(matName);
+        return true;
+    }
     return handleSingleMatrixOp(matName, [](Matrix& m) {
-        m = m.transpose();
+        m.transposeInPlace();
     });
 }
 
 bool Workspace::assignMatrix(const std::string& matName) {
     if (!matrixExists(matName)) return false;
-    Matrix& assigned = workspace.at(matName);
-    for (int i = 0; i < assigned.getRows(); ++i) {
-        for (int j = 0; j < assigned.getCols(); ++j) {
-            double value;
-            std::string inputStr;
-            std::cout << "Assign value for element in (" << i << ", " << j << ")\n";
-            std::cout << "> ";
-            std::getline(std::cin, inputStr);
-            std::istringstream ss(inputStr);
-            if (!(ss >> value) || !(ss.eof())) {
-                std::cout << "Invalid value assignment" << std::endl;
-                --j; // Retry the same element
-                continue;
+    if (isSparse(matName)) {
+        reportSparseUnsupported(output(), matName);
+        return false;
+    }
+    auto assign = [this](auto& assigned) {
+        for (int i = 0; i < assigned.getRows(); ++i) {
+            for (int j = 0; j < assigned.getCols(); ++j) {
+                double value;
+                std::string inputStr;
+                output() << "Assign value for element in (" << i << ", " << j << ")\n";
+                output() << "> ";
+                std::getline(std::cin, inputStr);
+                std::istringstream ss(inputStr);
+                if (!(ss >> value) || !(ss.eof())) {
+                    output() << "Invalid value assignment" << std::endl;
+                    --j; // Retry the same element
+                    continue;
+                }
+                assigned(i, j) = static_cast<typename std::decay_t<decltype(assigned)>::value_type>(value);
             }
-            assigned(i, j) = value;
+        }
+    };
+    if (isFloat32(matName)) {
+        assign(floatWorkspace.at(matName));
+    } else if (isOnDisk(matName)) {
+        assign(diskWorkspace.at(matName));
+    } else {
+        const Matrix before = workspace.at(matName); // shares the elements until assign() writes
+        Matrix& after = workspace.at(matName);
+        assign(after);
+        Matrix u, v;
+        if (rankOneChange(before, after, u, v)) {
+            updateDerivedData(matName, u, v);
+            return true;
         }
     }
+    invalidateDerivedData(matName);
     return true;
 }
 
 bool Workspace::deleteMatrix(const std::string& matName) {
+    if (isBatch(matName)) {
+        batchWorkspace.erase(matName);
+        invalidateDerivedData(matName);
+        output() << "Batch '" << matName << "' deleted from workspace." << std::endl;
+        return true;
+    }
     if (!matrixExists(matName)) return false;
     workspace.erase(matName);
-    std::cout << "Matrix '" << matName << "' deleted from workspace." << std::endl;
+    sparseWorkspace.erase(matName);
+    floatWorkspace.erase(matName);
+    diskWorkspace.erase(matName);
+    invalidateDerivedData(matName);
+    output() << "Matrix '" << matName << "' deleted from workspace." << std::endl;
     return true;
 }
 
 bool Workspace::scalarMultiplyMatrix(const std::string& resultName, const std::string& matName, const double scalar)
 {
-    return handleSingleMatrixOp(matName, [this, &resultName, scalar](Matrix& m) {
-        workspace[resultName] = m * scalar;
+    if (isSparse(matName)) {
+        storeMatrix(resultName, sparseWorkspace.at(matName) * scalar);
+        return true;
+    }
+    if (isFloat32(matName)) {
+        storeMatrix(resultName, FloatMatrix(floatWorkspace.at(matName) * scalar));
+        return true;
+    }
+    return handleReadOnlyMatrixOp(matName, [this, &resultName, scalar](const Matrix& m) {
+        storeMatrix(resultName, Matrix(m * scalar));
     });
 }
 
 bool Workspace::binaryMatrixOp(const std::string& resultName, const std::string& mat1Name, const std::string& mat2Name,
     const std::function<Matrix(const Matrix&, const Matrix&)>& op) {
-    if (workspace.find(mat1Name) == workspace.end()) {
-        std::cout << "Matrix '" << mat1Name << "' not found in workspace." << std::endl;
+    MATRIX_PROFILE("Workspace::binaryMatrixOp");
+    if (!matrixExists(mat1Name)) return false;
+    if (!matrixExists(mat2Name)) return false;
+    try {
+        Matrix converted1, converted2;
+        storeMatrix(resultName, op(denseOperand(mat1Name, converted1), denseOperand(mat2Name, converted2)));
+    } catch (const MatrixException& e) {
+        output() << e.what() << std::endl;
         return false;
     }
-    if (workspace.find(mat2Name) == workspace.end()) {
-        std::cout << "Matrix '" << mat2Name << "' not found in workspace." << std::endl;
+    return true;
+}
+
+bool Workspace::floatBinaryOp(const std::string& resultName, const std::string& mat1Name, const std::string& mat2Name,
+    const std::function<FloatMatrix(const FloatMatrix&, const FloatMatrix&)>& op) {
+    MATRIX_PROFILE("Workspace::floatBinaryOp");
+    try {
+        storeMatrix(resultName, op(floatWorkspace.at(mat1Name), floatWorkspace.at(mat2Name)));
+    } catch (const MatrixException& e) {
+        output() << e.what() << std::endl;
         return false;
     }
+    return true;
+}
+
+bool Workspace::sparseBinaryOp(const std::string& resultName, const std::string& mat1Name, const std::string& mat2Name,
+    const std::function<SparseMatrix(const SparseMatrix&, const SparseMatrix&)>& sparseOp,
+    const std::function<Matrix(const SparseMatrix&, const Matrix&)>& sparseDenseOp,
+    const std::function<Matrix(const Matrix&, const SparseMatrix&)>& denseSparseOp) {
+    MATRIX_PROFILE("Workspace::sparseBinaryOp");
+    if (!matrixExists(mat1Name)) return false;
+    if (!matrixExists(mat2Name)) return false;
     try {
-        workspace[resultName] = op(workspace.at(mat1Name), workspace.at(mat2Name));
-    } catch (const MatrixDimensionMismatch& e) {
-        std::cout << e.what() << std::endl;
+        Matrix converted;
+        const bool sparse1 = isSparse(mat1Name);
+        const bool sparse2 = isSparse(mat2Name);
+        if (sparse1 && sparse2)
+            storeMatrix(resultName, sparseOp(sparseWorkspace.at(mat1Name), sparseWorkspace.at(mat2Name)));
+        else if (sparse1)
+            storeMatrix(resultName, sparseDenseOp(sparseWorkspace.at(mat1Name), denseOperand(mat2Name, converted)));
+        else
+            storeMatrix(resultName, denseSparseOp(denseOperand(mat1Name, converted), sparseWorkspace.at(mat2Name)));
+    } catch (const MatrixException& e) {
+        output() << e.what() << std::endl;
         return false;
     }
     return true;
 }
 
 bool Workspace::addMatrices(const std::string& resultName,const std::string& mat1Name, const std::string& mat2Name) {
+    if (isSparse(mat1Name) || isSparse(mat2Name))
+        return sparseBinaryOp(resultName, mat1Name, mat2Name,
+            [](const SparseMatrix& a, const SparseMatrix& b) { return a + b; },
+            [](const SparseMatrix& a, const Matrix& b) { return a + b; },
+            [](const Matrix& a, const SparseMatrix& b) { return a + b; });
+    if (isFloat32(mat1Name) && isFloat32(mat2Name))
+        return floatBinaryOp(resultName, mat1Name, mat2Name,
+            [](const FloatMatrix& a, const FloatMatrix& b) -> FloatMatrix { return a + b; });
     return binaryMatrixOp(resultName, mat1Name, mat2Name,
-        [](const Matrix& a, const Matrix& b) { return a + b; });
+        [](const Matrix& a, const Matrix& b) -> Matrix { return a + b; });
 }
 
 bool Workspace::subtractMatrices(const std::string& resultName, const std::string& mat1Name, const std::string& mat2Name) {
+    if (isSparse(mat1Name) || isSparse(mat2Name))
+        return sparseBinaryOp(resultName, mat1Name, mat2Name,
+            [](const SparseMatrix& a, const SparseMatrix& b) { return a - b; },
+            [](const SparseMatrix& a, const Matrix& b) { return a - b; },
+            [](const Matrix& a, const SparseMatrix& b) { return a - b; });
+    if (isFloat32(mat1Name) && isFloat32(mat2Name))
+        return floatBinaryOp(resultName, mat1Name, mat2Name,
+            [](const FloatMatrix& a, const FloatMatrix& b) -> FloatMatrix { return a - b; });
     return binaryMatrixOp(resultName, mat1Name, mat2Name,
-        [](const Matrix& a, const Matrix& b) { return a - b; });
+        [](const Matrix& a, const Matrix& b) -> Matrix { return a - b; });
 }
 
 bool Workspace::multiplyMatrices(const std::string& resultName, const std::string& mat1Name, const std::string& mat2Name) {
+    if (isOnDisk(mat1Name) || isOnDisk(mat2Name))
+        return diskMultiply(resultName, mat1Name, mat2Name);
+    if (isSparse(mat1Name) || isSparse(mat2Name))
+        return sparseBinaryOp(resultName, mat1Name, mat2Name,
+            [](const SparseMatrix& a, const SparseMatrix& b) { return a * b; },
+            [](const SparseMatrix& a, const Matrix& b) { return a * b; },
+            [](const Matrix& a, const SparseMatrix& b) { return a * b; });
+    if (isFloat32(mat1Name) && isFloat32(mat2Name))
+        return floatBinaryOp(resultName, mat1Name, mat2Name,
+            [](const FloatMatrix& a, const FloatMatrix& b) -> FloatMatrix { return a * b; });
     return binaryMatrixOp(resultName, mat1Name, mat2Name,
-        [](const Matrix& a, const Matrix& b) { return a * b; });
+        [](const Matrix& a, const Matrix& b) -> Matrix { return a * b; });
 }
 
-bool Workspace::saveWorkspaceToFile(const std::string& filename) const {
-    const std::string folder = "workspaces/";
-    std::filesystem::create_directories(folder);
-
-    std::ofstream ofs(folder + filename);
-    if (!ofs.is_open()) {
-        std::cout << "Could not open file for writing.\n";
+bool Workspace::diskMultiply(const std::string& resultName, const std::string& mat1Name, const std::string& mat2Name) {
+    MATRIX_PROFILE("Workspace::diskMultiply");
+    if (!matrixExists(mat1Name)) return false;
+    if (!matrixExists(mat2Name)) return false;
+    try {
+        Matrix converted;
+        if (!isOnDisk(mat1Name)) {
+            // In-memory left operand: the product is as large as the right one, so it stays on disk
+            storeMatrix(resultName, OutOfCoreMatrix(denseOperand(mat1Name, converted)) * diskWorkspace.at(mat2Name));
+        } else if (!isOnDisk(mat2Name)) {
+            storeMatrix(resultName, diskWorkspace.at(mat1Name) * denseOperand(mat2Name, converted));
+        } else {
+            storeMatrix(resultName, diskWorkspace.at(mat1Name) * diskWorkspace.at(mat2Name));
+        }
+    } catch (const MatrixException& e) {
+        output() << e.what() << std::endl;
         return false;
     }
+    return true;
+}
 
-    for (const auto& pair : workspace) {
-        const std::string& name = pair.first;
-        const Matrix& matrix = pair.second;
-        ofs << name << " " << matrix.getRows() << " " << matrix.getCols() << "\n";
+bool Workspace::saveWorkspaceToFile(const std::string& filename) const {
+    MATRIX_PROFILE("Workspace::saveWorkspaceToFile");
+    const std::string folder = "workspaces/";
+    std::filesystem::create_directories(folder);
 
-        for (int r = 0; r < matrix.getRows(); ++r) {
-            for (int c = 0; c < matrix.getCols(); ++c) {
-                ofs << matrix(r, c) << " ";
-            }
-            ofs << "\n";
-        }
+    std::vector<std::pair<std::string, const Matrix*>> matrices;
+    matrices.reserve(workspace.size());
+    for (const auto& pair : workspace)
+        matrices.emplace_back(pair.first, &pair.second);
+    std::vector<std::pair<std::string, const SparseMatrix*>> sparse;
+    sparse.reserve(sparseWorkspace.size());
+    for (const auto& pair : sparseWorkspace)
+        sparse.emplace_back(pair.first, &pair.second);
+    std::vector<std::pair<std::string, const FloatMatrix*>> floats;
+    floats.reserve(floatWorkspace.size());
+    for (const auto& pair : floatWorkspace)
+        floats.emplace_back(pair.first, &pair.second);
+    for (const auto& pair : diskWorkspace)
+        output() << "Matrix '" << pair.first << "' is stored on disk and was not saved; convert it with 'to_memory "
+                 << pair.first << "' first.\n";
+    for (const auto& pair : batchWorkspace)
+        output() << "Batch '" << pair.first << "' was not saved; workspace files hold matrices only.\n";
 
-        ofs << "\n";
+    try {
+        if (WorkspaceFile::isBinaryName(filename))
+            WorkspaceFile::writeBinary(folder + filename, matrices, sparse, floats);
+        else
+            WorkspaceFile::writeText(folder + filename, matrices, sparse, floats);
+    } catch (const MatrixException&) {
+        output() << "Could not open file for writing.\n";
+        return false;
     }
-    std::cout << "Workspace saved successfully as '" << folder + filename << "'.\n";
+    output() << "Workspace saved successfully as '" << folder + filename << "'.\n";
     return true;
 }
 
 bool Workspace::loadWorkspaceFromFile(const std::string& filename) {
+    MATRIX_PROFILE("Workspace::loadWorkspaceFromFile");
     const std::string folder = "workspaces/";
-    std::ifstream ifs(folder + filename);
-    if (!ifs.is_open()) {
-        std::cout << "Could not open workspace file '" << folder + filename << "'.\n";
+    const std::string path = folder + filename;
+    if (!std::ifstream(path).is_open()) {
+        output() << "Could not open workspace file '" << path << "'.\n";
         return false;
     }
 
-    workspace.clear();
+    std::vector<std::pair<std::string, Matrix>> matrices;
+    std::vector<std::pair<std::string, SparseMatrix>> sparse;
+    std::vector<std::pair<std::string, FloatMatrix>> floats;
+    try {
+        matrices = WorkspaceFile::isBinaryFile(path) ? WorkspaceFile::readBinary(path, &sparse, &floats)
+                                                     : WorkspaceFile::readText(path, &sparse, &floats);
+    } catch (const MatrixException& e) {
+        output() << e.what() << std::endl;
+        return false;
+    }
 
-    std::string name;
-    int rows, cols;
-    while (ifs >> name >> rows >> cols) {
-        Matrix matrix;
-        try {
-            matrix = Matrix(rows, cols);
-        } catch (const MatrixException& e) {
-            std::cout << e.what() << std::endl;
-            return false;
-        }
+    // The file is fully read and validated before the current workspace is replaced
+    workspace.clear();
+    sparseWorkspace.clear();
+    floatWorkspace.clear();
+    diskWorkspace.clear();
+    batchWorkspace.clear();
+    derivedData.clear();
+    for (auto& [name, matrix] : matrices)
+        storeMatrix(name, std::move(matrix));
+    for (auto& [name, matrix] : sparse)
+        storeMatrix(name, std::move(matrix));
+    for (auto& [name, matrix] : floats)
+        storeMatrix(name, std::move(matrix));
 
-        for (int r = 0; r < rows; ++r) {
-            for (int c = 0; c < cols; ++c) {
-                if (!(ifs >> matrix(r, c))) {
-                    std::cout << "Failed to read value for matrix ' " << name <<" ' element at ("
-                              << r << ", " << c << "). Please check the file format.\n";
-                    workspace.clear();
-                    return false;
-                }
-            }
-        }
+    output() << "Workspace loaded successfully from '" << path << "'.\n";
+    return true;
+}
 
-        workspace[name] = matrix;
-    }
+std::optional<int> Workspace::rankOf(const std::string& matName) const {
+    if (!matrixExists(matName)) return std::nullopt;
+    DerivedData& derived = derivedFor(matName);
+    if (!derived.rank && !handleReadOnlyMatrixOp(matName, [&derived](const Matrix& m) { derived.rank = m.rank(); }))
+        return std::nullopt;
+    return derived.rank;
+}
 
-    std::cout << "Workspace loaded successfully from '" << folder + filename << "'.\n";
+bool Workspace::rankMatrix(const std::string& matName) const {
+    const std::optional<int> rank = rankOf(matName);
+    if (!rank) return false;
+    output() << "Rank of matrix '" << matName << "' is: " << *rank << std::endl;
     return true;
 }
 
-bool Workspace::rankMatrix(const std::string& matName) const {
-    return handleReadOnlyMatrixOp(matName, [&matName](const Matrix& m) {
-        std::cout << "Rank of matrix '" << matName << "' is: " << m.rank() << std::endl;
-    });
+std::optional<double> Workspace::determinantOf(const std::string& matName) const {
+    if (!matrixExists(matName)) return std::nullopt;
+    try {
+        // The same kernel Matrix::determinant() picks for this size, so the value is unchanged
+        DerivedData& derived = derivedFor(matName);
+        if (!derived.determinant) {
+            Matrix converted;
+            const Matrix& matrix = denseOperand(matName, converted);
+            double det;
+            if (matrix.getRows() == matrix.getCols() &&
+                FixedKernels::determinant(matrix.getRows(), matrix.data(), det)) {
+                derived.determinant = det;
+            } else {
+                if (!derived.factorization) derived.factorization.emplace(matrix);
+                derived.determinant = derived.factorization->determinant();
+            }
+        }
+        return derived.determinant;
+    } catch (const MatrixException& e) {
+        output() << e.what() << std::endl;
+        return std::nullopt;
+    }
 }
 
 bool Workspace::determinantMatrix(const std::string& matName) const {
-    return handleReadOnlyMatrixOp(matName, [&matName](const Matrix& m) {
-        double det = m.determinant();
-        std::cout << "Determinant of matrix '" << matName
-                  << "' is: " << det << std::endl;
-    });
+    const std::optional<double> determinant = determinantOf(matName);
+    if (!determinant) return false;
+    output() << "Determinant of matrix '" << matName
+             << "' is: " << *determinant << std::endl;
+    return true;
 }
 
 
 bool Workspace::inverseMatrix(const std::string& resultName,
                               const std::string& matName)
 {
-    return handleSingleMatrixOp(matName, [this, &resultName](Matrix& m) {
-        workspace[resultName] = m.inverse();
-    });
+    if (!matrixExists(matName)) return false;
+    try {
+        // The same kernel Matrix::inverse() picks for this size, so the result is unchanged
+        DerivedData& derived = derivedFor(matName);
+        if (!derived.inverse) {
+            Matrix converted;
+            const Matrix& matrix = denseOperand(matName, converted);
+            const int n = matrix.getRows();
+            if (n == matrix.getCols() && FixedKernels::isSpecialized(n)) {
+                Matrix inverse(n, n);
+                FixedKernels::inverse(n, matrix.data(), inverse.data());
+                derived.inverse = std::move(inverse);
+            } else {
+                if (!derived.factorization) derived.factorization.emplace(matrix);
+                derived.inverse = derived.factorization->inverse();
+            }
+        }
+        storeMatrix(resultName, Matrix(*derived.inverse));
+    } catch (const MatrixException& e) {
+        output() << e.what() << std::endl;
+        return false;
+    }
+    return true;
 }
 
-bool Workspace::solveMatrix(const std::string& resultName, const std::string& A, const std::string& b) {
+bool Workspace::solveMatrix(const std::string& resultName, const std::string& A, const std::string& b,
+                            SolveStatus* status) {
+    MATRIX_PROFILE("Workspace::solveMatrix");
     if (!matrixExists(A)) return false;
     if (!matrixExists(b)) return false;
     SolveResult result;
 
     try {
-        result = workspace.at(A).solve(workspace.at(b));
+        Matrix convertedA, convertedB;
+        const Matrix& rhs = denseOperand(b, convertedB);
+        if (solverOptions.method == SolverMethod::Direct && isOnDisk(A)) {
+            const OutOfCoreMatrix& matrix = diskWorkspace.at(A);
+            result.x = matrix.solve(rhs);
+            result.status = SolveStatus::Unique;
+        } else if (solverOptions.method != SolverMethod::Direct && isSparse(A)) {
+            result = IterativeSolvers::solve(sparseWorkspace.at(A), rhs, solverOptions);
+        } else {
+            const Matrix& dense = denseOperand(A, convertedA);
+            bool solved = false;
+            if (solverOptions.method == SolverMethod::Direct && dense.getRows() == dense.getCols() &&
+                rhs.getRows() == dense.getRows() && rhs.getCols() == 1) {
+                // The same solve Matrix::solve() performs: FixedKernels for the sizes it
+                // specializes, otherwise LU with the factors reused
+                const int n = dense.getRows();
+                if (FixedKernels::isSpecialized(n)) {
+                    Matrix x(n, 1);
+                    if (FixedKernels::solve(n, dense.data(), rhs.data(), x.data())) {
+                        result.x = std::move(x);
+                        result.status = SolveStatus::Unique;
+                        solved = true;
+                    }
+                } else {
+                    DerivedData& derived = derivedFor(A);
+                    if (!derived.factorization)
+                        derived.factorization.emplace(dense);
+                    if (!derived.factorization->isSingular()) {
+                        result.x = derived.factorization->solve(rhs);
+                        result.status = SolveStatus::Unique;
+                        solved = true;
+                    }
+                }
+            }
+            if (!solved)
+                result = IterativeSolvers::solve(dense, rhs, solverOptions);
+        }
     } catch (const MatrixException& e) {
-        std::cout << e.what() << std::endl;
+        output() << e.what() << std::endl;
         return false;
     }
 
+    if (status) *status = result.status;
+    const std::string method = IterativeSolvers::methodName(solverOptions.method);
     switch (result.status) {
         case SolveStatus::NoSolution:
-            std::cout << "The system has no solution." << std::endl;
+            output() << "The system has no solution." << std::endl;
             return true;
         case SolveStatus::Infinite:
-            std::cout << "The system has infinite solutions." << std::endl;
+            output() << "The system has infinite solutions." << std::endl;
+            return true;
+        case SolveStatus::NotConverged:
+            output() << "The " << method << " solver did not converge within " << result.iterations
+                     << " iterations (relative residual "
+                     << formatResidual(result.residual) << ")." << std::endl;
             return true;
         case SolveStatus::Unique:
-            workspace[resultName] = result.x;
-            std::cout << "The system has a unique solution, saved as '" << resultName << "'." << std::endl;
+            storeMatrix(resultName, std::move(result.x));
+            if (solverOptions.method == SolverMethod::Direct) {
+                output() << "The system has a unique solution, saved as '" << resultName << "'." << std::endl;
+            } else {
+                output() << "The " << method << " solver converged in " << result.iterations
+                         << " iterations (relative residual "
+                         << formatResidual(result.residual) << "), solution saved as '"
+                         << resultName << "'." << std::endl;
+            }
             return true;
         default:
-            std::cout << "Unknown solve status." << std::endl;
+            output() << "Unknown solve status." << std::endl;
+            return false;
+    }
+
+}
+
+bool Workspace::factorMatrix(const std::string& matName) {
+    MATRIX_PROFILE("Workspace::factorMatrix");
+    if (!matrixExists(matName)) return false;
+    try {
+        if (factorizationFor(matName).isSingular()) {
+            output() << MatrixSingular().what() << std::endl;
             return false;
+        }
+    } catch (const MatrixException& e) {
+        output() << e.what() << std::endl;
+        return false;
+    }
+    output() << "LU factorization of matrix '" << matName << "' stored." << std::endl;
+    return true;
+}
+
+bool Workspace::solveWithFactorization(const std::string& resultName, const std::string& A, const std::string& b) {
+    MATRIX_PROFILE("Workspace::solveWithFactorization");
+    if (!matrixExists(A)) return false;
+    if (!matrixExists(b)) return false;
+
+    try {
+        Matrix convertedB;
+        storeMatrix(resultName, factorizationFor(A).solve(denseOperand(b, convertedB)));
+    } catch (const MatrixException& e) {
+        output() << e.what() << std::endl;
+        return false;
     }
+    output() << "The system has a unique solution, saved as '" << resultName << "'." << std::endl;
+    return true;
+}
 
+bool Workspace::leastSquaresMatrix(const std::string& resultName, const std::string& A, const std::string& b) {
+    MATRIX_PROFILE("Workspace::leastSquaresMatrix");
+    if (!matrixExists(A)) return false;
+    if (!matrixExists(b)) return false;
+
+    int rank = 0, cols = 0;
+    double residual = 0.0;
+    try {
+        Matrix convertedA, convertedB;
+        const QRDecomposition qr(denseOperand(A, convertedA));
+        rank = qr.rank();
+        cols = qr.cols();
+        storeMatrix(resultName, qr.leastSquares(denseOperand(b, convertedB), &residual));
+    } catch (const MatrixException& e) {
+        output() << e.what() << std::endl;
+        return false;
+    }
+    output() << "Least-squares solution (rank " << rank << " of " << cols << " columns, relative residual "
+             << formatResidual(residual) << ") saved as '" << resultName << "'." << std::endl;
+    return true;
+}
+
+bool Workspace::createBatch(const std::string& batchName, const int count, const int rows, const int cols,
+                            const double initValue) {
+    MatrixBatch batch;
+    try {
+        batch = MatrixBatch(count, rows, cols, initValue);
+    } catch (const MatrixException& e) {
+        output() << e.what() << std::endl;
+        return false;
+    }
+    storeBatch(batchName, std::move(batch));
+    output() << "Batch '" << batchName << "' created:\n"
+             << "  " << count << " matrices of " << rows << " x " << cols << std::endl;
+    return true;
+}
+
+bool Workspace::insertIntoBatch(const std::string& batchName, const int index, const std::string& matName) {
+    if (!batchExists(batchName)) return false;
+    if (!matrixExists(matName)) return false;
+    try {
+        Matrix converted;
+        batchWorkspace.at(batchName).setMatrix(index, denseOperand(matName, converted));
+    } catch (const MatrixException& e) {
+        output() << e.what() << std::endl;
+        return false;
+    }
+    invalidateDerivedData(batchName);
+    return true;
+}
+
+bool Workspace::extractFromBatch(const std::string& matName, const std::string& batchName, const int index) {
+    if (!batchExists(batchName)) return false;
+    Matrix matrix;
+    try {
+        matrix = batchWorkspace.at(batchName).matrix(index);
+    } catch (const MatrixException& e) {
+        output() << e.what() << std::endl;
+        return false;
+    }
+    storeMatrix(matName, std::move(matrix));
+    return true;
+}
+
+bool Workspace::multiplyBatches(const std::string& resultName, const std::string& A, const std::string& B) {
+    MATRIX_PROFILE("Workspace::multiplyBatches");
+    if (!batchExists(A)) return false;
+    if (!batchExists(B)) return false;
+    try {
+        storeBatch(resultName, batchMultiply(batchWorkspace.at(A), batchWorkspace.at(B)));
+    } catch (const MatrixException& e) {
+        output() << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool Workspace::solveBatches(const std::string& resultName, const std::string& A, const std::string& B) {
+    MATRIX_PROFILE("Workspace::solveBatches");
+    if (!batchExists(A)) return false;
+    if (!batchExists(B)) return false;
+    BatchSolveResult result;
+    try {
+        result = batchSolve(batchWorkspace.at(A), batchWorkspace.at(B));
+    } catch (const MatrixException& e) {
+        output() << e.what() << std::endl;
+        return false;
+    }
+    const std::size_t count = result.singular.size();
+    storeBatch(resultName, std::move(result.x));
+    output() << "Solutions of " << count << " systems saved as '" << resultName << "'." << std::endl;
+    reportSingularCount(result);
+    return true;
+}
+
+bool Workspace::batchDeterminants(const std::string& resultName, const std::string& batchName) {
+    MATRIX_PROFILE("Workspace::batchDeterminants");
+    if (!batchExists(batchName)) return false;
+    const MatrixBatch& batch = batchWorkspace.at(batchName);
+    if (batch.count() == 0) {
+        output() << "Batch '" << batchName << "' is empty." << std::endl;
+        return false;
+    }
+    try {
+        const std::vector<double> det = batchDeterminant(batch);
+        Matrix column(static_cast<int>(det.size()), 1);
+        std::copy(det.begin(), det.end(), column.data());
+        storeMatrix(resultName, std::move(column));
+    } catch (const MatrixException& e) {
+        output() << e.what() << std::endl;
+        return false;
+    }
+    output() << "Determinants saved as '" << resultName << "'." << std::endl;
+    return true;
+}
+
+bool Workspace::invertBatch(const std::string& resultName, const std::string& batchName) {
+    MATRIX_PROFILE("Workspace::invertBatch");
+    if (!batchExists(batchName)) return false;
+    BatchSolveResult result;
+    try {
+        result = batchInverse(batchWorkspace.at(batchName));
+    } catch (const MatrixException& e) {
+        output() << e.what() << std::endl;
+        return false;
+    }
+    storeBatch(resultName, std::move(result.x));
+    reportSingularCount(result);
+    return true;
+}
+
+bool Workspace::setExecutionPolicy(const ExecutionPolicy& policy) {
+    Parallel::setDefaultPolicy(policy);
+    output() << "Execution policy set to " << policy.describe() << "." << std::endl;
+    return true;
+}
+
+bool Workspace::showExecutionPolicy() const {
+    output() << "Execution policy: " << Parallel::defaultPolicy().describe() << "." << std::endl;
+    return true;
+}
+
+bool Workspace::setSolver(const SolverOptions& options) {
+    if (!(options.tolerance > 0.0) || options.maxIterations <= 0 || options.restart <= 0) {
+        output() << "Solver tolerance and iteration limit must be positive." << std::endl;
+        return false;
+    }
+    solverOptions = options;
+    output() << "Solver set to " << solverOptions.describe() << "." << std::endl;
+    return true;
+}
+
+bool Workspace::showSolver() const {
+    output() << "Solver: " << solverOptions.describe() << "." << std::endl;
+    return true;
+}
+
+namespace {
+    bool reportProfilingDisabled(std::ostream& out) {
+        if (Profiler::compiledIn()) return false;
+        out << "Profiling is not available in this build (configure with -DMATRIX_PROFILING=ON)." << std::endl;
+        return true;
+    }
+
+    std::string formatBytes(std::uint64_t bytes) {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(1);
+        if (bytes < (1u << 10)) out << bytes << " B";
+        else if (bytes < (1u << 20)) out << bytes / 1024.0 << " KiB";
+        else if (bytes < (1u << 30)) out << bytes / (1024.0 * 1024.0) << " MiB";
+        else out << bytes / (1024.0 * 1024.0 * 1024.0) << " GiB";
+        return out.str();
+    }
+}
+
+bool Workspace::showStatistics() const {
+    if (reportProfilingDisabled(output())) return false;
+    const std::vector<Profiler::Counters> counters = Profiler::statistics();
+    if (counters.empty()) {
+        output() << "No operations recorded yet." << std::endl;
+        return true;
+    }
+
+    std::ostringstream out;
+    out << std::left << std::setw(36) << "Operation" << std::right << std::setw(9) << "Calls"
+        << std::setw(14) << "Total ms" << std::setw(12) << "Mean us" << std::setw(10) << "GFLOP/s"
+        << std::setw(13) << "Allocated" << '\n';
+    out << std::fixed;
+    for (const Profiler::Counters& c : counters) {
+        out << std::left << std::setw(36) << c.name << std::right << std::setw(9) << c.calls
+            << std::setprecision(3) << std::setw(14) << c.nanoseconds / 1e6
+            << std::setprecision(1) << std::setw(12) << c.nanoseconds / 1e3 / c.calls;
+        if (c.flops > 0 && c.nanoseconds > 0)
+            out << std::setprecision(2) << std::setw(10) << static_cast<double>(c.flops) / c.nanoseconds;
+        else
+            out << std::setw(10) << "-";
+        out << std::setw(13) << formatBytes(c.bytesAllocated) << '\n';
+    }
+    output() << out.str() << std::flush;
+    return true;
+}
+
+bool Workspace::resetStatistics() {
+    if (reportProfilingDisabled(output())) return false;
+    Profiler::reset();
+    output() << "Profiling counters reset." << std::endl;
+    return true;
+}
+
+bool Workspace::startTrace() {
+    if (reportProfilingDisabled(output())) return false;
+    Profiler::startTrace();
+    output() << "Recording a trace." << std::endl;
+    return true;
+}
+
+bool Workspace::stopTrace(const std::string& filename) {
+    if (reportProfilingDisabled(output())) return false;
+    if (!Profiler::isTracing()) {
+        output() << "No trace is being recorded (use 'trace start')." << std::endl;
+        return false;
+    }
+    try {
+        const std::size_t dropped = Profiler::droppedTraceEvents();
+        const std::size_t events = Profiler::writeTrace(filename);
+        output() << "Trace of " << events << " events written to '" << filename << "'";
+        if (dropped > 0) output() << " (" << dropped << " later events dropped)";
+        output() << "." << std::endl;
+    } catch (const std::exception& e) {
+        output() << "Could not write trace: " << e.what() << "." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void Workspace::endCommand() {
+    MatrixMemory::trim(IDLE_CACHE_BYTES);
 }
 
 bool Workspace::handleSingleMatrixOp(
     const std::string& matName,
     const std::function<void(Matrix&)>& op)
 {
+    MATRIX_PROFILE("Workspace::handleSingleMatrixOp");
     if (!matrixExists(matName)) return false;
+    if (isSparse(matName)) {
+        reportSparseUnsupported(output(), matName);
+        return false;
+    }
+    if (isFloat32(matName)) {
+        reportFloat32Unsupported(output(), matName);
+        return false;
+    }
+    if (isOnDisk(matName)) {
+        reportOnDiskUnsupported(output(), matName);
+        return false;
+    }
     try {
         op(workspace.at(matName));
     } catch (const MatrixException& e) {
-        std::cout << e.what() << std::endl;
+        output() << e.what() << std::endl;
         return false;
     }
+    invalidateDerivedData(matName);
     return true;
 }
 
@@ -263,9 +1322,10 @@ bool Workspace::handleReadOnlyMatrixOp(
 {
     if (!matrixExists(matName)) return false;
     try {
-        op(workspace.at(matName));
+        Matrix converted;
+        op(denseOperand(matName, converted));
     } catch (const MatrixException& e) {
-        std::cout << e.what() << std::endl;
+        output() << e.what() << std::endl;
         return false;
     }
     return true;
@@ -277,7 +1337,41 @@ bool Workspace::rotate3DVector(const std::string& vecName,
                         double angleDegreesX,
                         double angleDegreesY,
                         double angleDegreesZ) {
-    return handleSingleMatrixOp(vecName,[this, vecName,angleDegreesX, angleDegreesY, angleDegreesZ](Matrix& vec) {
-            workspace[vecName] = vec.rotate3D(angleDegreesX, angleDegreesY, angleDegreesZ);
-    });
+    return rotate3DVectors({vecName}, angleDegreesX, angleDegreesY, angleDegreesZ);
+}
+
+bool Workspace::rotate3DVectors(const std::vector<std::string>& vecNames,
+                         double angleDegreesX,
+                         double angleDegreesY,
+                         double angleDegreesZ) {
+    MATRIX_PROFILE("Workspace::rotate3DVectors");
+    for (const std::string& vecName : vecNames) {
+        if (!matrixExists(vecName)) return false;
+        if (isSparse(vecName)) {
+            reportSparseUnsupported(output(), vecName);
+            return false;
+        }
+        if (isOnDisk(vecName)) {
+            reportOnDiskUnsupported(output(), vecName);
+            return false;
+        }
+        const int rows = isFloat32(vecName) ? floatWorkspace.at(vecName).getRows() : workspace.at(vecName).getRows();
+        const int cols = isFloat32(vecName) ? floatWorkspace.at(vecName).getCols() : workspace.at(vecName).getCols();
+        if (rows != 3) {
+            output() << MatrixDimensionMismatch(3, 3, rows, cols).what() << std::endl;
+            return false;
+        }
+    }
+
+    const Mat3 rotation = Rotation3D::fromAngles(angleDegreesX, angleDegreesY, angleDegreesZ);
+    std::unordered_set<std::string> rotated;
+    for (const std::string& vecName : vecNames) {
+        if (!rotated.insert(vecName).second) continue; // listed twice: rotate it once
+        if (isFloat32(vecName))
+            floatWorkspace.at(vecName).rotate3DInPlace(rotation);
+        else
+            workspace.at(vecName).rotate3DInPlace(rotation);
+        invalidateDerivedData(vecName);
+    }
+    return true;
 }
@@ -0,0 +1,703 @@
+#include "WorkspaceFile.h"
+#include "MatrixException.h"
+#include "Parallel.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string_view>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define WORKSPACE_FILE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+    constexpr char MAGIC[8] = {'A', 'M', 'W', 'S', 'B', 'I', 'N', '\0'};
+    constexpr std::uint32_t VERSION = 3;            // 2 added sparse matrices, 3 float32 ones
+    constexpr std::uint32_t OLDEST_READABLE_VERSION = 1;
+    constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+    constexpr std::uint64_t PAYLOAD_ALIGNMENT = 64;
+
+    struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byteOrderMark;
+        std::uint64_t matrixCount;
+        std::uint64_t nameTableOffset;
+        std::uint64_t nameTableSize;
+        std::uint64_t directoryOffset;
+        std::uint64_t reserved[2];
+    };
+    static_assert(sizeof(Header) == 64, "header layout must not change");
+
+    struct DirectoryEntry {
+        std::uint64_t nameOffset;  // relative to the name table
+        std::uint32_t nameLength;
+        std::int32_t rows;
+        std::int32_t cols;
+        std::uint32_t kind;        // KIND_DENSE, KIND_SPARSE or KIND_FLOAT32 (always 0 before version 2)
+        std::uint64_t dataOffset;  // absolute, PAYLOAD_ALIGNMENT-aligned
+    };
+    static_assert(sizeof(DirectoryEntry) == 32, "directory layout must not change");
+
+    constexpr std::uint32_t KIND_DENSE = 0;
+    constexpr std::uint32_t KIND_SPARSE = 1;
+    constexpr std::uint32_t KIND_FLOAT32 = 2;
+
+    std::uint64_t alignUp(std::uint64_t offset) {
+        return (offset + PAYLOAD_ALIGNMENT - 1) / PAYLOAD_ALIGNMENT * PAYLOAD_ALIGNMENT;
+    }
+
+    /**
+     * Byte offsets of the parts of a sparse payload, relative to its start.
+     */
+    struct SparseLayout {
+        std::uint64_t rowStart;
+        std::uint64_t colIndex;
+        std::uint64_t values;
+        std::uint64_t size;
+
+        SparseLayout(std::uint64_t rows, std::uint64_t count) {
+            rowStart = sizeof(std::uint64_t);
+            colIndex = rowStart + (rows + 1) * sizeof(std::uint64_t);
+            values = colIndex + (count * sizeof(std::int32_t) + 7) / 8 * 8;
+            size = values + count * sizeof(double);
+        }
+    };
+
+    /**
+     * Read-only view of a whole file: memory-mapped where the platform
+     * supports it, read into memory otherwise.
+     */
+    class FileView {
+    public:
+        explicit FileView(const std::string& path) {
+#ifdef WORKSPACE_FILE_MMAP
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) throw WorkspaceFileCorrupt("cannot open '" + path + "'");
+            struct stat info {};
+            if (::fstat(fd, &info) != 0) {
+                ::close(fd);
+                throw WorkspaceFileCorrupt("cannot read '" + path + "'");
+            }
+            _size = static_cast<std::size_t>(info.st_size);
+            if (_size > 0) {
+                void* mapped = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapped == MAP_FAILED) {
+                    ::close(fd);
+                    throw WorkspaceFileCorrupt("cannot map '" + path + "'");
+                }
+                // Both formats are read front to back (text: once more from cache)
+                ::madvise(mapped, _size, MADV_SEQUENTIAL);
+                _data = static_cast<const unsigned char*>(mapped);
+            }
+            ::close(fd); // the mapping stays valid
+#else
+            std::ifstream ifs(path, std::ios::binary | std::ios::ate);
+            if (!ifs) throw WorkspaceFileCorrupt("cannot open '" + path + "'");
+            _buffer.resize(static_cast<std::size_t>(ifs.tellg()));
+            ifs.seekg(0);
+            ifs.read(reinterpret_cast<char*>(_buffer.data()), static_cast<std::streamsize>(_buffer.size()));
+            if (!ifs) throw WorkspaceFileCorrupt("cannot read '" + path + "'");
+            _data = _buffer.data();
+            _size = _buffer.size();
+#endif
+        }
+
+        ~FileView() {
+#ifdef WORKSPACE_FILE_MMAP
+            if (_data) ::munmap(const_cast<unsigned char*>(_data), _size);
+#endif
+        }
+
+        FileView(const FileView&) = delete;
+        FileView& operator=(const FileView&) = delete;
+
+        [[nodiscard]] const unsigned char* data() const { return _data; }
+        [[nodiscard]] std::size_t size() const { return _size; }
+
+        /**
+         * True if [offset, offset + length) lies inside the file (overflow-safe).
+         */
+        [[nodiscard]] bool contains(std::uint64_t offset, std::uint64_t length) const {
+            return offset <= _size && length <= _size - offset;
+        }
+
+    private:
+        const unsigned char* _data = nullptr;
+        std::size_t _size = 0;
+#ifndef WORKSPACE_FILE_MMAP
+        std::vector<unsigned char> _buffer;
+#endif
+    };
+
+    /**
+     * Size in bytes of a dense or float32 entry, checked to lie inside the file.
+     */
+    std::uint64_t checkDensePayload(const FileView& file, const DirectoryEntry& entry, const std::string& name,
+                                    std::size_t elementSize) {
+        if (entry.rows <= 0 || entry.cols <= 0)
+            throw MatrixInvalidInitialization();
+        const std::uint64_t bytes = static_cast<std::uint64_t>(entry.rows) * static_cast<std::uint64_t>(entry.cols) * elementSize;
+        if (!file.contains(entry.dataOffset, bytes))
+            throw WorkspaceFileCorrupt("truncated data for matrix '" + name + "'");
+        return bytes;
+    }
+
+    /**
+     * Copy the CSR arrays of a sparse payload out of the file; fromCSR()
+     * then checks that they describe a valid matrix.
+     */
+    SparseMatrix readSparsePayload(const FileView& file, const DirectoryEntry& entry, const std::string& name) {
+        std::uint64_t count = 0;
+        if (entry.rows <= 0 || entry.cols <= 0)
+            throw MatrixInvalidInitialization();
+        if (!file.contains(entry.dataOffset, sizeof(count)))
+            throw WorkspaceFileCorrupt("truncated data for matrix '" + name + "'");
+        std::memcpy(&count, file.data() + entry.dataOffset, sizeof(count));
+        if (count > file.size() / sizeof(double))
+            throw WorkspaceFileCorrupt("truncated data for matrix '" + name + "'");
+
+        const SparseLayout layout(static_cast<std::uint64_t>(entry.rows), count);
+        if (!file.contains(entry.dataOffset, layout.size))
+            throw WorkspaceFileCorrupt("truncated data for matrix '" + name + "'");
+        const unsigned char* payload = file.data() + entry.dataOffset;
+
+        std::vector<std::size_t> rowStart(static_cast<std::size_t>(entry.rows) + 1);
+        std::vector<int> colIndex(count);
+        std::vector<double> values(count);
+        std::memcpy(rowStart.data(), payload + layout.rowStart, layout.colIndex - layout.rowStart);
+        std::memcpy(colIndex.data(), payload + layout.colIndex, count * sizeof(std::int32_t));
+        std::memcpy(values.data(), payload + layout.values, count * sizeof(double));
+        return SparseMatrix::fromCSR(entry.rows, entry.cols, std::move(rowStart), std::move(colIndex), std::move(values));
+    }
+
+    // ==== Text format helpers ====
+
+    constexpr std::size_t WRITE_BUFFER_SIZE = 1 << 20;
+
+    bool isSpace(char c) {
+        return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    const char* skipSpace(const char* p, const char* end) {
+        while (p != end && isSpace(*p)) ++p;
+        return p;
+    }
+
+    const char* tokenEnd(const char* p, const char* end) {
+        while (p != end && !isSpace(*p)) ++p;
+        return p;
+    }
+
+    /**
+     * Parse a whole token as a double or float. Accepts what the writer
+     * produces (shortest round-trip, "inf", "nan") plus an optional leading '+'.
+     */
+    template <typename Real>
+    bool parseReal(const char* begin, const char* end, Real& value) {
+        if (begin != end && *begin == '+') ++begin;
+        auto [ptr, ec] = std::from_chars(begin, end, value);
+        return ec == std::errc() && ptr == end;
+    }
+
+    template <typename Integer>
+    bool parseInt(const char* begin, const char* end, Integer& value) {
+        if (begin != end && *begin == '+') ++begin;
+        auto [ptr, ec] = std::from_chars(begin, end, value);
+        return ec == std::errc() && ptr == end;
+    }
+
+    constexpr std::string_view SPARSE_MARKER = "sparse";
+    constexpr std::string_view FLOAT32_MARKER = "float32";
+
+    /**
+     * Parse the `<count>` and `<row> <col> <value>` entries that follow a
+     * sparse header, advancing p past them.
+     */
+    SparseMatrix readSparseEntries(const char*& p, const char* end,
+                                   const std::string& name, int rows, int cols) {
+        auto next = [&p, end](const char*& token) {
+            token = skipSpace(p, end);
+            p = tokenEnd(token, end);
+            return token != p;
+        };
+        const char* token = nullptr;
+        std::size_t count = 0;
+        if (!next(token) || !parseInt(token, p, count))
+            throw WorkspaceFileCorrupt("bad entry count for sparse matrix '" + name + "'");
+        // Every entry takes at least 6 characters, which bounds a bogus count
+        if (count > static_cast<std::size_t>(end - p) / 6 + 1)
+            throw WorkspaceFileCorrupt("missing entries for sparse matrix '" + name + "'");
+
+        std::vector<SparseMatrix::Triplet> entries(count);
+        for (std::size_t k = 0; k < count; ++k) {
+            SparseMatrix::Triplet& entry = entries[k];
+            const bool ok = next(token) && parseInt(token, p, entry.row) &&
+                            next(token) && parseInt(token, p, entry.col) &&
+                            next(token) && parseReal(token, p, entry.value);
+            if (!ok)
+                throw WorkspaceFileCorrupt("bad entry #" + std::to_string(k) + " of sparse matrix '" + name + "'");
+        }
+        return SparseMatrix::fromTriplets(rows, cols, std::move(entries));
+    }
+
+    /**
+     * A run of up to VALUES_PER_BLOCK consecutive values of one matrix,
+     * located by the scanning pass and decoded independently.
+     */
+    struct TextBlock {
+        std::size_t matrix;  // index into the result
+        std::size_t first;   // first element index within the matrix
+        std::size_t count;   // number of values
+        const char* text;    // start of the first value
+    };
+
+    /**
+     * Appends text to a large buffer and hands it to the stream in big writes.
+     */
+    class BufferedWriter {
+    public:
+        explicit BufferedWriter(std::ofstream& out) : _out(out) { _buffer.reserve(WRITE_BUFFER_SIZE); }
+
+        void append(const char* text, std::size_t length) {
+            if (_buffer.size() + length > WRITE_BUFFER_SIZE) flush();
+            _buffer.append(text, length);
+        }
+        void append(const std::string& text) { append(text.data(), text.size()); }
+        void append(char c) { append(&c, 1); }
+
+        void append(double value) {
+            char digits[32];
+            auto [ptr, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+            append(digits, static_cast<std::size_t>(ptr - digits));
+        }
+
+        void append(float value) {
+            char digits[32];
+            auto [ptr, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+            append(digits, static_cast<std::size_t>(ptr - digits));
+        }
+
+        void append(int value) {
+            char digits[16];
+            auto [ptr, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+            append(digits, static_cast<std::size_t>(ptr - digits));
+        }
+
+        void flush() {
+            _out.write(_buffer.data(), static_cast<std::streamsize>(_buffer.size()));
+            _buffer.clear();
+        }
+
+    private:
+        std::ofstream& _out;
+        std::string _buffer;
+    };
+}
+
+namespace WorkspaceFile {
+
+    bool isBinaryName(const std::string& filename) {
+        const std::string extension = BINARY_EXTENSION;
+        return filename.size() >= extension.size() &&
+               filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0;
+    }
+
+    bool isBinaryFile(const std::string& path) {
+        std::ifstream ifs(path, std::ios::binary);
+        char magic[sizeof(MAGIC)] = {};
+        if (!ifs.read(magic, sizeof(magic))) return false;
+        return std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+    }
+
+    void writeText(const std::string& path,
+                   const std::vector<std::pair<std::string, const Matrix*>>& matrices,
+                   const std::vector<std::pair<std::string, const SparseMatrix*>>& sparse,
+                   const std::vector<std::pair<std::string, const FloatMatrix*>>& floats) {
+        MATRIX_PROFILE("WorkspaceFile::writeText");
+        std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+        if (!ofs) throw WorkspaceFileCorrupt("cannot open '" + path + "' for writing");
+
+        BufferedWriter out(ofs);
+        auto writeDense = [&out](const std::string& name, const auto& matrix, bool single) {
+            out.append(name);
+            out.append(' ');
+            out.append(matrix.getRows());
+            out.append(' ');
+            out.append(matrix.getCols());
+            if (single) {
+                out.append(' ');
+                out.append(std::string(FLOAT32_MARKER));
+            }
+            out.append('\n');
+
+            const auto* values = matrix.data();
+            for (int r = 0; r < matrix.getRows(); ++r) {
+                for (int c = 0; c < matrix.getCols(); ++c) {
+                    out.append(*values++);
+                    out.append(' ');
+                }
+                out.append('\n');
+            }
+            out.append('\n');
+        };
+        for (const auto& [name, matrix] : matrices)
+            writeDense(name, *matrix, false);
+        for (const auto& [name, matrix] : sparse) {
+            out.append(name);
+            out.append(' ');
+            out.append(matrix->getRows());
+            out.append(' ');
+            out.append(matrix->getCols());
+            out.append(" sparse ");
+            out.append(std::to_string(matrix->nonZeros()));
+            out.append('\n');
+
+            const auto& rowStart = matrix->rowStart();
+            for (int r = 0; r < matrix->getRows(); ++r) {
+                for (std::size_t p = rowStart[r]; p < rowStart[r + 1]; ++p) {
+                    out.append(r);
+                    out.append(' ');
+                    out.append(matrix->colIndex()[p]);
+                    out.append(' ');
+                    out.append(matrix->values()[p]);
+                    out.append('\n');
+                }
+            }
+            out.append('\n');
+        }
+        for (const auto& [name, matrix] : floats)
+            writeDense(name, *matrix, true);
+        out.flush();
+
+        if (!ofs.flush()) throw WorkspaceFileCorrupt("failed writing '" + path + "'");
+    }
+
+    std::vector<std::pair<std::string, Matrix>> readText(
+        const std::string& path, std::vector<std::pair<std::string, SparseMatrix>>* sparse,
+        std::vector<std::pair<std::string, FloatMatrix>>* floats) {
+        MATRIX_PROFILE("WorkspaceFile::readText");
+        FileView file(path);
+        const char* p = reinterpret_cast<const char*>(file.data());
+        const char* const end = p + file.size();
+
+        std::vector<std::pair<std::string, Matrix>> matrices;
+        std::vector<char> single; // per matrix: written as float32
+        std::vector<TextBlock> blocks;
+
+        // Problems found while scanning; reported only if no earlier value
+        // turns out to be bad during decoding.
+        std::exception_ptr headerError;
+        std::string missingName;
+        int missingCols = 1;
+        std::size_t missingElement = 0;
+        bool missing = false;
+
+        // Pass 1 (serial, no number parsing): split tokens, read headers and
+        // remember where every block of values starts.
+        while (!missing && !headerError) {
+            p = skipSpace(p, end);
+            if (p == end) break;
+            const char* nameEnd = tokenEnd(p, end);
+            std::string name(p, nameEnd);
+
+            int dims[2];
+            p = nameEnd;
+            bool headerOk = true;
+            for (int& dim : dims) {
+                const char* start = skipSpace(p, end);
+                p = tokenEnd(start, end);
+                if (start == p || !parseInt(start, p, dim)) { headerOk = false; break; }
+            }
+            if (!headerOk) break;
+
+            const char* markerStart = skipSpace(p, end);
+            const char* markerEnd = tokenEnd(markerStart, end);
+            if (std::string_view(markerStart, static_cast<std::size_t>(markerEnd - markerStart)) == SPARSE_MARKER) {
+                p = markerEnd;
+                try {
+                    SparseMatrix matrix = readSparseEntries(p, end, name, dims[0], dims[1]);
+                    if (sparse)
+                        sparse->emplace_back(std::move(name), std::move(matrix));
+                    else {
+                        matrices.emplace_back(std::move(name), matrix.toDense());
+                        single.push_back(false);
+                    }
+                } catch (const MatrixException&) {
+                    headerError = std::current_exception();
+                }
+                continue;
+            }
+            const bool isFloat32 =
+                std::string_view(markerStart, static_cast<std::size_t>(markerEnd - markerStart)) == FLOAT32_MARKER;
+            if (isFloat32) p = markerEnd;
+
+            // Every value takes at least 2 characters, which bounds a bogus header
+            // before anything is allocated for it. A matrix cut short is checked
+            // serially up to its first bad or missing value; it is the last one
+            // in the file, so that is the value to report if no earlier one is bad.
+            const std::uint64_t claimed = dims[0] > 0 && dims[1] > 0
+                                              ? static_cast<std::uint64_t>(dims[0]) * static_cast<std::uint64_t>(dims[1])
+                                              : 0;
+            if (claimed > static_cast<std::uint64_t>(end - p) / 2 + 1) {
+                std::size_t k = 0;
+                for (p = skipSpace(p, end); p != end; p = skipSpace(p, end), ++k) {
+                    const char* valueEnd = tokenEnd(p, end);
+                    float narrow = 0.0f;
+                    double wide = 0.0;
+                    if (!(isFloat32 ? parseReal(p, valueEnd, narrow) : parseReal(p, valueEnd, wide))) break;
+                    p = valueEnd;
+                }
+                missing = true;
+                missingName = name;
+                missingCols = dims[1];
+                missingElement = k;
+                break;
+            }
+
+            try {
+                matrices.emplace_back(std::move(name), Matrix(dims[0], dims[1]));
+                single.push_back(isFloat32);
+            } catch (const MatrixException&) {
+                headerError = std::current_exception();
+                break;
+            }
+
+            const std::size_t index = matrices.size() - 1;
+            const std::size_t total = static_cast<std::size_t>(dims[0]) * dims[1];
+            for (std::size_t k = 0; k < total; ++k) {
+                p = skipSpace(p, end);
+                if (p == end) {
+                    missing = true;
+                    missingName = matrices[index].first;
+                    missingCols = dims[1];
+                    missingElement = k;
+                    break;
+                }
+                if (k % VALUES_PER_BLOCK == 0)
+                    blocks.push_back({ index, k, std::min(VALUES_PER_BLOCK, total - k), p });
+                p = tokenEnd(p, end);
+            }
+        }
+
+        // Pass 2 (parallel): decode every block straight into its matrix.
+        // float32 values are parsed as floats (so they round-trip exactly)
+        // and held as doubles until the matrix is narrowed below.
+        constexpr std::size_t NO_FAILURE = std::numeric_limits<std::size_t>::max();
+        std::vector<std::size_t> failedAt(blocks.size(), NO_FAILURE);
+        Parallel::parallelFor(0, static_cast<int>(blocks.size()),
+                              Parallel::minChunkFor(static_cast<long long>(VALUES_PER_BLOCK)), [&](int b0, int b1) {
+            for (int b = b0; b < b1; ++b) {
+                const TextBlock& block = blocks[b];
+                double* out = matrices[block.matrix].second.data() + block.first;
+                const bool asFloat = single[block.matrix];
+                const char* q = block.text;
+                for (std::size_t i = 0; i < block.count; ++i) {
+                    q = skipSpace(q, end);
+                    const char* valueEnd = tokenEnd(q, end);
+                    float narrow = 0.0f;
+                    const bool ok = asFloat ? parseReal(q, valueEnd, narrow) : parseReal(q, valueEnd, out[i]);
+                    if (q == valueEnd || !ok) {
+                        failedAt[b] = block.first + i;
+                        break;
+                    }
+                    if (asFloat) out[i] = narrow;
+                    q = valueEnd;
+                }
+            }
+        });
+
+        // Report the first problem in file order
+        auto badValue = [&](std::size_t matrix, std::size_t element) {
+            const auto& [name, m] = matrices[matrix];
+            const int cols = m.getCols();
+            return WorkspaceFileBadValue(name, static_cast<int>(element / cols), static_cast<int>(element % cols));
+        };
+        for (std::size_t b = 0; b < blocks.size(); ++b) {
+            if (failedAt[b] != NO_FAILURE)
+                throw badValue(blocks[b].matrix, failedAt[b]);
+        }
+        if (missing)
+            throw WorkspaceFileBadValue(missingName, static_cast<int>(missingElement / missingCols),
+                                        static_cast<int>(missingElement % missingCols));
+        if (headerError) std::rethrow_exception(headerError);
+
+        if (floats) {
+            std::vector<std::pair<std::string, Matrix>> wide;
+            wide.reserve(matrices.size());
+            for (std::size_t i = 0; i < matrices.size(); ++i) {
+                if (single[i])
+                    floats->emplace_back(std::move(matrices[i].first), FloatMatrix(matrices[i].second));
+                else
+                    wide.push_back(std::move(matrices[i]));
+            }
+            matrices = std::move(wide);
+        }
+        return matrices;
+    }
+
+    void writeBinary(const std::string& path,
+                     const std::vector<std::pair<std::string, const Matrix*>>& matrices,
+                     const std::vector<std::pair<std::string, const SparseMatrix*>>& sparse,
+                     const std::vector<std::pair<std::string, const FloatMatrix*>>& floats) {
+        MATRIX_PROFILE("WorkspaceFile::writeBinary");
+        const std::size_t count = matrices.size() + sparse.size() + floats.size();
+        const std::size_t firstFloat = matrices.size() + sparse.size();
+        Header header {};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.byteOrderMark = BYTE_ORDER_MARK;
+        header.matrixCount = count;
+
+        // Dense matrices first, then sparse ones, then float32 ones
+        std::string names;
+        std::vector<DirectoryEntry> directory(count);
+        auto describe = [&](DirectoryEntry& entry, const std::string& name, int rows, int cols, std::uint32_t kind) {
+            entry.nameOffset = names.size();
+            entry.nameLength = static_cast<std::uint32_t>(name.size());
+            entry.rows = rows;
+            entry.cols = cols;
+            entry.kind = kind;
+            names += name;
+        };
+        for (std::size_t i = 0; i < matrices.size(); ++i)
+            describe(directory[i], matrices[i].first, matrices[i].second->getRows(), matrices[i].second->getCols(), KIND_DENSE);
+        for (std::size_t i = 0; i < sparse.size(); ++i)
+            describe(directory[matrices.size() + i], sparse[i].first, sparse[i].second->getRows(), sparse[i].second->getCols(), KIND_SPARSE);
+        for (std::size_t i = 0; i < floats.size(); ++i)
+            describe(directory[firstFloat + i], floats[i].first, floats[i].second->getRows(), floats[i].second->getCols(), KIND_FLOAT32);
+
+        header.nameTableOffset = sizeof(Header);
+        header.nameTableSize = names.size();
+        header.directoryOffset = alignUp(header.nameTableOffset + header.nameTableSize);
+
+        std::uint64_t offset = alignUp(header.directoryOffset + directory.size() * sizeof(DirectoryEntry));
+        for (std::size_t i = 0; i < count; ++i) {
+            DirectoryEntry& entry = directory[i];
+            entry.dataOffset = offset;
+            const std::uint64_t elements = static_cast<std::uint64_t>(entry.rows) * entry.cols;
+            const std::uint64_t bytes = i < matrices.size() ? elements * sizeof(double)
+                : i >= firstFloat ? elements * sizeof(float)
+                : SparseLayout(entry.rows, sparse[i - matrices.size()].second->nonZeros()).size;
+            offset = alignUp(offset + bytes);
+        }
+
+        std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+        if (!ofs) throw WorkspaceFileCorrupt("cannot open '" + path + "' for writing");
+
+        std::uint64_t written = 0;
+        auto write = [&](const void* bytes, std::uint64_t length) {
+            ofs.write(static_cast<const char*>(bytes), static_cast<std::streamsize>(length));
+            written += length;
+        };
+        auto padTo = [&](std::uint64_t target) {
+            static const char zeros[PAYLOAD_ALIGNMENT] = {};
+            if (target > written) write(zeros, target - written);
+        };
+
+        write(&header, sizeof(header));
+        write(names.data(), names.size());
+        padTo(header.directoryOffset);
+        write(directory.data(), directory.size() * sizeof(DirectoryEntry));
+        for (std::size_t i = 0; i < matrices.size(); ++i) {
+            padTo(directory[i].dataOffset);
+            const Matrix& matrix = *matrices[i].second;
+            write(matrix.data(), static_cast<std::uint64_t>(matrix.getRows()) * matrix.getCols() * sizeof(double));
+        }
+        for (std::size_t i = 0; i < sparse.size(); ++i) {
+            const DirectoryEntry& entry = directory[matrices.size() + i];
+            const SparseMatrix& matrix = *sparse[i].second;
+            const std::uint64_t entries = matrix.nonZeros();
+            const SparseLayout layout(entry.rows, entries);
+
+            padTo(entry.dataOffset);
+            write(&entries, sizeof(entries));
+            static_assert(sizeof(std::size_t) == sizeof(std::uint64_t), "row offsets are stored as uint64");
+            write(matrix.rowStart().data(), layout.colIndex - layout.rowStart);
+            write(matrix.colIndex().data(), entries * sizeof(std::int32_t));
+            padTo(entry.dataOffset + layout.values);
+            write(matrix.values().data(), entries * sizeof(double));
+        }
+        for (std::size_t i = 0; i < floats.size(); ++i) {
+            padTo(directory[firstFloat + i].dataOffset);
+            const FloatMatrix& matrix = *floats[i].second;
+            write(matrix.data(), static_cast<std::uint64_t>(matrix.getRows()) * matrix.getCols() * sizeof(float));
+        }
+
+        if (!ofs.flush()) throw WorkspaceFileCorrupt("failed writing '" + path + "'");
+    }
+
+    std::vector<std::pair<std::string, Matrix>> readBinary(
+        const std::string& path, std::vector<std::pair<std::string, SparseMatrix>>* sparse,
+        std::vector<std::pair<std::string, FloatMatrix>>* floats) {
+        MATRIX_PROFILE("WorkspaceFile::readBinary");
+        FileView file(path);
+
+        Header header {};
+        if (!file.contains(0, sizeof(Header)))
+            throw WorkspaceFileCorrupt("truncated header");
+        std::memcpy(&header, file.data(), sizeof(Header));
+        if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0)
+            throw WorkspaceFileCorrupt("not a binary workspace");
+        if (header.byteOrderMark != BYTE_ORDER_MARK)
+            throw WorkspaceFileCorrupt("written on a machine with a different byte order");
+        if (header.version < OLDEST_READABLE_VERSION || header.version > VERSION)
+            throw WorkspaceFileCorrupt("unsupported version " + std::to_string(header.version));
+
+        if (!file.contains(header.nameTableOffset, header.nameTableSize) ||
+            header.matrixCount > file.size() / sizeof(DirectoryEntry) ||
+            !file.contains(header.directoryOffset, header.matrixCount * sizeof(DirectoryEntry)))
+            throw WorkspaceFileCorrupt("truncated tables");
+
+        const char* names = reinterpret_cast<const char*>(file.data() + header.nameTableOffset);
+        std::vector<std::pair<std::string, Matrix>> matrices;
+        matrices.reserve(header.matrixCount);
+
+        for (std::uint64_t i = 0; i < header.matrixCount; ++i) {
+            DirectoryEntry entry {};
+            std::memcpy(&entry, file.data() + header.directoryOffset + i * sizeof(DirectoryEntry), sizeof(entry));
+
+            if (entry.nameOffset > header.nameTableSize || entry.nameLength > header.nameTableSize - entry.nameOffset)
+                throw WorkspaceFileCorrupt("bad name for matrix #" + std::to_string(i));
+            std::string name(names + entry.nameOffset, entry.nameLength);
+
+            if (entry.kind == KIND_SPARSE) {
+                SparseMatrix matrix = readSparsePayload(file, entry, name);
+                if (sparse)
+                    sparse->emplace_back(std::move(name), std::move(matrix));
+                else
+                    matrices.emplace_back(std::move(name), matrix.toDense());
+                continue;
+            }
+            if (entry.kind == KIND_FLOAT32) {
+                const std::uint64_t bytes = checkDensePayload(file, entry, name, sizeof(float));
+                FloatMatrix matrix(entry.rows, entry.cols); // checks the size limit
+                std::memcpy(matrix.data(), file.data() + entry.dataOffset, bytes);
+                if (floats)
+                    floats->emplace_back(std::move(name), std::move(matrix));
+                else
+                    matrices.emplace_back(std::move(name), Matrix(matrix));
+                continue;
+            }
+            if (entry.kind != KIND_DENSE)
+                throw WorkspaceFileCorrupt("unknown kind for matrix '" + name + "'");
+
+            const std::uint64_t bytes = checkDensePayload(file, entry, name, sizeof(double));
+            Matrix matrix(entry.rows, entry.cols); // checks the size limit
+            std::memcpy(matrix.data(), file.data() + entry.dataOffset, bytes);
+
+            matrices.emplace_back(std::move(name), std::move(matrix));
+        }
+        return matrices;
+    }
+}
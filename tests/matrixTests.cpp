@@ -2,8 +2,34 @@
 #include <iostream>
 #include <cmath>
 #include <sstream>
+#include <vector>
+#include <fstream>
+#include <iterator>
+#include <cstdio>
+#include <limits>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
 #include "../include/Matrix.h"
 #include "../include/MatrixException.h"
+#include "../include/MatrixBatch.h"
+#include "../include/MatrixKernels.h"
+#include "../include/LUDecomposition.h"
+#include "../include/MatrixAllocator.h"
+#include "../include/OutOfCoreMatrix.h"
+#include "../include/FixedMatrix.h"
+#include "../include/IterativeSolvers.h"
+#include "../include/Parallel.h"
+#include "../include/Profiler.h"
+#include "../include/QRDecomposition.h"
+#include "../include/ConcurrentWorkspace.h"
+#include "../include/MatrixServer.h"
+#include "../include/SparseMatrix.h"
+#include "../include/TaskScheduler.h"
+#include "../include/WorkspaceFile.h"
+#include "../cli/CLI.h"
 
 // Example test function
 void testMatrixInitializationCustom() {
@@ -360,6 +386,1946 @@ void testVectorRotation(){
     std::cout << "✅ test3DRotation passed!" << std::endl;
 }
 
+// Fill a matrix with deterministic pseudo-random values in [-1, 1)
+Matrix makePseudoRandomMatrix(int rows, int cols, unsigned seed) {
+    Matrix m(rows, cols);
+    unsigned state = seed;
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < cols; ++j) {
+            state = state * 1664525u + 1013904223u;
+            m(i, j) = static_cast<double>(state >> 8) / static_cast<double>(1u << 23) - 1.0;
+        }
+    }
+    return m;
+}
+
+void testBlockedMultiplyMatchesReference() {
+    // Shapes chosen to hit the small path, partial register tiles and
+    // partial cache blocks in every dimension.
+    const int shapes[][3] = {
+        {1, 1, 1}, {3, 3, 3}, {7, 13, 5}, {33, 40, 29},
+        {130, 300, 61}, {5, 520, 9}, {257, 17, 131}
+    };
+    for (const auto& shape : shapes) {
+        const int m = shape[0], k = shape[1], n = shape[2];
+        Matrix a = makePseudoRandomMatrix(m, k, 17u + m);
+        Matrix b = makePseudoRandomMatrix(k, n, 91u + n);
+        Matrix blocked = a * b;
+
+        std::vector<double> aData(m * k), bData(k * n), expected(m * n);
+        for (int i = 0; i < m; ++i) for (int p = 0; p < k; ++p) aData[i * k + p] = a(i, p);
+        for (int p = 0; p < k; ++p) for (int j = 0; j < n; ++j) bData[p * n + j] = b(p, j);
+        MatrixKernels::gemmReference(m, n, k, 1.0, aData.data(), k, bData.data(), n,
+                                     0.0, expected.data(), n);
+
+        assert(blocked.getRows() == m && blocked.getCols() == n);
+        for (int i = 0; i < m; ++i) {
+            for (int j = 0; j < n; ++j) {
+                assert(std::abs(blocked(i, j) - expected[i * n + j]) < 1e-9 * (k + 1));
+            }
+        }
+    }
+
+    // alpha/beta contract: C = 2 * A * B - C
+    Matrix a = makePseudoRandomMatrix(40, 50, 5u);
+    Matrix b = makePseudoRandomMatrix(50, 45, 6u);
+    Matrix c = makePseudoRandomMatrix(40, 45, 7u);
+    Matrix expected = a * b * 2.0 - c;
+    std::vector<double> aData(40 * 50), bData(50 * 45), cData(40 * 45);
+    for (int i = 0; i < 40; ++i) for (int j = 0; j < 50; ++j) aData[i * 50 + j] = a(i, j);
+    for (int i = 0; i < 50; ++i) for (int j = 0; j < 45; ++j) bData[i * 45 + j] = b(i, j);
+    for (int i = 0; i < 40; ++i) for (int j = 0; j < 45; ++j) cData[i * 45 + j] = c(i, j);
+    MatrixKernels::gemm(40, 45, 50, 2.0, aData.data(), 50, bData.data(), 45, -1.0, cData.data(), 45);
+    for (int i = 0; i < 40; ++i) {
+        for (int j = 0; j < 45; ++j) {
+            assert(std::abs(cData[i * 45 + j] - expected(i, j)) < 1e-9);
+        }
+    }
+
+    std::cout << "✅ testBlockedMultiplyMatchesReference passed!" << std::endl;
+}
+
+void testElementwiseKernels() {
+    // Lengths around every vector width so both the SIMD body and the
+    // scalar tail of each back end are exercised.
+    for (int len = 1; len <= 37; ++len) {
+        std::vector<double> x(len), y(len), expected(len);
+        for (int i = 0; i < len; ++i) { x[i] = 0.5 * i - 3.0; y[i] = 1.25 * i + 1.0; }
+
+        expected = y;
+        for (int i = 0; i < len; ++i) expected[i] += x[i];
+        std::vector<double> out = y;
+        MatrixKernels::add(len, x.data(), out.data());
+        assert(out == expected);
+
+        for (int i = 0; i < len; ++i) expected[i] = y[i] - x[i];
+        out = y;
+        MatrixKernels::subtract(len, x.data(), out.data());
+        assert(out == expected);
+
+        for (int i = 0; i < len; ++i) expected[i] = y[i] * -2.5;
+        out = y;
+        MatrixKernels::scale(len, -2.5, out.data());
+        assert(out == expected);
+
+        for (int i = 0; i < len; ++i) expected[i] = -x[i];
+        MatrixKernels::negate(len, x.data(), out.data());
+        assert(out == expected);
+
+        for (int i = 0; i < len; ++i) expected[i] = y[i] + 3.0 * x[i];
+        out = y;
+        MatrixKernels::axpy(len, 3.0, x.data(), out.data());
+        assert(out == expected);
+    }
+
+    // Matrix-level entry points
+    Matrix a(3, 5, 2.0);
+    Matrix b(3, 5, 4.0);
+    a.axpy(0.5, b);
+    assert(a == Matrix(3, 5, 4.0));
+    assert(-a == Matrix(3, 5, -4.0));
+    try {
+        a.axpy(1.0, Matrix(5, 3));
+        assert(false);
+    } catch (const MatrixDimensionMismatch&) {}
+
+    std::cout << "✅ testElementwiseKernels passed! (" << MatrixKernels::simdBackendName() << ")" << std::endl;
+}
+
+void testMoveSemantics() {
+    Matrix source(4, 3, 2.0);
+    const double* buffer = &source(0, 0);
+
+    // Move construction takes over the buffer and empties the source
+    Matrix moved(std::move(source));
+    assert(&moved(0, 0) == buffer);
+    assert(moved.getRows() == 4 && moved.getCols() == 3);
+    assert(source.getRows() == 0 && source.getCols() == 0);
+
+    // Move assignment does the same
+    Matrix target(1, 1);
+    target = std::move(moved);
+    assert(&target(0, 0) == buffer);
+    assert(moved.getRows() == 0 && moved.getCols() == 0);
+
+    // Rvalue operators reuse the temporary's buffer
+    Matrix other(4, 3, 1.0);
+    Matrix sum = std::move(target) + other;
+    assert(&sum(0, 0) == buffer);
+    assert(sum == Matrix(4, 3, 3.0));
+
+    Matrix diff = std::move(sum) - other;
+    assert(&diff(0, 0) == buffer);
+    assert(diff == Matrix(4, 3, 2.0));
+
+    Matrix scaled = 2.0 * (std::move(diff) * 3.0);
+    assert(&scaled(0, 0) == buffer);
+    assert(scaled == Matrix(4, 3, 12.0));
+
+    Matrix negated = -std::move(scaled);
+    assert(&negated(0, 0) == buffer);
+    assert(negated == Matrix(4, 3, -12.0));
+
+    Matrix rightReuse = other + std::move(negated);
+    assert(&rightReuse(0, 0) == buffer);
+    assert(rightReuse == Matrix(4, 3, -11.0));
+
+    Matrix both = Matrix(4, 3, 1.0) + Matrix(4, 3, 2.0);
+    assert(both == Matrix(4, 3, 3.0));
+
+    // Dimension checks still apply on the rvalue paths
+    try {
+        Matrix bad = Matrix(2, 2) + Matrix(3, 3);
+        assert(false);
+    } catch (const MatrixDimensionMismatch&) {}
+
+    std::cout << "✅ testMoveSemantics passed!" << std::endl;
+}
+
+void testExpressionTemplates() {
+    Matrix a(3, 4, 1.0);
+    Matrix b(3, 4, 2.0);
+    Matrix c(3, 4, 3.0);
+
+    // A chain is evaluated into a single result
+    Matrix r = a + b - c * 2.0;
+    assert(r == Matrix(3, 4, -3.0));
+    Matrix r2 = -(a - 0.5 * b) + 2.0 * (c - a) * 0.25;
+    assert(r2 == Matrix(3, 4, 1.0));
+
+    // Expressions compare directly, without materializing
+    assert(a + b == c);
+    assert(c - b != c);
+    assert(-a == a * -1.0);
+
+    // Assigning into a matrix of the same shape writes in place, even when
+    // the destination is also an operand
+    const double* buffer = &a(0, 0);
+    a = a + b + c;
+    assert(&a(0, 0) == buffer);
+    assert(a == Matrix(3, 4, 6.0));
+    a += b * 2.0 - c;
+    assert(a == Matrix(3, 4, 7.0));
+    a -= -b;
+    assert(a == Matrix(3, 4, 9.0));
+
+    // Assigning an expression of another shape reallocates
+    Matrix small(1, 1);
+    small = b - c;
+    assert(small.getRows() == 3 && small.getCols() == 4);
+    assert(small == Matrix(3, 4, -1.0));
+
+    // Matrix multiplication accepts expression operands
+    Matrix left(2, 3, 1.0);
+    Matrix right(3, 2, 1.0);
+    Matrix product = (left + left) * (right * 3.0);
+    assert(product == Matrix(2, 2, 18.0));
+    assert((left * 2.0) * right == Matrix(2, 2, 6.0));
+    assert(left * (right - right * 0.5) == Matrix(2, 2, 1.5));
+
+    // Dimension mismatches are reported when the expression is built
+    try {
+        Matrix bad = a + b - Matrix(4, 3) * 2.0;
+        assert(false);
+    } catch (const MatrixDimensionMismatch&) {}
+    try {
+        a += Matrix(2, 2) * 2.0;
+        assert(false);
+    } catch (const MatrixDimensionMismatch&) {}
+
+    std::cout << "✅ testExpressionTemplates passed!" << std::endl;
+}
+
+void testEliminationOnLargerSystems() {
+    // Diagonally dominant, so well conditioned and non-singular
+    const int n = 60;
+    Matrix a = makePseudoRandomMatrix(n, n, 123u);
+    for (int i = 0; i < n; ++i) a(i, i) += n;
+    Matrix b = makePseudoRandomMatrix(n, 1, 321u);
+
+    SolveResult res = a.solve(b);
+    assert(res.status == SolveStatus::Unique);
+    Matrix residual = a * res.x - b;
+    for (int i = 0; i < n; ++i) assert(std::abs(residual(i, 0)) < 1e-9);
+
+    Matrix product = a * a.inverse();
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            assert(std::abs(product(i, j) - (i == j ? 1.0 : 0.0)) < 1e-9);
+        }
+    }
+
+    // det(A^T) == det(A) and rank is full
+    assert(std::abs(a.determinant() - a.transpose().determinant()) < 1e-6 * std::abs(a.determinant()));
+    assert(a.rank() == n);
+
+    std::cout << "✅ testEliminationOnLargerSystems passed!" << std::endl;
+}
+
+void testLUDecomposition() {
+    Matrix a(3, 3);
+    a(0,0) = 2;  a(0,1) = 1;  a(0,2) = 1;
+    a(1,0) = 4;  a(1,1) = -6; a(1,2) = 0;
+    a(2,0) = -2; a(2,1) = 7;  a(2,2) = 2;
+    LUDecomposition lu(a);
+    assert(lu.size() == 3);
+    assert(!lu.isSingular());
+    assert(std::abs(lu.determinant() - (-16.0)) < 1e-12);
+
+    // Several right-hand sides against the same factors
+    Matrix b(3, 2);
+    b(0,0) = 5;  b(0,1) = 1;
+    b(1,0) = -2; b(1,1) = 2;
+    b(2,0) = 9;  b(2,1) = 3;
+    Matrix x = lu.solve(b);
+    assert(x.getRows() == 3 && x.getCols() == 2);
+    Matrix residual = a * x - b;
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 2; ++j)
+            assert(std::abs(residual(i, j)) < 1e-12);
+
+    Matrix product = a * lu.inverse();
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            assert(std::abs(product(i, j) - (i == j ? 1.0 : 0.0)) < 1e-12);
+
+    try {
+        (void)lu.solve(Matrix(2, 1, 1.0));
+        assert(false);
+    } catch (const MatrixDimensionMismatch&) {}
+
+    // Singular matrices factor, but cannot be solved or inverted
+    LUDecomposition singular(Matrix(2, 2, 1.0));
+    assert(singular.isSingular());
+    assert(singular.determinant() == 0.0);
+    try {
+        (void)singular.solve(Matrix(2, 1, 1.0));
+        assert(false);
+    } catch (const MatrixSingular&) {}
+    try {
+        (void)singular.inverse();
+        assert(false);
+    } catch (const MatrixSingular&) {}
+
+    try {
+        LUDecomposition notSquare(Matrix(2, 3, 1.0));
+        assert(false);
+    } catch (const MatrixNotSquare&) {}
+
+    std::cout << "✅ testLUDecomposition passed!" << std::endl;
+}
+
+void testQRDecomposition() {
+    // Rank of products of thin factors, across several panels
+    auto lowRank = [](int rows, int cols, int rank, unsigned seed) {
+        return makePseudoRandomMatrix(rows, rank, seed) * makePseudoRandomMatrix(rank, cols, seed + 1);
+    };
+    assert(QRDecomposition(lowRank(60, 40, 5, 31u)).rank() == 5);
+    assert(QRDecomposition(lowRank(200, 150, 70, 33u)).rank() == 70);
+    assert(QRDecomposition(makePseudoRandomMatrix(150, 120, 35u)).rank() == 120);
+    assert(QRDecomposition(Matrix(4, 6, 0.0)).rank() == 0);
+
+    // The tolerance is relative: scaling does not change the rank
+    Matrix tiny = lowRank(30, 20, 7, 37u) * 1e-20;
+    assert(tiny.rank() == 7);
+    assert((lowRank(30, 20, 7, 37u) * 1e20).rank() == 7);
+
+    QRDecomposition qr(lowRank(50, 30, 12, 39u));
+    std::vector<int> columns = qr.permutation();
+    std::sort(columns.begin(), columns.end());
+    for (int j = 0; j < 30; ++j) assert(columns[j] == j);
+    assert(qr.tolerance() > 0.0);
+
+    // Overdetermined systems whose equations agree have a unique solution
+    Matrix a = makePseudoRandomMatrix(100, 40, 41u);
+    Matrix x0 = makePseudoRandomMatrix(40, 1, 42u);
+    Matrix b = a * x0;
+    SolveResult unique = a.solve(b);
+    assert(unique.status == SolveStatus::Unique);
+    assert(unique.x.getRows() == 40 && unique.x.getCols() == 1);
+    for (int i = 0; i < 40; ++i) assert(std::abs(unique.x(i, 0) - x0(i, 0)) < 1e-10);
+    assert(unique.residual < 1e-12);
+
+    // Otherwise there is none, but the least-squares solution satisfies AᵀAx = Aᵀb
+    Matrix noisy = b + makePseudoRandomMatrix(100, 1, 43u) * 0.1;
+    assert(a.solve(noisy).status == SolveStatus::NoSolution);
+    double residual = -1.0;
+    Matrix x = QRDecomposition(a).leastSquares(noisy, &residual);
+    Matrix normal = a.transpose() * (noisy - a * x);
+    for (int i = 0; i < 40; ++i) assert(std::abs(normal(i, 0)) < 1e-10);
+    Matrix r = noisy - a * x;
+    double rr = 0.0, bb = 0.0;
+    for (int i = 0; i < 100; ++i) { rr += r(i, 0) * r(i, 0); bb += noisy(i, 0) * noisy(i, 0); }
+    assert(std::abs(residual - std::sqrt(rr / bb)) < 1e-12);
+
+    // Rank-deficient and underdetermined systems
+    Matrix wide = makePseudoRandomMatrix(3, 5, 44u);
+    assert(wide.solve(makePseudoRandomMatrix(3, 1, 45u)).status == SolveStatus::Infinite);
+    Matrix singular = lowRank(8, 8, 5, 46u);
+    assert(singular.solve(singular * makePseudoRandomMatrix(8, 1, 47u)).status == SolveStatus::Infinite);
+    assert(singular.solve(makePseudoRandomMatrix(8, 1, 48u)).status == SolveStatus::NoSolution);
+
+    // A rank-deficient least-squares solution is still a minimizer
+    Matrix basic = QRDecomposition(singular).leastSquares(makePseudoRandomMatrix(8, 2, 49u));
+    Matrix gradient = singular.transpose() * (makePseudoRandomMatrix(8, 2, 49u) - singular * basic);
+    for (int i = 0; i < 8; ++i)
+        for (int j = 0; j < 2; ++j) assert(std::abs(gradient(i, j)) < 1e-9);
+
+    std::cout << "✅ testQRDecomposition passed!" << std::endl;
+}
+
+void testMatrixBatch() {
+    // 21 matrices: two full blocks and a padded one
+    const int count = 21, n = 5;
+    MatrixBatch a(count, n, n), b(count, n, 2);
+    std::vector<Matrix> as, bs;
+    for (int k = 0; k < count; ++k) {
+        as.push_back(makePseudoRandomMatrix(n, n, 100u + k));
+        bs.push_back(makePseudoRandomMatrix(n, 2, 200u + k));
+        a.setMatrix(k, as[k]);
+        b.setMatrix(k, bs[k]);
+    }
+    as[7] = Matrix(n, n, 1.0); // singular
+    a.setMatrix(7, as[7]);
+    assert(a(7, 2, 3) == 1.0 && a.matrix(3) == as[3]);
+
+    auto near = [](const Matrix& x, const Matrix& y, double tolerance) {
+        for (int i = 0; i < x.getRows(); ++i)
+            for (int j = 0; j < x.getCols(); ++j)
+                if (std::abs(x(i, j) - y(i, j)) > tolerance) return false;
+        return true;
+    };
+
+    const MatrixBatch products = batchMultiply(a, b);
+    assert(products.count() == count && products.rows() == n && products.cols() == 2);
+    for (int k = 0; k < count; ++k) assert(near(products.matrix(k), as[k] * bs[k], 1e-12));
+
+    const BatchSolveResult solved = batchSolve(a, b);
+    assert(solved.singularCount == 1 && solved.singular[7] && !solved.singular[6]);
+    for (int k = 0; k < count; ++k) {
+        if (k == 7) {
+            assert(near(solved.x.matrix(k), Matrix(n, 2, 0.0), 0.0));
+            continue;
+        }
+        assert(near(as[k] * solved.x.matrix(k), bs[k], 1e-9));
+    }
+
+    const std::vector<double> det = batchDeterminant(a);
+    for (int k = 0; k < count; ++k)
+        assert(std::abs(det[k] - as[k].determinant()) <= 1e-9 * std::max(1.0, std::abs(det[k])));
+    assert(det[7] == 0.0);
+
+    const BatchSolveResult inverses = batchInverse(a);
+    assert(inverses.singularCount == 1);
+    assert(near(as[4] * inverses.x.matrix(4), Matrix::identity(n), 1e-9));
+
+    // The strided entry points give the same results, with and without gaps between matrices
+    const std::ptrdiff_t stride = n * n + 3;
+    std::vector<double> packed(count * stride, -1.0), strided(count * stride, 0.0);
+    for (int k = 0; k < count; ++k)
+        std::copy(as[k].data(), as[k].data() + n * n, packed.begin() + k * stride);
+    const MatrixBatch roundTrip = MatrixBatch::fromStrided(packed.data(), count, n, n, stride);
+    roundTrip.toStrided(strided.data(), stride);
+    for (int k = 0; k < count; ++k) assert(roundTrip.matrix(k) == as[k]);
+
+    std::vector<double> stridedDet(count);
+    batchDeterminant(count, n, packed.data(), stride, stridedDet.data());
+    assert(stridedDet == det);
+    std::vector<double> stridedInverse(count * n * n);
+    std::vector<std::uint8_t> flags(count);
+    assert(batchInverse(count, n, packed.data(), stride, stridedInverse.data(), n * n, flags.data()) == 1);
+    assert(flags[7] && std::equal(stridedInverse.begin() + 4 * n * n, stridedInverse.begin() + 5 * n * n,
+                                  inverses.x.matrix(4).data()));
+    std::vector<double> product(count * n * n);
+    batchMultiply(count, n, n, n, packed.data(), stride, stridedInverse.data(), n * n, product.data(), n * n);
+    Matrix identity(n, n);
+    std::copy(product.begin(), product.begin() + n * n, identity.data());
+    assert(near(identity, Matrix::identity(n), 1e-9));
+
+    // Shape errors are thrown for the whole batch
+    bool threw = false;
+    try { (void)batchMultiply(a, MatrixBatch(count, 3, 3)); }
+    catch (const MatrixDimensionMismatch&) { threw = true; }
+    assert(threw);
+    threw = false;
+    try { (void)batchDeterminant(b); } catch (const MatrixNotSquare&) { threw = true; }
+    assert(threw);
+    threw = false;
+    try { (void)a(count, 0, 0); } catch (const MatrixOutOfBounds&) { threw = true; }
+    assert(threw);
+
+    // Named batches in a workspace
+    Workspace ws;
+    std::ostringstream out;
+    ws.setOutput(out);
+    assert(ws.createBatch("A", 3, 2, 2, 0.0));
+    Matrix m(2, 2, 1.0);
+    m(0, 0) = 2.0;
+    m(1, 1) = 3.0;
+    assert(ws.putMatrix("m", std::move(m)));
+    assert(ws.insertIntoBatch("A", 0, "m") && ws.insertIntoBatch("A", 2, "m"));
+    assert(ws.createBatch("B", 3, 2, 1, 1.0));
+    assert(ws.solveBatches("X", "A", "B"));
+    assert(out.str().find("1 of 3 matrices are singular") != std::string::npos);
+    assert(ws.extractFromBatch("x0", "X", 0));
+    Matrix x0;
+    assert(ws.getMatrix("x0", x0) && std::abs(x0(0, 0) - 0.4) < 1e-12 && std::abs(x0(1, 0) - 0.2) < 1e-12);
+    assert(ws.batchDeterminants("d", "A"));
+    Matrix d;
+    assert(ws.getMatrix("d", d) && d.getRows() == 3 && std::abs(d(0, 0) - 5.0) < 1e-12 && d(1, 0) == 0.0);
+    assert(!ws.getMatrix("A", d)); // batches are not matrices
+    assert(!ws.multiplyBatches("P", "A", "m"));
+    assert(ws.getMatrixCount() == 6);
+    assert(ws.deleteMatrix("A") && ws.getMatrixCount() == 5);
+
+    std::cout << "✅ testMatrixBatch passed!" << std::endl;
+}
+
+void testParallelFor() {
+    Parallel::ScopedPolicy fourThreads(ExecutionPolicy::parallel(4));
+    assert(Parallel::workerCount() == 4);
+    std::vector<int> hits(1000, 0);
+    Parallel::parallelFor(0, 1000, 10, [&](int b, int e) {
+        for (int i = b; i < e; ++i) hits[i]++;
+    });
+    for (int h : hits) assert(h == 1);
+
+    // Nested regions inherit the caller's policy and cannot deadlock the pool
+    std::vector<int> nested(64 * 64, 0);
+    Parallel::parallelFor(0, 64, 1, [&](int b, int e) {
+        assert(Parallel::workerCount() == 4);
+        for (int i = b; i < e; ++i) {
+            Parallel::parallelFor(0, 64, 1, [&](int nb, int ne) {
+                for (int j = nb; j < ne; ++j) nested[i * 64 + j]++;
+            });
+        }
+    });
+    for (int h : nested) assert(h == 1);
+
+    // Exceptions thrown by a worker reach the caller
+    bool thrown = false;
+    try {
+        Parallel::parallelFor(0, 100, 1, [](int b, int) {
+            if (b == 0) throw MatrixSingular();
+        });
+    } catch (const MatrixSingular&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    {
+        Parallel::ScopedPolicy serial(ExecutionPolicy::serial());
+        assert(Parallel::workerCount() == 1);
+        assert(Parallel::currentPolicy().describe() == "serial");
+    }
+    assert(Parallel::workerCount() == 4);
+    assert(ExecutionPolicy::parallel(3).describe() == "parallel (3 threads)");
+
+    // Small ranges stay on one chunk
+    assert(Parallel::minChunkFor(Parallel::MIN_PARALLEL_WORK) == 1);
+    assert(Parallel::minChunkFor(1) == Parallel::MIN_PARALLEL_WORK);
+
+    std::cout << "✅ testParallelFor passed!" << std::endl;
+}
+
+void testParallelPolicyGivesSameResults() {
+    Matrix a = makePseudoRandomMatrix(300, 257, 17u);
+    Matrix b = makePseudoRandomMatrix(257, 310, 18u);
+    Matrix c = makePseudoRandomMatrix(300, 257, 19u);
+
+    Matrix product, sum, transposed, square;
+    {
+        Parallel::ScopedPolicy serial(ExecutionPolicy::serial());
+        product = a * b;
+        sum = a + c * 2.0 - a;
+        transposed = a.transpose();
+        square = product * product.transpose();
+        square.transposeInPlace();
+    }
+
+    // Every element is computed the same way whatever the split, so the
+    // parallel results are bitwise identical
+    Parallel::ScopedPolicy parallel(ExecutionPolicy::parallel(4));
+    assert(a * b == product);
+    assert(a + c * 2.0 - a == sum);
+    assert(a.transpose() == transposed);
+    Matrix square2 = product * product.transpose();
+    square2.transposeInPlace();
+    assert(square2 == square);
+
+    Matrix scaled(a);
+    scaled *= 3.0;
+    scaled.axpy(-3.0, a);
+    for (int i = 0; i < a.getRows(); ++i)
+        for (int j = 0; j < a.getCols(); ++j)
+            assert(scaled(i, j) == 0.0);
+
+    std::cout << "✅ testParallelPolicyGivesSameResults passed!" << std::endl;
+}
+
+void testStrassenMultiply() {
+    // Odd sizes in every dimension, all above the crossover: one level of
+    // recursion with every peel
+    const int m = MatrixKernels::STRASSEN_CROSSOVER + 89;
+    const int k = MatrixKernels::STRASSEN_CROSSOVER + 11;
+    const int n = MatrixKernels::STRASSEN_CROSSOVER + 5;
+    Matrix a = makePseudoRandomMatrix(m, k, 23u);
+    Matrix b = makePseudoRandomMatrix(k, n, 24u);
+    Matrix c = makePseudoRandomMatrix(m, n, 25u);
+
+    Matrix blocked = c;
+    MatrixKernels::gemm(m, n, k, 0.5, a.data(), k, b.data(), n, 2.0, blocked.data(), n);
+    Matrix strassen = c;
+    {
+        Parallel::ScopedPolicy serial(ExecutionPolicy::serial());
+        MatrixKernels::gemmStrassen(m, n, k, 0.5, a.data(), k, b.data(), n, 2.0, strassen.data(), n);
+    }
+    for (int i = 0; i < m; ++i)
+        for (int j = 0; j < n; ++j)
+            assert(std::abs(strassen(i, j) - blocked(i, j)) < 1e-12 * k);
+
+    // The seven products in parallel give the same bits as one after another
+    Matrix parallel = c;
+    {
+        Parallel::ScopedPolicy policy(ExecutionPolicy::parallel(4));
+        MatrixKernels::gemmStrassen(m, n, k, 0.5, a.data(), k, b.data(), n, 2.0, parallel.data(), n);
+    }
+    assert(parallel == strassen);
+
+    // Selected through the policy, operator* uses it; small products do not change
+    ExecutionPolicy policy = ExecutionPolicy::parallel(3);
+    policy.multiply = ExecutionPolicy::Multiply::Strassen;
+    assert(policy.describe() == "parallel (3 threads), Strassen multiply");
+    Matrix viaPolicy, small;
+    Matrix smallA = makePseudoRandomMatrix(40, 50, 26u), smallB = makePseudoRandomMatrix(50, 30, 27u);
+    {
+        Parallel::ScopedPolicy scoped(policy);
+        viaPolicy = a * b;
+        small = smallA * smallB;
+    }
+    Matrix expected(m, n);
+    MatrixKernels::gemmStrassen(m, n, k, 1.0, a.data(), k, b.data(), n, 0.0, expected.data(), n);
+    assert(viaPolicy == expected);
+    assert(small == smallA * smallB);
+
+    // Single precision
+    FloatMatrix af(a), bf(b);
+    FloatMatrix strassenF(m, n), blockedF(m, n);
+    MatrixKernels::gemmStrassen(m, n, k, 1.0f, af.data(), k, bf.data(), n, 0.0f, strassenF.data(), n);
+    MatrixKernels::gemm(m, n, k, 1.0f, af.data(), k, bf.data(), n, 0.0f, blockedF.data(), n);
+    for (int i = 0; i < m; ++i)
+        for (int j = 0; j < n; ++j)
+            assert(std::abs(strassenF(i, j) - blockedF(i, j)) < 1e-4f * k);
+
+    std::cout << "✅ testStrassenMultiply passed!" << std::endl;
+}
+
+void testBlockedLUDecomposition() {
+    // Not a multiple of the panel width, so the last panel is partial
+    const int n = 203;
+    Matrix a = makePseudoRandomMatrix(n, n, 99u);
+    for (int i = 0; i < n; ++i) a(i, i) += 4.0;
+    Matrix b = makePseudoRandomMatrix(n, 3, 7u);
+
+    for (unsigned workers : {1u, 4u}) {
+        Parallel::ScopedPolicy policy(ExecutionPolicy::parallel(workers));
+        LUDecomposition lu(a);
+        assert(!lu.isSingular());
+        Matrix residual = a * lu.solve(b) - b;
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < 3; ++j)
+                assert(std::abs(residual(i, j)) < 1e-8);
+
+        Matrix product = a * lu.inverse();
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j)
+                assert(std::abs(product(i, j) - (i == j ? 1.0 : 0.0)) < 1e-8);
+    }
+
+    // Row-parallel elimination gives the same echelon form on any thread count
+    int serialRank = 0;
+    {
+        Parallel::ScopedPolicy serial(ExecutionPolicy::serial());
+        serialRank = a.rank();
+    }
+    Parallel::ScopedPolicy parallel(ExecutionPolicy::parallel(4));
+    assert(a.rank() == serialRank && serialRank == n);
+
+    // A repeated row makes the matrix singular, however it is blocked
+    for (int j = 0; j < n; ++j) a(150, j) = a(10, j);
+    LUDecomposition singular(a);
+    assert(singular.isSingular());
+    assert(a.rank() == n - 1);
+
+    std::cout << "✅ testBlockedLUDecomposition passed!" << std::endl;
+}
+
+void testTransposeKernels() {
+    const int shapes[][2] = {{1, 1}, {1, 40}, {40, 1}, {16, 16}, {17, 17}, {64, 64},
+                             {37, 53}, {100, 3}, {3, 100}, {128, 40}};
+    for (const auto& shape : shapes) {
+        const int rows = shape[0], cols = shape[1];
+        Matrix a = makePseudoRandomMatrix(rows, cols, static_cast<unsigned>(rows * 131 + cols));
+
+        Matrix t = a.transpose();
+        assert(t.getRows() == cols && t.getCols() == rows);
+        for (int i = 0; i < rows; ++i)
+            for (int j = 0; j < cols; ++j)
+                assert(t(j, i) == a(i, j));
+
+        Matrix inPlace(a);
+        inPlace.transposeInPlace();
+        assert(inPlace == t);
+        inPlace.transposeInPlace();
+        assert(inPlace == a);
+    }
+
+    std::cout << "✅ testTransposeKernels passed!" << std::endl;
+}
+
+void testBinaryWorkspaceFile() {
+    const std::string path = "matrixTests_workspace.bin";
+    Matrix a = makePseudoRandomMatrix(37, 5, 5u);
+    a(0, 0) = 0.1;      // not exactly representable in short decimal text
+    a(1, 1) = 1e-300;
+    Matrix b(1, 1, -7.0);
+
+    WorkspaceFile::writeBinary(path, {{"alpha", &a}, {"b", &b}});
+    assert(WorkspaceFile::isBinaryFile(path));
+    assert(WorkspaceFile::isBinaryName(path));
+    assert(!WorkspaceFile::isBinaryName("workspace.txt"));
+
+    auto loaded = WorkspaceFile::readBinary(path);
+    assert(loaded.size() == 2);
+    assert(loaded[0].first == "alpha" && loaded[0].second == a); // bit-exact
+    assert(loaded[1].first == "b" && loaded[1].second == b);
+
+    // Truncating the last payload is detected
+    std::string bytes;
+    {
+        std::ifstream ifs(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    }
+    {
+        std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+        ofs.write(bytes.data(), static_cast<std::streamsize>(bytes.size() - 4));
+    }
+    bool thrown = false;
+    try {
+        (void)WorkspaceFile::readBinary(path);
+    } catch (const WorkspaceFileCorrupt&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // So are dimensions the payload cannot hold, before anything is allocated for them
+    {
+        std::string huge = bytes;
+        const std::int32_t original[2] = {37, 5}, claimed[2] = {60000, 60000};
+        const std::size_t at = huge.find(std::string(reinterpret_cast<const char*>(original), sizeof original));
+        assert(at != std::string::npos);
+        huge.replace(at, sizeof claimed, reinterpret_cast<const char*>(claimed), sizeof claimed);
+        std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+        ofs.write(huge.data(), static_cast<std::streamsize>(huge.size()));
+    }
+    thrown = false;
+    try {
+        (void)WorkspaceFile::readBinary(path);
+    } catch (const WorkspaceFileCorrupt&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // So is an unknown version
+    bytes[8] = 99;
+    {
+        std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+        ofs.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+    thrown = false;
+    try {
+        (void)WorkspaceFile::readBinary(path);
+    } catch (const WorkspaceFileCorrupt&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::remove(path.c_str());
+
+    std::cout << "✅ testBinaryWorkspaceFile passed!" << std::endl;
+}
+
+void testTextWorkspaceFile() {
+    const std::string path = "matrixTests_workspace.txt";
+    auto writeFile = [&](const std::string& contents) {
+        std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+        ofs << contents;
+    };
+
+    // Round trip is exact, and spans several parallel decode blocks
+    Matrix big = makePseudoRandomMatrix(97, 131, 3u);
+    big(0, 0) = 0.1;
+    big(5, 7) = -1e-300;
+    big(9, 9) = std::numeric_limits<double>::infinity();
+    Matrix small(1, 2, 2.5);
+    {
+        Parallel::ScopedPolicy parallel(ExecutionPolicy::parallel(4));
+        WorkspaceFile::writeText(path, {{"big", &big}, {"s", &small}});
+        auto loaded = WorkspaceFile::readText(path);
+        assert(loaded.size() == 2);
+        assert(loaded[0].first == "big" && loaded[0].second == big);
+        assert(loaded[1].first == "s" && loaded[1].second == small);
+    }
+
+    // Files written by the old stream-based writer still load
+    writeFile("A 2 2\n1 2 \n3 4.5 \n\n\nB 1 1\n+7 \n\n");
+    auto legacy = WorkspaceFile::readText(path);
+    assert(legacy.size() == 2);
+    assert(legacy[0].second(1, 1) == 4.5 && legacy[1].second(0, 0) == 7.0);
+
+    // The first bad value is reported with its position
+    auto expectBadValue = [&](const std::string& contents, const std::string& where) {
+        writeFile(contents);
+        try {
+            (void)WorkspaceFile::readText(path);
+            assert(false);
+        } catch (const WorkspaceFileBadValue& e) {
+            assert(std::string(e.what()).find(where) != std::string::npos);
+        }
+    };
+    expectBadValue("A 2 2\n1 2\n3 x\n", "' A ' element at (1, 1)");
+    expectBadValue("A 1 2\n1 2\nB 2 2\n1 2 3\n", "' B ' element at (1, 1)");
+    // A header claiming more values than the file has room for is not allocated
+    expectBadValue("A 60000 60000\n1 2\n", "' A ' element at (0, 2)");
+    expectBadValue("A 60000 60000\n1 2\nB 1 1\n5\n", "' A ' element at (0, 2)");
+    expectBadValue("A 1 2\n1 x\nB 60000 60000\n1\n", "' A ' element at (0, 1)");
+
+    // Invalid dimensions throw the Matrix exception
+    writeFile("A 0 2\n");
+    try {
+        (void)WorkspaceFile::readText(path);
+        assert(false);
+    } catch (const MatrixInvalidInitialization&) {}
+
+    // Reading stops quietly at something that is not a header
+    writeFile("A 1 1\n5\ntrailing words\n");
+    assert(WorkspaceFile::readText(path).size() == 1);
+    std::remove(path.c_str());
+
+    std::cout << "✅ testTextWorkspaceFile passed!" << std::endl;
+}
+
+Matrix makeMostlyZeroMatrix(int rows, int cols, unsigned seed) {
+    Matrix m = makePseudoRandomMatrix(rows, cols, seed);
+    for (int i = 0; i < rows; ++i)
+        for (int j = 0; j < cols; ++j)
+            if (m(i, j) < 0.8) m(i, j) = 0.0; // keeps about 10%
+    return m;
+}
+
+void assertNear(const Matrix& actual, const Matrix& expected, double tolerance) {
+    assert(actual.getRows() == expected.getRows() && actual.getCols() == expected.getCols());
+    for (int i = 0; i < actual.getRows(); ++i)
+        for (int j = 0; j < actual.getCols(); ++j)
+            assert(std::abs(actual(i, j) - expected(i, j)) < tolerance);
+}
+
+void testLUUpdate() {
+    const int n = 40;
+    Matrix a = makePseudoRandomMatrix(n, n, 91u);
+    for (int i = 0; i < n; ++i) a(i, i) += 4.0;
+    const Matrix b = makePseudoRandomMatrix(n, 2, 92u);
+    const auto relativeError = [](double actual, double expected) {
+        return std::abs(actual - expected) / std::abs(expected);
+    };
+
+    // One element, then a whole row, then a whole column: each a rank-one change
+    LUDecomposition lu(a);
+    Matrix u(n, 1), v(n, 1);
+    u(3, 0) = 2.5;
+    v(7, 0) = 1.0;
+    assert(lu.update(u, v));
+    a(3, 7) += 2.5;
+    const Matrix newRow = makePseudoRandomMatrix(1, n, 93u);
+    Matrix rowChange(n, 1), unitRow(n, 1);
+    unitRow(11, 0) = 1.0;
+    for (int j = 0; j < n; ++j) {
+        rowChange(j, 0) = newRow(0, j) - a(11, j);
+        a(11, j) = newRow(0, j);
+    }
+    assert(lu.update(unitRow, rowChange));
+    Matrix columnChange = makePseudoRandomMatrix(n, 1, 94u), unitColumn(n, 1);
+    unitColumn(5, 0) = 1.0;
+    for (int i = 0; i < n; ++i) a(i, 5) += columnChange(i, 0);
+    assert(lu.update(columnChange, unitColumn));
+    assert(lu.updateCount() == 3);
+
+    const LUDecomposition fresh(a);
+    assert(relativeError(lu.determinant(), fresh.determinant()) < 1e-12);
+    assertNear(lu.solve(b), fresh.solve(b), 1e-10);
+    assertNear(lu.inverse(), fresh.inverse(), 1e-10);
+
+    // A zero change is free; one that makes the matrix singular is refused
+    assert(lu.update(Matrix(n, 1), v) && lu.updateCount() == 3);
+    LUDecomposition identity(Matrix::identity(3));
+    Matrix e0(3, 1);
+    e0(0, 0) = 1.0;
+    Matrix minusE0 = e0 * -1.0;
+    assert(!identity.update(minusE0, e0)); // I - e0 e0ᵀ
+    assert(identity.updateCount() == 0 && identity.determinant() == 1.0);
+    LUDecomposition singular(Matrix(2, 2, 1.0));
+    assert(!singular.update(Matrix(2, 1, 1.0), Matrix(2, 1, 1.0)));
+    try {
+        (void)lu.update(Matrix(n + 1, 1), v);
+        assert(false);
+    } catch (const MatrixDimensionMismatch&) {}
+
+    // At most MAX_UPDATES changes, after which the caller refactors
+    LUDecomposition capped(Matrix::identity(4));
+    Matrix small(4, 1, 1e-3);
+    for (int k = 0; k < LUDecomposition::MAX_UPDATES; ++k) assert(capped.update(small, small));
+    assert(!capped.update(small, small));
+
+    // The workspace keeps its factors and inverse across set, updating them
+    Workspace ws;
+    std::ostringstream out;
+    ws.setOutput(out);
+    Matrix w = makePseudoRandomMatrix(n, n, 95u);
+    for (int i = 0; i < n; ++i) w(i, i) += 4.0;
+    assert(ws.putMatrix("A", Matrix(w)) && ws.putMatrix("b", Matrix(b)));
+    assert(ws.factorMatrix("A") && ws.inverseMatrix("Ainv", "A"));
+    if (Profiler::compiledIn()) Profiler::reset();
+    assert(ws.setElement("A", 2, 9, 0.75));
+    w(2, 9) = 0.75;
+    assert(ws.setElement("A", 2, 9, 0.75)); // unchanged value
+    assert(ws.solveWithFactorization("x", "A", "b"));
+    assert(ws.inverseMatrix("Ainv", "A"));
+    const std::optional<double> det = ws.determinantOf("A");
+    if (Profiler::compiledIn()) {
+        for (const Profiler::Counters& c : Profiler::statistics())
+            assert(c.name != "LUDecomposition::factor" || c.calls == 0);
+    }
+    Matrix x, inverse;
+    assert(ws.getMatrix("x", x) && ws.getMatrix("Ainv", inverse));
+    const LUDecomposition expected(w);
+    assertNear(x, expected.solve(b), 1e-10);
+    assertNear(inverse, expected.inverse(), 1e-10);
+    assert(det && relativeError(*det, expected.determinant()) < 1e-12);
+
+    std::cout << "✅ testLUUpdate passed!" << std::endl;
+}
+
+void testDerivedDataCache() {
+    Workspace ws;
+    std::ostringstream out;
+    ws.setOutput(out);
+    // 5x5 goes through LUDecomposition, whose factors the workspace keeps
+    Matrix a = makePseudoRandomMatrix(5, 5, 96u);
+    for (int i = 0; i < 5; ++i) a(i, i) += 4.0;
+    assert(ws.putMatrix("A", Matrix(a)));
+    const auto calls = [](const std::string& name) {
+        std::size_t count = 0;
+        for (const Profiler::Counters& c : Profiler::statistics())
+            if (c.name == name) count = c.calls;
+        return count;
+    };
+    // Queries A's rank, determinant and inverse, counting the LU and rank
+    // passes they needed, and checks them against A's current contents
+    const auto check = [&ws, &calls](std::size_t factors, std::size_t ranks) {
+        if (Profiler::compiledIn()) Profiler::reset();
+        const std::optional<double> det = ws.determinantOf("A");
+        const std::optional<int> rank = ws.rankOf("A");
+        const bool inverted = ws.inverseMatrix("Ainv", "A");
+        if (Profiler::compiledIn())
+            assert(calls("LUDecomposition::factor") == factors && calls("Matrix::rank") == ranks);
+        Matrix current, inverse;
+        assert(det && rank && ws.getMatrix("A", current));
+        assert(std::abs(*det - current.determinant()) <= 1e-12 * std::max(1.0, std::abs(*det)));
+        assert(*rank == current.rank());
+        assert(inverted == (*rank == current.getRows()));
+        if (inverted) {
+            assert(ws.getMatrix("Ainv", inverse));
+            assertNear(inverse, current.inverse(), 1e-10);
+        }
+    };
+
+    // Computed once, then reused while A is unchanged
+    check(1, 1);
+    check(0, 0);
+    check(0, 0);
+
+    // Every change to A makes it recompute
+    assert(ws.transposeMatrix("A"));
+    check(1, 1);
+    check(0, 0);
+    {
+        std::istringstream values("4\n1\n0\n0\n1\n1\n4\n1\n0\n0\n0\n1\n4\n1\n0\n"
+                                  "0\n0\n1\n4\n1\n1\n0\n0\n1\n4\n");
+        std::streambuf* previous = std::cin.rdbuf(values.rdbuf());
+        assert(ws.assignMatrix("A"));
+        std::cin.rdbuf(previous);
+    }
+    check(1, 1);
+    assert(ws.saveWorkspaceToFile("cache_test.txt"));
+    check(0, 0);
+    // set updates the LU factors in place rather than refactoring
+    assert(ws.setElement("A", 0, 2, 2.5));
+    check(0, 1);
+    check(0, 0);
+    assert(ws.createMatrix("A", 5, 5, 1.0));
+    check(1, 1); // singular now: rank 1, no inverse
+    assert(ws.loadWorkspaceFromFile("cache_test.txt"));
+    check(1, 1);
+    std::remove("workspaces/cache_test.txt");
+
+    // Sizes Matrix sends to FixedKernels get exactly Matrix's values, also after a rotation
+    Matrix r = makePseudoRandomMatrix(3, 3, 97u);
+    for (int i = 0; i < 3; ++i) r(i, i) += 4.0;
+    const Matrix b = makePseudoRandomMatrix(3, 1, 98u);
+    assert(ws.putMatrix("R", Matrix(r)) && ws.putMatrix("b", Matrix(b)));
+    for (int pass = 0; pass < 2; ++pass) {
+        if (pass == 1) assert(ws.rotate3DVector("R", 30.0, 45.0, 60.0));
+        Matrix current, inverse, x;
+        const std::optional<double> det = ws.determinantOf("R");
+        assert(ws.inverseMatrix("Rinv", "R") && ws.solveMatrix("x", "R", "b"));
+        assert(ws.getMatrix("R", current) && ws.getMatrix("Rinv", inverse) && ws.getMatrix("x", x));
+        assert(det && *det == current.determinant());
+        assert(inverse == current.inverse());
+        assert(x == current.solve(b).x);
+    }
+
+    std::cout << "✅ testDerivedDataCache passed!" << std::endl;
+}
+
+void testSparseMatrix() {
+    // Conversion keeps exactly the non-zeros
+    Matrix dense = makeMostlyZeroMatrix(50, 70, 11u);
+    SparseMatrix sparse(dense);
+    assert(sparse.getRows() == 50 && sparse.getCols() == 70);
+    assert(sparse.toDense() == dense);
+    size_t expectedCount = 0;
+    for (int i = 0; i < 50; ++i)
+        for (int j = 0; j < 70; ++j)
+            if (dense(i, j) != 0.0) ++expectedCount;
+    assert(sparse.nonZeros() == expectedCount);
+    assert(sparse(3, 4) == dense(3, 4));
+
+    // Triplets are summed per element; cancelled elements disappear
+    SparseMatrix t = SparseMatrix::fromTriplets(3, 3, {{2, 1, 1.5}, {0, 0, 2.0}, {2, 1, 1.0}, {1, 2, 4.0}, {1, 2, -4.0}});
+    assert(t.nonZeros() == 2 && t(2, 1) == 2.5 && t(0, 0) == 2.0 && t(1, 2) == 0.0);
+
+    // set() inserts, updates and removes entries
+    t.set(1, 1, 7.0);
+    t.set(0, 0, 3.0);
+    t.set(2, 1, 0.0);
+    assert(t.nonZeros() == 2 && t(1, 1) == 7.0 && t(0, 0) == 3.0 && t(2, 1) == 0.0);
+    assert(t.rowStart() == std::vector<size_t>({0, 1, 2, 2}));
+
+    // Products, sums and transposes agree with the dense operations
+    Matrix other = makeMostlyZeroMatrix(70, 40, 12u);
+    Matrix full = makePseudoRandomMatrix(70, 40, 13u);
+    Matrix left = makePseudoRandomMatrix(30, 50, 14u);
+    for (const ExecutionPolicy& policy : {ExecutionPolicy::serial(), ExecutionPolicy::parallel(4)}) {
+        Parallel::ScopedPolicy scoped(policy);
+        assertNear(sparse * full, dense * full, 1e-12);
+        assertNear(left * sparse, left * dense, 1e-12);
+        assertNear((sparse * SparseMatrix(other)).toDense(), dense * other, 1e-12);
+    }
+    assert(sparse.transpose().toDense() == dense.transpose());
+    assert(sparse.transpose().transpose() == sparse);
+
+    Matrix dense2 = makeMostlyZeroMatrix(50, 70, 15u);
+    SparseMatrix sparse2(dense2);
+    assert((sparse + sparse2).toDense() == Matrix(dense + dense2));
+    assert((sparse - sparse2).toDense() == Matrix(dense - dense2));
+    assert((sparse - sparse).nonZeros() == 0);
+    assert(sparse + dense2 == Matrix(dense + dense2));
+    assert(dense2 - sparse == Matrix(dense2 - dense));
+    assert((sparse * 2.0).toDense() == Matrix(dense * 2.0));
+    assert((0.0 * sparse).nonZeros() == 0);
+
+    // Sparse matrices are not bound by the dense element limit
+    SparseMatrix huge(1'000'000, 1'000'000);
+    huge.set(999'999, 0, 1.0);
+    assert(huge.transpose()(0, 999'999) == 1.0);
+    try {
+        (void)huge.toDense();
+        assert(false);
+    } catch (const MatrixTooLarge&) {}
+
+    // Errors
+    try {
+        (void)(sparse * sparse);
+        assert(false);
+    } catch (const MatrixDimensionMismatch&) {}
+    try {
+        (void)sparse(50, 0);
+        assert(false);
+    } catch (const MatrixOutOfBounds&) {}
+    try {
+        (void)SparseMatrix::fromCSR(2, 2, {0, 2, 2}, {1, 0}, {1.0, 2.0});
+        assert(false);
+    } catch (const MatrixInvalidSparseStructure&) {}
+
+    std::cout << "✅ testSparseMatrix passed!" << std::endl;
+}
+
+void testSparseWorkspaceFile() {
+    Matrix dense = makePseudoRandomMatrix(4, 3, 21u);
+    SparseMatrix sparse(makeMostlyZeroMatrix(60, 90, 22u));
+    SparseMatrix wide(3, 2'000'000);
+    wide.set(2, 1'999'999, 0.1);
+
+    for (const std::string path : {"matrixTests_sparse.txt", "matrixTests_sparse.bin"}) {
+        const bool binary = WorkspaceFile::isBinaryName(path);
+        if (binary)
+            WorkspaceFile::writeBinary(path, {{"d", &dense}}, {{"s", &sparse}, {"w", &wide}});
+        else
+            WorkspaceFile::writeText(path, {{"d", &dense}}, {{"s", &sparse}, {"w", &wide}});
+
+        std::vector<std::pair<std::string, SparseMatrix>> loadedSparse;
+        auto loaded = binary ? WorkspaceFile::readBinary(path, &loadedSparse)
+                             : WorkspaceFile::readText(path, &loadedSparse);
+        assert(loaded.size() == 1 && loaded[0].first == "d" && loaded[0].second == dense);
+        assert(loadedSparse.size() == 2);
+        assert(loadedSparse[0].first == "s" && loadedSparse[0].second == sparse);
+        assert(loadedSparse[1].first == "w" && loadedSparse[1].second == wide);
+        std::remove(path.c_str());
+    }
+
+    // Readers that only take dense matrices get converted ones
+    const std::string path = "matrixTests_sparse.txt";
+    {
+        std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+        ofs << "S 2 3 sparse 2\n0 2 1.5\n1 0 -2\n\nD 1 1\n4\n";
+    }
+    auto converted = WorkspaceFile::readText(path);
+    assert(converted.size() == 2);
+    assert(converted[0].first == "S" && converted[0].second(0, 2) == 1.5 && converted[0].second(1, 0) == -2.0);
+    assert(converted[1].first == "D" && converted[1].second(0, 0) == 4.0);
+
+    // Malformed entries are reported
+    {
+        std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+        ofs << "S 2 3 sparse 2\n0 2 1.5\n1 x -2\n";
+    }
+    try {
+        (void)WorkspaceFile::readText(path);
+        assert(false);
+    } catch (const WorkspaceFileCorrupt& e) {
+        assert(std::string(e.what()).find("entry #1 of sparse matrix 'S'") != std::string::npos);
+    }
+    std::remove(path.c_str());
+
+    std::cout << "✅ testSparseWorkspaceFile passed!" << std::endl;
+}
+
+SparseMatrix makeLaplacian2D(int gridSize) {
+    std::vector<SparseMatrix::Triplet> entries;
+    const int n = gridSize * gridSize;
+    for (int i = 0; i < gridSize; ++i) {
+        for (int j = 0; j < gridSize; ++j) {
+            const int k = i * gridSize + j;
+            entries.push_back({k, k, 4.0});
+            if (i > 0) entries.push_back({k, k - gridSize, -1.0});
+            if (i + 1 < gridSize) entries.push_back({k, k + gridSize, -1.0});
+            if (j > 0) entries.push_back({k, k - 1, -1.0});
+            if (j + 1 < gridSize) entries.push_back({k, k + 1, -1.0});
+        }
+    }
+    return SparseMatrix::fromTriplets(n, n, std::move(entries));
+}
+
+void testIterativeSolvers() {
+    // Symmetric positive definite system: every method and preconditioner converges
+    SparseMatrix laplacian = makeLaplacian2D(12);
+    Matrix dense = laplacian.toDense();
+    Matrix b = makePseudoRandomMatrix(144, 1, 31u);
+    SolveResult direct = dense.solve(b);
+    assert(direct.status == SolveStatus::Unique && direct.residual < 1e-12);
+
+    for (SolverMethod method : {SolverMethod::ConjugateGradient, SolverMethod::GMRES, SolverMethod::BiCGSTAB}) {
+        int unpreconditioned = 0;
+        for (PreconditionerType preconditioner : {PreconditionerType::None, PreconditionerType::Jacobi, PreconditionerType::ILU0}) {
+            SolverOptions options;
+            options.method = method;
+            options.preconditioner = preconditioner;
+            SolveResult sparseResult = IterativeSolvers::solve(laplacian, b, options);
+            SolveResult denseResult = IterativeSolvers::solve(dense, b, options);
+            assert(sparseResult.status == SolveStatus::Unique && denseResult.status == SolveStatus::Unique);
+            assert(sparseResult.residual <= options.tolerance && sparseResult.iterations > 0);
+            assert(sparseResult.iterations == denseResult.iterations);
+            assertNear(sparseResult.x, direct.x, 1e-8);
+            assertNear(denseResult.x, direct.x, 1e-8);
+            if (preconditioner == PreconditionerType::None)
+                unpreconditioned = sparseResult.iterations;
+            else if (preconditioner == PreconditionerType::ILU0)
+                assert(sparseResult.iterations < unpreconditioned);
+        }
+    }
+
+    // Nonsymmetric system (convection-diffusion-like): GMRES and BiCGSTAB
+    std::vector<SparseMatrix::Triplet> entries;
+    for (int i = 0; i < 200; ++i) {
+        entries.push_back({i, i, 3.0});
+        if (i > 0) entries.push_back({i, i - 1, -1.5});
+        if (i + 1 < 200) entries.push_back({i, i + 1, -0.5});
+    }
+    SparseMatrix nonsymmetric = SparseMatrix::fromTriplets(200, 200, entries);
+    Matrix rhs = makePseudoRandomMatrix(200, 1, 32u);
+    Matrix expected = nonsymmetric.toDense().solve(rhs).x;
+    for (SolverMethod method : {SolverMethod::GMRES, SolverMethod::BiCGSTAB}) {
+        SolverOptions options;
+        options.method = method;
+        options.restart = 10;
+        SolveResult result = IterativeSolvers::solve(nonsymmetric, rhs, options);
+        assert(result.status == SolveStatus::Unique);
+        assertNear(result.x, expected, 1e-8);
+    }
+
+    // Iteration cap reached
+    SolverOptions capped;
+    capped.method = SolverMethod::ConjugateGradient;
+    capped.preconditioner = PreconditionerType::None;
+    capped.maxIterations = 3;
+    SolveResult notConverged = IterativeSolvers::conjugateGradient(laplacian, b, capped);
+    assert(notConverged.status == SolveStatus::NotConverged);
+    assert(notConverged.iterations == 3 && notConverged.residual > capped.tolerance);
+    assert(notConverged.x.getRows() == 0);
+
+    // Zero right-hand side converges immediately to x = 0
+    SolveResult zero = IterativeSolvers::bicgstab(laplacian, Matrix(144, 1, 0.0), SolverOptions{});
+    assert(zero.status == SolveStatus::Unique && zero.iterations == 0 && zero.x == Matrix(144, 1, 0.0));
+
+    // Errors
+    SolverOptions options;
+    options.method = SolverMethod::GMRES;
+    try {
+        (void)IterativeSolvers::solve(SparseMatrix(3, 4), Matrix(3, 1, 1.0), options);
+        assert(false);
+    } catch (const MatrixNotSquare&) {}
+    try {
+        (void)IterativeSolvers::solve(laplacian, Matrix(10, 1, 1.0), options);
+        assert(false);
+    } catch (const MatrixDimensionMismatch&) {}
+    try {
+        (void)IterativeSolvers::solve(SparseMatrix::fromTriplets(2, 2, {{0, 1, 1.0}, {1, 0, 1.0}}), Matrix(2, 1, 1.0), options);
+        assert(false);
+    } catch (const MatrixSingular&) {}
+
+    // Names round-trip through the parsers used by the CLI
+    SolverMethod method;
+    PreconditionerType preconditioner;
+    assert(IterativeSolvers::parseMethod("bicgstab", method) && method == SolverMethod::BiCGSTAB);
+    assert(IterativeSolvers::parsePreconditioner("ilu0", preconditioner) && preconditioner == PreconditionerType::ILU0);
+    assert(!IterativeSolvers::parseMethod("jacobi", method));
+    assert(options.describe() == "gmres (jacobi preconditioner, tolerance 1e-10, at most 1000 iterations)");
+
+    std::cout << "✅ testIterativeSolvers passed!" << std::endl;
+}
+
+void testFixedMatrix() {
+    // Fixed-size arithmetic matches the general Matrix
+    constexpr Mat3 a({1, 2, 3, 4, 5, 6, 7, 8, 10});
+    constexpr Vec3 v({1, -1, 2});
+    static_assert(Mat3::getRows() == 3 && Vec3::getCols() == 1);
+    static_assert((Mat3::identity() * v) == v);
+    assert((a * v).toMatrix() == Matrix(a.toMatrix() * v.toMatrix()));
+    assert((a * a).toMatrix() == Matrix(a.toMatrix() * a.toMatrix()));
+    assert(a.transpose().toMatrix() == a.toMatrix().transpose());
+    assert((a + a - a * 2.0) == Mat3());
+    assert(Mat3::fromMatrix(a.toMatrix()) == a);
+    try {
+        (void)Vec3::fromMatrix(Matrix(1, 3));
+        assert(false);
+    } catch (const MatrixDimensionMismatch&) {}
+
+    // Rotation builders: exact for multiples of 90 degrees, orthonormal otherwise
+    assert(Rotation3D::aboutZ(90) * Vec3({1, 0, 0}) == Vec3({0, 1, 0}));
+    assert(Rotation3D::aboutX(-270) == Rotation3D::aboutX(90));
+    const Mat3 r = Rotation3D::fromAngles(30, 45, 60);
+    assertNear((r * r.transpose()).toMatrix(), Matrix::identity(3), 1e-15);
+    assertNear(r.toMatrix(), Matrix(Rotation3D::aboutZ(60).toMatrix() * Rotation3D::aboutY(45).toMatrix() * Rotation3D::aboutX(30).toMatrix()), 1e-15);
+
+    // One batched pass over a 3xN matrix equals rotating every column on its own
+    // (N is odd so the SIMD tail is exercised too)
+    Matrix points = makePseudoRandomMatrix(3, 100'003, 41u);
+    Matrix expected(3, 100'003);
+    for (int j = 0; j < points.getCols(); ++j) {
+        const Vec3 p({points(0, j), points(1, j), points(2, j)});
+        const Vec3 q = r * p;
+        for (int i = 0; i < 3; ++i) expected(i, j) = q(i, 0);
+    }
+    for (const ExecutionPolicy& policy : {ExecutionPolicy::serial(), ExecutionPolicy::parallel(4)}) {
+        Parallel::ScopedPolicy scoped(policy);
+        Matrix rotated = points;
+        rotated.rotate3DInPlace(r);
+        assertNear(rotated, expected, 1e-15);
+        assert(points.rotate3D(30, 45, 60) == rotated);
+    }
+
+    try {
+        Matrix fourRows(4, 2);
+        fourRows.rotate3DInPlace(r);
+        assert(false);
+    } catch (const MatrixDimensionMismatch&) {}
+
+    std::cout << "✅ testFixedMatrix passed!" << std::endl;
+}
+
+void testFixedSizeDispatch() {
+    // Matrix routes the specialized sizes to FixedKernels; the results agree
+    // with the general LU and with gemm to rounding
+    for (int n : {2, 3, 4, 8}) {
+        assert(FixedKernels::isSpecialized(n));
+        const Matrix a = makePseudoRandomMatrix(n, n, 100u + n);
+        const Matrix b = makePseudoRandomMatrix(n, 1, 200u + n);
+        const LUDecomposition lu(a);
+
+        assert(std::abs(a.determinant() - lu.determinant()) <= 1e-12 * std::abs(lu.determinant()));
+        assertNear(a.inverse(), lu.inverse(), 1e-12);
+        const SolveResult solved = a.solve(b);
+        assert(solved.status == SolveStatus::Unique);
+        assertNear(solved.x, lu.solve(b), 1e-12);
+
+        Matrix reference(n, n);
+        MatrixKernels::gemmReference(n, n, n, 1.0, a.data(), n, a.data(), n, 0.0, reference.data(), n);
+        assertNear(a * a, reference, 1e-12);
+        Matrix referenceVector(n, 1);
+        MatrixKernels::gemmReference(n, 1, n, 1.0, a.data(), n, b.data(), 1, 0.0, referenceVector.data(), 1);
+        assertNear(a * b, referenceVector, 1e-12);
+
+        // Singular: the last row repeats the first
+        Matrix singular = a;
+        for (int j = 0; j < n; ++j) singular(n - 1, j) = singular(0, j);
+        assert(singular.determinant() == 0.0);
+        try {
+            (void)singular.inverse();
+            assert(false);
+        } catch (const MatrixSingular&) {}
+        assert(singular.solve(b).status == QRDecomposition(Matrix(singular)).solve(b).status);
+    }
+
+    // Other sizes and rectangular shapes keep the general path
+    assert(!FixedKernels::isSpecialized(5));
+    double det = 0.0;
+    assert(!FixedKernels::determinant(5, nullptr, det));
+    assert(!FixedKernels::multiply(3, 3, 2, nullptr, nullptr, nullptr));
+    const Matrix a5 = makePseudoRandomMatrix(5, 5, 7u);
+    assert(a5.determinant() == LUDecomposition(a5).determinant());
+
+    // FixedLU on its own, a permutation needing row swaps
+    const FixedLU<3> swapped(Mat3({0, 1, 0, 0, 0, 1, 1, 0, 0}));
+    assert(!swapped.isSingular());
+    assert(swapped.determinant() == 1.0);
+    assert(swapped.inverse() == Mat3({0, 0, 1, 1, 0, 0, 0, 1, 0}));
+    assert(swapped.solve(Vec3({1, 2, 3})) == Vec3({3, 1, 2}));
+
+    std::cout << "✅ testFixedSizeDispatch passed!" << std::endl;
+}
+
+void testMatrixAllocator() {
+    // Every buffer is aligned for the SIMD kernels, whatever its size
+    for (int n : {1, 3, 7, 33, 100, 500}) {
+        Matrix m(n, n + 1, 1.0);
+        assert(reinterpret_cast<std::uintptr_t>(m.data()) % MatrixMemory::ALIGNMENT == 0);
+        Matrix copy = m.transpose();
+        assert(reinterpret_cast<std::uintptr_t>(copy.data()) % MatrixMemory::ALIGNMENT == 0);
+    }
+
+    // A freed buffer is handed to the next matrix of a similar size
+    MatrixMemory::trim();
+    const double* first;
+    {
+        Matrix a(300, 300, 2.0);
+        first = a.data();
+    }
+    MatrixMemory::Statistics before = MatrixMemory::statistics();
+    assert(before.cachedBytes >= 300 * 300 * sizeof(double));
+    Matrix b(299, 301, 0.0);
+    MatrixMemory::Statistics after = MatrixMemory::statistics();
+    assert(b.data() == first);
+    assert(after.reused == before.reused + 1 && after.allocations == before.allocations + 1);
+    assert(b(298, 300) == 0.0);
+
+    // Temporaries inside an elimination are recycled instead of reallocated
+    Matrix system = makePseudoRandomMatrix(120, 120, 51u);
+    (void)system.inverse();
+    before = MatrixMemory::statistics();
+    (void)system.inverse();
+    after = MatrixMemory::statistics();
+    assert(after.reused - before.reused == after.allocations - before.allocations);
+
+    // trim() and the cache limit bound what is kept
+    MatrixMemory::trim();
+    assert(MatrixMemory::statistics().cachedBytes == 0);
+    const std::size_t limit = MatrixMemory::statistics().cacheLimit;
+    MatrixMemory::setCacheLimit(0);
+    { Matrix dropped(100, 100); }
+    assert(MatrixMemory::statistics().cachedBytes == 0);
+    MatrixMemory::setCacheLimit(limit);
+
+    // The allocator works with any element type
+    std::vector<int, PooledAllocator<int>> ints(1000, 7);
+    ints.push_back(8);
+    assert(ints.size() == 1001 && ints.front() == 7 && ints.back() == 8);
+    assert(reinterpret_cast<std::uintptr_t>(ints.data()) % MatrixMemory::ALIGNMENT == 0);
+
+    std::cout << "✅ testMatrixAllocator passed!" << std::endl;
+}
+
+void testFloatMatrix() {
+    // Element-wise arithmetic stays in float and matches double to float precision
+    const Matrix a = makePseudoRandomMatrix(37, 53, 61u);
+    const Matrix b = makePseudoRandomMatrix(37, 53, 62u);
+    const FloatMatrix fa(a), fb(b);
+    assert(reinterpret_cast<std::uintptr_t>(fa.data()) % MatrixMemory::ALIGNMENT == 0);
+    FloatMatrix sum = fa + fb * 2.0 - fa;
+    FloatMatrix scaled = -(fa * 0.5);
+    FloatMatrix updated(fa);
+    updated.axpy(3.0f, fb);
+    for (int i = 0; i < a.getRows(); ++i) {
+        for (int j = 0; j < a.getCols(); ++j) {
+            assert(std::abs(sum(i, j) - 2.0 * b(i, j)) < 1e-5);
+            assert(std::abs(scaled(i, j) + 0.5 * a(i, j)) < 1e-5);
+            assert(std::abs(updated(i, j) - (a(i, j) + 3.0 * b(i, j))) < 1e-5);
+        }
+    }
+    assert(fa + fb == fb + fa);
+
+    // The float GEMM and transpose kernels agree with the double ones
+    const Matrix c = makePseudoRandomMatrix(53, 29, 63u);
+    const Matrix product = a * c;
+    const FloatMatrix floatProduct = fa * FloatMatrix(c);
+    assert(floatProduct.getRows() == 37 && floatProduct.getCols() == 29);
+    for (int i = 0; i < product.getRows(); ++i)
+        for (int j = 0; j < product.getCols(); ++j)
+            assert(std::abs(floatProduct(i, j) - product(i, j)) < 1e-4 * (1.0 + std::abs(product(i, j))));
+    assert(Matrix(fa.transpose()) == Matrix(fa).transpose());
+
+    // Elimination runs in float; determinant, inverse and solve go through double
+    const FloatMatrix square(makePseudoRandomMatrix(12, 12, 64u));
+    assert(square.rank() == 12);
+    const Matrix wide(square);
+    assert(std::abs(square.determinant() - wide.determinant()) < 1e-12 * (1.0 + std::abs(wide.determinant())));
+    const FloatMatrix inverse = square.inverse();
+    const FloatMatrix nearIdentity = square * inverse;
+    for (int i = 0; i < 12; ++i)
+        for (int j = 0; j < 12; ++j)
+            assert(std::abs(nearIdentity(i, j) - (i == j ? 1.0f : 0.0f)) < 1e-3f);
+    const SolveResult solved = square.solve(FloatMatrix(12, 1, 1.0f));
+    assert(solved.status == SolveStatus::Unique && solved.residual < 1e-12);
+    FloatMatrix singular(3, 3, 1.0f);
+    assert(singular.rank() == 1);
+    assert(singular.solve(FloatMatrix(3, 1, 1.0f)).status == SolveStatus::Infinite);
+
+    // Rotation works on float vectors too
+    FloatMatrix vector(3, 1, 0.0f);
+    vector(0, 0) = 1.0f;
+    vector.rotate3DInPlace(Rotation3D::aboutZ(90.0));
+    assert(std::abs(vector(0, 0)) < 1e-6f && std::abs(vector(1, 0) - 1.0f) < 1e-6f);
+
+    // Both workspace formats keep float32 matrices exact and in float32
+    FloatMatrix fractions(2, 3, 0.0f);
+    fractions(0, 0) = 0.1f;
+    fractions(0, 1) = 1.0f / 3.0f;
+    fractions(1, 2) = -std::numeric_limits<float>::max();
+    for (const std::string path : {"matrixTests_float.txt", "matrixTests_float.bin"}) {
+        const bool binary = WorkspaceFile::isBinaryName(path);
+        if (binary)
+            WorkspaceFile::writeBinary(path, {{"d", &a}}, {}, {{"f", &fractions}});
+        else
+            WorkspaceFile::writeText(path, {{"d", &a}}, {}, {{"f", &fractions}});
+
+        std::vector<std::pair<std::string, FloatMatrix>> loadedFloats;
+        auto loaded = binary ? WorkspaceFile::readBinary(path, nullptr, &loadedFloats)
+                             : WorkspaceFile::readText(path, nullptr, &loadedFloats);
+        assert(loaded.size() == 1 && loaded[0].first == "d" && loaded[0].second == a);
+        assert(loadedFloats.size() == 1 && loadedFloats[0].first == "f" && loadedFloats[0].second == fractions);
+
+        // Readers that only take double matrices get widened ones
+        auto widened = binary ? WorkspaceFile::readBinary(path) : WorkspaceFile::readText(path);
+        assert(widened.size() == 2 && widened[1].second == Matrix(fractions));
+        std::remove(path.c_str());
+    }
+
+    // A sparse section converted to dense ahead of a float32 one keeps both in their own type
+    {
+        const std::string path = "matrixTests_float.txt";
+        {
+            std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+            ofs << "S 2 2 sparse 1\n1 0 2.5\n\nF 1 2 float32\n0.1 -3\n\nD 1 1\n7\n";
+        }
+        std::vector<std::pair<std::string, FloatMatrix>> loadedFloats;
+        auto loaded = WorkspaceFile::readText(path, nullptr, &loadedFloats);
+        assert(loaded.size() == 2);
+        assert(loaded[0].first == "S" && loaded[0].second(1, 0) == 2.5 && loaded[0].second(0, 0) == 0.0);
+        assert(loaded[1].first == "D" && loaded[1].second(0, 0) == 7.0);
+        assert(loadedFloats.size() == 1 && loadedFloats[0].first == "F");
+        assert(loadedFloats[0].second(0, 0) == 0.1f && loadedFloats[0].second(0, 1) == -3.0f);
+        std::remove(path.c_str());
+    }
+
+    std::cout << "✅ testFloatMatrix passed!" << std::endl;
+}
+
+void testOutOfCoreMatrix() {
+    // Sizes that are not multiples of the tile size exercise the padded edge tiles
+    const Matrix a = makePseudoRandomMatrix(300, 700, 71u);
+    const Matrix b = makePseudoRandomMatrix(700, 290, 72u);
+    const OutOfCoreMatrix diskA(a), diskB(b);
+    assert(diskA.getRows() == 300 && diskA.getCols() == 700);
+    assert(diskA.tileRows() == 2 && diskA.tileCols() == 3);
+    assert(diskA.toMatrix() == a);
+    assert(diskA(299, 699) == a(299, 699));
+
+    const Matrix product = a * b;
+    const Matrix diskProduct = (diskA * diskB).toMatrix();
+    const Matrix streamed = diskA * b;
+    for (int i = 0; i < product.getRows(); ++i) {
+        for (int j = 0; j < product.getCols(); ++j) {
+            assert(std::abs(diskProduct(i, j) - product(i, j)) < 1e-9);
+            assert(std::abs(streamed(i, j) - product(i, j)) < 1e-9);
+        }
+    }
+    assert(diskA.transpose().toMatrix() == a.transpose());
+
+    // Blocked out-of-core LU matches the in-memory solver, pivoting across tiles
+    const Matrix square = makePseudoRandomMatrix(600, 600, 73u);
+    const Matrix rhs = makePseudoRandomMatrix(600, 2, 74u);
+    const Matrix x = OutOfCoreMatrix(square).solve(rhs);
+    const Matrix residual = square * x - rhs;
+    for (int i = 0; i < residual.getRows(); ++i)
+        for (int j = 0; j < residual.getCols(); ++j)
+            assert(std::abs(residual(i, j)) < 1e-8);
+
+    OutOfCoreMatrix singular(300, 300, 1.0);
+    bool threw = false;
+    try {
+        (void)singular.solve(Matrix(300, 1, 1.0));
+    } catch (const MatrixSingular&) {
+        threw = true;
+    }
+    assert(threw);
+
+    // More elements than fit in an int, or in Matrix; only touched tiles use disk
+    OutOfCoreMatrix huge(70000, 70000);
+    huge(69999, 69999) = 2.5;
+    huge(0, 69999) = -1.0;
+    assert(huge(69999, 69999) == 2.5 && huge(0, 69999) == -1.0 && huge(35000, 35000) == 0.0);
+    assert(huge.storageBytes() >= std::size_t(70000) * 70000 * sizeof(double));
+    threw = false;
+    try {
+        (void)huge.toMatrix();
+    } catch (const MatrixTooLarge&) {
+        threw = true;
+    }
+    assert(threw);
+    threw = false;
+    try {
+        huge(70000, 0) = 1.0;
+    } catch (const MatrixOutOfBounds&) {
+        threw = true;
+    }
+    assert(threw);
+
+    std::cout << "✅ testOutOfCoreMatrix passed!" << std::endl;
+}
+
+void testCopyOnWrite() {
+    Matrix a = makePseudoRandomMatrix(50, 50, 71u);
+    const Matrix& view = a;
+
+    // A copy shares the elements until one side is modified
+    Matrix b = a;
+    const Matrix& shared = b;
+    assert(shared.data() == view.data());
+    b(3, 4) = 42.0;
+    assert(shared.data() != view.data());
+    assert(b(3, 4) == 42.0 && a(3, 4) != 42.0);
+
+    // Copy assignment shares too; in-place arithmetic and transposes detach
+    Matrix c;
+    c = a;
+    assert(static_cast<const Matrix&>(c).data() == view.data());
+    const Matrix original = a;
+    c += a;
+    c *= 0.5;
+    c.transposeInPlace();
+    assert(a == original && c == original.transpose());
+    Matrix d = a;
+    d = d + a;
+    assert(a == original && d == original * 2.0);
+
+    // Factorizations and eliminations work on their own copies
+    const Matrix rhs = makePseudoRandomMatrix(50, 1, 72u);
+    const Matrix rhsCopy = rhs;
+    LUDecomposition lu(a);
+    (void)a.rank();
+    (void)a.determinant();
+    (void)a.solve(rhs);
+    Matrix singular(3, 3, 1.0);
+    const Matrix singularCopy = singular;
+    (void)singular.solve(Matrix(3, 1, 1.0));
+    assert(a == original && rhs == rhsCopy && singular == singularCopy);
+    assert(static_cast<const Matrix&>(original).data() == view.data());
+
+    // Moving leaves an empty matrix behind, which can be reused
+    Matrix moved = std::move(b);
+    assert(moved(3, 4) == 42.0 && b.getRows() == 0 && b.getCols() == 0);
+    b = moved;
+    b.data()[0] = -1.0;
+    assert(moved(0, 0) != -1.0);
+
+    std::cout << "✅ testCopyOnWrite passed!" << std::endl;
+}
+
+void testProfiler() {
+    if (!Profiler::compiledIn()) {
+        std::cout << "✅ testProfiler skipped (MATRIX_PROFILING is off)" << std::endl;
+        return;
+    }
+    const auto find = [](const std::string& name) {
+        for (const Profiler::Counters& c : Profiler::statistics())
+            if (c.name == name) return c;
+        return Profiler::Counters{};
+    };
+
+    // Calls, FLOPs and allocations are attributed to every enclosing scope
+    Profiler::reset();
+    const Matrix a = makePseudoRandomMatrix(40, 30, 81u), b = makePseudoRandomMatrix(30, 20, 82u);
+    (void)(a * b);
+    (void)(a * b);
+    const Profiler::Counters multiply = find("Matrix::multiply");
+    assert(multiply.calls == 2);
+    assert(multiply.flops == 2 * 2 * 40 * 30 * 20);
+    assert(multiply.bytesAllocated >= 2 * 40 * 20 * sizeof(double));
+    assert(find("MatrixKernels::gemm").calls == 2);
+    assert(find("Matrix::transpose").calls == 0);
+
+    Profiler::reset();
+    assert(find("Matrix::multiply").calls == 0);
+
+    // The trace holds one complete event per scope, nested in time
+    const std::string path = "profiler_test_trace.json";
+    Profiler::startTrace();
+    assert(Profiler::isTracing());
+    (void)LUDecomposition(makePseudoRandomMatrix(20, 20, 83u)).determinant();
+    (void)a.transpose();
+    assert(Profiler::writeTrace(path) == 3);
+    assert(!Profiler::isTracing());
+    std::ifstream in(path);
+    const std::string json((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    assert(json.find("\"traceEvents\"") != std::string::npos);
+    assert(json.find("\"name\": \"LUDecomposition::factor\", \"cat\": \"LUDecomposition\", \"ph\": \"X\"") != std::string::npos);
+    assert(json.find("\"name\": \"MatrixKernels::transpose\"") != std::string::npos);
+    in.close();
+    std::remove(path.c_str());
+
+    std::cout << "✅ testProfiler passed!" << std::endl;
+}
+
+void testTaskScheduler() {
+    // Owner-thread state: which tasks have committed, and the retire order
+    std::vector<int> committed, retired;
+    std::vector<std::vector<int>> committedAtStart(5);
+    std::atomic<int> running{0}, maxRunning{0};
+
+    TaskScheduler scheduler(4);
+    auto task = [&](int id, std::vector<std::string> reads, std::vector<std::string> writes, int sleepMs) {
+        TaskScheduler::Task t;
+        t.reads = std::move(reads);
+        t.writes = std::move(writes);
+        t.start = [&, id, sleepMs] {
+            committedAtStart[id] = committed;
+            return [&, sleepMs] {
+                const int now = ++running;
+                for (int seen = maxRunning.load(); now > seen && !maxRunning.compare_exchange_weak(seen, now);) {}
+                std::this_thread::sleep_for(std::chrono::milliseconds(sleepMs));
+                --running;
+            };
+        };
+        t.commit = [&, id] { committed.push_back(id); };
+        t.retire = [&, id] { retired.push_back(id); };
+        return t;
+    };
+    auto contains = [](const std::vector<int>& ids, int id) {
+        return std::find(ids.begin(), ids.end(), id) != ids.end();
+    };
+
+    scheduler.submit(task(0, {}, {"A"}, 60));         // writes A
+    scheduler.submit(task(1, {}, {"B"}, 60));         // independent of 0
+    scheduler.submit(task(2, {"A", "B"}, {"C"}, 1));  // reads what 0 and 1 write
+    scheduler.submit(task(3, {}, {"A"}, 1));          // writes what 2 reads
+    scheduler.submit(task(4, {"D"}, {}, 1));          // independent of everything
+    scheduler.waitAll();
+
+    assert(scheduler.pending() == 0);
+    assert((retired == std::vector<int>{0, 1, 2, 3, 4}));
+    assert(committedAtStart[0].empty() && committedAtStart[1].empty());
+    assert(contains(committedAtStart[2], 0) && contains(committedAtStart[2], 1));
+    assert(contains(committedAtStart[3], 2));
+    assert(!contains(committedAtStart[4], 0)); // did not wait for the slow writers
+    assert(maxRunning.load() >= 2);
+
+    // An exception thrown by the work reaches the owner once the task commits
+    TaskScheduler::Task failing;
+    failing.writes = {"A"};
+    failing.start = [] { return [] { throw MatrixSingular(); }; };
+    bool thrown = false;
+    try {
+        scheduler.submit(std::move(failing));
+        scheduler.waitAll();
+    } catch (const MatrixSingular&) {
+        thrown = true;
+    }
+    assert(thrown && scheduler.pending() == 0);
+
+    std::cout << "✅ testTaskScheduler passed!" << std::endl;
+}
+
+void testConcurrentWorkspace() {
+    ConcurrentWorkspace shared;
+    std::ostringstream setup;
+    assert(shared.createMatrix("S", 6, 6, 0.0, setup));
+    for (int i = 0; i < 6; ++i)
+        assert(shared.setElement("S", i, i, i + 1.0, setup));
+
+    // Writers on their own names, readers of S and snapshot saves, all at once
+    constexpr int WRITERS = 3, READERS = 3, ROUNDS = 40;
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < WRITERS; ++t) {
+        threads.emplace_back([&shared, &failures, t] {
+            std::ostringstream out;
+            const std::string x = "X" + std::to_string(t), y = "Y" + std::to_string(t);
+            for (int round = 1; round <= ROUNDS; ++round) {
+                // Every matrix is uniform after each operation
+                if (!shared.createMatrix(x, 8, 8, round, out) || !shared.multiplyMatrices(y, x, x, out))
+                    ++failures;
+            }
+        });
+    }
+    for (int t = 0; t < READERS; ++t) {
+        threads.emplace_back([&shared, &failures, t] {
+            for (int round = 0; round < ROUNDS; ++round) {
+                std::ostringstream out;
+                if (!shared.determinantMatrix("S", out) || out.str().find("720") == std::string::npos)
+                    ++failures;
+                if (t == 0 && round % 10 == 0 && !shared.saveWorkspaceToFile("concurrent_test.bin", out))
+                    ++failures;
+            }
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+    assert(failures.load() == 0);
+    assert(shared.getMatrixCount() == 1 + 2 * WRITERS);
+
+    auto uniformValue = [](ConcurrentWorkspace& workspace, const std::string& name) {
+        double value = std::nan("");
+        workspace.execute({name}, {}, [&](Workspace& w) {
+            return w.handleReadOnlyMatrixOp(name, [&](const Matrix& m) {
+                value = m(0, 0);
+                for (int i = 0; i < m.getRows(); ++i)
+                    for (int j = 0; j < m.getCols(); ++j)
+                        if (m(i, j) != value) value = std::nan("");
+            });
+        });
+        return value;
+    };
+    for (int t = 0; t < WRITERS; ++t) {
+        assert(uniformValue(shared, "X" + std::to_string(t)) == ROUNDS);
+        assert(uniformValue(shared, "Y" + std::to_string(t)) == 8.0 * ROUNDS * ROUNDS);
+    }
+
+    // A save is one consistent state: every saved product matches its saved factor
+    ConcurrentWorkspace loaded;
+    std::ostringstream out;
+    assert(loaded.loadWorkspaceFromFile("concurrent_test.bin", out));
+    assert(loaded.getMatrixCount() >= 1);
+    for (int t = 0; t < WRITERS; ++t) {
+        const double x = uniformValue(loaded, "X" + std::to_string(t));
+        const double y = uniformValue(loaded, "Y" + std::to_string(t));
+        assert(std::isnan(x) || std::isnan(y) || y == 8.0 * x * x || y == 8.0 * (x - 1) * (x - 1));
+    }
+    std::remove("workspaces/concurrent_test.bin");
+
+    // Loading replaces the contents and keeps serving readers
+    assert(shared.loadWorkspaceFromFile("missing_file.bin", out) == false);
+    assert(shared.getMatrixCount() == 1 + 2 * WRITERS);
+    assert(shared.deleteMatrix("X0", out) && shared.getMatrixCount() == 2 * WRITERS);
+    std::ostringstream listing;
+    assert(shared.listMatrices(listing) && listing.str().find("'S'") != std::string::npos);
+
+    std::cout << "✅ testConcurrentWorkspace passed!" << std::endl;
+}
+
+void testMatrixServer() {
+    ConcurrentWorkspace shared;
+    MatrixServer server(shared);
+    const int port = server.listen("127.0.0.1", 0);
+    assert(port > 0);
+    std::thread serving([&server] { server.serve(); });
+
+    Matrix a(3, 3), b(3, 3);
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j) {
+            a(i, j) = 1.0 / (i + j + 1) + (i == j ? 2.0 : 0.0);
+            b(i, j) = 0.1 * (3 * i + j) - 0.35;
+        }
+    Workspace local;
+    std::ostringstream sink;
+    local.setOutput(sink);
+    assert(local.putMatrix("A", Matrix(a)) && local.putMatrix("B", Matrix(b)) &&
+           local.multiplyMatrices("C", "A", "B"));
+    Matrix expected;
+    assert(local.getMatrix("C", expected));
+
+    {
+        MatrixClient client("127.0.0.1", port);
+        client.ping();
+        client.put("A", a);
+        client.put("B", b);
+
+        // Pipelined: every response comes back in order, the matrices bit for bit
+        using MatrixProtocol::Opcode;
+        auto nameOnly = [](const std::string& name) {
+            std::string payload;
+            MatrixProtocol::Writer(payload).str(name);
+            return payload;
+        };
+        std::string product;
+        MatrixProtocol::Writer names(product);
+        names.str("C");
+        names.str("A");
+        names.str("B");
+        const std::uint32_t first = client.send(Opcode::Multiply, product);
+        client.send(Opcode::Get, nameOnly("C"));
+        client.send(Opcode::Determinant, nameOnly("A"));
+        client.send(Opcode::Rank, nameOnly("B"));
+        client.send(Opcode::Get, nameOnly("missing"));
+        client.send(static_cast<Opcode>(0x7F));
+
+        std::vector<MatrixClient::Response> responses;
+        for (int i = 0; i < 6; ++i) responses.push_back(client.receive());
+        for (int i = 0; i < 6; ++i) assert(responses[i].requestId == first + i);
+        assert(responses[0].ok());
+        MatrixProtocol::Reader matrix(responses[1].payload.data(), responses[1].payload.size());
+        const Matrix c = matrix.matrix();
+        matrix.finish();
+        assert(c.getRows() == 3 && c.getCols() == 3);
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j) assert(c(i, j) == expected(i, j));
+        assert(MatrixProtocol::Reader(responses[2].payload.data(), responses[2].payload.size()).f64() ==
+               *local.determinantOf("A"));
+        assert(MatrixProtocol::Reader(responses[3].payload.data(), responses[3].payload.size()).i32() ==
+               *local.rankOf("B"));
+        assert(responses[4].status == MatrixProtocol::Status::Failed &&
+               responses[4].message().find("missing") != std::string::npos);
+        assert(responses[5].status == MatrixProtocol::Status::BadRequest);
+
+        // A second client sees the same workspace
+        MatrixClient other("127.0.0.1", port);
+        other.subtract("D", "C", "C");
+        assert(other.get("D")(1, 2) == 0.0);
+        assert(client.list().size() == 4);
+        other.remove("D");
+        bool threw = false;
+        try {
+            (void)client.get("D");
+        } catch (const MatrixServerError&) {
+            threw = true;
+        }
+        assert(threw && client.list().size() == 3);
+
+        // The result may name an operand; a system without a unique
+        // solution fails and leaves the result's old value in place
+        client.put("v", Matrix(3, 1, 1.0));
+        client.solve("v", "A", "v");
+        const Matrix x = client.get("v");
+        assertNear(a * x, Matrix(3, 1, 1.0), 1e-12);
+        client.put("S", Matrix(3, 3, 1.0));
+        client.put("keep", Matrix(2, 2, 7.0));
+        threw = false;
+        try {
+            client.solve("keep", "S", "v");
+        } catch (const MatrixServerError&) {
+            threw = true;
+        }
+        assert(threw && client.get("keep") == Matrix(2, 2, 7.0));
+        client.solve("A", "A", "v");
+        assert(client.get("A").getCols() == 1);
+    }
+
+    // Closed connections do not leave their threads behind: each accept
+    // joins the ones that have finished
+    for (int i = 0; i < 200; ++i) {
+        MatrixClient shortLived("127.0.0.1", port);
+        shortLived.ping();
+    }
+    bool reaped = false;
+    for (int attempt = 0; attempt < 200 && !reaped; ++attempt) {
+        MatrixClient probe("127.0.0.1", port);
+        probe.ping();
+        reaped = server.connectionThreads() <= 2; // the probe, maybe the one before it
+        if (!reaped) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    assert(reaped);
+
+    server.stop();
+    serving.join();
+
+    // A request over the server's limit closes the connection, unanswered
+    ConcurrentWorkspace strictShared;
+    MatrixServer strict(strictShared);
+    assert(strict.maxRequestBytes() == MatrixServer::DEFAULT_MAX_REQUEST);
+    strict.setMaxRequestBytes(64);
+    const int strictPort = strict.listen("127.0.0.1", 0);
+    std::thread strictServing([&strict] { strict.serve(); });
+    {
+        MatrixClient client("127.0.0.1", strictPort);
+        client.put("small", Matrix(2, 2, 1.0)); // 2 + 5 + 8 + 32 bytes
+        bool closed = false;
+        try {
+            client.put("large", Matrix(4, 4, 1.0));
+        } catch (const MatrixServerError&) {
+            closed = true;
+        }
+        assert(closed);
+    }
+    strict.stop();
+    strictServing.join();
+    std::cout << "✅ testMatrixServer passed!" << std::endl;
+}
+
+void testScriptMode() {
+    // Runs a script with std::cout and std::cerr captured; returns its exit status
+    const auto run = [](const std::string& text, bool verbose, bool async, std::string& out, std::string& err) {
+        std::istringstream script(text);
+        std::ostringstream capturedOut, capturedErr;
+        std::streambuf* previousOut = std::cout.rdbuf(capturedOut.rdbuf());
+        std::streambuf* previousErr = std::cerr.rdbuf(capturedErr.rdbuf());
+        int status;
+        {
+            CLI cli;
+            status = cli.runScript(script, verbose, async);
+        }
+        std::cout.rdbuf(previousOut);
+        std::cerr.rdbuf(previousErr);
+        out = capturedOut.str();
+        err = capturedErr.str();
+        return status;
+    };
+    const std::string failing =
+        "# comments and blank lines are skipped\n"
+        "\n"
+        "create A 2 2 1\n"
+        "   \n"
+        "assign A\n1\n2\n3\n4\n" // assign reads lines 6-9
+        "det A\n"
+        "transpose missing\n"
+        "exit\n"
+        "det A\n";              // after exit: not run
+
+    for (bool async : {false, true}) {
+        std::string out, err;
+        const int status = run(failing, false, async, out, err);
+        assert(status == 1);
+
+        // Quiet: only the result reaches std::cout (as -2 or -2.000, by the stream's format)
+        assert(out.rfind("Determinant of matrix 'A' is: -2", 0) == 0 && std::count(out.begin(), out.end(), '\n') == 1);
+
+        // The failure names its line and carries the command's own message
+        assert(err.find("Command failed at line 11: transpose missing\nMatrix 'missing' not found in workspace.\n") == 0);
+
+        // The summary: the total, then count and time per command name
+        std::istringstream summary(err.substr(err.find("Script finished: ")));
+        std::string line;
+        std::getline(summary, line);
+        assert(line.rfind("Script finished: 5 commands (1 failed) in ", 0) == 0);
+        std::vector<std::string> names;
+        while (std::getline(summary, line)) {
+            std::istringstream fields(line);
+            std::string name, unit;
+            int count = 0;
+            double milliseconds = -1.0;
+            fields >> name >> count >> milliseconds >> unit;
+            assert(fields && count == 1 && milliseconds >= 0.0 && unit == "ms");
+            names.push_back(name);
+        }
+        assert(names == std::vector<std::string>({"assign", "create", "det", "exit", "transpose"}));
+    }
+
+    // A clean script exits with 0; verbose shows every command's output and time
+    std::string out, err;
+    int status = run("create B 1 1 2\nrank B\n", false, false, out, err);
+    assert(status == 0 && out == "Rank of matrix 'B' is: 1\n" && err.find("Command failed") == std::string::npos);
+    status = run("create B 1 1 2\nrank B\n", true, false, out, err);
+    assert(status == 0 && out.find("Matrix 'B' created") == 0 && out.find("Rank of matrix 'B' is: 1") != std::string::npos);
+    assert(err.find("] create B 1 1 2\n") != std::string::npos && err.find("] rank B\n") != std::string::npos);
+
+    std::cout << "✅ testScriptMode passed!" << std::endl;
+}
+
 void testE2E() {
     Matrix mat1(2,2,1.0);
     Matrix mat2(2,2,1.0);
@@ -419,6 +2385,37 @@ int main() {
     testSolveUniqueNoAndInfinite();
     testOperators();
     testVectorRotation();
+    testBlockedMultiplyMatchesReference();
+    testElementwiseKernels();
+    testMoveSemantics();
+    testExpressionTemplates();
+    testEliminationOnLargerSystems();
+    testLUDecomposition();
+    testLUUpdate();
+    testDerivedDataCache();
+    testQRDecomposition();
+    testMatrixBatch();
+    testParallelFor();
+    testParallelPolicyGivesSameResults();
+    testStrassenMultiply();
+    testBlockedLUDecomposition();
+    testTransposeKernels();
+    testBinaryWorkspaceFile();
+    testTextWorkspaceFile();
+    testSparseMatrix();
+    testSparseWorkspaceFile();
+    testIterativeSolvers();
+    testFixedMatrix();
+    testFixedSizeDispatch();
+    testMatrixAllocator();
+    testFloatMatrix();
+    testOutOfCoreMatrix();
+    testCopyOnWrite();
+    testProfiler();
+    testTaskScheduler();
+    testConcurrentWorkspace();
+    testMatrixServer();
+    testScriptMode();
     testE2E();
     return 0;
 }